@@ -1,10 +1,14 @@
 ﻿// ============================================================================
 // AccurateRip.cpp - AccurateRip implementation
 // ============================================================================
+#define NOMINMAX
 #include "AccurateRip.h"
+#include "AccurateRipCache.h"
+#include "ArCrcKernel.h"
 #include <winhttp.h>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 #pragma comment(lib, "winhttp.lib")
 
@@ -23,37 +27,109 @@ static int CountAudioTracks(const DiscInfo& disc) {
 	return count;
 }
 
-uint32_t AccurateRip::CalculateCRC(const std::vector<std::vector<BYTE>>& sectors,
-	int trackNum, int totalTracks, DWORD trackStartLBA) {
-	uint32_t crc = 0;
-	uint32_t mult = 1;  // Always start at 1 for each track
+// Helper: last LBA of audio track i as AccurateRip defines it — the next
+// audio track's startLBA - 1, or the audio lead-out - 1.  The stored endLBA
+// may have been trimmed by pregap scanning, and on enhanced CDs the data
+// track must not be counted.
+static DWORD GetAccurateRipEndLBA(const DiscInfo& disc, size_t i) {
+	for (size_t j = i + 1; j < disc.tracks.size(); j++) {
+		if (disc.tracks[j].isAudio) return disc.tracks[j].startLBA - 1;
+	}
+	return GetAudioLeadOut(disc) - 1;
+}
 
-	// AccurateRip V1: Skip first/last 5 sectors (2940 samples) of DISC
-	// For first track: skip first 5 sectors
-	// For last track: skip last 5 sectors
-	size_t skipStartSectors = (trackNum == 1) ? 5 : 0;
-	size_t skipEndSectors = (trackNum == totalTracks) ? 5 : 0;
+// ── AccurateRip window bounds ───────────────────────────────────────────
+// AccurateRip skips the first 5 sectors of the first track (multipliers
+// below 2940) and the last 5 sectors of the last track.  [a, b] is the
+// inclusive multiplier range that contributes to the CRC.
+static bool CrcWindow(size_t trackLength, bool firstTrack, bool lastTrack,
+	size_t& a, size_t& b) {
+	const size_t SKIP = 5 * 588;
+	a = firstTrack ? SKIP : 1;
+	b = lastTrack ? (trackLength > SKIP ? trackLength - SKIP : 0) : trackLength;
+	return trackLength > 0 && b >= a;
+}
 
-	for (size_t i = 0; i < sectors.size(); i++) {
-		const BYTE* data = sectors[i].data();
+uint32_t AccurateRip::CalculateCRC(const SectorSpan& sectors,
+	int trackNum, int totalTracks, uint32_t* crcV2) {
+	ArCrcSums sums;
+	size_t a = 0, b = 0;
+
+	// The multiplier is the 1-based sample position in the track; skipped
+	// edge samples still advance it, they just do not contribute.  The
+	// audio plane is packed, so the whole window is one run of samples.
+	if (CrcWindow(sectors.count * 588, trackNum == 1, trackNum == totalTracks, a, b)) {
+		if (sectors.stride == AUDIO_SECTOR_SIZE) {
+			ArCrcKernel::Accumulate(sectors.data + (a - 1) * 4, b - a + 1,
+				static_cast<uint32_t>(a), sums);
+		}
+		else {
+			for (size_t i = 0; i < sectors.count; i++) {
+				size_t first = i * 588 + 1;
+				size_t lo = std::max(a, first);
+				size_t hi = std::min(b, first + 587);
+				if (lo > hi) continue;
+				ArCrcKernel::Accumulate(sectors.Sector(i) + (lo - first) * 4, hi - lo + 1,
+					static_cast<uint32_t>(lo), sums);
+			}
+		}
+	}
 
-		for (int j = 0; j < AUDIO_SECTOR_SIZE; j += 4) {
-			uint32_t sample = static_cast<uint32_t>(data[j]) |
-				(static_cast<uint32_t>(data[j + 1]) << 8) |
-				(static_cast<uint32_t>(data[j + 2]) << 16) |
-				(static_cast<uint32_t>(data[j + 3]) << 24);
+	if (crcV2) *crcV2 = sums.v2;
+	return sums.v1;
+}
 
-			// Skip first 5 sectors of first track, last 5 sectors of last track
-			bool skip = (trackNum == 1 && i < skipStartSectors) ||
-				(trackNum == totalTracks && i >= sectors.size() - skipEndSectors);
+// Clip the multiplier range [a, b] to the samples that exist in a buffer
+// of sampleCount samples when multiplier 1 sits at index p.  Samples
+// outside the buffer count as silence and contribute nothing.
+static bool ClipToBuffer(ptrdiff_t p, size_t sampleCount, size_t& a, size_t& b) {
+	ptrdiff_t lo = std::max<ptrdiff_t>(static_cast<ptrdiff_t>(a), 1 - p);
+	ptrdiff_t hi = std::min<ptrdiff_t>(static_cast<ptrdiff_t>(b),
+		static_cast<ptrdiff_t>(sampleCount) - p);
+	if (lo > hi) return false;
+	a = static_cast<size_t>(lo);
+	b = static_cast<size_t>(hi);
+	return true;
+}
 
-			if (!skip) {
-				crc += sample * mult;
-			}
-			mult++;  // Always increment — mult is the 1-based sample position in the track
-		}
+void AccurateRip::CalculateCRCForOffsets(const uint32_t* samples, size_t sampleCount,
+	size_t trackStart, size_t trackLength, bool firstTrack, bool lastTrack,
+	int minOffset, int maxOffset, std::vector<uint32_t>& crcs) {
+
+	crcs.assign(maxOffset >= minOffset ? static_cast<size_t>(maxOffset - minOffset + 1) : 0, 0);
+	size_t a = 0, b = 0;
+	if (crcs.empty() || !CrcWindow(trackLength, firstTrack, lastTrack, a, b)) return;
+
+	// Samples outside the buffer read as silence, like a refused overread.
+	auto x = [&](ptrdiff_t i) -> uint32_t {
+		return (i >= 0 && static_cast<size_t>(i) < sampleCount) ? samples[i] : 0;
+	};
+
+	// p is the buffer index of multiplier 1 at the current offset.
+	//   C(p) = sum k * x[p+k-1]   and   S(p) = sum x[p+k-1]   for k in [a, b]
+	// Moving the window one sample later only touches the two edge samples:
+	//   C(p+1) = C(p) - S(p) - (a-1) * x[p+a-1] + b * x[p+b]
+	//   S(p+1) = S(p) - x[p+a-1] + x[p+b]
+	// All arithmetic is modulo 2^32, exactly like the CRC itself.
+	ptrdiff_t p = static_cast<ptrdiff_t>(trackStart) + minOffset;
+	ArCrcSums initial;
+	size_t lo = a, hi = b;
+	if (ClipToBuffer(p, sampleCount, lo, hi)) {
+		ArCrcKernel::Accumulate(samples + (p + static_cast<ptrdiff_t>(lo) - 1), hi - lo + 1,
+			static_cast<uint32_t>(lo), initial);
+	}
+	uint32_t crc = initial.v1, sum = initial.sum;
+	crcs[0] = crc;
+
+	const uint32_t aMinus1 = static_cast<uint32_t>(a - 1);
+	const uint32_t bMult = static_cast<uint32_t>(b);
+	for (size_t i = 1; i < crcs.size(); i++, p++) {
+		uint32_t leaving = x(p + static_cast<ptrdiff_t>(a) - 1);
+		uint32_t entering = x(p + static_cast<ptrdiff_t>(b));
+		crc = crc - sum - aMinus1 * leaving + bMult * entering;
+		sum = sum - leaving + entering;
+		crcs[i] = crc;
 	}
-	return crc;
 }
 
 uint32_t AccurateRip::CalculateDiscID1(const DiscInfo& disc) {
@@ -122,32 +198,113 @@ static bool IsInternetAvailable() {
 	return available;
 }
 
-bool AccurateRip::Lookup(DiscInfo& disc, std::vector<std::vector<uint32_t>>& pressingCRCs) {
-	pressingCRCs.clear();
+bool AccurateRip::ParseResponse(const BYTE* data, size_t size, int trackCount,
+	std::vector<AccurateRipPressing>& pressings) {
+	pressings.clear();
+	if (!data || trackCount <= 0) return false;
+
+	const size_t headerSize = 13;
+	const size_t v1PerTrack = 5;
+	const size_t v2PerTrack = 9;
+	size_t v1ChunkSize = headerSize + trackCount * v1PerTrack;
+	size_t v2ChunkSize = headerSize + trackCount * v2PerTrack;
+
+	size_t perTrack = 0;
+	size_t chunkSize = 0;
+	if (size >= v2ChunkSize && size % v2ChunkSize == 0) {
+		perTrack = v2PerTrack;
+		chunkSize = v2ChunkSize;
+	}
+	else if (size >= v1ChunkSize && size % v1ChunkSize == 0) {
+		perTrack = v1PerTrack;
+		chunkSize = v1ChunkSize;
+	}
+	else if (size >= v2ChunkSize) {
+		perTrack = v2PerTrack;
+		chunkSize = v2ChunkSize;
+	}
+	else if (size >= v1ChunkSize) {
+		perTrack = v1PerTrack;
+		chunkSize = v1ChunkSize;
+	}
+	if (perTrack == 0) return false;
+
+	// Parse ALL pressings (chunks).  Each chunk header is the track count
+	// followed by the three disc IDs.
+	auto readLE32 = [data](size_t pos) {
+		return static_cast<uint32_t>(data[pos]) |
+			(static_cast<uint32_t>(data[pos + 1]) << 8) |
+			(static_cast<uint32_t>(data[pos + 2]) << 16) |
+			(static_cast<uint32_t>(data[pos + 3]) << 24);
+	};
+
+	size_t chunkOffset = 0;
+	while (chunkOffset + chunkSize <= size) {
+		AccurateRipPressing pressing;
+		pressing.discId1 = readLE32(chunkOffset + 1);
+		pressing.discId2 = readLE32(chunkOffset + 5);
+		pressing.cddbId = readLE32(chunkOffset + 9);
+		pressing.tracks.resize(trackCount);
+		size_t pos = chunkOffset + headerSize;
+
+		for (int t = 0; t < trackCount; t++) {
+			auto& ref = pressing.tracks[t];
+			ref.confidence = data[pos];
+			ref.crcV1 = readLE32(pos + 1);
+			if (perTrack == v2PerTrack) {
+				ref.crc450 = readLE32(pos + 5);
+			}
+			pos += perTrack;
+		}
 
-	if (!IsInternetAvailable()) {
-		std::cout << "  SKIPPED: No internet connection available\n";
-		return false;
+		pressings.push_back(std::move(pressing));
+		chunkOffset += chunkSize;
 	}
+	return !pressings.empty();
+}
 
-	uint32_t discId1 = CalculateDiscID1(disc);
-	uint32_t discId2 = CalculateDiscID2(disc);
-	uint32_t cddbId = CalculateCDDBID(disc);
-	int trackCount = CountAudioTracks(disc);
+bool AccurateRip::Lookup(DiscInfo& disc) {
+	auto& pressings = disc.accurateRipPressings;
+	pressings.clear();
 
-	char url[256];
-	snprintf(url, sizeof(url),
-		"/accuraterip/%x/%x/%x/dBAR-%03d-%08x-%08x-%08x.bin",
-		discId1 & 0xF, (discId1 >> 4) & 0xF, (discId1 >> 8) & 0xF,
-		trackCount, discId1, discId2, cddbId);
+	AccurateRipDiscKey key;
+	key.discId1 = CalculateDiscID1(disc);
+	key.discId2 = CalculateDiscID2(disc);
+	key.cddbId = CalculateCDDBID(disc);
+	key.trackCount = CountAudioTracks(disc);
 
 	std::cout << "AccurateRip lookup...\n";
 	std::cout << "  Disc ID 1: " << std::hex << std::setfill('0')
-		<< std::setw(8) << discId1 << std::dec << "\n";
+		<< std::setw(8) << key.discId1 << std::dec << "\n";
 	std::cout << "  Disc ID 2: " << std::hex << std::setfill('0')
-		<< std::setw(8) << discId2 << std::dec << "\n";
+		<< std::setw(8) << key.discId2 << std::dec << "\n";
 	std::cout << "  CDDB ID:   " << std::hex << std::setfill('0')
-		<< std::setw(8) << cddbId << std::dec << "\n";
+		<< std::setw(8) << key.cddbId << std::dec << std::setfill(' ') << "\n";
+
+	// The local cache answers without touching the network; in offline
+	// mode it is the only source.
+	auto& cache = AccurateRipCache::Instance();
+	std::vector<BYTE> data;
+	if (cache.Find(key, data) && ParseResponse(data.data(), data.size(), key.trackCount, pressings)) {
+		std::cout << "  FOUND in local AccurateRip cache\n";
+		std::cout << "  Found " << pressings.size() << " pressing(s)\n";
+		return true;
+	}
+	if (cache.IsOffline()) {
+		std::cout << "  SKIPPED: Offline mode (disc not in local AccurateRip cache)\n";
+		return false;
+	}
+
+	if (!IsInternetAvailable()) {
+		std::cout << "  SKIPPED: No internet connection available\n";
+		return false;
+	}
+
+	char url[256];
+	snprintf(url, sizeof(url),
+		"/accuraterip/%x/%x/%x/dBAR-%03d-%08x-%08x-%08x.bin",
+		key.discId1 & 0xF, (key.discId1 >> 4) & 0xF, (key.discId1 >> 8) & 0xF,
+		key.trackCount, key.discId1, key.discId2, key.cddbId);
 
 	HINTERNET hSession = WinHttpOpen(L"AudioCopy/1.0",
 		WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, nullptr, nullptr, 0);
@@ -184,7 +341,6 @@ bool AccurateRip::Lookup(DiscInfo& disc, std::vector<std::vector<uint32_t>>& pre
 			found = true;
 			std::cout << "  FOUND in AccurateRip database!\n";
 
-			std::vector<BYTE> data;
 			DWORD bytesAvailable = 0;
 			while (WinHttpQueryDataAvailable(hRequest, &bytesAvailable) && bytesAvailable > 0) {
 				std::vector<BYTE> buffer(bytesAvailable);
@@ -194,54 +350,9 @@ bool AccurateRip::Lookup(DiscInfo& disc, std::vector<std::vector<uint32_t>>& pre
 				}
 			}
 
-			const size_t headerSize = 13;
-			const size_t v1PerTrack = 5;
-			const size_t v2PerTrack = 9;
-			size_t v1ChunkSize = headerSize + trackCount * v1PerTrack;
-			size_t v2ChunkSize = headerSize + trackCount * v2PerTrack;
-
-			size_t perTrack = 0;
-			size_t chunkSize = 0;
-			if (data.size() >= v2ChunkSize && data.size() % v2ChunkSize == 0) {
-				perTrack = v2PerTrack;
-				chunkSize = v2ChunkSize;
-			}
-			else if (data.size() >= v1ChunkSize && data.size() % v1ChunkSize == 0) {
-				perTrack = v1PerTrack;
-				chunkSize = v1ChunkSize;
-			}
-			else if (data.size() >= v2ChunkSize) {
-				perTrack = v2PerTrack;
-				chunkSize = v2ChunkSize;
-			}
-			else if (data.size() >= v1ChunkSize) {
-				perTrack = v1PerTrack;
-				chunkSize = v1ChunkSize;
-			}
-
-			if (perTrack > 0 && chunkSize > 0) {
-				// Parse ALL pressings (chunks) in the response
-				size_t chunkOffset = 0;
-				while (chunkOffset + chunkSize <= data.size()) {
-					std::vector<uint32_t> pressing(trackCount, 0);
-					size_t pos = chunkOffset + headerSize;
-
-					for (int t = 0; t < trackCount && pos + perTrack <= chunkOffset + chunkSize; t++) {
-						pos++;  // skip confidence byte
-						pressing[t] = static_cast<uint32_t>(data[pos]) |
-							(static_cast<uint32_t>(data[pos + 1]) << 8) |
-							(static_cast<uint32_t>(data[pos + 2]) << 16) |
-							(static_cast<uint32_t>(data[pos + 3]) << 24);
-						pos += 4;
-						if (perTrack == v2PerTrack) {
-							pos += 4;  // skip CRC v2
-						}
-					}
-
-					pressingCRCs.push_back(std::move(pressing));
-					chunkOffset += chunkSize;
-				}
-				std::cout << "  Found " << pressingCRCs.size() << " pressing(s)\n";
+			if (ParseResponse(data.data(), data.size(), key.trackCount, pressings)) {
+				std::cout << "  Found " << pressings.size() << " pressing(s)\n";
+				cache.Store(key, data.data(), data.size());
 			}
 		}
 		else if (statusCode == 404) {
@@ -255,7 +366,30 @@ bool AccurateRip::Lookup(DiscInfo& disc, std::vector<std::vector<uint32_t>>& pre
 	return found;
 }
 
-bool AccurateRip::VerifyCRCs(const DiscInfo& disc, const std::vector<std::vector<uint32_t>>& pressingCRCs) {
+// Best pressing whose track entry agrees with the given CRCs.  V2
+// submissions occupy their own chunks in the database and store their
+// checksum in the same slot as V1, so both CRCs are matched against
+// crcV1.  Returns the 0-based pressing index or -1.
+static int FindPressing(const std::vector<AccurateRipPressing>& pressings,
+	int audioTrackIdx, uint32_t crcV1, uint32_t crcV2, bool& matchedV2) {
+	int best = -1;
+	int bestConfidence = -1;
+	for (size_t p = 0; p < pressings.size(); p++) {
+		if (audioTrackIdx >= static_cast<int>(pressings[p].tracks.size())) continue;
+		const auto& ref = pressings[p].tracks[audioTrackIdx];
+		bool v1 = ref.crcV1 != 0 && ref.crcV1 == crcV1;
+		bool v2 = crcV2 != 0 && ref.crcV1 == crcV2;
+		if ((v1 || v2) && ref.confidence > bestConfidence) {
+			best = static_cast<int>(p);
+			bestConfidence = ref.confidence;
+			matchedV2 = v2;
+		}
+	}
+	return best;
+}
+
+bool AccurateRip::VerifyCRCs(const DiscInfo& disc) {
+	const auto& pressings = disc.accurateRipPressings;
 	std::cout << "\n=== AccurateRip CRC Verification ===\n";
 	bool allMatch = true;
 	int audioTrackIdx = 0;
@@ -264,7 +398,8 @@ bool AccurateRip::VerifyCRCs(const DiscInfo& disc, const std::vector<std::vector
 	// Build a flat-offset table: for each track, compute where its startLBA
 	// data begins inside the rawSectors array.  This avoids fragile sequential
 	// index tracking that breaks when AccurateRip boundaries don't match the
-	// stored (possibly pregap-trimmed) boundaries.
+	// stored (possibly pregap-trimmed) boundaries.  Tracks outside the
+	// selected session were never read and take no room.
 	std::vector<size_t> trackDataOffset(disc.tracks.size());
 	size_t cumulative = 0;
 	for (size_t i = 0; i < disc.tracks.size(); i++) {
@@ -272,64 +407,89 @@ bool AccurateRip::VerifyCRCs(const DiscInfo& disc, const std::vector<std::vector
 			? disc.tracks[i].startLBA
 			: disc.tracks[i].pregapLBA;
 		trackDataOffset[i] = cumulative + (disc.tracks[i].startLBA - readStart);
+		if (disc.selectedSession > 0 && disc.tracks[i].session != disc.selectedSession) continue;
 		cumulative += disc.tracks[i].endLBA - readStart + 1;
 	}
 
-	DWORD audioLeadOut = GetAudioLeadOut(disc);
+	// The whole audio plane viewed as packed samples, for the offset search.
+	// A streamed rip has handed most of it back already; only the CRCs
+	// accumulated during the read are available then.
+	const bool storeResident = !disc.rawSectors.HasReleased();
+	const uint32_t* allSamples = storeResident
+		? reinterpret_cast<const uint32_t*>(disc.rawSectors.AudioSpan().data) : nullptr;
+	size_t allSampleCount = disc.rawSectors.size() * 588;
+
+	// Rips of a pressing cut with a different offset only differ by a shift;
+	// AccurateRip's own tools search the same ±(5 sectors - 1) range.
+	constexpr int MAX_PRESSING_SHIFT = 5 * 588 - 1;
+	std::vector<uint32_t> shiftedCRCs;
 
 	for (size_t i = 0; i < disc.tracks.size(); i++) {
 		const auto& t = disc.tracks[i];
 		if (!t.isAudio) continue;
 
-		// AccurateRip defines track boundaries by the original TOC:
-		//   startLBA  →  next audio track's startLBA - 1   (or audio lead-out - 1 for last audio track)
-		// The stored endLBA may have been trimmed by pregap scanning, so we
-		// reconstruct the original boundary here.
-		// For enhanced CDs, use the audio session lead-out instead of the
-		// data track's startLBA.
-		DWORD originalEndLBA = audioLeadOut - 1;  // default: last audio track
-		for (size_t j = i + 1; j < disc.tracks.size(); j++) {
-			if (disc.tracks[j].isAudio) {
-				originalEndLBA = disc.tracks[j].startLBA - 1;
-				break;
-			}
+		bool firstTrack = (audioTrackIdx == 0);
+		bool lastTrack = (audioTrackIdx + 1 == totalAudioTracks);
+		DWORD arSectorCount = GetAccurateRipEndLBA(disc, i) - t.startLBA + 1;
+
+		// Prefer the checksums accumulated while reading; fall back to a
+		// pass over the store when the stream missed part of the window
+		// (e.g. pregaps skipped) or the offset changed since the rip.
+		uint32_t crcV1 = 0, crcV2 = 0;
+		const AccurateRipTrackCRC* streamed =
+			(audioTrackIdx < static_cast<int>(disc.accurateRipTracks.size()))
+			? &disc.accurateRipTracks[audioTrackIdx] : nullptr;
+		if (streamed && streamed->IsComplete() && streamed->readOffset == disc.driveOffset) {
+			crcV1 = streamed->crcV1;
+			crcV2 = streamed->crcV2;
+		}
+		else if (!storeResident) {
+			std::cout << "Track " << std::setw(2) << t.trackNumber
+				<< ": [NOT COMPUTED - audio was streamed to disk]\n";
+			allMatch = false;
+			audioTrackIdx++;
+			continue;
 		}
-		DWORD arSectorCount = originalEndLBA - t.startLBA + 1;
-
-		// Use absolute offset — sectors are contiguous in rawSectors because
-		// each track's readStart == previous track's endLBA + 1.
-		size_t baseIdx = trackDataOffset[i];
-		std::vector<std::vector<BYTE>> trackSectors;
-		for (DWORD j = 0; j < arSectorCount && baseIdx + j < disc.rawSectors.size(); j++) {
-			std::vector<BYTE> audioOnly(AUDIO_SECTOR_SIZE);
-			memcpy(audioOnly.data(), disc.rawSectors[baseIdx + j].data(), AUDIO_SECTOR_SIZE);
-			trackSectors.push_back(std::move(audioOnly));
+		else {
+			// Sectors are contiguous in rawSectors because each track's
+			// readStart == previous track's endLBA + 1.  The span views the
+			// store directly; nothing is copied.
+			SectorSpan trackSectors = disc.rawSectors.AudioSpan(trackDataOffset[i], arSectorCount);
+			crcV1 = CalculateCRC(trackSectors, audioTrackIdx + 1, totalAudioTracks, &crcV2);
 		}
 
-		uint32_t crc = CalculateCRC(trackSectors, audioTrackIdx + 1,
-			totalAudioTracks, t.startLBA);
-
-		// Check calculated CRC against ALL pressings
-		bool match = false;
-		int matchedPressing = -1;
-		for (size_t p = 0; p < pressingCRCs.size(); p++) {
-			if (audioTrackIdx < static_cast<int>(pressingCRCs[p].size()) &&
-				crc == pressingCRCs[p][audioTrackIdx]) {
-				match = true;
-				matchedPressing = static_cast<int>(p) + 1;
-				break;
+		bool matchedV2 = false;
+		int shift = 0;
+		int matched = FindPressing(pressings, audioTrackIdx, crcV1, crcV2, matchedV2);
+
+		// No pressing at our offset — slide the window over the store once
+		// and look for a pressing at a shifted offset, nearest shift first.
+		if (matched < 0 && !pressings.empty() && allSamples) {
+			CalculateCRCForOffsets(allSamples, allSampleCount,
+				trackDataOffset[i] * 588, static_cast<size_t>(arSectorCount) * 588,
+				firstTrack, lastTrack, -MAX_PRESSING_SHIFT, MAX_PRESSING_SHIFT, shiftedCRCs);
+			for (int d = 1; d <= MAX_PRESSING_SHIFT && matched < 0; d++) {
+				for (int s : { d, -d }) {
+					uint32_t crc = shiftedCRCs[s + MAX_PRESSING_SHIFT];
+					if (crc == 0) continue;
+					matched = FindPressing(pressings, audioTrackIdx, crc, 0, matchedV2);
+					if (matched >= 0) { shift = s; break; }
+				}
 			}
 		}
 
-		std::cout << "Track " << std::setw(2) << t.trackNumber << ": CRC = "
-			<< std::hex << std::setw(8) << std::setfill('0') << crc
+		std::cout << "Track " << std::setw(2) << t.trackNumber << ": V1 = "
+			<< std::hex << std::setw(8) << std::setfill('0') << crcV1
+			<< "  V2 = " << std::setw(8) << crcV2
 			<< std::dec << std::setfill(' ');
 
-		if (pressingCRCs.empty()) {
+		if (pressings.empty()) {
 			std::cout << "  [NO REFERENCE]\n";
 		}
-		else if (match) {
-			std::cout << "  [OK - pressing #" << matchedPressing << "]\n";
+		else if (matched >= 0) {
+			std::cout << "  [OK " << (matchedV2 ? "V2" : "V1") << " - pressing #" << (matched + 1);
+			if (shift != 0) std::cout << ", offset " << std::showpos << shift << std::noshowpos;
+			std::cout << ", confidence " << pressings[matched].tracks[audioTrackIdx].confidence << "]\n";
 		}
 		else {
 			std::cout << "  [MISMATCH]\n";
@@ -340,4 +500,83 @@ bool AccurateRip::VerifyCRCs(const DiscInfo& disc, const std::vector<std::vector
 	}
 
 	return allMatch;
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// AccurateRipStream
+// ============================================================================
+
+void AccurateRipStream::Begin(const DiscInfo& disc) {
+	m_windows.clear();
+	m_tracks.clear();
+	m_offset = disc.driveOffset;
+
+	int totalAudioTracks = CountAudioTracks(disc);
+	int audioTrackIdx = 0;
+	for (size_t i = 0; i < disc.tracks.size(); i++) {
+		const auto& t = disc.tracks[i];
+		if (!t.isAudio) continue;
+
+		DWORD endLBA = GetAccurateRipEndLBA(disc, i);
+		size_t trackLength = (endLBA >= t.startLBA) ? (endLBA - t.startLBA + 1) * 588 : 0;
+
+		Window w;
+		w.firstSample = static_cast<int64_t>(t.startLBA) * 588;
+		AccurateRipTrackCRC crc;
+		crc.trackNumber = t.trackNumber;
+		crc.readOffset = m_offset;
+
+		size_t a = 0, b = 0;
+		if (CrcWindow(trackLength, audioTrackIdx == 0, audioTrackIdx + 1 == totalAudioTracks, a, b)) {
+			w.multFirst = static_cast<int64_t>(a);
+			w.multLast = static_cast<int64_t>(b);
+			crc.samplesExpected = w.multLast - w.multFirst + 1;
+		}
+		else {
+			w.multFirst = 1;
+			w.multLast = 0;     // empty window — never complete
+		}
+
+		m_windows.push_back(w);
+		m_tracks.push_back(crc);
+		audioTrackIdx++;
+	}
+}
+
+void AccurateRipStream::Accumulate(DWORD lba, const BYTE* audio, bool remove) {
+	if (m_windows.empty() || !audio) return;
+
+	// Raw sample j of this sector lands at corrected position first + j once
+	// ApplyOffsetCorrection has shifted the stream by m_offset samples.
+	const int64_t first = static_cast<int64_t>(lba) * 588 - m_offset;
+	const int64_t last = first + 587;
+
+	// A sector straddles at most one track boundary: start from the last
+	// window that begins at or before its final sample and walk back.
+	size_t w = std::upper_bound(m_windows.begin(), m_windows.end(), last,
+		[](int64_t pos, const Window& win) { return pos < win.firstSample; }) - m_windows.begin();
+	while (w-- > 0) {
+		const Window& win = m_windows[w];
+		int64_t lo = std::max(first, win.firstSample + win.multFirst - 1);
+		int64_t hi = std::min(last, win.firstSample + win.multLast - 1);
+		if (lo <= hi) {
+			ArCrcSums sums;
+			ArCrcKernel::Accumulate(audio + (lo - first) * 4, static_cast<size_t>(hi - lo + 1),
+				static_cast<uint32_t>(lo - win.firstSample + 1), sums);
+			uint32_t v1 = sums.v1, v2 = sums.v2;
+
+			auto& crc = m_tracks[w];
+			if (remove) {
+				crc.crcV1 -= v1;
+				crc.crcV2 -= v2;
+				crc.samplesFed -= hi - lo + 1;
+			}
+			else {
+				crc.crcV1 += v1;
+				crc.crcV2 += v2;
+				crc.samplesFed += hi - lo + 1;
+			}
+		}
+		if (win.firstSample <= first) break;
+	}
+}
@@ -5,21 +5,78 @@
 
 #include "DiscTypes.h"
 #include <cstdint>
+#include <vector>
 
 class AccurateRip {
 public:
-    // CRC calculation
-    static uint32_t CalculateCRC(const std::vector<std::vector<BYTE>>& sectors,
-        int trackNum, int totalTracks, DWORD trackStart);
+    // V1 CRC of one track's audio (and V2 through crcV2 when non-null).
+    // trackNum / totalTracks are 1-based audio track positions; they decide
+    // whether the disc-edge samples are skipped.
+    static uint32_t CalculateCRC(const SectorSpan& sectors,
+        int trackNum, int totalTracks, uint32_t* crcV2 = nullptr);
+
+    // V1 CRC of one track for every read offset in [minOffset, maxOffset],
+    // computed from a single buffer with an O(1) sliding update per offset.
+    // `samples` holds packed stereo samples (L | R << 16) for the track plus
+    // at least |offset| samples of margin on each side; trackStart is the
+    // index of the track's first nominal sample.  crcs[i] is the CRC at
+    // offset minOffset + i.  Samples outside the buffer count as silence.
+    static void CalculateCRCForOffsets(const uint32_t* samples, size_t sampleCount,
+        size_t trackStart, size_t trackLength, bool firstTrack, bool lastTrack,
+        int minOffset, int maxOffset, std::vector<uint32_t>& crcs);
 
     // Disc ID calculations
     static uint32_t CalculateDiscID1(const DiscInfo& disc);
     static uint32_t CalculateDiscID2(const DiscInfo& disc);
     static uint32_t CalculateCDDBID(const DiscInfo& disc);
 
-    // Database lookup — fetches per-track CRCs for ALL pressings
-    static bool Lookup(DiscInfo& disc, std::vector<std::vector<uint32_t>>& pressingCRCs);
+    // Database lookup — fetches the checksums of ALL pressings (V1, or V2
+    // for V2 submissions, in the one CRC slot per track) into
+    // disc.accurateRipPressings.  The local dBAR cache is consulted first
+    // (see AccurateRipCache); network responses are added to it.
+    static bool Lookup(DiscInfo& disc);
+
+    // Parse a dBAR response (one or more pressing chunks) for a disc with
+    // trackCount audio tracks.  Returns false if no chunk could be read.
+    static bool ParseResponse(const BYTE* data, size_t size, int trackCount,
+        std::vector<AccurateRipPressing>& pressings);
+
+    // Verify every audio track against every pressing in
+    // disc.accurateRipPressings.  Uses the CRCs streamed during the rip
+    // when they are complete, otherwise recomputes from disc.rawSectors.
+    // Tracks that match no pressing are retried at shifted offsets so rips
+    // of a pressing with a different offset are still recognised.
+    static bool VerifyCRCs(const DiscInfo& disc);
+};
+
+// ── Streaming AccurateRip accumulator ───────────────────────────────────────
+// V1 and V2 are both plain sums over (sample, position) pairs, so they can
+// be built sector by sector as the read loop delivers audio, in any order.
+// Sectors are fed as read, before offset correction; Begin() records the
+// disc.driveOffset that ApplyOffsetCorrection will later apply and maps each
+// raw sample to its corrected position.  A sector that is re-read and
+// replaced is retracted with RemoveSector() before the new data is added.
+class AccurateRipStream {
+public:
+    // Lay out the AccurateRip window of every audio track.
+    void Begin(const DiscInfo& disc);
+
+    void AddSector(DWORD lba, const BYTE* audio) { Accumulate(lba, audio, false); }
+    void RemoveSector(DWORD lba, const BYTE* audio) { Accumulate(lba, audio, true); }
+
+    const std::vector<AccurateRipTrackCRC>& Results() const { return m_tracks; }
+
+private:
+    // Absolute corrected sample positions (LBA * 588 + sample).
+    struct Window {
+        int64_t firstSample = 0;    // Position of multiplier 1
+        int64_t multFirst = 0;      // First multiplier that contributes
+        int64_t multLast = 0;       // Last multiplier that contributes
+    };
+
+    void Accumulate(DWORD lba, const BYTE* audio, bool remove);
 
-    // Verify CRCs for all tracks against all pressings
-    static bool VerifyCRCs(const DiscInfo& disc, const std::vector<std::vector<uint32_t>>& pressingCRCs);
-};
\ No newline at end of file
+    std::vector<Window> m_windows;
+    std::vector<AccurateRipTrackCRC> m_tracks;
+    int m_offset = 0;
+};
@@ -0,0 +1,365 @@
+﻿// ============================================================================
+// AccurateRipCache.cpp - Memory-mapped dBAR cache implementation
+// ============================================================================
+#include "AccurateRipCache.h"
+#include "AccurateRip.h"
+#include <shlobj.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+// ── On-disk layout ──────────────────────────────────────────────────────────
+//   FileHeader
+//   Slot[slotCount]        open-addressed table, linear probing
+//   payloads               raw dBAR bytes, referenced by Slot::offset
+// All fields are little-endian, as written by x86/x64.
+namespace {
+	constexpr char CACHE_MAGIC[8] = { 'A', 'R', 'D', 'B', 'C', 'A', 'C', 'H' };
+	constexpr uint32_t CACHE_VERSION = 1;
+	constexpr uint32_t FLAG_OFFLINE = 0x1;
+	constexpr uint32_t MIN_SLOTS = 64;
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t flags;          // FLAG_*
+		uint32_t slotCount;      // Power of two
+		uint32_t entryCount;
+		uint64_t fileSize;
+	};
+
+	// trackCount == 0 marks an empty slot (a disc always has audio tracks).
+	struct Slot {
+		uint32_t discId1;
+		uint32_t discId2;
+		uint32_t cddbId;
+		uint32_t trackCount;
+		uint64_t offset;         // Payload position from the start of the file
+		uint32_t size;           // Payload length in bytes
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(FileHeader) == 32, "cache header layout changed");
+	static_assert(sizeof(Slot) == 32, "cache slot layout changed");
+
+	uint32_t HashKey(const AccurateRipDiscKey& key) {
+		uint32_t h = key.discId1 * 0x9E3779B1u;
+		h ^= key.discId2 * 0x85EBCA77u + (h << 6) + (h >> 2);
+		h ^= key.cddbId * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+		h ^= static_cast<uint32_t>(key.trackCount);
+		// murmur3 finaliser — spreads the bits used by the slot mask
+		h ^= h >> 16; h *= 0x85EBCA6Bu;
+		h ^= h >> 13; h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	struct KeyHash {
+		size_t operator()(const AccurateRipDiscKey& key) const { return HashKey(key); }
+	};
+
+	uint32_t ReadLE32(const BYTE* p) {
+		return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+			(static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	// A dBAR chunk header is the track count followed by the three disc IDs,
+	// so a file identifies itself without relying on its name.
+	bool KeyFromDbar(const BYTE* data, size_t size, AccurateRipDiscKey& key) {
+		if (size < 13 || data[0] == 0) return false;
+		key.trackCount = data[0];
+		key.discId1 = ReadLE32(data + 1);
+		key.discId2 = ReadLE32(data + 5);
+		key.cddbId = ReadLE32(data + 9);
+		return true;
+	}
+
+	bool HasBinExtension(const std::filesystem::path& p) {
+		std::string ext = p.extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(),
+			[](unsigned char c) { return static_cast<char>(tolower(c)); });
+		return ext == ".bin";
+	}
+}
+
+// ============================================================================
+// Construction / mapping
+// ============================================================================
+
+AccurateRipCache& AccurateRipCache::Instance() {
+	static AccurateRipCache instance;
+	return instance;
+}
+
+AccurateRipCache::AccurateRipCache() : m_path(DefaultPath()) {
+	MapFile();
+}
+
+AccurateRipCache::~AccurateRipCache() {
+	UnmapFile();
+}
+
+std::filesystem::path AccurateRipCache::DefaultPath() {
+	wchar_t* appDataPath = nullptr;
+	if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &appDataPath))) {
+		std::filesystem::path dir = std::filesystem::path(appDataPath) / L"AudioCopy";
+		CoTaskMemFree(appDataPath);
+
+		std::error_code ec;
+		std::filesystem::create_directories(dir, ec);
+		return dir / L"accuraterip.cache";
+	}
+	return L"accuraterip.cache";
+}
+
+bool AccurateRipCache::Open(const std::filesystem::path& path) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	UnmapFile();
+	m_path = path;
+	return MapFile();
+}
+
+// A missing or unrecognised file is an empty cache, not an error — the
+// next write replaces it.
+bool AccurateRipCache::MapFile() {
+	std::error_code ec;
+	if (!std::filesystem::exists(m_path, ec)) return true;
+
+	m_file = CreateFileW(m_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader))) {
+		UnmapFile();
+		return true;
+	}
+
+	m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping) {
+		m_view = static_cast<const BYTE*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (!m_view) {
+		UnmapFile();
+		return false;
+	}
+	m_viewSize = static_cast<size_t>(size.QuadPart);
+
+	const auto* header = reinterpret_cast<const FileHeader*>(m_view);
+	uint64_t tableEnd = sizeof(FileHeader) + static_cast<uint64_t>(header->slotCount) * sizeof(Slot);
+	bool valid = memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+		header->version == CACHE_VERSION &&
+		header->slotCount != 0 && (header->slotCount & (header->slotCount - 1)) == 0 &&
+		tableEnd <= m_viewSize;
+	if (!valid) UnmapFile();
+	return true;
+}
+
+void AccurateRipCache::UnmapFile() {
+	if (m_view) UnmapViewOfFile(m_view);
+	if (m_mapping) CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+	m_view = nullptr;
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+	m_viewSize = 0;
+}
+
+// ============================================================================
+// Lookup
+// ============================================================================
+
+bool AccurateRipCache::Probe(const AccurateRipDiscKey& key, const BYTE*& data, size_t& size) const {
+	if (!m_view || key.trackCount <= 0) return false;
+
+	const auto* header = reinterpret_cast<const FileHeader*>(m_view);
+	const auto* slots = reinterpret_cast<const Slot*>(m_view + sizeof(FileHeader));
+	uint32_t mask = header->slotCount - 1;
+
+	for (uint32_t i = 0, idx = HashKey(key) & mask; i < header->slotCount; i++, idx = (idx + 1) & mask) {
+		const Slot& slot = slots[idx];
+		if (slot.trackCount == 0) return false;
+		if (slot.discId1 != key.discId1 || slot.discId2 != key.discId2 ||
+			slot.cddbId != key.cddbId || slot.trackCount != static_cast<uint32_t>(key.trackCount))
+			continue;
+		if (slot.offset > m_viewSize || slot.size > m_viewSize - slot.offset) return false;
+		data = m_view + slot.offset;
+		size = slot.size;
+		return true;
+	}
+	return false;
+}
+
+bool AccurateRipCache::Find(const AccurateRipDiscKey& key, std::vector<BYTE>& dbar) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const BYTE* data = nullptr;
+	size_t size = 0;
+	if (!Probe(key, data, size)) return false;
+	dbar.assign(data, data + size);
+	return true;
+}
+
+size_t AccurateRipCache::FindBatch(const std::vector<AccurateRipDiscKey>& keys,
+	std::vector<std::vector<BYTE>>& dbars) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	dbars.assign(keys.size(), {});
+	size_t hits = 0;
+	for (size_t i = 0; i < keys.size(); i++) {
+		const BYTE* data = nullptr;
+		size_t size = 0;
+		if (!Probe(keys[i], data, size)) continue;
+		dbars[i].assign(data, data + size);
+		hits++;
+	}
+	return hits;
+}
+
+bool AccurateRipCache::OfflineFlag() const {
+	return m_view && (reinterpret_cast<const FileHeader*>(m_view)->flags & FLAG_OFFLINE) != 0;
+}
+
+bool AccurateRipCache::IsOffline() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return OfflineFlag();
+}
+
+size_t AccurateRipCache::Count() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_view ? reinterpret_cast<const FileHeader*>(m_view)->entryCount : 0;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+bool AccurateRipCache::Store(const AccurateRipDiscKey& key, const BYTE* dbar, size_t size) {
+	if (!dbar || size == 0) return false;
+	std::vector<AccurateRipCacheEntry> entries(1);
+	entries[0].key = key;
+	entries[0].dbar.assign(dbar, dbar + size);
+	return StoreBatch(entries);
+}
+
+bool AccurateRipCache::StoreBatch(const std::vector<AccurateRipCacheEntry>& entries) {
+	for (const auto& entry : entries) {
+		if (entry.dbar.empty() || entry.key.trackCount <= 0) return false;
+	}
+	if (entries.empty()) return true;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return Rebuild(entries, OfflineFlag());
+}
+
+bool AccurateRipCache::SetOffline(bool offline) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (OfflineFlag() == offline) return true;
+	return Rebuild({}, offline);
+}
+
+bool AccurateRipCache::ImportFolder(const std::filesystem::path& folder, AccurateRipImportStats& stats) {
+	stats = AccurateRipImportStats{};
+	std::vector<AccurateRipCacheEntry> additions;
+	std::vector<AccurateRipPressing> pressings;
+
+	std::error_code ec;
+	for (std::filesystem::recursive_directory_iterator it(folder, ec), end; !ec && it != end; it.increment(ec)) {
+		if (!it->is_regular_file(ec) || !HasBinExtension(it->path())) continue;
+
+		std::ifstream in(it->path(), std::ios::binary);
+		std::vector<BYTE> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+		AccurateRipCacheEntry entry;
+		if (!KeyFromDbar(data.data(), data.size(), entry.key) ||
+			!AccurateRip::ParseResponse(data.data(), data.size(), entry.key.trackCount, pressings)) {
+			stats.rejected++;
+			continue;
+		}
+		entry.dbar = std::move(data);
+		additions.push_back(std::move(entry));
+		stats.imported++;
+	}
+	if (ec && additions.empty()) return false;
+	return StoreBatch(additions);
+}
+
+// Write the merged table to a temporary file and swap it in.  Payloads of
+// existing entries are copied straight out of the current mapping.
+bool AccurateRipCache::Rebuild(const std::vector<AccurateRipCacheEntry>& additions, bool offline) {
+	struct Item {
+		AccurateRipDiscKey key;
+		const BYTE* data;
+		size_t size;
+	};
+	std::vector<Item> items;
+	std::unordered_set<AccurateRipDiscKey, KeyHash> seen;
+
+	// Newest first, so a later import of the same disc wins.
+	for (auto it = additions.rbegin(); it != additions.rend(); ++it) {
+		if (seen.insert(it->key).second) items.push_back({ it->key, it->dbar.data(), it->dbar.size() });
+	}
+	if (m_view) {
+		const auto* header = reinterpret_cast<const FileHeader*>(m_view);
+		const auto* slots = reinterpret_cast<const Slot*>(m_view + sizeof(FileHeader));
+		for (uint32_t i = 0; i < header->slotCount; i++) {
+			const Slot& slot = slots[i];
+			if (slot.trackCount == 0) continue;
+			if (slot.offset > m_viewSize || slot.size > m_viewSize - slot.offset) continue;
+			AccurateRipDiscKey key{ slot.discId1, slot.discId2, slot.cddbId, static_cast<int>(slot.trackCount) };
+			if (seen.insert(key).second) items.push_back({ key, m_view + slot.offset, slot.size });
+		}
+	}
+
+	// Keep the load factor at or below one half so probes stay short.
+	uint32_t slotCount = MIN_SLOTS;
+	while (slotCount < items.size() * 2) slotCount <<= 1;
+
+	FileHeader header{};
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.flags = offline ? FLAG_OFFLINE : 0;
+	header.slotCount = slotCount;
+	header.entryCount = static_cast<uint32_t>(items.size());
+
+	std::vector<Slot> slots(slotCount, Slot{});
+	uint64_t offset = sizeof(FileHeader) + static_cast<uint64_t>(slotCount) * sizeof(Slot);
+	for (const auto& item : items) {
+		uint32_t idx = HashKey(item.key) & (slotCount - 1);
+		while (slots[idx].trackCount != 0) idx = (idx + 1) & (slotCount - 1);
+		Slot& slot = slots[idx];
+		slot.discId1 = item.key.discId1;
+		slot.discId2 = item.key.discId2;
+		slot.cddbId = item.key.cddbId;
+		slot.trackCount = static_cast<uint32_t>(item.key.trackCount);
+		slot.offset = offset;
+		slot.size = static_cast<uint32_t>(item.size);
+		offset += item.size;
+	}
+	header.fileSize = offset;
+
+	std::filesystem::path tempPath = m_path;
+	tempPath += L".tmp";
+	{
+		std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(Slot));
+		for (const auto& item : items) {
+			out.write(reinterpret_cast<const char*>(item.data), item.size);
+		}
+		if (!out) {
+			out.close();
+			std::error_code ec;
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+	}
+
+	UnmapFile();
+	std::error_code ec;
+	std::filesystem::rename(tempPath, m_path, ec);
+	bool replaced = !ec;
+	if (!replaced) std::filesystem::remove(tempPath, ec);
+	MapFile();
+	return replaced;
+}
@@ -0,0 +1,103 @@
+﻿// ============================================================================
+// AccurateRipCache.h - Local, memory-mapped cache of AccurateRip dBAR files
+//
+// Stores raw dBAR responses in %LOCALAPPDATA%\AudioCopy\accuraterip.cache,
+// keyed by (discId1, discId2, cddbId, trackCount).  The file is an
+// open-addressed hash table of fixed-size slots followed by the dBAR
+// payloads, mapped read-only, so a lookup is one hash probe and a copy of a
+// few hundred bytes — no parsing of the whole cache and no network.
+//
+// Writes (a fresh network response, a bulk import) rebuild the file into a
+// temporary copy and swap it in, so a crash never leaves a torn cache.
+// Every write costs a full rewrite, so callers with several responses hand
+// them over together through StoreBatch and pay for it once.
+// ============================================================================
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Identifies one dBAR file — the same tuple that names it on the server.
+struct AccurateRipDiscKey {
+	uint32_t discId1 = 0;
+	uint32_t discId2 = 0;
+	uint32_t cddbId = 0;
+	int trackCount = 0;
+
+	bool operator==(const AccurateRipDiscKey& o) const {
+		return discId1 == o.discId1 && discId2 == o.discId2 &&
+			cddbId == o.cddbId && trackCount == o.trackCount;
+	}
+};
+
+// One dBAR response and the disc it belongs to.
+struct AccurateRipCacheEntry {
+	AccurateRipDiscKey key;
+	std::vector<BYTE> dbar;
+};
+
+struct AccurateRipImportStats {
+	int imported = 0;       // dBAR files added or replaced
+	int rejected = 0;       // files that did not parse as dBAR
+};
+
+class AccurateRipCache {
+public:
+	// Get the singleton instance (maps the default cache file on first use)
+	static AccurateRipCache& Instance();
+
+	// Copy the cached dBAR bytes for `key` into `dbar`.
+	bool Find(const AccurateRipDiscKey& key, std::vector<BYTE>& dbar);
+
+	// Look up several discs under one lock.  dbars[i] receives the bytes for
+	// keys[i], or is left empty on a miss.  Returns the number of hits.
+	size_t FindBatch(const std::vector<AccurateRipDiscKey>& keys,
+		std::vector<std::vector<BYTE>>& dbars);
+
+	// Add or replace one dBAR response (one rebuild of the file).
+	bool Store(const AccurateRipDiscKey& key, const BYTE* dbar, size_t size);
+
+	// Add or replace several responses with a single rebuild.  A later entry
+	// for the same disc wins over an earlier one.
+	bool StoreBatch(const std::vector<AccurateRipCacheEntry>& entries);
+
+	// Import every *.bin file below `folder` (recursively) in one rebuild.
+	// The key of each file is taken from its first chunk header.
+	bool ImportFolder(const std::filesystem::path& folder, AccurateRipImportStats& stats);
+
+	// Offline mode: Lookup answers from the cache only and never opens a
+	// network connection.  The setting is stored in the cache file.
+	bool IsOffline();
+	bool SetOffline(bool offline);
+
+	size_t Count();
+	std::filesystem::path GetCachePath() const { return m_path; }
+
+	// Use a different cache file (e.g. a shared one on an ingest server).
+	bool Open(const std::filesystem::path& path);
+
+private:
+	AccurateRipCache();
+	~AccurateRipCache();
+	AccurateRipCache(const AccurateRipCache&) = delete;
+	AccurateRipCache& operator=(const AccurateRipCache&) = delete;
+
+	bool MapFile();
+	void UnmapFile();
+	bool Rebuild(const std::vector<AccurateRipCacheEntry>& additions, bool offline);
+	bool Probe(const AccurateRipDiscKey& key, const BYTE*& data, size_t& size) const;
+	bool OfflineFlag() const;
+
+	static std::filesystem::path DefaultPath();
+
+	std::filesystem::path m_path;
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+	const BYTE* m_view = nullptr;
+	size_t m_viewSize = 0;
+	std::mutex m_mutex;
+};
@@ -23,7 +23,7 @@ struct MultiPassResult {
 	int passesMatched = 0;       // Number of passes that returned the same data
 	int totalPasses = 0;         // Total number of read passes
 	bool allMatch = false;       // true if every pass returned identical data
-	uint32_t majorityHash = 0;   // Hash of the most-common read result
+	uint64_t majorityHash = 0;   // Hash prefix of the most-common read result
 };
 
 // ── Seek time analysis result ───────────────────────────────────────────────
@@ -0,0 +1,172 @@
+﻿// ============================================================================
+// ArCrcKernel.cpp - Scalar / SSE2 / AVX2 AccurateRip checksum kernels
+// ============================================================================
+#include "ArCrcKernel.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define AR_CRC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts AVX2 intrinsics in any function; GCC/Clang need the target
+// enabled per function so the rest of the file stays baseline code.
+#if defined(__GNUC__) || defined(__clang__)
+#define AR_CRC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AR_CRC_TARGET_AVX2
+#endif
+
+namespace {
+	using KernelFn = void (*)(const unsigned char*, size_t, uint32_t, ArCrcSums&);
+
+	void AccumulateScalar(const unsigned char* data, size_t count, uint32_t mult, ArCrcSums& sums) {
+		uint32_t v1 = sums.v1, v2 = sums.v2, sum = sums.sum;
+		for (size_t i = 0; i < count; i++, mult++) {
+			uint32_t x;
+			memcpy(&x, data + i * 4, sizeof(x));
+			uint64_t prod = static_cast<uint64_t>(x) * mult;
+			uint32_t lo = static_cast<uint32_t>(prod);
+			v1 += lo;
+			v2 += lo + static_cast<uint32_t>(prod >> 32);
+			sum += x;
+		}
+		sums.v1 = v1;
+		sums.v2 = v2;
+		sums.sum = sum;
+	}
+
+#ifdef AR_CRC_X86
+	// pmuludq multiplies the even 32-bit lanes into full 64-bit products.
+	// Adding those products into 32-bit lanes keeps the low halves in the
+	// even lanes and the high halves in the odd lanes, so after the loop
+	// V1 is the sum of the even lanes and V2 the sum of all lanes — no
+	// per-step shuffles or 64-bit adds.
+	void AccumulateSSE2(const unsigned char* data, size_t count, uint32_t mult, ArCrcSums& sums) {
+		size_t vecCount = count & ~static_cast<size_t>(3);
+		if (vecCount > 0) {
+			__m128i m = _mm_setr_epi32(static_cast<int>(mult), static_cast<int>(mult + 1),
+				static_cast<int>(mult + 2), static_cast<int>(mult + 3));
+			const __m128i step = _mm_set1_epi32(4);
+			__m128i accProd = _mm_setzero_si128();
+			__m128i accSum = _mm_setzero_si128();
+
+			for (size_t i = 0; i < vecCount; i += 4) {
+				__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+				__m128i even = _mm_mul_epu32(x, m);
+				__m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(m, 32));
+				accProd = _mm_add_epi32(accProd, _mm_add_epi32(even, odd));
+				accSum = _mm_add_epi32(accSum, x);
+				m = _mm_add_epi32(m, step);
+			}
+
+			uint32_t prod[4], total[4];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(prod), accProd);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(total), accSum);
+			sums.v1 += prod[0] + prod[2];
+			sums.v2 += prod[0] + prod[1] + prod[2] + prod[3];
+			sums.sum += total[0] + total[1] + total[2] + total[3];
+		}
+		AccumulateScalar(data + vecCount * 4, count - vecCount,
+			mult + static_cast<uint32_t>(vecCount), sums);
+	}
+
+	AR_CRC_TARGET_AVX2
+	void AccumulateAVX2(const unsigned char* data, size_t count, uint32_t mult, ArCrcSums& sums) {
+		size_t vecCount = count & ~static_cast<size_t>(7);
+		if (vecCount > 0) {
+			__m256i m = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(mult)),
+				_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			const __m256i step = _mm256_set1_epi32(8);
+			__m256i accProd = _mm256_setzero_si256();
+			__m256i accSum = _mm256_setzero_si256();
+
+			for (size_t i = 0; i < vecCount; i += 8) {
+				__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i * 4));
+				__m256i even = _mm256_mul_epu32(x, m);
+				__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(m, 32));
+				accProd = _mm256_add_epi32(accProd, _mm256_add_epi32(even, odd));
+				accSum = _mm256_add_epi32(accSum, x);
+				m = _mm256_add_epi32(m, step);
+			}
+
+			uint32_t prod[8], total[8];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(prod), accProd);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(total), accSum);
+			for (int lane = 0; lane < 8; lane += 2) {
+				sums.v1 += prod[lane];
+				sums.v2 += prod[lane] + prod[lane + 1];
+				sums.sum += total[lane] + total[lane + 1];
+			}
+		}
+		AccumulateScalar(data + vecCount * 4, count - vecCount,
+			mult + static_cast<uint32_t>(vecCount), sums);
+	}
+
+	// AVX2 needs both the CPUID feature bit and OS support for saving the
+	// YMM registers (OSXSAVE + XCR0 bits 1 and 2).
+	bool CpuHasAVX2() {
+#ifdef _MSC_VER
+		int regs[4] = {};
+		__cpuid(regs, 0);
+		if (regs[0] < 7) return false;
+		__cpuid(regs, 1);
+		bool osxsave = (regs[2] & (1 << 27)) != 0;
+		bool avx = (regs[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx) return false;
+		if ((_xgetbv(0) & 0x6) != 0x6) return false;
+		__cpuidex(regs, 7, 0);
+		return (regs[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	bool CpuHasSSE2() {
+#if defined(_M_X64) || defined(__x86_64__)
+		return true;    // part of the x64 baseline
+#elif defined(_MSC_VER)
+		int regs[4] = {};
+		__cpuid(regs, 1);
+		return (regs[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+#endif
+
+	struct Dispatch {
+		KernelFn fn = AccumulateScalar;
+		const char* name = "scalar";
+	};
+
+	const Dispatch& Selected() {
+		static const Dispatch selected = [] {
+			Dispatch d;
+#ifdef AR_CRC_X86
+			if (CpuHasAVX2()) {
+				d.fn = AccumulateAVX2;
+				d.name = "AVX2";
+			}
+			else if (CpuHasSSE2()) {
+				d.fn = AccumulateSSE2;
+				d.name = "SSE2";
+			}
+#endif
+			return d;
+		}();
+		return selected;
+	}
+}
+
+void ArCrcKernel::Accumulate(const void* samples, size_t count, uint32_t firstMult, ArCrcSums& sums) {
+	if (count == 0) return;
+	Selected().fn(static_cast<const unsigned char*>(samples), count, firstMult, sums);
+}
+
+const char* ArCrcKernel::Name() {
+	return Selected().name;
+}
@@ -0,0 +1,38 @@
+﻿// ============================================================================
+// ArCrcKernel.h - Vectorised AccurateRip checksum kernel
+//
+// Every AccurateRip path (rip verification, the streaming accumulator and
+// offset calibration) reduces to the same inner sum over a run of packed
+// stereo samples x[i] (L | R << 16) with consecutive multipliers m, m+1, ...
+//
+//   V1  += lo32(x[i] * (m + i))
+//   V2  += lo32(x[i] * (m + i)) + hi32(x[i] * (m + i))
+//   Sum += x[i]                     (needed by the sliding offset update)
+//
+// Callers clip the run to the AccurateRip window first, so the kernel has
+// no per-sample skip test.  The implementation is chosen once per process
+// from CPUID: AVX2 (8 samples per step), SSE2 (4 samples per step) or
+// portable scalar code.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Running totals of one or more Accumulate() calls.  All arithmetic is
+// modulo 2^32, like the checksums themselves.
+struct ArCrcSums {
+	uint32_t v1 = 0;
+	uint32_t v2 = 0;
+	uint32_t sum = 0;
+};
+
+class ArCrcKernel {
+public:
+	// Add `count` little-endian 32-bit samples starting at `samples` (no
+	// alignment required), the first one weighted by firstMult.
+	static void Accumulate(const void* samples, size_t count, uint32_t firstMult, ArCrcSums& sums);
+
+	// Implementation selected for this CPU: "AVX2", "SSE2" or "scalar".
+	static const char* Name();
+};
@@ -7,9 +7,16 @@
 #include "ScsiDrive.h"
 #include "Progress.h"
 #include "ConsoleColors.h"
+#include "OffsetCorrelator.h"
+#include "SectorHash.h"
+#include "SecureSectorTable.h"
 #include <functional>
 #include <string>
 
+class DiscLayout;
+class RipStreamWriter;
+class ScanAnalyzer;
+
 class AudioCDCopier {
 public:
 	AudioCDCopier() = default;
@@ -34,6 +41,7 @@ public:
 	int SelectCacheDefeat();
 	int SelectHideCDRMedia();
 	int SelectSilentMode();
+	int SelectRipOutput();
 	int SelectPlextorWriteOptions(bool& outTestWrite, bool& outVariRecEnable, int& outVariRecOffset);
 
 	// TOC reading
@@ -53,6 +61,9 @@ public:
 	bool ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config,
 		SecureRipResult& result, std::function<void(int, int)> progress = nullptr);
 	bool ReadDiscBurst(DiscInfo& disc, std::function<void(int, int)> progress = nullptr, int speedOverride = 0);
+	// While set, the read loops pass finished sectors to `stream` (see
+	// RipStream.h) and the store only keeps what is still pending.
+	void SetRipStream(RipStreamWriter* stream) { m_stream = stream; }
 
 	// Quality scanning
 	bool RunBlerScan(const DiscInfo& disc, BlerResult& result, int scanSpeed = 8);
@@ -69,6 +80,10 @@ public:
 
 	// Output
 	bool SaveToFile(const DiscInfo& disc, const std::wstring& basePath);
+	// The .cue and summary half of SaveToFile, for an image whose .bin /
+	// .sub were streamed during the read.
+	bool SaveCueSheet(const DiscInfo& disc, const std::wstring& basePath,
+		const std::vector<std::wstring>& pregapFiles);
 	bool SaveBlerLog(const BlerResult& result, const std::wstring& filename);
 	void PrintBlerGraph(const BlerResult& result, int width = 60, int height = 10);
 	bool SaveReadLog(const DiscInfo& disc, const std::wstring& filename);
@@ -132,13 +147,19 @@ public:
 
 	// CRC verification
 	uint32_t CalculateTrackCRC(const DiscInfo& disc, int trackIndex);
+	// (trackNumber, CRC) for every audio track, in TOC order
+	std::vector<std::pair<int, uint32_t>> CalculateTrackCRCs(const DiscInfo& disc);
 	bool VerifyTrackCRCs(const DiscInfo& disc, std::vector<CRCVerification>& results);
 	bool CompareDiscCRCs(const std::vector<std::pair<int, uint32_t>>& originalCRCs,
 		const std::vector<std::pair<int, uint32_t>>& copyCRCs);
-	int DetectSampleOffset(const std::vector<std::vector<BYTE>>& origSectors,
-		const std::vector<std::vector<BYTE>>& copySectors,
-		int maxOffsetSamples = 3000);
-	void ApplySampleOffset(std::vector<std::vector<BYTE>>& rawSectors, int offsetSamples);
+	// Cut evenly spaced probe windows from a rip so they can outlive the
+	// bulk data; returns each window's first sector index in `sectors`.
+	std::vector<size_t> ExtractOffsetProbes(const SectorStore& sectors, SectorStore& probes);
+	// Correlate every probe window against the same position of the copy.
+	SampleOffsetResult DetectDiscSampleOffset(const SectorStore& origProbes,
+		const std::vector<size_t>& probeStarts, const SectorStore& copySectors,
+		int maxOffsetSamples = OffsetCorrelator::ONE_SECOND_SAMPLES);
+	void ApplySampleOffset(SectorStore& sectors, int offsetSamples);
 
 	// Drive capabilities
 	bool DetectDriveCapabilities(DriveCapabilities& caps);
@@ -226,25 +247,65 @@ private:
 	// Internal constants
 	static constexpr int MAX_RETRIES = 5;
 	static constexpr int RETRY_SPEED_REDUCTION = 4;
+	static constexpr DWORD CACHE_DEFEAT_DISTANCE = 750;
+	static constexpr DWORD CACHE_DEFEAT_INTERVAL = 20;
+	// Extra distance beyond a defeat span and its read-ahead.
+	static constexpr DWORD CACHE_DEFEAT_MARGIN = 75;
+
+	// Measured audio cache of the drive (PrepareCacheDefeat); until then,
+	// and when its size is unknown, the fixed distance and interval apply.
+	DriveCacheProfile m_cacheProfile;
+	// Sectors the drive may still be holding from earlier reads; re-reads
+	// are only scheduled behind a cache defeat inside this window.
+	DWORD m_cacheWindowSectors = CACHE_DEFEAT_DISTANCE;
+
+	// Streaming output for the current read (SetRipStream), or nullptr.
+	RipStreamWriter* m_stream = nullptr;
 
 	// Internal reading methods
 	bool ReadSectorWithRetry(DWORD lba, BYTE* data, int sectorSize, bool isAudio,
 		bool includeSubchannel, int& retryCount, bool detectC2, int* c2Errors);
 	bool ReadSectorSecure(DWORD lba, BYTE* data, int sectorSize, bool isAudio,
 		const SecureRipConfig& config, SecureSectorResult& result, DWORD maxLBA = 0);
+	// ReadSectorSecure in steps: Begin, one SectorRescuePass per pass (no
+	// cache defeat — the caller schedules those), then Finish.
+	void BeginSectorRescue(SectorRescue& rescue, DWORD lba, const BYTE* current,
+		int sectorSize, bool isAudio);
+	void SectorRescuePass(SectorRescue& rescue, const SecureRipConfig& config, int pass);
+	void FinishSectorRescue(SectorRescue& rescue, const SecureRipConfig& config);
 	bool DefeatDriveCache(DWORD currentLBA, DWORD maxLBA = 0);
+	// Load (or measure once) the drive's cache profile and size the defeat
+	// window, distance and interval from it.
+	void PrepareCacheDefeat(const DiscInfo& disc);
+	// Sectors between periodic defeats in sequential reads (0 = never).
+	DWORD CacheDefeatInterval() const;
+	// Seek distance of a defeat when the cache size is not known.
+	DWORD SeekDefeatDistance() const;
 	bool FlushDriveCache();
-	uint32_t HashSector(const BYTE* data, int size);
-	uint32_t CalculateSectorHash(const BYTE* data);
-
-	// Shared utility
-	DWORD CalculateTotalAudioSectors(const DiscInfo& disc) const;
+	SectorHash HashSector(const BYTE* data, int size);
+	SectorHash CalculateSectorHash(const BYTE* data);
 
 	// Disc rot analysis helpers
-	void ClassifyZone(DWORD lba, DWORD firstLBA, DWORD lastLBA, int c2Errors, DiscZoneStats& zones);
+	void ClassifyZone(DWORD lba, DWORD firstLBA, DWORD lastLBA, int c2Errors, DiscZoneStats& zones,
+		int weight = 1);
 	int CalculateClusterTolerance(int scanSpeed);
 	void DetectErrorClusters(const std::vector<DWORD>& errorLBAs, std::vector<ErrorCluster>& clusters, int scanSpeed = 8);
 	std::string AssessRotRisk(const DiscRotAnalysis& result);
+	void SetRotRecommendation(DiscRotAnalysis& result);
+
+	// Per-sector scan analyzers (ScanAnalyzers.h)
+	class BlerAnalyzer;
+	class RotZoneAnalyzer;
+	class AudioContentAnalyzer;
+	// One C2 read (with per-sector C1 when withC1) of every sector in the
+	// layout, handed to each analyzer in turn.  verifyC2 re-reads C2-positive
+	// sectors once for ScanSector::verifiedC2.  False if cancelled.
+	bool RunScanPass(const DiscLayout& layout, int scanSpeed, bool withC1, bool verifyC2,
+		const std::vector<ScanAnalyzer*>& analyzers);
+	// Speed comparison on (LBA, track end LBA) samples: all of them at low
+	// speed, then all at high speed.  False if cancelled.
+	bool CompareSpeedsAtSamples(const std::vector<std::pair<DWORD, DWORD>>& samples,
+		std::vector<SpeedComparisonResult>& results);
 	int CalculateOverallScore(const ComprehensiveScanResult& result);
 
 	// Audio analysis helpers
@@ -1,6 +1,8 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
+#include "ScanAnalyzers.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -15,7 +17,8 @@ bool AudioCDCopier::AnalyzeAudioContent(DiscInfo& disc, AudioAnalysisResult& res
 	result = AudioAnalysisResult{};
 	m_drive.SetSpeed(scanSpeed);
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to analyze.\n";
 		return false;
@@ -26,11 +29,8 @@ bool AudioCDCopier::AnalyzeAudioContent(DiscInfo& disc, AudioAnalysisResult& res
 
 	// Count expected samples accurately (sampling restarts per track)
 	int totalSamples = 0;
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		DWORD trackSectors = t.endLBA - start + 1;
-		totalSamples += static_cast<int>((trackSectors + sampleInterval - 1) / sampleInterval);
+	for (const auto& span : layout.Spans()) {
+		totalSamples += static_cast<int>((span.Count() + sampleInterval - 1) / sampleInterval);
 	}
 	totalSamples = std::max(1, totalSamples);
 
@@ -42,14 +42,10 @@ bool AudioCDCopier::AnalyzeAudioContent(DiscInfo& disc, AudioAnalysisResult& res
 	progress.Start();
 
 	std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
-	int tested = 0;
-	int readFailures = 0;
+	AudioContentAnalyzer analyzer(*this, result);
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-
-		for (DWORD lba = start; lba <= t.endLBA; lba += sampleInterval) {
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba += sampleInterval) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				std::cout << "\n\n*** Analysis cancelled by user ***\n";
 				m_drive.SetSpeed(0);
@@ -57,67 +53,21 @@ bool AudioCDCopier::AnalyzeAudioContent(DiscInfo& disc, AudioAnalysisResult& res
 				return false;
 			}
 
-			if (!m_drive.ReadSectorAudioOnly(lba, buf.data())) {
-				readFailures++;
-				tested++;
-				progress.Update(tested, totalSamples);
-				continue;
-			}
-
-			bool suspicious = false;
-			bool silent = IsSectorSilent(buf.data());
-
-			if (silent) {
-				result.silentSectors++;
-			}
-			if (IsSectorClipped(buf.data())) {
-				result.clippedSectors++;
-				suspicious = true;
-			}
-
-			// Calculate RMS level for accurate low-level detection
-			int64_t sampleSum = 0;
-			int sampleCount = AUDIO_SECTOR_SIZE / 2;
-			for (int i = 0; i < AUDIO_SECTOR_SIZE; i += 2) {
-				int16_t sample = *reinterpret_cast<const int16_t*>(buf.data() + i);
-				sampleSum += static_cast<int64_t>(sample) * sample;  // RMS calculation
-			}
-			double rms = std::sqrt(static_cast<double>(sampleSum) / sampleCount);
-
-			// Low-level if RMS < 1000 (about 3% of max)
-			if (rms > 50 && rms < 1000 && !silent) {
-				result.lowLevelSectors++;
-				suspicious = true;
-			}
-
-			// Per-channel DC offset detection
-			// Check each channel independently so single-channel bias is not masked
-			int64_t dcSumL = 0, dcSumR = 0;
-			int channelSamples = AUDIO_SECTOR_SIZE / 4;  // samples per channel
-			for (int i = 0; i < AUDIO_SECTOR_SIZE; i += 4) {
-				dcSumL += *reinterpret_cast<const int16_t*>(buf.data() + i);
-				dcSumR += *reinterpret_cast<const int16_t*>(buf.data() + i + 2);
-			}
-			double dcOffsetL = std::abs(static_cast<double>(dcSumL) / channelSamples);
-			double dcOffsetR = std::abs(static_cast<double>(dcSumR) / channelSamples);
-			double dcOffset = std::max(dcOffsetL, dcOffsetR);
-			if (dcOffset > 1000.0) {  // ~3% of max: filters normal audio asymmetry
-				result.dcOffsetSectors++;
-				suspicious = true;
-			}
-
-			if (suspicious) {
-				result.suspiciousLBAs.push_back(lba);
-			}
-
-			tested++;
-			progress.Update(tested, totalSamples);
+			ScanSector sector;
+			sector.lba = lba;
+			sector.audio = buf.data();
+			sector.readOk = m_drive.ReadSectorAudioOnly(lba, buf.data());
+			analyzer.AddSector(sector);
+			progress.Update(analyzer.Tested(), totalSamples);
 		}
 	}
 
 	progress.Finish(true);
 	m_drive.SetSpeed(0);
 
+	int tested = analyzer.Tested();
+	int readFailures = analyzer.ReadFailures();
+
 	std::cout << "\n" << std::string(60, '=') << "\n";
 	std::cout << "           AUDIO CONTENT ANALYSIS REPORT\n";
 	std::cout << std::string(60, '=') << "\n";
@@ -164,12 +114,7 @@ bool AudioCDCopier::AnalyzeAudioContent(DiscInfo& disc, AudioAnalysisResult& res
 		std::cout << "  (Sectors flagged for clipping, DC offset, or low level - may need re-read)\n";
 		for (int i = 0; i < showCount; i++) {
 			DWORD lba = result.suspiciousLBAs[i];
-			int trackNum = 0;
-			for (const auto& t : disc.tracks) {
-				DWORD tStart = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-				if (lba >= tStart && lba <= t.endLBA) { trackNum = t.trackNumber; break; }
-			}
-			std::cout << "  LBA " << std::setw(8) << lba << "  (Track " << trackNum << ")\n";
+			std::cout << "  LBA " << std::setw(8) << lba << "  (Track " << layout.TrackAt(lba) << ")\n";
 		}
 	}
 
@@ -1,9 +1,9 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
 #include "InterruptHandler.h"
+#include "SecureSectorTable.h"
 #include <iostream>
 #include <conio.h>
-#include <map>
 #include <cstring>
 
 // ============================================================================
@@ -57,111 +57,190 @@ bool AudioCDCopier::ReadSectorWithRetry(DWORD lba, BYTE* data, int sectorSize,
 
 bool AudioCDCopier::ReadSectorSecure(DWORD lba, BYTE* data, int sectorSize, bool isAudio,
 	const SecureRipConfig& config, SecureSectorResult& result, DWORD maxLBA) {
-	result.lba = lba;
-	result.totalPasses = 0;
-	result.matchingPasses = 0;
-	result.c2ErrorPasses = 0;
-	result.isSecure = false;
-
-	std::map<uint32_t, std::pair<int, std::vector<BYTE>>> hashCounts;
-
-	int consecutiveReadFailures = 0;
-	int consecutiveUnusableReads = 0;
-	constexpr int MAX_CONSECUTIVE_READ_FAILURES = 3;
-	constexpr int MAX_CONSECUTIVE_UNUSABLE = 5;
-
-	for (int pass = 0; pass < config.maxPasses; pass++) {
-		result.totalPasses++;
+	// One sector, every pass back to back — a cache defeat before each re-read.
+	SectorRescue rescue;
+	BeginSectorRescue(rescue, lba, data, sectorSize, isAudio);
 
+	for (int pass = 0; pass < config.maxPasses && !rescue.finished; pass++) {
 		if (config.cacheDefeat && pass > 0) {
 			DefeatDriveCache(lba, maxLBA);
-			result.usedCacheDefeat = true;
+			rescue.result.usedCacheDefeat = true;
 		}
+		SectorRescuePass(rescue, config, pass);
+	}
+	FinishSectorRescue(rescue, config);
 
-		std::vector<BYTE> buf(sectorSize);
-		int c2Errors = 0;
-		bool ok = false;
+	result = rescue.result;
+	if (rescue.ok) memcpy(data, rescue.data, sectorSize);
+	return rescue.ok;
+}
 
-		if (isAudio && config.useC2) {
-			ScsiDrive::C2ReadOptions c2Opts;
-			c2Opts.countBytes = true;
+// ============================================================================
+// Per-sector rescue steps (shared by ReadSectorSecure and phase 3 runs)
+// ============================================================================
 
-			BYTE* subchannelPtr = (sectorSize > AUDIO_SECTOR_SIZE) ? buf.data() + AUDIO_SECTOR_SIZE : nullptr;
-			ok = m_drive.ReadSectorWithC2Ex(lba, buf.data(), subchannelPtr, c2Errors, nullptr, c2Opts);
-			if (c2Errors > 0) result.c2ErrorPasses++;
-		}
-		else if (isAudio) {
-			if (sectorSize > AUDIO_SECTOR_SIZE) {
-				ok = m_drive.ReadSector(lba, buf.data(), buf.data() + AUDIO_SECTOR_SIZE);
-			}
-			else {
-				ok = m_drive.ReadSectorAudioOnly(lba, buf.data());
+namespace {
+	// Rebuild the sector by sample vote into rescue.data.  With requireSecure
+	// the result is only taken when every sample is secure.
+	bool AcceptSampleVote(SectorRescue& rescue, const SecureRipConfig& config, bool requireSecure) {
+		auto& candidates = rescue.candidates;
+		auto& result = rescue.result;
+		const auto* best = candidates.Best();
+
+		BYTE voted[RAW_SECTOR_SIZE];
+		memcpy(voted, candidates.Data(*best), rescue.sectorSize);
+		auto vote = candidates.Vote(voted, config.requiredMatches, rescue.confidence);
+		if (requireSecure && !vote.secure) return false;
+
+		memcpy(rescue.data, voted, rescue.sectorSize);
+		result.finalHash = SectorHash::Compute(voted, AUDIO_SECTOR_SIZE).Prefix();
+		result.matchingPasses = best->count;
+		result.reconstructed = true;
+		result.contestedSamples = vote.contested;
+		result.minSampleConfidence = vote.minConfidence;
+		result.sampleConfidence.clear();
+		for (int s = 0; s < SectorCandidatePool::SAMPLES; s++) {
+			if (rescue.confidence[s] < 1.0f) {
+				result.sampleConfidence.push_back({ rescue.lba, s, rescue.confidence[s] });
 			}
 		}
-		else {
-			ok = m_drive.ReadDataSector(lba, buf.data());
-		}
+		result.isSecure = vote.secure;
+		rescue.ok = true;
+		return true;
+	}
+}
 
-		if (!ok) {
-			consecutiveReadFailures++;
-			consecutiveUnusableReads++;
-			if (consecutiveReadFailures >= MAX_CONSECUTIVE_READ_FAILURES)
-				break;
-			continue;
-		}
-		consecutiveReadFailures = 0;
-
-		// First half of passes: only accept C2-clean reads
-		// Second half: accept C2-error reads for best-effort recovery
-		if (c2Errors > 0 && result.c2ErrorPasses < config.maxPasses / 2) {
-			consecutiveUnusableReads++;
-			// Every read is either failing or C2-polluted — give up early
-			if (consecutiveUnusableReads >= MAX_CONSECUTIVE_UNUSABLE)
-				break;
-			continue;
-		}
-		consecutiveUnusableReads = 0;
+void AudioCDCopier::BeginSectorRescue(SectorRescue& rescue, DWORD lba, const BYTE* current,
+	int sectorSize, bool isAudio) {
+	rescue.lba = lba;
+	rescue.sectorSize = sectorSize;
+	rescue.isAudio = isAudio;
+	rescue.finished = false;
+	rescue.ok = false;
+	rescue.consecutiveReadFailures = 0;
+	rescue.consecutiveUnusableReads = 0;
+	rescue.result = SecureSectorResult{};
+	rescue.result.lba = lba;
+	// Distinct read results live in a fixed pool of inline sector buffers —
+	// no allocation per pass.
+	rescue.candidates.Reset();
+	if (current) memcpy(rescue.data, current, sectorSize);
+	else memset(rescue.data, 0, sizeof(rescue.data));
+}
 
-		uint32_t hash = HashSector(buf.data(), AUDIO_SECTOR_SIZE);
+void AudioCDCopier::SectorRescuePass(SectorRescue& rescue, const SecureRipConfig& config, int pass) {
+	constexpr int MAX_CONSECUTIVE_READ_FAILURES = 3;
+	constexpr int MAX_CONSECUTIVE_UNUSABLE = 5;
+
+	if (rescue.finished) return;
+	auto& result = rescue.result;
+	auto& candidates = rescue.candidates;
+	const int sectorSize = rescue.sectorSize;
+	const DWORD lba = rescue.lba;
+
+	// Per-sample voting needs the C2 pointers to tell good samples from bad.
+	const bool sampleVote = config.sampleVote && rescue.isAudio && config.useC2;
+
+	result.totalPasses++;
+
+	BYTE* buf = candidates.Scratch();
+	memset(buf, 0, sectorSize);
+	int c2Errors = 0;
+	bool ok = false;
 
-		if (hashCounts.find(hash) == hashCounts.end()) {
-			hashCounts[hash] = { 1, std::move(buf) };
+	if (rescue.isAudio && config.useC2) {
+		ScsiDrive::C2ReadOptions c2Opts;
+		c2Opts.countBytes = true;
+
+		BYTE* subchannelPtr = (sectorSize > AUDIO_SECTOR_SIZE) ? buf + AUDIO_SECTOR_SIZE : nullptr;
+		ok = m_drive.ReadSectorWithC2Ex(lba, buf, subchannelPtr, c2Errors,
+			sampleVote ? rescue.c2Pointers : nullptr, c2Opts);
+		if (c2Errors > 0) result.c2ErrorPasses++;
+	}
+	else if (rescue.isAudio) {
+		if (sectorSize > AUDIO_SECTOR_SIZE) {
+			ok = m_drive.ReadSector(lba, buf, buf + AUDIO_SECTOR_SIZE);
 		}
 		else {
-			hashCounts[hash].first++;
+			ok = m_drive.ReadSectorAudioOnly(lba, buf);
 		}
+	}
+	else {
+		ok = m_drive.ReadDataSector(lba, buf);
+	}
 
-		// Check if ANY hash has enough matches
-		for (const auto& hc : hashCounts) {
-			if (hc.second.first >= config.requiredMatches &&
-				pass + 1 >= config.minPasses) {
-				memcpy(data, hc.second.second.data(), sectorSize);
-				result.finalHash = hc.first;
-				result.matchingPasses = hc.second.first;
-				result.passesRequired = pass + 1;
-				result.isSecure = (result.c2ErrorPasses == 0);
-				return true;
-			}
+	if (!ok) {
+		rescue.consecutiveReadFailures++;
+		rescue.consecutiveUnusableReads++;
+		if (rescue.consecutiveReadFailures >= MAX_CONSECUTIVE_READ_FAILURES)
+			rescue.finished = true;
+		return;
+	}
+	rescue.consecutiveReadFailures = 0;
+
+	// First half of passes: only accept C2-clean reads
+	// Second half: accept C2-error reads for best-effort recovery
+	if (c2Errors > 0 && result.c2ErrorPasses < config.maxPasses / 2) {
+		// Not a whole-sector match candidate, but the samples its C2
+		// pointers leave clean still count in the sample vote.
+		if (sampleVote) {
+			candidates.Commit(HashSector(buf, AUDIO_SECTOR_SIZE), rescue.c2Pointers, false);
 		}
+		rescue.consecutiveUnusableReads++;
+		// Every read is either failing or C2-polluted — give up early
+		if (rescue.consecutiveUnusableReads >= MAX_CONSECUTIVE_UNUSABLE)
+			rescue.finished = true;
+		return;
+	}
+	rescue.consecutiveUnusableReads = 0;
+
+	candidates.Commit(HashSector(buf, AUDIO_SECTOR_SIZE), sampleVote ? rescue.c2Pointers : nullptr);
+
+	// Check if the best-confirmed reading has enough matches
+	const auto* best = candidates.Best();
+	if (best->count >= config.requiredMatches && pass + 1 >= config.minPasses) {
+		memcpy(rescue.data, candidates.Data(*best), sectorSize);
+		result.finalHash = best->hash.Prefix();
+		result.matchingPasses = best->count;
+		result.passesRequired = pass + 1;
+		result.isSecure = (result.c2ErrorPasses == 0);
+		rescue.ok = true;
+		rescue.finished = true;
+		return;
 	}
 
-	// Fallback: use best available result
-	int bestCount = 0;
-	uint32_t bestHash = 0;
-	for (const auto& hc : hashCounts) {
-		if (hc.second.first > bestCount) {
-			bestCount = hc.second.first;
-			bestHash = hc.first;
-		}
+	// No whole-sector agreement yet — the passes may still agree sample
+	// by sample once each one's C2-flagged samples are discounted.
+	if (sampleVote && candidates.Size() > 1 && pass + 1 >= config.minPasses &&
+		AcceptSampleVote(rescue, config, true)) {
+		result.passesRequired = pass + 1;
+		rescue.finished = true;
 	}
+}
 
-	if (bestCount > 0) {
-		memcpy(data, hashCounts[bestHash].second.data(), sectorSize);
-		result.finalHash = bestHash;
-		result.matchingPasses = bestCount;
+void AudioCDCopier::FinishSectorRescue(SectorRescue& rescue, const SecureRipConfig& config) {
+	rescue.finished = true;
+	if (rescue.ok) return;
+
+	// Fallback: use best available result
+	auto& candidates = rescue.candidates;
+	auto& result = rescue.result;
+	if (candidates.Size() == 0) return;
+
+	if (config.sampleVote && rescue.isAudio && config.useC2) {
+		// Best-effort per-sample reconstruction beats any single read.
+		AcceptSampleVote(rescue, config, false);
 		result.passesRequired = result.totalPasses;
-		result.isSecure = (bestCount >= config.requiredMatches && result.c2ErrorPasses == 0);
+		return;
 	}
 
-	return bestCount > 0;
-}
\ No newline at end of file
+	const auto* best = candidates.Best();
+	if (best->count == 0) return;
+
+	memcpy(rescue.data, candidates.Data(*best), rescue.sectorSize);
+	result.finalHash = best->hash.Prefix();
+	result.matchingPasses = best->count;
+	result.passesRequired = result.totalPasses;
+	result.isSecure = (best->count >= config.requiredMatches && result.c2ErrorPasses == 0);
+	rescue.ok = true;
+}
@@ -1,5 +1,6 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
@@ -203,25 +204,24 @@ void AudioCDCopier::PrintBlerPerTrackSummary(const DiscInfo& disc, const BlerRes
 		std::cout << "  Track  Length     C2 Errors  Err Secs  Avg/sec   Status\n";
 	std::cout << "  " << std::string(hasC1Support ? 78 : 58, '-') << "\n";
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD tStart = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		DWORD tEnd = t.endLBA;
-		DWORD tSectors = tEnd - tStart + 1;
-		DWORD tSeconds = (tSectors + 74) / 75;
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	for (const auto& span : layout.Spans()) {
+		const auto& t = disc.tracks[span.trackIndex];
+		DWORD tSeconds = (span.Count() + 74) / 75;
 
+		// Buckets are 75 sectors of the layout's linear position; a bucket
+		// belongs to the track its first sector falls in.
+		size_t firstSecond = (span.linearStart + 74) / 75;
+		size_t lastSecond = (span.linearStart + span.Count() - 1) / 75;
 		int trackC1 = 0, trackC2 = 0, trackC2Seconds = 0;
-		for (size_t i = 0; i < result.perSecondC2.size(); i++) {
-			DWORD secLBA = static_cast<DWORD>(result.perSecondC2[i].first);
-			if (secLBA >= tStart && secLBA <= tEnd) {
-				if (result.perSecondC2[i].second > 0) {
-					trackC2 += result.perSecondC2[i].second;
-					trackC2Seconds++;
-				}
-				if (hasC1Support && i < result.perSecondC1.size()
-					&& result.perSecondC1[i].second > 0) {
-					trackC1 += result.perSecondC1[i].second;
-				}
+		for (size_t i = firstSecond; i <= lastSecond && i < result.perSecondC2.size(); i++) {
+			if (result.perSecondC2[i].second > 0) {
+				trackC2 += result.perSecondC2[i].second;
+				trackC2Seconds++;
+			}
+			if (hasC1Support && i < result.perSecondC1.size()
+				&& result.perSecondC1[i].second > 0) {
+				trackC1 += result.perSecondC1[i].second;
 			}
 		}
 
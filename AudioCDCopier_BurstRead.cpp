@@ -1,54 +1,111 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "AccurateRip.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
+#include "ReadPipeline.h"
+#include "RipStream.h"
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 // ============================================================================
 // Burst Mode Reading (Maximum Speed, No Verification)
 // ============================================================================
 
 bool AudioCDCopier::ReadDiscBurst(DiscInfo& disc, std::function<void(int, int)> progress, int speedOverride) {
-	DWORD total = 0;
-	for (size_t i = 0; i < disc.tracks.size(); i++) {
-		if (disc.selectedSession > 0 && disc.tracks[i].session != disc.selectedSession) continue;
-		DWORD start = (disc.pregapMode == PregapMode::Skip) ? disc.tracks[i].startLBA : disc.tracks[i].pregapLBA;
-		total += disc.tracks[i].endLBA - start + 1;
-	}
+	DiscLayout layout = DiscLayout::ForRip(disc);
+	DWORD total = layout.TotalSectors();
 
-	try {
-		disc.rawSectors.clear();
-		disc.rawSectors.reserve(total);
-	}
-	catch (const std::bad_alloc&) {
+	disc.rawSectors.clear();
+	if (!disc.rawSectors.Reserve(total, disc.includeSubchannel)) {
 		std::cerr << "Error: Not enough memory\n";
 		return false;
 	}
 
+	disc.accurateRipTracks.clear();
+	AccurateRipStream arStream;
+	arStream.Begin(disc);
+
 	m_drive.SetSpeed(speedOverride);   // 0 = max (original behaviour)
 	std::cout << "  BURST MODE - " << (speedOverride == 0 ? "Maximum speed" : (std::to_string(speedOverride) + "x")) << ", no verification\n";
 	if (disc.enableCacheDefeat) {
 		std::cout << "  Cache defeat: ENABLED (will reduce speed)\n";
+		PrepareCacheDefeat(disc);
 	}
 	std::cout << "  (Press ESC or Ctrl+C to cancel)\n";
 
 	constexpr DWORD BATCH_SIZE = 26;
-	constexpr DWORD CACHE_DEFEAT_INTERVAL = 20;
-
-	DWORD cur = 0;
-	for (size_t i = 0; i < disc.tracks.size(); i++) {
-		auto& t = disc.tracks[i];
-		if (disc.selectedSession > 0 && t.session != disc.selectedSession) continue;
-		DWORD start = (disc.pregapMode == PregapMode::Skip) ? t.startLBA : t.pregapLBA;
-		DWORD trackSectors = t.endLBA - start + 1;
+	constexpr size_t PIPELINE_DEPTH = 4;
+	const DWORD defeatInterval = CacheDefeatInterval();
+
+	DWORD cur = 0;      // sectors submitted (or read synchronously)
+	DWORD lastDefeat = 0;
+	DWORD done = 0;     // sectors completed, for progress
+	// Store sectors the worker has finished with — a streaming writer may
+	// take (and release) everything below this.
+	std::atomic<size_t> consumed{ 0 };
+
+	// Batched audio reads run through the pipeline: up to PIPELINE_DEPTH
+	// READ CDs stay queued at the drive while the worker thread feeds the
+	// AccurateRip accumulator.  Each batch lands directly in the store, whose
+	// reservation guarantees the destination never moves.
+	auto backend = ReadBackend::Create(m_drive, PIPELINE_DEPTH);
+	ReadPipeline pipeline(*backend,
+		[&](PipelineRead& read) {
+			if (!read.ok) {
+				// Batch failed — re-read this chunk one sector at a time so
+				// individual bad sectors can be identified.
+				for (DWORD k = 0; k < read.count; k++) {
+					BYTE* sec = read.buffer + k * AUDIO_SECTOR_SIZE;
+					memset(sec, 0, AUDIO_SECTOR_SIZE);
+					if (!m_drive.ReadSectorAudioOnly(read.lba + k, sec)) {
+						disc.errorCount++;
+						disc.badSectors.push_back(read.lba + k);
+					}
+				}
+			}
+			done += read.count;
+			if (progress) progress(done, total);
+		},
+		[&](const PipelineRead& read) {
+			for (DWORD k = 0; k < read.count; k++) {
+				arStream.AddSector(read.lba + k, read.buffer + k * AUDIO_SECTOR_SIZE);
+			}
+			if (m_stream) {
+				consumed.store(static_cast<size_t>(read.buffer - disc.rawSectors.Audio(0)) /
+					AUDIO_SECTOR_SIZE + read.count, std::memory_order_release);
+			}
+		});
+
+	for (const auto& span : layout.Spans()) {
+		auto& t = disc.tracks[span.trackIndex];
+		DWORD start = span.firstLBA;
+		DWORD trackSectors = span.Count();
 		bool canBatch = t.isAudio && !disc.includeSubchannel;
 
+		// Subchannel and data reads below run synchronously and feed the
+		// accumulator on this thread — let the pipeline finish first.
+		if (!canBatch) pipeline.Drain();
+
 		for (DWORD offset = 0; offset < trackSectors; ) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				return false;
 			}
 
-			if (disc.enableCacheDefeat && cur > 0 && (cur % CACHE_DEFEAT_INTERVAL) == 0) {
+			// Synchronous reads are final as soon as they return; batches
+			// only once the worker has fed them to the accumulator.
+			if (m_stream) {
+				m_stream->Advance(disc.rawSectors,
+					canBatch ? consumed.load(std::memory_order_acquire) : disc.rawSectors.size());
+			}
+
+			if (disc.enableCacheDefeat && defeatInterval > 0 && cur - lastDefeat >= defeatInterval) {
+				// Queued reads would land after the flush and hit the cache.
+				pipeline.Drain();
 				DefeatDriveCache(start + offset, disc.leadOutLBA);
+				lastDefeat = cur;
 			}
 
 			// Batch read: audio-only tracks without subchannel
@@ -56,57 +113,72 @@ bool AudioCDCopier::ReadDiscBurst(DiscInfo& disc, std::function<void(int, int)>
 				DWORD remaining = trackSectors - offset;
 				DWORD chunk = (remaining < BATCH_SIZE) ? remaining : BATCH_SIZE;
 
-				std::vector<BYTE> batchBuf(AUDIO_SECTOR_SIZE * chunk);
-				bool ok = m_drive.ReadSectorsAudioOnly(start + offset, chunk, batchBuf.data());
-
-				if (ok) {
-					for (DWORD s = 0; s < chunk; s++) {
-						std::vector<BYTE> sec(AUDIO_SECTOR_SIZE);
-						memcpy(sec.data(), batchBuf.data() + s * AUDIO_SECTOR_SIZE, AUDIO_SECTOR_SIZE);
-						disc.rawSectors.push_back(std::move(sec));
-					}
-					offset += chunk;
-					cur += chunk;
-					if (progress) progress(cur, total);
-					continue;
+				BYTE* dst = disc.rawSectors.AppendSectors(chunk);
+				if (!dst) {
+					std::cerr << "Error: Not enough memory\n";
+					return false;
 				}
-
-				// Batch failed — fall through to single-sector reads for this chunk
-				// so individual bad sectors can be identified
+				pipeline.Submit(start + offset, chunk, dst);
+				offset += chunk;
+				cur += chunk;
+				continue;
 			}
 
-			// Single-sector fallback (also used for data tracks / subchannel)
-			DWORD lba = start + offset;
-			int sectorSize = (disc.includeSubchannel && t.isAudio) ? RAW_SECTOR_SIZE : AUDIO_SECTOR_SIZE;
-			std::vector<BYTE> sec(sectorSize, 0);
-			bool ok = false;
+			// Subchannel rips: one READ CD per chunk of 2448-byte sectors,
+			// split into the audio and subchannel planes by the drive layer.
+			if (t.isAudio && disc.includeSubchannel) {
+				DWORD remaining = trackSectors - offset;
+				DWORD chunk = (remaining < BATCH_SIZE) ? remaining : BATCH_SIZE;
 
-			if (t.isAudio) {
-				if (disc.includeSubchannel) {
-					ok = m_drive.ReadSector(lba, sec.data(), sec.data() + AUDIO_SECTOR_SIZE);
+				size_t first = disc.rawSectors.size();
+				if (!disc.rawSectors.AppendSectors(chunk, true)) {
+					std::cerr << "Error: Not enough memory\n";
+					return false;
 				}
-				else {
-					ok = m_drive.ReadSectorAudioOnly(lba, sec.data());
+				std::vector<BYTE> sectorOk(chunk, 0);
+				m_drive.ReadSectors(start + offset, chunk, disc.rawSectors.Audio(first),
+					disc.rawSectors.Subchannel(first), sectorOk.data());
+
+				for (DWORD k = 0; k < chunk; k++) {
+					if (!sectorOk[k]) {
+						disc.errorCount++;
+						disc.badSectors.push_back(start + offset + k);
+					}
+					arStream.AddSector(start + offset + k, disc.rawSectors.Audio(first + k));
 				}
-			}
-			else {
-				ok = m_drive.ReadDataSector(lba, sec.data());
+				offset += chunk;
+				cur += chunk;
+				done += chunk;
+				if (progress) progress(done, total);
+				continue;
 			}
 
-			if (!ok) {
+			// Single-sector path (data tracks)
+			DWORD lba = start + offset;
+			BYTE* sec = disc.rawSectors.AppendSector(false);
+			if (!sec) {
+				std::cerr << "Error: Not enough memory\n";
+				return false;
+			}
+			if (!m_drive.ReadDataSector(lba, sec)) {
 				disc.errorCount++;
 				disc.badSectors.push_back(lba);
 			}
 
-			disc.rawSectors.push_back(std::move(sec));
 			offset++;
 			cur++;
-			if (progress && (cur & 63) == 0) progress(cur, total);
+			done++;
+			if (progress && (done & 63) == 0) progress(done, total);
 		}
 	}
 
+	pipeline.Drain();
+	if (m_stream) m_stream->Advance(disc.rawSectors, disc.rawSectors.size());
+
 	// Ensure progress bar reaches 100%
 	if (progress) progress(total, total);
 
+	disc.accurateRipTracks = arStream.Results();
+
 	return true;
 }
\ No newline at end of file
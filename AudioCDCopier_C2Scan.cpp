@@ -1,5 +1,6 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include <iostream>
 #include <iomanip>
@@ -15,18 +16,6 @@
 // Prevents runaway memory usage and console flooding on heavily damaged discs.
 static constexpr size_t MAX_BAD_SECTOR_ENTRIES = 500;
 
-// Helper function to calculate total audio sectors
-DWORD AudioCDCopier::CalculateTotalAudioSectors(const DiscInfo& disc) const {
-	DWORD totalSectors = 0;
-	for (const auto& t : disc.tracks) {
-		if (t.isAudio) {
-			DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-			totalSectors += t.endLBA - start + 1;
-		}
-	}
-	return totalSectors;
-}
-
 // C2 accuracy validation
 bool AudioCDCopier::ValidateC2Accuracy(DWORD testLBA) {
 	return m_drive.ValidateC2Accuracy(testLBA);
@@ -83,23 +72,9 @@ bool AudioCDCopier::RunC2Scan(const DiscInfo& disc, BlerResult& result, int scan
 	}
 
 	// Calculate total audio sectors and overall LBA range for zone classification
-	DWORD totalSectors = 0;
-	DWORD globalFirstLBA = 0, globalLastLBA = 0;
-	bool foundFirst = false;
-	for (const auto& t : disc.tracks) {
-		if (t.isAudio) {
-			DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-			if (!foundFirst) {
-				globalFirstLBA = start;
-				foundFirst = true;
-			}
-			else if (start < globalFirstLBA) {
-				globalFirstLBA = start;
-			}
-			if (t.endLBA > globalLastLBA) globalLastLBA = t.endLBA;
-			totalSectors += t.endLBA - start + 1;
-		}
-	}
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
+	DWORD globalFirstLBA = layout.FirstLBA(), globalLastLBA = layout.LastLBA();
 
 	if (totalSectors == 0) {
 		Console::Error("No audio tracks found.\n");
@@ -137,21 +112,47 @@ bool AudioCDCopier::RunC2Scan(const DiscInfo& disc, BlerResult& result, int scan
 	ScsiDrive::C2ReadOptions c2Opts;
 	c2Opts.multiPass = false;
 	c2Opts.countBytes = true;   // Byte counting — PlexTools-style C2 error interpretation
-	c2Opts.defeatCache = true;  // Defeat drive cache for accurate reads
 
-	// Allocate C2 buffer ONCE, outside the loop
-	std::vector<BYTE> c2Buffer(C2_ERROR_SIZE, 0);
+	// One buffer for the whole scan, sized to the largest C2 batch the
+	// adapter accepts; the drive streams at its set speed instead of
+	// waiting on one command per sector.
+	const DWORD batchSectors = m_drive.GetMaxTransferSectors(SECTOR_WITH_C2_SIZE);
+	std::vector<BYTE> audio(static_cast<size_t>(batchSectors) * AUDIO_SECTOR_SIZE);
+	std::vector<C2SectorStatus> status(batchSectors);
+
+	// A sequential scan only needs cache defeats on a drive measured to cache
+	// audio: once per cache-full when the size is known, the fixed seek
+	// interval when it is not.  Unmeasured or uncached drives read straight
+	// through.
+	const DWORD defeatInterval = m_cacheProfile.measured ? CacheDefeatInterval() : 0;
+	DWORD lastDefeat = 0;
 
 	// Collect error LBAs for cluster detection (separate from capped display list)
 	std::vector<DWORD> errorLBAs;
 
+	// Bad sectors in the display list (capped); the total is kept uncapped
+	auto recordBadSector = [&](DWORD lba, int c2Errors, const C2SectorStatus& st) {
+		totalBadSectorCount++;
+		if (badSectors.size() < MAX_BAD_SECTOR_ENTRIES) {
+			C2SectorError errorEntry;
+			errorEntry.lba = lba;
+			errorEntry.c2Errors = c2Errors;
+			errorEntry.senseKey = st.senseKey;
+			errorEntry.asc = st.asc;
+			errorEntry.ascq = st.ascq;
+			badSectors.push_back(errorEntry);
+		}
+	};
+
 	// Scan all audio tracks
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
+	for (const auto& span : layout.Spans()) {
 		currentErrorRun = 0;  // reset at each track boundary
 
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
+		// Per-second bucket and position in it, advanced by counting
+		size_t secIdx = span.linearStart / 75;
+		DWORD inSecond = span.linearStart % 75;
+
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; ) {
 			// Check for user interrupt
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				m_drive.SetSpeed(0);
@@ -159,129 +160,98 @@ bool AudioCDCopier::RunC2Scan(const DiscInfo& disc, BlerResult& result, int scan
 				return false;
 			}
 
-			std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
-			int c2Errors = 0;
-			BYTE senseKey = 0, asc = 0, ascq = 0;
-
-			// Zero out C2 buffer before each read (reuse same buffer)
-			std::memset(c2Buffer.data(), 0, C2_ERROR_SIZE);
-
-			// Calculate per-second index
-			size_t secIdx = static_cast<size_t>(scannedSectors / 75);
-			if (secIdx >= result.perSecondC2.size())
-				secIdx = result.perSecondC2.size() - 1;
-
-			// Record starting LBA for each time bucket
-			if (scannedSectors % 75 == 0)
-				result.perSecondC2[secIdx].first = lba;
-
-			// Read sector with C2 error detection
-			bool readSuccess = m_drive.ReadSectorWithC2Ex(lba, buf.data(), nullptr, c2Errors,
-				c2Buffer.data(), c2Opts, &senseKey, &asc, &ascq);
-
-			if (readSuccess) {
-				// CRITICAL: Check if errors were recovered by the drive
-				// Sense key 0x01 means "Recovered Error" - drive fixed it internally
-				bool recovered = (senseKey == 0x01);
-
-				if (c2Errors > 0) {
-					// Only count as actual errors if NOT recovered
-					if (!recovered) {
-						result.totalC2Errors += c2Errors;
-						result.totalC2Sectors++;
-						result.perSecondC2[secIdx].second += c2Errors;
-
-						// Track worst sector
-						if (c2Errors > result.maxC2InSingleSector) {
-							result.maxC2InSingleSector = c2Errors;
-							result.worstSectorLBA = lba;
-						}
+			if (defeatInterval > 0 && scannedSectors - lastDefeat >= defeatInterval) {
+				DefeatDriveCache(lba, globalLastLBA);
+				lastDefeat = scannedSectors;
+			}
 
-						// Track consecutive errors
-						currentErrorRun++;
-						if (currentErrorRun > result.consecutiveErrorSectors) {
-							result.consecutiveErrorSectors = currentErrorRun;
+			DWORD count = std::min(batchSectors, span.lastLBA - lba + 1);
+			m_drive.ReadSectorsWithC2(lba, count, audio.data(), nullptr, nullptr,
+				nullptr, c2Opts, nullptr, status.data());
+
+			for (DWORD k = 0; k < count; k++, lba++) {
+				const C2SectorStatus& st = status[k];
+				int c2Errors = st.c2Errors;
+
+				if (inSecond == 0)
+					result.perSecondC2[secIdx].first = lba;
+
+				if (st.ok) {
+					// CRITICAL: Check if errors were recovered by the drive
+					// Sense key 0x01 means "Recovered Error" - drive fixed it internally
+					bool recovered = (st.senseKey == 0x01);
+
+					if (c2Errors > 0) {
+						// Only count as actual errors if NOT recovered
+						if (!recovered) {
+							result.totalC2Errors += c2Errors;
+							result.totalC2Sectors++;
+							result.perSecondC2[secIdx].second += c2Errors;
+
+							// Track worst sector
+							if (c2Errors > result.maxC2InSingleSector) {
+								result.maxC2InSingleSector = c2Errors;
+								result.worstSectorLBA = lba;
+							}
+
+							// Track consecutive errors
+							currentErrorRun++;
+							if (currentErrorRun > result.consecutiveErrorSectors) {
+								result.consecutiveErrorSectors = currentErrorRun;
+							}
+
+							// Always record LBA for cluster analysis (uncapped)
+							errorLBAs.push_back(lba);
+							recordBadSector(lba, c2Errors, st);
+
+							// Classify into inner/middle/outer zone
+							ClassifyZone(lba, globalFirstLBA, globalLastLBA, 1, result.zoneStats);
 						}
-
-						// Always record LBA for cluster analysis (uncapped)
-						errorLBAs.push_back(lba);
-
-						// Record in display list (capped to prevent runaway growth)
-						totalBadSectorCount++;
-						if (badSectors.size() < MAX_BAD_SECTOR_ENTRIES) {
-							C2SectorError errorEntry;
-							errorEntry.lba = lba;
-							errorEntry.c2Errors = c2Errors;
-							errorEntry.senseKey = senseKey;
-							errorEntry.asc = asc;
-							errorEntry.ascq = ascq;
-							badSectors.push_back(errorEntry);
+						else {
+							// Recovered error - reset consecutive error counter
+							currentErrorRun = 0;
+							result.recoveredC2Errors += c2Errors;
+							result.recoveredC2Sectors++;
+							recordBadSector(lba, c2Errors, st);
+
+							// Classify zone (no error contribution for recovered sectors)
+							ClassifyZone(lba, globalFirstLBA, globalLastLBA, 0, result.zoneStats);
 						}
-
-						// Classify into inner/middle/outer zone
-						ClassifyZone(lba, globalFirstLBA, globalLastLBA, 1, result.zoneStats);
 					}
 					else {
-						// Recovered error - reset consecutive error counter
+						// Clean sector - reset error run
 						currentErrorRun = 0;
-						result.recoveredC2Errors += c2Errors;
-						result.recoveredC2Sectors++;
-
-						// Record recovered errors in display list (capped)
-						totalBadSectorCount++;
-						if (badSectors.size() < MAX_BAD_SECTOR_ENTRIES) {
-							C2SectorError errorEntry;
-							errorEntry.lba = lba;
-							errorEntry.c2Errors = c2Errors;
-							errorEntry.senseKey = senseKey;
-							errorEntry.asc = asc;
-							errorEntry.ascq = ascq;
-							badSectors.push_back(errorEntry);
-						}
 
-						// Classify zone (no error contribution for recovered sectors)
+						// Classify zone (clean sector)
 						ClassifyZone(lba, globalFirstLBA, globalLastLBA, 0, result.zoneStats);
 					}
 				}
 				else {
-					// Clean sector - reset error run
-					currentErrorRun = 0;
+					// SCSI command failed completely - this is a read failure.
+					// Not counted in totalC2Sectors — read failures are tracked separately
+					// via totalReadFailures so the two fields remain mutually exclusive.
+					result.totalReadFailures++;
+					result.perSecondC2[secIdx].second++;              // register in per-second data
+					currentErrorRun++;
+					if (currentErrorRun > result.consecutiveErrorSectors) {
+						result.consecutiveErrorSectors = currentErrorRun;
+					}
 
-					// Classify zone (clean sector)
-					ClassifyZone(lba, globalFirstLBA, globalLastLBA, 0, result.zoneStats);
-				}
-			}
-			else {
-				// SCSI command failed completely - this is a read failure.
-				// Not counted in totalC2Sectors — read failures are tracked separately
-				// via totalReadFailures so the two fields remain mutually exclusive.
-				result.totalReadFailures++;
-				result.perSecondC2[secIdx].second++;              // register in per-second data
-				currentErrorRun++;
-				if (currentErrorRun > result.consecutiveErrorSectors) {
-					result.consecutiveErrorSectors = currentErrorRun;
-				}
+					// Always record LBA for cluster analysis (uncapped)
+					errorLBAs.push_back(lba);
+					recordBadSector(lba, -1, st);  // -1 indicates total read failure
 
-				// Always record LBA for cluster analysis (uncapped)
-				errorLBAs.push_back(lba);
-
-				// Record read failure in display list (capped)
-				totalBadSectorCount++;
-				if (badSectors.size() < MAX_BAD_SECTOR_ENTRIES) {
-					C2SectorError errorEntry;
-					errorEntry.lba = lba;
-					errorEntry.c2Errors = -1;  // -1 indicates total read failure
-					errorEntry.senseKey = senseKey;
-					errorEntry.asc = asc;
-					errorEntry.ascq = ascq;
-					badSectors.push_back(errorEntry);
+					// Classify zone (error)
+					ClassifyZone(lba, globalFirstLBA, globalLastLBA, 1, result.zoneStats);
 				}
 
-				// Classify zone (error)
-				ClassifyZone(lba, globalFirstLBA, globalLastLBA, 1, result.zoneStats);
+				if (++inSecond == 75) {
+					inSecond = 0;
+					secIdx++;
+				}
 			}
 
-			scannedSectors++;
+			scannedSectors += count;
 			progress.Update(static_cast<int>(scannedSectors), static_cast<int>(totalSectors));
 		}
 	}
@@ -383,21 +353,13 @@ void AudioCDCopier::PrintC2SenseCodeChart(const std::vector<C2SectorError>& badS
 			return a.c2Errors > b.c2Errors;
 		});
 
+	DiscLayout layout = DiscLayout::ForScan(disc);
+
 	// Display bad sectors (may be capped by caller)
 	for (size_t i = 0; i < sortedSectors.size(); i++) {
 		const auto& err = sortedSectors[i];
 
-		// Find which track this LBA belongs to
-		int trackNum = 0;
-		for (const auto& t : disc.tracks) {
-			if (t.isAudio) {
-				DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-				if (err.lba >= start && err.lba <= t.endLBA) {
-					trackNum = t.trackNumber;
-					break;
-				}
-			}
-		}
+		int trackNum = layout.TrackAt(err.lba);
 
 		// Calculate time position (MM:SS.FF format)
 		DWORD sectorOffset = static_cast<DWORD>(err.lba);
@@ -1,58 +1,195 @@
-#define NOMINMAX
+﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
+#include "InterruptHandler.h"
+#include "PioneerVendor.h"
+#include "ScanAnalyzers.h"
 #include <iostream>
+#include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <vector>
 
 // ============================================================================
-// Comprehensive Disc Quality Scan - Orchestrates All Quality Tests
+// Comprehensive Disc Quality Scan - One read pass feeding every analyzer
+//
+// The audio area is read once with C2 (and per-sector C1 where the drive
+// reports it).  Each sector goes to the BLER, disc rot zone, audio content
+// and hash analyzers (ScanAnalyzers.h).  Only the tests that physically need
+// more reads do any, and only on samples:
+//   consistency   two cache-defeated re-reads per sample, compared with the
+//                 pass hash — serves both the rot re-read check (adaptive
+//                 per-zone interval) and multi-pass verification
+//   speed         the ~100 sample sectors of RunSpeedComparisonTest
+// Vendor C1 quality scans (Plextor / Pioneer / LiteOn) are separate passes
+// and are left to the stand-alone disc rot and Q-Check scans.
 // ============================================================================
 
+namespace {
+	constexpr int CONSISTENCY_PASSES = 3;   // the pass read plus two re-reads
+
+	int RotSampleInterval(double errorRate) {
+		if (errorRate > 2.0) return 20;
+		if (errorRate > 0.5) return 50;
+		if (errorRate > 0.1) return 100;
+		return 200;
+	}
+}
+
 bool AudioCDCopier::RunComprehensiveScan(DiscInfo& disc, ComprehensiveScanResult& result, int speed) {
 	std::cout << "\n=== COMPREHENSIVE DISC QUALITY SCAN ===\n";
-	std::cout << "This will run all available quality tests on the disc.\n";
-	std::cout << "Estimated time: 15-30 minutes depending on disc condition.\n\n";
-	
+	std::cout << "One read pass feeds BLER, disc rot and audio analysis; only sampled\n";
+	std::cout << "sectors are re-read for the consistency and speed tests.\n\n";
+
 	result = ComprehensiveScanResult{};
 
-	// Test 1: BLER Scan (C2 error distribution)
-	std::cout << "\n[1/5] Running BLER quality scan...\n";
-	if (!RunBlerScan(disc, result.bler, speed)) {
-		std::cout << "BLER scan failed or was cancelled.\n";
+	EnsureCapabilitiesDetected();
+	if (!m_drive.CheckC2Support()) {
+		std::cout << "ERROR: C2 not supported.\n";
 		return false;
 	}
-
-	// Test 2: Disc Rot Detection
-	std::cout << "\n[2/5] Running disc rot detection...\n";
-	if (!RunDiscRotScan(disc, result.rot, speed)) {
-		std::cout << "Disc rot scan failed or was cancelled.\n";
+	bool hasC1 = m_drive.SupportsC1BlockErrors();
+	bool verifyC2 = PioneerVendor(m_drive).IsPioneerDrive();
+
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
+	DWORD firstLBA = layout.FirstLBA(), lastLBA = layout.LastLBA();
+	if (totalSectors == 0) {
+		std::cout << "No audio tracks.\n";
 		return false;
 	}
 
-	// Test 3: Speed Comparison
-	std::cout << "\n[3/5] Running speed comparison test...\n";
-	if (!RunSpeedComparisonTest(disc, result.speedComparison)) {
-		std::cout << "Speed comparison test failed or was cancelled.\n";
+	// ── 1. Read pass ────────────────────────────────────────────────────
+	std::cout << "\n[1/3] Reading " << totalSectors << " sectors with C2"
+		<< (hasC1 ? " and C1" : "") << "...\n";
+	std::cout << "  (Press ESC or Ctrl+C to cancel)\n\n";
+
+	BlerAnalyzer bler(*this, result.bler, layout, hasC1, speed);
+	RotZoneAnalyzer rot(*this, result.rot, layout, speed);
+	AudioContentAnalyzer audio(*this, result.audio);
+	SectorHashAnalyzer hashes(layout);
+	std::vector<ScanAnalyzer*> analyzers = { &bler, &rot, &audio, &hashes };
+
+	if (!RunScanPass(layout, speed, hasC1, verifyC2, analyzers)) {
+		std::cout << "\n\n*** Scan cancelled by user ***\n";
 		return false;
 	}
+	for (auto* analyzer : analyzers) analyzer->Finish();
 
-	// Test 4: Multi-Pass Verification
-	std::cout << "\n[4/5] Running multi-pass verification (3 passes)...\n";
-	if (!RunMultiPassVerification(disc, result.multiPass, 3, speed)) {
-		std::cout << "Multi-pass verification failed or was cancelled.\n";
-		return false;
+	PrintBlerReport(disc, result.bler);
+	if (result.bler.totalC2Sectors == 0 && result.bler.totalReadFailures == 0 && !hasC1) {
+		result.bler.c2Unverified = true;
 	}
 
-	// Test 5: Audio Content Analysis
-	std::cout << "\n[5/5] Running audio content analysis...\n";
-	if (!AnalyzeAudioContent(disc, result.audio, speed)) {
-		std::cout << "Audio content analysis failed or was cancelled.\n";
+	// ── 2. Consistency re-reads (sampled) ───────────────────────────────
+	// Rot samples follow each zone's error rate, as in RunDiscRotScan;
+	// multi-pass samples every totalSectors / 1000, as in
+	// RunMultiPassVerification.  A sector in both sets is re-read once.
+	int innerInterval = RotSampleInterval(result.rot.zones.InnerErrorRate());
+	int middleInterval = RotSampleInterval(result.rot.zones.MiddleErrorRate());
+	int outerInterval = RotSampleInterval(result.rot.zones.OuterErrorRate());
+	DWORD multiInterval = std::max<DWORD>(1, totalSectors / 1000);
+
+	struct ConsistencySample {
+		DWORD lba;
+		DWORD trackEnd;
+		bool rot;
+		bool multiPass;
+	};
+	std::vector<ConsistencySample> samples;
+	DWORD range = lastLBA - firstLBA;
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++) {
+			double pct = range > 0 ? static_cast<double>(lba - firstLBA) / range : 0;
+			int rotInterval = (pct < 0.33) ? innerInterval : (pct < 0.66) ? middleInterval : outerInterval;
+			bool isRot = (lba - span.firstLBA) % rotInterval == 0;
+			bool isMulti = (lba - span.firstLBA) % multiInterval == 0;
+			if (isRot || isMulti) samples.push_back({ lba, span.lastLBA, isRot, isMulti });
+		}
+	}
+
+	std::cout << "\n[2/3] Re-reading " << samples.size() << " sampled sectors for consistency...\n";
+	m_drive.SetSpeed(speed);
+
+	ProgressIndicator progress(40);
+	progress.SetLabel("  Consistency");
+	progress.Start();
+
+	std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
+	int rotTested = 0, rotInconsistent = 0;
+	for (size_t i = 0; i < samples.size(); i++) {
+		if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+			m_drive.SetSpeed(0);
+			progress.Finish(false);
+			std::cout << "\n\n*** Scan cancelled by user ***\n";
+			return false;
+		}
+
+		const auto& sample = samples[i];
+		const SectorHash* reference = hashes.Find(sample.lba);
+		SectorHash reads[CONSISTENCY_PASSES];
+		bool readOk = (reference != nullptr);
+		if (readOk) reads[0] = *reference;
+		for (int pass = 1; pass < CONSISTENCY_PASSES && readOk; pass++) {
+			// Without Accurate Stream the drive may answer from its cache.
+			if (!m_hasAccurateStream) DefeatDriveCache(sample.lba, sample.trackEnd);
+			readOk = m_drive.ReadSectorAudioOnly(sample.lba, buf.data());
+			if (readOk) reads[pass] = CalculateSectorHash(buf.data());
+		}
+
+		if (sample.rot && readOk) {
+			rotTested++;
+			if (reads[1] != reads[0] || reads[2] != reads[0]) rotInconsistent++;
+		}
+
+		if (sample.multiPass) {
+			MultiPassResult r{};
+			r.lba = sample.lba;
+			r.totalPasses = CONSISTENCY_PASSES;
+			if (readOk) {
+				// Majority of three: any two that agree.
+				const SectorHash& majority = (reads[1] == reads[2]) ? reads[1] : reads[0];
+				for (const auto& h : reads) {
+					if (h == majority) r.passesMatched++;
+				}
+				r.allMatch = (r.passesMatched == CONSISTENCY_PASSES);
+				r.majorityHash = majority.Prefix();
+			}
+			// As in RunMultiPassVerification, only imperfect samples are kept.
+			if (!r.allMatch) result.multiPass.push_back(r);
+		}
+
+		progress.Update(static_cast<int>(i + 1), static_cast<int>(samples.size()));
+	}
+	progress.Finish(true);
+	m_drive.SetSpeed(0);
+
+	result.rot.totalRereadTests = rotTested;
+	result.rot.inconsistentSectors = rotInconsistent;
+	result.rot.inconsistencyRate = rotTested > 0
+		? static_cast<double>(rotInconsistent) / rotTested * 100.0 : 0;
+	AnalyzeErrorPatterns(rot.ErrorLBAs(), result.rot);
+	SetRotRecommendation(result.rot);
+	PrintDiscRotReport(result.rot);
+
+	// ── 3. Speed comparison (sampled) ───────────────────────────────────
+	DWORD speedInterval = std::max<DWORD>(1, totalSectors / 100);
+	std::vector<std::pair<DWORD, DWORD>> speedSamples;
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba += speedInterval) {
+			speedSamples.push_back({ lba, span.lastLBA });
+		}
+	}
+
+	std::cout << "\n[3/3] Comparing C2 at 4x and 24x on " << speedSamples.size() << " sampled sectors...\n";
+	if (!CompareSpeedsAtSamples(speedSamples, result.speedComparison)) {
+		std::cout << "\n\n*** Scan cancelled by user ***\n";
 		return false;
 	}
 
 	// Calculate overall score
 	result.overallScore = CalculateOverallScore(result);
-	
+
 	if (result.overallScore >= 90) result.overallRating = "A";
 	else if (result.overallScore >= 80) result.overallRating = "B";
 	else if (result.overallScore >= 70) result.overallRating = "C";
@@ -65,6 +202,85 @@ bool AudioCDCopier::RunComprehensiveScan(DiscInfo& disc, ComprehensiveScanResult
 	return true;
 }
 
+// ============================================================================
+// RunScanPass - One sequential C2 read of the audio area
+//
+// Reads are batched (ReadSectorsWithC2); its per-sector status carries the
+// C1/C2 block counts and isolates recovered sense, so the C1-capable BLER
+// scan reads in batches too.  verifyC2 re-reads C2-positive sectors once
+// after a cache defeat, as RunDiscRotScan does on Pioneer drives, whose C2
+// can be transient.
+// ============================================================================
+bool AudioCDCopier::RunScanPass(const DiscLayout& layout, int scanSpeed, bool withC1, bool verifyC2,
+	const std::vector<ScanAnalyzer*>& analyzers) {
+	DWORD totalSectors = layout.TotalSectors();
+	DWORD lastLBA = layout.LastLBA();
+	const DWORD batchSectors = m_drive.GetMaxTransferSectors(SECTOR_WITH_C2_SIZE);
+
+	ScsiDrive::C2ReadOptions c2Opts;
+	c2Opts.multiPass = false;
+	c2Opts.countBytes = true;   // Byte counting — PlexTools-style C2 error interpretation
+
+	std::vector<BYTE> audio(static_cast<size_t>(batchSectors) * AUDIO_SECTOR_SIZE);
+	std::vector<BYTE> verifyBuf(AUDIO_SECTOR_SIZE);
+	std::vector<C2SectorStatus> status(batchSectors);
+	std::vector<ScanSector> sectors(batchSectors);
+
+	m_drive.SetSpeed(scanSpeed);
+	ProgressIndicator progress(40);
+	progress.SetLabel("  Scanning");
+	progress.Start();
+
+	DWORD scanned = 0;
+	for (const auto& span : layout.Spans()) {
+		for (auto* analyzer : analyzers) analyzer->BeginTrack();
+
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; ) {
+			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+				m_drive.SetSpeed(0);
+				progress.Finish(false);
+				return false;
+			}
+
+			DWORD count = std::min(batchSectors, span.lastLBA - lba + 1);
+			m_drive.ReadSectorsWithC2(lba, count, audio.data(), nullptr, nullptr,
+				nullptr, c2Opts, nullptr, status.data());
+
+			for (DWORD k = 0; k < count; k++) {
+				const C2SectorStatus& st = status[k];
+				ScanSector& s = sectors[k];
+				s = ScanSector{};
+				s.lba = lba + k;
+				s.audio = audio.data() + static_cast<size_t>(k) * AUDIO_SECTOR_SIZE;
+				s.readOk = st.ok;
+				s.recovered = (st.senseKey == 0x01);
+				s.c2Errors = st.c2Errors;
+				if (withC1) {
+					s.c1BlockErrors = st.c1BlockErrors;
+					s.c2BlockErrors = st.c2BlockErrors;
+				}
+				s.verifiedC2 = s.c2Errors;
+				if (verifyC2 && s.readOk && s.c2Errors > 0) {
+					DefeatDriveCache(s.lba, lastLBA);
+					int verify = 0;
+					if (m_drive.ReadSectorWithC2Ex(s.lba, verifyBuf.data(), nullptr, verify, nullptr, c2Opts)) {
+						s.verifiedC2 = (verify == 0) ? 0 : std::max(s.c2Errors, verify);
+					}
+				}
+			}
+			for (auto* analyzer : analyzers) analyzer->AddBatch(sectors.data(), count);
+
+			lba += count;
+			scanned += count;
+			progress.Update(static_cast<int>(scanned), static_cast<int>(totalSectors));
+		}
+	}
+
+	progress.Finish(true);
+	m_drive.SetSpeed(0);
+	return true;
+}
+
 int AudioCDCopier::CalculateOverallScore(const ComprehensiveScanResult& result) {
 	int score = 100;
 
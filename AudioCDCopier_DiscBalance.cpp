@@ -1,5 +1,6 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include <iostream>
 #include <iomanip>
@@ -60,15 +61,12 @@ bool AudioCDCopier::CheckDiscBalance(DiscInfo& disc, int& balanceScore) {
 	// sectors) so the target sector is NOT prefetched into cache.
 	constexpr DWORD READ_AHEAD_MARGIN = 150;
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
-	if (totalSectors == 0) return false;
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	if (layout.TotalSectors() == 0) return false;
 
 	// Build a flat list of all sample LBAs spaced evenly across the disc
 	std::vector<DWORD> sampleLBAs;
-	DWORD maxLBA = 0;
-	for (const auto& t : disc.tracks) {
-		if (t.isAudio && t.endLBA > maxLBA) maxLBA = t.endLBA;
-	}
+	DWORD maxLBA = layout.LastLBA();
 	// Build sample LBAs with outer-edge bias: use a quadratic distribution
 	// so ~60% of samples fall in the outer 40% of the disc, where wobble
 	// effects are strongest (centrifugal force ∝ radius²).
@@ -80,15 +78,7 @@ bool AudioCDCopier::CheckDiscBalance(DiscInfo& disc, int& balanceScore) {
 		// Blend 50% uniform + 50% concave to keep some inner coverage
 		double blended = 0.5 * t + 0.5 * biased;
 		DWORD lba = static_cast<DWORD>(blended * maxLBA);
-
-		for (const auto& tr : disc.tracks) {
-			if (!tr.isAudio) continue;
-			DWORD start = (tr.trackNumber == 1) ? 0 : tr.pregapLBA;
-			if (lba >= start && lba <= tr.endLBA) {
-				sampleLBAs.push_back(lba);
-				break;
-			}
-		}
+		if (layout.SpanAt(lba)) sampleLBAs.push_back(lba);
 	}
 	if (sampleLBAs.empty()) return false;
 
@@ -5,6 +5,9 @@
 #include "ConsoleGraph.h"
 #include "ConsoleFormat.h"
 #include "PioneerVendor.h"
+#include "ScanAnalyzers.h"
+#include "ScanSession.h"
+#include "GuidedC2Plan.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -168,16 +171,9 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 		return false;
 	}
 
-	DWORD firstLBA = 0, lastLBA = 0;
-	DWORD totalSectors = 0;
-	for (const auto& t : disc.tracks) {
-		if (t.isAudio) {
-			DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-			if (totalSectors == 0) firstLBA = start;
-			lastLBA = t.endLBA;
-			totalSectors += t.endLBA - start + 1;
-		}
-	}
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD firstLBA = layout.FirstLBA(), lastLBA = layout.LastLBA();
+	DWORD totalSectors = layout.TotalSectors();
 
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to scan.\n";
@@ -185,7 +181,6 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 	}
 
 	result = DiscRotAnalysis{};
-	std::vector<DWORD> errorLBAs;
 	std::vector<DWORD> inconsistentLBAs;
 
 	// ── Phase 0 (optional): C1 quality scan for early degradation ────
@@ -231,85 +226,68 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 			: m_drive.LiteOnScanStart(firstLBA, lastLBA);
 
 		if (started) {
-			bool scanDone = false;
 			bool c1Cancelled = false;
-			int sampleIndex = 0;
-			DWORD lastReportedLBA = DWORD(-1);
-
-			while (!scanDone) {
+			ScanSession session(ScanSession::ForQualityScan(m_drive,
+				usePlextor ? ScanSession::Vendor::PlextorQCheck
+				: usePioneer ? ScanSession::Vendor::Pioneer
+				: ScanSession::Vendor::LiteOn,
+				firstLBA, lastLBA, scanSpeed));
+			std::vector<ScanSlice> slices;
+
+			// Empty, repeated and the first 3 startup/seek-settle slices are
+			// filtered by the session, as in Q-Check.
+			session.Start();
+			while (session.Wait(slices, 100)) {
 				if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+					session.Stop();
 					c1Cancelled = true;
 					break;
 				}
 
-				if (usePlextor)
-					std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
-				int c1 = 0, c2 = 0, cu = 0;
-				DWORD currentLBA = 0;
-
-				bool pollOk = usePlextor
-					? m_drive.PlextorQCheckPoll(c1, c2, cu, currentLBA, scanDone)
-					: usePioneer
-					? m_drive.PioneerScanPoll(c1, c2, cu, currentLBA, scanDone)
-					: m_drive.LiteOnScanPoll(c1, c2, cu, currentLBA, scanDone);
-
-				if (!pollOk && (usePlextor || usePioneer)) {
-					std::this_thread::sleep_for(std::chrono::milliseconds(200));
-					pollOk = usePlextor
-						? m_drive.PlextorQCheckPoll(c1, c2, cu, currentLBA, scanDone)
-						: m_drive.PioneerScanPoll(c1, c2, cu, currentLBA, scanDone);
-				}
-				if (!pollOk) break;
-				if (!usePioneer && currentLBA == 0 && c1 == 0 && c2 == 0 && cu == 0 && !scanDone) continue;
-				if (currentLBA == lastReportedLBA && !scanDone) continue;
-				lastReportedLBA = currentLBA;
-
-				// Match Q-Check: discard the first 3 startup/seek-settle samples.
-				if (sampleIndex < 3) { sampleIndex++; continue; }
-
-				if (useLiteOn && currentLBA >= lastLBA) scanDone = true;
-
-				QCheckSample sample;
-				sample.lba = currentLBA;
-				sample.c1 = c1;
-				if (usePioneer) {
-					sample.pioneerE22 = c2;
-					sample.c2 = 0;
-				}
-				else {
-					sample.c2 = c2;
-				}
-				sample.cu = cu;
-				c1Result.samples.push_back(sample);
-				c1Result.totalC1 += sample.c1;
-				c1Result.totalC2 += sample.c2;
-				c1Result.totalCU += sample.cu;
-				c1Result.totalPioneerE22 += sample.pioneerE22;
-				int idx = static_cast<int>(c1Result.samples.size()) - 1;
-				if (c1 > c1Result.maxC1PerSecond) {
-					c1Result.maxC1PerSecond = c1;
-					c1Result.maxC1SecondIndex = idx;
-				}
-				if (sample.c2 > c1Result.maxC2PerSecond) {
-					c1Result.maxC2PerSecond = sample.c2;
-					c1Result.maxC2SecondIndex = idx;
-				}
-				if (cu > c1Result.maxCUPerSecond)
-					c1Result.maxCUPerSecond = cu;
-				if (sample.pioneerE22 > c1Result.maxPioneerE22PerSecond) {
-					c1Result.maxPioneerE22PerSecond = sample.pioneerE22;
-					c1Result.maxPioneerE22SecondIndex = idx;
+				for (const ScanSlice& slice : slices) {
+					QCheckSample sample;
+					sample.lba = slice.lba;
+					sample.c1 = slice.c1;
+					if (usePioneer) {
+						sample.pioneerE22 = slice.c2;
+						sample.c2 = 0;
+					}
+					else {
+						sample.c2 = slice.c2;
+					}
+					sample.cu = slice.cu;
+					c1Result.samples.push_back(sample);
+					c1Result.totalC1 += sample.c1;
+					c1Result.totalC2 += sample.c2;
+					c1Result.totalCU += sample.cu;
+					c1Result.totalPioneerE22 += sample.pioneerE22;
+					int idx = static_cast<int>(c1Result.samples.size()) - 1;
+					if (sample.c1 > c1Result.maxC1PerSecond) {
+						c1Result.maxC1PerSecond = sample.c1;
+						c1Result.maxC1SecondIndex = idx;
+					}
+					if (sample.c2 > c1Result.maxC2PerSecond) {
+						c1Result.maxC2PerSecond = sample.c2;
+						c1Result.maxC2SecondIndex = idx;
+					}
+					if (sample.cu > c1Result.maxCUPerSecond)
+						c1Result.maxCUPerSecond = sample.cu;
+					if (sample.pioneerE22 > c1Result.maxPioneerE22PerSecond) {
+						c1Result.maxPioneerE22PerSecond = sample.pioneerE22;
+						c1Result.maxPioneerE22SecondIndex = idx;
+					}
 				}
-				sampleIndex++;
+				if (slices.empty()) continue;
+				const ScanSlice latest = slices.back();
+				slices.clear();
 
-				double pct = (totalSectors > 0 && currentLBA >= firstLBA)
-					? std::min(100.0, static_cast<double>(currentLBA - firstLBA) * 100.0 / totalSectors)
+				double pct = (totalSectors > 0 && latest.lba >= firstLBA)
+					? std::min(100.0, static_cast<double>(latest.lba - firstLBA) * 100.0 / totalSectors)
 					: 0.0;
 				std::cout << "\r  C1 scan... " << std::fixed << std::setprecision(1)
-					<< pct << "%  C1=" << c1
-					<< (usePioneer ? " E22=" : " C2=") << c2
-					<< " CU=" << cu << "     " << std::flush;
+					<< pct << "%  C1=" << latest.c1
+					<< (usePioneer ? " E22=" : " C2=") << latest.c2
+					<< " CU=" << latest.cu << "     " << std::flush;
 			}
 
 			if (usePlextor) m_drive.PlextorQCheckStop();
@@ -360,6 +338,9 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 			RecalculateQCheckTotals(c1Result);
 			if (spikesTrimmed)
 				std::cout << "  Startup spike(s) trimmed from quality scan.\n";
+			if (session.LateSlices() > 0)
+				std::cout << "  " << session.LateSlices()
+				<< " late poll(s) split evenly across the seconds they covered\n";
 			if (pioneerCoupledSpikesTrimmed)
 				std::cout << "  [Pioneer] Suppressed isolated coupled C1/E22 spike(s) as vendor-scan artifacts.\n";
 
@@ -398,7 +379,34 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 		std::cout << "  (Disc rot detection limited to C2 errors only)\n\n";
 	}
 
+	// ── Phase 1: C2, over the whole disc or where the C1 map points ──
+	const DWORD totalSeconds = layout.TotalSeconds();
+	if (hasC1) {
+		result.perSecondC1.assign(totalSeconds, 0);
+		for (const auto& s : c1Result.samples) {
+			DWORD sec = layout.SecondOf(s.lba);
+			if (sec != DiscLayout::NOT_COVERED) result.perSecondC1[sec] += s.c1;
+		}
+	}
+
+	const std::vector<int> c2Plan = hasC1 ? PlanGuidedC2(c1Result, layout) : std::vector<int>();
+	result.c2Guided = !c2Plan.empty();
+	result.perSecondC2.assign(totalSeconds, result.c2Guided ? -1 : 0);
+	DWORD plannedSectors = totalSectors;
+	if (result.c2Guided) {
+		// Same per-LBA test as the read loop below, so the progress total
+		// matches what is read.
+		plannedSectors = 0;
+		for (const auto& span : layout.Spans())
+			for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++)
+				if (c2Plan[layout.SecondOf(lba)] > 0) plannedSectors++;
+	}
+
 	std::cout << "Phase 1: C2 error distribution scan...\n";
+	if (result.c2Guided) {
+		std::cout << "  Guided by the C1 map: " << plannedSectors << " of " << totalSectors
+			<< " sectors (high-C1 zones + 1-in-" << ROT_BASELINE_STRIDE << " baseline)\n";
+	}
 	m_drive.SetSpeed(scanSpeed);
 
 	ProgressIndicator progress(40);
@@ -408,18 +416,19 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 	ScsiDrive::C2ReadOptions c2Opts;
 	c2Opts.countBytes = true;
 
+	RotZoneAnalyzer zones(*this, result, layout, scanSpeed);
 	DWORD scannedSectors = 0;
-	int maxC2InSector = 0;
 	int pioneerTransientC2 = 0;
 	int pioneerRecoveredReadFailures = 0;
 	if (isPioneerDrive) {
 		std::cout << "  [Pioneer] C2-positive sectors will be verified with a second read.\n";
 	}
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++) {
+			DWORD sec = layout.SecondOf(lba);
+			int weight = result.c2Guided ? c2Plan[sec] : 1;
+			if (weight == 0) continue;
 
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				m_drive.SetSpeed(0);
 				return false;
@@ -449,23 +458,27 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 						}
 					}
 				}
-				ClassifyZone(lba, firstLBA, lastLBA, c2Errors > 0 ? 1 : 0, result.zones);
-				if (c2Errors > 0) {
-					errorLBAs.push_back(lba);
-					if (c2Errors > maxC2InSector)
-						maxC2InSector = c2Errors;
-				}
-			}
-			else {
-				ClassifyZone(lba, firstLBA, lastLBA, 1, result.zones);
-				errorLBAs.push_back(lba);
 			}
 
+			ScanSector sector;
+			sector.lba = lba;
+			sector.audio = buf.data();
+			sector.readOk = readOk;
+			sector.c2Errors = c2Errors;
+			sector.verifiedC2 = c2Errors;
+			sector.weight = weight;
+			zones.AddSector(sector);
+
+			int& c2Second = result.perSecondC2[sec];
+			if (c2Second < 0) c2Second = 0;
+			if (!readOk || c2Errors > 0) c2Second++;
+
 			scannedSectors++;
-			progress.Update(static_cast<int>(scannedSectors), static_cast<int>(totalSectors));
+			progress.Update(static_cast<int>(scannedSectors), static_cast<int>(plannedSectors));
 		}
 	}
 	progress.Finish(true);
+	result.c2SectorsRead = scannedSectors;
 	if (pioneerTransientC2 > 0) {
 		std::cout << "  [Pioneer] Ignored " << pioneerTransientC2
 			<< " transient C2 sector" << (pioneerTransientC2 == 1 ? "" : "s")
@@ -477,9 +490,7 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 			<< " on verification read.\n";
 	}
 
-	std::sort(errorLBAs.begin(), errorLBAs.end());
-	DetectErrorClusters(errorLBAs, result.clusters, scanSpeed);
-	result.maxC2InSingleSector = maxC2InSector;
+	zones.Finish();
 
 	// Adaptive Zone-Based Sampling
 	std::cout << "\nPhase 2: Adaptive read consistency check...\n";
@@ -499,21 +510,21 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 	int middleInterval = calcSampleInterval(middleRate);
 	int outerInterval = calcSampleInterval(outerRate);
 
-	int expectedSamples = 0;
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
-			DWORD range = lastLBA - firstLBA;
-			DWORD pos = lba - firstLBA;
-			double pct = range > 0 ? static_cast<double>(pos) / range : 0;
+	// Sample positions are picked once; the per-zone interval restarts at
+	// each track's first sector.
+	std::vector<DWORD> sampleLBAs;
+	DWORD range = lastLBA - firstLBA;
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++) {
+			double pct = range > 0 ? static_cast<double>(lba - firstLBA) / range : 0;
 			int sampleInterval = 200;
 			if (pct < 0.33) sampleInterval = innerInterval;
 			else if (pct < 0.66) sampleInterval = middleInterval;
 			else sampleInterval = outerInterval;
-			if ((lba - start) % sampleInterval == 0) expectedSamples++;
+			if ((lba - span.firstLBA) % sampleInterval == 0) sampleLBAs.push_back(lba);
 		}
 	}
+	int expectedSamples = static_cast<int>(sampleLBAs.size());
 
 	int samplesChecked = 0;
 	int inconsistentSamples = 0;
@@ -521,37 +532,21 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 	progress.SetLabel("  Adaptive Check");
 	progress.Start();
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
-			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
-				break;
-			}
-
-			DWORD range = lastLBA - firstLBA;
-			DWORD pos = lba - firstLBA;
-			double pct = range > 0 ? static_cast<double>(pos) / range : 0;
-			int sampleInterval = 200;
-
-			if (pct < 0.33) sampleInterval = innerInterval;
-			else if (pct < 0.66) sampleInterval = middleInterval;
-			else sampleInterval = outerInterval;
-
-			if ((lba - start) % sampleInterval != 0) continue;
+	for (DWORD lba : sampleLBAs) {
+		if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+			break;
+		}
 
-			int inconsistent = 0;
-			if (TestReadConsistency(lba, 3, inconsistent, scanSpeed)) {
-				samplesChecked++;
-				if (inconsistent > 0) {
-					inconsistentSamples++;
-					inconsistentLBAs.push_back(lba);
-				}
+		int inconsistent = 0;
+		if (TestReadConsistency(lba, 3, inconsistent, scanSpeed)) {
+			samplesChecked++;
+			if (inconsistent > 0) {
+				inconsistentSamples++;
+				inconsistentLBAs.push_back(lba);
 			}
-
-			progress.Update(samplesChecked, expectedSamples);
 		}
+
+		progress.Update(samplesChecked, expectedSamples);
 	}
 	progress.Finish(true);
 
@@ -562,41 +557,21 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 
 	m_drive.SetSpeed(0);
 
-	AnalyzeErrorPatterns(errorLBAs, result);
+	AnalyzeErrorPatterns(zones.ErrorLBAs(), result);
 
 	// ── Factor C1 data into rot assessment ───────────────────────────
 	if (hasC1) {
 		AnalyzeC1RotPatterns(c1Result, firstLBA, lastLBA, result);
 	}
 
-	if (result.rotRiskLevel == "NONE") {
-		result.recommendation = "Disc appears healthy. Store properly to prevent future damage.";
-	}
-	else if (result.rotRiskLevel == "LOW") {
-		result.recommendation = "Minor issues detected. Consider backing up soon.";
-	}
-	else if (result.rotRiskLevel == "MODERATE") {
-		result.recommendation = "Disc showing early degradation signs. Back up immediately.";
-	}
-	else if (result.rotRiskLevel == "HIGH") {
-		result.recommendation = "Significant degradation detected. Back up NOW - data loss likely.";
-	}
-	else {
-		result.recommendation = "CRITICAL damage! Extract whatever data possible immediately.";
-	}
+	SetRotRecommendation(result);
 
 	PrintDiscRotReport(result);
 
-	// Print C1 graph if available
-	if (hasC1 && !c1Result.samples.empty()) {
-		// Convert samples to a flat int vector for BucketData
-		std::vector<int> c1Values;
-		c1Values.reserve(c1Result.samples.size());
-		for (const auto& s : c1Result.samples)
-			c1Values.push_back(s.c1);
-
+	// C1 and C2 per second on one time axis; columns line up between graphs
+	if (hasC1 && !result.perSecondC1.empty()) {
 		int maxC1 = 1;
-		for (int v : c1Values)
+		for (int v : result.perSecondC1)
 			if (v > maxC1) maxC1 = v;
 
 		// Ensure the chart is tall enough to show the Red Book reference line
@@ -611,9 +586,25 @@ bool AudioCDCopier::RunDiscRotScan(DiscInfo& disc, DiscRotAnalysis& result, int
 		c1Opts.refLabel = "Red Book limit (220/sec)";
 		c1Opts.colorize = true;
 
-		auto buckets = Console::BucketData(c1Values, c1Opts.width);
-		Console::DrawBarGraph(buckets, maxC1, c1Opts,
-			static_cast<DWORD>(c1Result.samples.size()));
+		auto buckets = Console::BucketData(result.perSecondC1, c1Opts.width);
+		Console::DrawBarGraph(buckets, maxC1, c1Opts, totalSeconds);
+
+		int maxC2 = 0;
+		for (int v : result.perSecondC2)
+			if (v > maxC2) maxC2 = v;
+		if (maxC2 > 0) {
+			Console::GraphOptions c2Opts;
+			c2Opts.title = "C2 Profile";
+			c2Opts.subtitle = result.c2Guided
+				? "C2 / failed sectors per second, same time axis (only C1-guided seconds read)"
+				: "C2 / failed sectors per second, same time axis";
+			c2Opts.width = c1Opts.width;
+			c2Opts.height = 6;
+			c2Opts.colorize = true;
+
+			Console::DrawBarGraph(Console::BucketData(result.perSecondC2, c2Opts.width),
+				std::max(maxC2, 5), c2Opts, totalSeconds);
+		}
 	}
 
 	return true;
@@ -652,7 +643,7 @@ bool AudioCDCopier::TestReadConsistency(DWORD lba, int passes, int& mismatchCoun
 }
 
 void AudioCDCopier::ClassifyZone(DWORD lba, DWORD totalStart, ULONG totalEnd,
-	int hasError, DiscZoneStats& zones) {
+	int hasError, DiscZoneStats& zones, int weight) {
 	DWORD range = totalEnd - totalStart;
 	if (range == 0) return;
 
@@ -660,16 +651,16 @@ void AudioCDCopier::ClassifyZone(DWORD lba, DWORD totalStart, ULONG totalEnd,
 	double position = static_cast<double>(relative) / range;
 
 	if (position < 0.33) {
-		zones.innerSectors++;
-		zones.innerErrors += hasError;
+		zones.innerSectors += weight;
+		zones.innerErrors += hasError * weight;
 	}
 	else if (position < 0.66) {
-		zones.middleSectors++;
-		zones.middleErrors += hasError;
+		zones.middleSectors += weight;
+		zones.middleErrors += hasError * weight;
 	}
 	else {
-		zones.outerSectors++;
-		zones.outerErrors += hasError;
+		zones.outerSectors += weight;
+		zones.outerErrors += hasError * weight;
 	}
 }
 
@@ -761,6 +752,24 @@ void AudioCDCopier::AnalyzeErrorPatterns(const std::vector<DWORD>& errorLBAs,
 	analysis.rotRiskLevel = AssessRotRisk(analysis);
 }
 
+void AudioCDCopier::SetRotRecommendation(DiscRotAnalysis& result) {
+	if (result.rotRiskLevel == "NONE") {
+		result.recommendation = "Disc appears healthy. Store properly to prevent future damage.";
+	}
+	else if (result.rotRiskLevel == "LOW") {
+		result.recommendation = "Minor issues detected. Consider backing up soon.";
+	}
+	else if (result.rotRiskLevel == "MODERATE") {
+		result.recommendation = "Disc showing early degradation signs. Back up immediately.";
+	}
+	else if (result.rotRiskLevel == "HIGH") {
+		result.recommendation = "Significant degradation detected. Back up NOW - data loss likely.";
+	}
+	else {
+		result.recommendation = "CRITICAL damage! Extract whatever data possible immediately.";
+	}
+}
+
 std::string AudioCDCopier::AssessRotRisk(const DiscRotAnalysis& analysis) {
 	int score = 0;
 
@@ -799,7 +808,11 @@ void AudioCDCopier::PrintDiscRotReport(const DiscRotAnalysis& analysis) {
 	std::cout << "\n";
 	Heading("  Zone Error Rates\n");
 	SetColorRGB(Theme::DimR, Theme::DimG, Theme::DimB);
-	std::cout << "  (Disc surface divided into three radial zones)\n\n";
+	std::cout << "  (Disc surface divided into three radial zones)\n";
+	if (analysis.c2Guided)
+		std::cout << "  (C2 read on " << analysis.c2SectorsRead
+			<< " C1-guided sectors; zone counts are whole-disc estimates)\n";
+	std::cout << "\n";
 	Reset();
 
 	auto printZone = [](const char* label, double rate, int errors, int sectors) {
@@ -879,6 +892,11 @@ void AudioCDCopier::PrintDiscRotReport(const DiscRotAnalysis& analysis) {
 
 	std::cout << "\n";
 	Heading("  Error Clusters\n");
+	if (analysis.c2Guided) {
+		SetColorRGB(Theme::DimR, Theme::DimG, Theme::DimB);
+		std::cout << "  (From the C1-guided sectors only; clusters may extend into\n"
+			<< "   unread seconds, and the peak C2 count covers read sectors only)\n";
+	}
 	Reset();
 	std::cout << "  Total clusters:  " << analysis.clusters.size() << "\n";
 	if (!analysis.clusters.empty()) {
@@ -1024,6 +1042,8 @@ bool AudioCDCopier::SaveDiscRotLog(const DiscRotAnalysis& analysis, const std::w
 	fprintf(f, "# ==============================\n");
 	fprintf(f, "# Error Clusters (%zu total)\n", analysis.clusters.size());
 	fprintf(f, "# ==============================\n");
+	if (analysis.c2Guided)
+		fprintf(f, "# From the %lu C1-guided sectors only\n", analysis.c2SectorsRead);
 	fprintf(f, "ClusterIndex,StartLBA,EndLBA,SectorCount,ErrorCount\n");
 	for (size_t i = 0; i < analysis.clusters.size(); i++) {
 		const auto& c = analysis.clusters[i];
@@ -9,11 +9,13 @@
 // ============================================================================
 #define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
+#include "ScanSession.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
-#include <chrono>
+#include <vector>
 #include <algorithm>
 #include <fstream>
 #include <cmath>
@@ -31,15 +33,9 @@ bool AudioCDCopier::RunJitterScan(const DiscInfo& disc, JitterResult& result, in
 	result.supported = true;
 
 	// Scan range — audio sectors only, matches QCheck.
-	DWORD firstLBA = 0, lastLBA = 0;
-	bool first = true;
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		if (first) { firstLBA = start; first = false; }
-		lastLBA = t.endLBA;
-	}
-	if (first) { std::cout << "No audio tracks.\n"; return false; }
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	if (layout.Empty()) { std::cout << "No audio tracks.\n"; return false; }
+	DWORD firstLBA = layout.FirstLBA(), lastLBA = layout.LastLBA();
 
 	result.totalSectors = lastLBA - firstLBA + 1;
 	result.totalSeconds = (result.totalSectors + 74) / 75;
@@ -57,74 +53,57 @@ bool AudioCDCopier::RunJitterScan(const DiscInfo& disc, JitterResult& result, in
 		return false;
 	}
 
-	auto start = std::chrono::steady_clock::now();
-	bool scanDone = false;
-	int sampleIndex = 0;
-	DWORD lastReportedLBA = DWORD(-1);
+	// Empty, repeated and the first 3 startup slices are filtered by the
+	// session (matches QCheck); it ends at lastLBA.
+	ScanSession session(ScanSession::ForJitterScan(m_drive, firstLBA, lastLBA, scanSpeed));
+	std::vector<ScanSlice> slices;
 	int lastLineLength = 0;
 	constexpr int BAR_WIDTH = 25;
 
-	while (!scanDone) {
+	session.Start();
+	while (session.Wait(slices, 100)) {
 		if (InterruptHandler::Instance().IsInterrupted()
 			|| InterruptHandler::Instance().CheckEscapeKey()) {
+			session.Stop();
 			m_drive.LiteOnJitterStop();
 			m_drive.SetSpeed(0);
 			std::cout << "\n*** Jitter scan cancelled ***\n";
 			return false;
 		}
 
-		int jitter = 0, beta = 0;
-		DWORD currentLBA = 0;
-		if (!m_drive.LiteOnJitterPoll(jitter, beta, currentLBA, scanDone)) {
-			m_drive.LiteOnJitterStop();
-			if (!result.samples.empty()) break;   // partial data — still useful
-			std::cout << "\nERROR: Lost communication with drive.\n";
-			m_drive.SetSpeed(0);
-			return false;
+		for (const ScanSlice& slice : slices) {
+			JitterSample s;
+			s.lba = slice.lba;
+			s.jitter = slice.c1;
+			s.beta = slice.c2;
+			result.samples.push_back(s);
+			result.totalJitter += s.jitter;
+
+			int idx = static_cast<int>(result.samples.size()) - 1;
+			if (s.jitter > result.maxJitter) {
+				result.maxJitter = s.jitter;
+				result.maxJitterSampleIndex = idx;
+			}
+			if (idx == 0) {
+				result.minBeta = s.beta;
+				result.maxBeta = s.beta;
+			}
+			else {
+				if (s.beta < result.minBeta) result.minBeta = s.beta;
+				if (s.beta > result.maxBeta) result.maxBeta = s.beta;
+			}
 		}
-
-		// Skip empty / duplicate responses while the drive seeks/spins up
-		if (currentLBA == 0 && jitter == 0 && beta == 0 && !scanDone) continue;
-		if (currentLBA == lastReportedLBA && !scanDone) continue;
-		lastReportedLBA = currentLBA;
-
-		// Discard first 3 raw samples — startup artefacts (matches QCheck)
-		if (sampleIndex < 3) { sampleIndex++; continue; }
-
-		if (currentLBA >= lastLBA) scanDone = true;
-
-		JitterSample s;
-		s.lba = currentLBA;
-		s.jitter = jitter;
-		s.beta = beta;
-		result.samples.push_back(s);
-		result.totalJitter += jitter;
-
-		int idx = static_cast<int>(result.samples.size()) - 1;
-		if (jitter > result.maxJitter) {
-			result.maxJitter = jitter;
-			result.maxJitterSampleIndex = idx;
-		}
-		if (idx == 0) {
-			result.minBeta = beta;
-			result.maxBeta = beta;
-		}
-		else {
-			if (beta < result.minBeta) result.minBeta = beta;
-			if (beta > result.maxBeta) result.maxBeta = beta;
-		}
-
-		sampleIndex++;
+		if (slices.empty()) continue;
+		const ScanSlice latest = slices.back();
+		slices.clear();
 
 		// ── Progress line (same shape as QCheck) ─────────────
 		double pct = 0.0;
-		if (result.totalSectors > 0 && currentLBA >= firstLBA) {
-			pct = static_cast<double>(currentLBA - firstLBA) * 100.0 / result.totalSectors;
+		if (result.totalSectors > 0 && latest.lba >= firstLBA) {
+			pct = static_cast<double>(latest.lba - firstLBA) * 100.0 / result.totalSectors;
 			if (pct > 100.0) pct = 100.0;
 		}
-		auto now = std::chrono::steady_clock::now();
-		int elapsed = static_cast<int>(
-			std::chrono::duration_cast<std::chrono::seconds>(now - start).count());
+		int elapsed = static_cast<int>(latest.timeMs / 1000.0);
 		int eta = -1;
 		if (pct > 1.0 && pct < 100.0) {
 			eta = static_cast<int>(elapsed * (100.0 - pct) / pct);
@@ -146,7 +125,7 @@ bool AudioCDCopier::RunJitterScan(const DiscInfo& disc, JitterResult& result, in
 			else
 				line << eta << "s";
 		}
-		line << "  jitter=" << jitter << " beta=" << beta;
+		line << "  jitter=" << latest.c1 << " beta=" << latest.c2;
 
 		std::string out = line.str();
 		if (static_cast<int>(out.size()) < lastLineLength)
@@ -155,6 +134,13 @@ bool AudioCDCopier::RunJitterScan(const DiscInfo& disc, JitterResult& result, in
 		std::cout << out << std::flush;
 	}
 
+	if (session.GetState() == ScanSession::State::Failed && result.samples.empty()) {
+		m_drive.LiteOnJitterStop();
+		std::cout << "\nERROR: Lost communication with drive.\n";
+		m_drive.SetSpeed(0);
+		return false;
+	}   // partial data — still useful
+
 	m_drive.LiteOnJitterStop();
 	m_drive.SetSpeed(0);
 
@@ -166,6 +152,10 @@ bool AudioCDCopier::RunJitterScan(const DiscInfo& disc, JitterResult& result, in
 	}
 
 	std::cout << "\n";
+	if (session.LateSlices() > 0) {
+		std::cout << "  " << session.LateSlices()
+			<< " late poll(s) repeated across the seconds they covered\n";
+	}
 	PrintJitterReport(result);
 	return true;
 }
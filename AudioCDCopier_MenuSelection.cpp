@@ -314,6 +314,28 @@ int AudioCDCopier::SelectSilentMode() {
 	return enable ? 1 : 0;
 }
 
+int AudioCDCopier::SelectRipOutput() {
+	std::cout << "\n=== Rip Output ===\n";
+	std::cout << "Files can be written after the whole disc has been read, or\n";
+	std::cout << "while it is being read.\n\n";
+	std::cout << "  - BUFFERED:  Holds the disc in memory (~800 MB with subchannel).\n";
+	std::cout << "               AccurateRip can also search other pressings' offsets.\n";
+	std::cout << "  - STREAMING: Writes and frees sectors as they are read; only\n";
+	std::cout << "               sectors awaiting secure re-reads stay in memory.\n\n";
+	std::cout << "0. Back to menu\n";
+	std::cout << "1. Buffered (default)\n";
+	std::cout << "2. Streaming (low memory)\n";
+	std::cout << "Choice: ";
+
+	int c = GetMenuChoice(0, 2, 1);
+	std::cin.clear(); std::cin.ignore(10000, '\n');
+
+	if (c == 0) return -1;
+	bool streaming = (c == 2);
+	std::cout << (streaming ? "Rip output: STREAMING\n" : "Rip output: BUFFERED\n");
+	return streaming ? 1 : 0;
+}
+
 int AudioCDCopier::SelectPlextorWriteOptions(bool& outTestWrite,
 	bool& outVariRecEnable, int& outVariRecOffset) {
 	outTestWrite = false;
@@ -384,6 +406,7 @@ SecureRipConfig AudioCDCopier::GetSecureRipConfig(SecureRipMode mode) {
 		config.c2Guided = true;
 		config.cacheDefeat = false;
 		config.maxSpeed = 0;
+		config.sampleVote = false;
 		break;
 	case SecureRipMode::Fast:
 		config.minPasses = 2;
@@ -15,9 +15,11 @@
 // ============================================================================
 #define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include "ConsoleGraph.h"
 #include "PioneerVendor.h"
+#include "ScanSession.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -252,17 +254,10 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 	// (to include the hidden pre-gap) and from pregapLBA for other tracks.
 	// Data tracks are skipped — the error-measurement mode only works on
 	// audio sectors (the drive expects Red Book framing).
-	DWORD firstLBA = 0, lastLBA = 0;
-	bool first = true;
-	for (const auto& t : disc.tracks) {
-		if (t.isAudio) {
-			DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-			if (first) { firstLBA = start; first = false; }
-			lastLBA = t.endLBA;
-		}
-	}
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD firstLBA = layout.FirstLBA(), lastLBA = layout.LastLBA();
 
-	if (first) {
+	if (layout.Empty()) {
 		std::cout << "No audio tracks found.\n";
 		return false;
 	}
@@ -315,150 +310,85 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 		};
 
 	// ── Poll for results ─────────────────────────────────────
-	// The drive scans asynchronously.  We poll periodically to retrieve
-	// C1/C2/CU counts and the current LBA position.  Each successful
-	// poll returns one time-slice of aggregated error statistics.
-	bool scanDone = false;
-	int sampleIndex = 0;
-	DWORD lastReportedLBA = DWORD(-1);   // Tracks duplicate reports from the same position
-
-	// ── Timer state for elapsed / ETA display ────────────────
-	auto scanStartTime = std::chrono::steady_clock::now();
+	// The drive scans asynchronously.  A ScanSession polls it on a
+	// background thread, paced from the observed scan rate, and hands
+	// over each time-slice of C1/C2/CU counts and its LBA position.
+	// Empty, repeated and startup slices are already filtered out.
+	const ScanSession::Vendor vendor = usePlextor ? ScanSession::Vendor::PlextorQCheck
+		: usePioneer ? ScanSession::Vendor::Pioneer
+		: ScanSession::Vendor::LiteOn;
+	ScanSession session(ScanSession::ForQualityScan(m_drive, vendor, firstLBA, lastLBA, scanSpeed));
+	std::vector<ScanSlice> slices;
+
 	int lastLineLength = 0;              // For padding '\r' lines to clear remnants
 	constexpr int BAR_WIDTH = 25;        // Width of the UTF-8 progress bar in columns
 
-	while (!scanDone) {
+	session.Start();
+	while (session.Wait(slices, 100)) {
 		// ── Check for user cancellation ──────────────────────
 		// Stop the hardware scan gracefully before returning so the drive
 		// doesn't continue spinning in measurement mode indefinitely.
 		if (InterruptHandler::Instance().IsInterrupted() || InterruptHandler::Instance().CheckEscapeKey()) {
+			session.Stop();
 			stopPrimaryScan();
 			std::cout << "\n*** Quality scan cancelled by user ***\n";
 			return false;
 		}
 
-		// Plextor Q-Check is asynchronous — the drive scans internally and
-		// we poll for updates.  Pioneer and LiteOn block on their SCSI
-		// command sequence, so adding a fixed delay makes scans needlessly
-		// slow.
-		if (usePlextor)
-			std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
-		int c1 = 0, c2 = 0, cu = 0;
-		DWORD currentLBA = 0;
-
-		// Poll the drive for the next time-slice of error statistics.
-		// Returns false on communication failure, true otherwise.
-		// `scanDone` is set to true by the driver when it reaches lastLBA.
-		bool pollOk = usePlextor
-			? m_drive.PlextorQCheckPoll(c1, c2, cu, currentLBA, scanDone)
-			: (usePioneer ? m_drive.PioneerScanPoll(c1, c2, cu, currentLBA, scanDone)
-				: m_drive.LiteOnScanPoll(c1, c2, cu, currentLBA, scanDone));
-
-		if (!pollOk) {
-			// One retry for asynchronous scans (Plextor / Pioneer) —
-			// transient SCSI timeouts are common when the drive is busy
-			// with its internal scan loop.
-			if (usePlextor || usePioneer) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(200));
-				pollOk = usePlextor
-					? m_drive.PlextorQCheckPoll(c1, c2, cu, currentLBA, scanDone)
-					: m_drive.PioneerScanPoll(c1, c2, cu, currentLBA, scanDone);
+		for (const ScanSlice& slice : slices) {
+			// ── Record the sample ────────────────────────────────
+			QCheckSample sample;
+			sample.lba = slice.lba;
+			sample.c1 = slice.c1;    // C1 corrections this time slice (first-level Reed-Solomon)
+			if (usePioneer) {
+				sample.pioneerE22 = slice.c2;  // Pioneer vendor diagnostic; not counted as verified C2
+				sample.c2 = 0;
 			}
-			if (!pollOk) {
-				// Communication lost.  Stop the scan if possible.
-				stopPrimaryScan();
-				// If we already have partial data, treat it as a completed
-				// scan and report what we have — better than nothing.
-				if (!result.samples.empty()) break;
-				std::cout << "\nERROR: Lost communication with drive during scan.\n";
-				return false;
+			else {
+				sample.c2 = slice.c2;          // Verified C2 corrections from LiteOn/Plextor
 			}
-		}
-
-		// Skip empty responses — the drive hasn't produced data yet
-		// (still seeking to the start position or spinning up).
-		// Pioneer tracks LBA in software starting at firstLBA, so LBA 0
-		// is a valid position — don't apply this filter for Pioneer scans.
-		if (!usePioneer && currentLBA == 0 && c1 == 0 && c2 == 0 && cu == 0 && !scanDone)
-			continue;
-
-		// Skip duplicate LBA reports — the drive sometimes returns the
-		// same position twice before advancing to the next time slice.
-		if (currentLBA == lastReportedLBA && !scanDone)
-			continue;
-		lastReportedLBA = currentLBA;
-
-		// Discard the first 3 samples — the drive is still seeking/spinning
-		// up and reports accumulated startup errors in the initial responses.
-		// QPXTool does the same; without this the first sample creates a
-		// massive spike that dominates the entire graph and skews statistics.
-		// Applies to all scan paths (Plextor, Pioneer, LiteOn).
-		if (sampleIndex < 3) {
-			sampleIndex++;
-			continue;
-		}
-
-		// LiteOn drives don't set the `scanDone` flag automatically —
-		// detect end-of-disc by checking if the current position has
-		// reached or passed the last audio sector.
-		if (useLiteOn && currentLBA >= lastLBA) {
-			scanDone = true;
-		}
-
-		// ── Record the sample ────────────────────────────────
-		QCheckSample sample;
-		sample.lba = currentLBA;
-		sample.c1 = c1;    // C1 corrections this time slice (first-level Reed-Solomon)
-		if (usePioneer) {
-			sample.pioneerE22 = c2;  // Pioneer vendor diagnostic; not counted as verified C2
-			sample.c2 = 0;
-		}
-		else {
-			sample.c2 = c2;          // Verified C2 corrections from LiteOn/Plextor
-		}
-		sample.cu = cu;     // Uncorrectable errors (both correction stages failed)
-		result.samples.push_back(sample);
+			sample.cu = slice.cu;    // Uncorrectable errors (both correction stages failed)
+			result.samples.push_back(sample);
 
-		// Running totals for summary statistics.
-		result.totalC1 += sample.c1;
-		result.totalC2 += sample.c2;
-		result.totalCU += sample.cu;
-		result.totalPioneerE22 += sample.pioneerE22;
+			// Running totals for summary statistics.
+			result.totalC1 += sample.c1;
+			result.totalC2 += sample.c2;
+			result.totalCU += sample.cu;
+			result.totalPioneerE22 += sample.pioneerE22;
 
-		// Track peak values and their positions for the report.
-		int idx = static_cast<int>(result.samples.size()) - 1;
+			// Track peak values and their positions for the report.
+			int idx = static_cast<int>(result.samples.size()) - 1;
 
-		if (c1 > result.maxC1PerSecond) {
-			result.maxC1PerSecond = c1;
-			result.maxC1SecondIndex = idx;    // Sample index where peak C1 occurred
-		}
-		if (sample.c2 > result.maxC2PerSecond) {
-			result.maxC2PerSecond = sample.c2;
-			result.maxC2SecondIndex = idx;
-		}
-		if (sample.pioneerE22 > result.maxPioneerE22PerSecond) {
-			result.maxPioneerE22PerSecond = sample.pioneerE22;
-			result.maxPioneerE22SecondIndex = idx;
+			if (sample.c1 > result.maxC1PerSecond) {
+				result.maxC1PerSecond = sample.c1;
+				result.maxC1SecondIndex = idx;    // Sample index where peak C1 occurred
+			}
+			if (sample.c2 > result.maxC2PerSecond) {
+				result.maxC2PerSecond = sample.c2;
+				result.maxC2SecondIndex = idx;
+			}
+			if (sample.pioneerE22 > result.maxPioneerE22PerSecond) {
+				result.maxPioneerE22PerSecond = sample.pioneerE22;
+				result.maxPioneerE22SecondIndex = idx;
+			}
+			if (sample.cu > result.maxCUPerSecond)
+				result.maxCUPerSecond = sample.cu;
 		}
-		if (cu > result.maxCUPerSecond)
-			result.maxCUPerSecond = cu;
-
-		sampleIndex++;
+		if (slices.empty()) continue;
+		const ScanSlice latest = slices.back();
+		slices.clear();
 
 		// ── Compute progress, elapsed, and ETA ───────────────
 		// Progress is calculated from the LBA position relative to the
 		// total scan range, not from sample count, since time slices
 		// don't have a fixed sector width.
 		double pct = 0.0;
-		if (currentLBA >= firstLBA && result.totalSectors > 0) {
-			pct = static_cast<double>(currentLBA - firstLBA) * 100.0 / result.totalSectors;
+		if (latest.lba >= firstLBA && result.totalSectors > 0) {
+			pct = static_cast<double>(latest.lba - firstLBA) * 100.0 / result.totalSectors;
 			if (pct > 100.0) pct = 100.0;
 		}
 
-		auto now = std::chrono::steady_clock::now();
-		int elapsedSec = static_cast<int>(
-			std::chrono::duration_cast<std::chrono::seconds>(now - scanStartTime).count());
+		int elapsedSec = static_cast<int>(latest.timeMs / 1000.0);
 
 		// ETA: linear extrapolation from elapsed time and progress fraction.
 		// Only shown after 1% progress to avoid wildly inaccurate estimates
@@ -499,9 +429,9 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 
 		// Show live error counts so the user can spot problems immediately
 		// without waiting for the full report.
-		line << "  C1=" << c1
-			<< (usePioneer ? " E22=" : " C2=") << c2
-			<< " CU=" << cu;
+		line << "  C1=" << latest.c1
+			<< (usePioneer ? " E22=" : " C2=") << latest.c2
+			<< " CU=" << latest.cu;
 
 		// Pad with spaces to overwrite any leftover characters from a
 		// longer previous line (e.g. when ETA shrinks).
@@ -513,12 +443,22 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 		std::cout << output << std::flush;
 	}
 
+	if (session.GetState() == ScanSession::State::Failed) {
+		// Communication lost.  Stop the scan if possible.
+		stopPrimaryScan();
+		// If we already have partial data, treat it as a completed
+		// scan and report what we have — better than nothing.
+		if (result.samples.empty()) {
+			std::cout << "\nERROR: Lost communication with drive during scan.\n";
+			return false;
+		}
+	}
+
 	stopPrimaryScan();
 
 	// ── Print final elapsed time ─────────────────────────────
-	auto scanEndTime = std::chrono::steady_clock::now();
-	int totalElapsed = static_cast<int>(
-		std::chrono::duration_cast<std::chrono::seconds>(scanEndTime - scanStartTime).count());
+	// Up to the poll that reported the end of the scan.
+	int totalElapsed = static_cast<int>(session.ElapsedMs() / 1000.0);
 
 	// Format elapsed time in adaptive units (h/m/s) for readability.
 	std::ostringstream elapsed;
@@ -534,6 +474,12 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 
 	std::cout << "\n  Done in " << elapsed.str()
 		<< " (" << result.samples.size() << " samples)\n";
+	// Late polls were split into per-second samples with their counts
+	// shared out, so those seconds are averages rather than readings.
+	if (session.LateSlices() > 0) {
+		std::cout << "  " << session.LateSlices()
+			<< " late poll(s) split evenly across the seconds they covered\n";
+	}
 
 	// ── Remove startup spike(s) ──────────────────────────────
 	// Even after discarding the first 3 raw samples, the earliest recorded
@@ -639,17 +585,16 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 
 		if (recheckStarted) {
 			int recheckC2Total = 0;        // Only C2 matters for this pass
-			bool recheckDone = false;
 			bool recheckStopped = false;
-			int recheckSampleIdx = 0;
-			DWORD recheckLastLBA = DWORD(-1);
 			int recheckLastLine = 0;
-			auto recheckStart = std::chrono::steady_clock::now();
 
-			// Same polling loop as the primary scan, but we only accumulate
+			// Same session setup as the primary scan, but we only accumulate
 			// C2 counts — C1 and CU from the recheck are discarded.
-			while (!recheckDone) {
+			ScanSession recheck(ScanSession::ForQualityScan(m_drive, vendor, firstLBA, lastLBA, scanSpeed));
+			recheck.Start();
+			while (recheck.Wait(slices, 100)) {
 				if (InterruptHandler::Instance().IsInterrupted() || InterruptHandler::Instance().CheckEscapeKey()) {
+					recheck.Stop();
 					if (usePlextor) m_drive.PlextorQCheckStop();
 					else if (usePioneer) m_drive.PioneerScanStop();
 					else m_drive.LiteOnScanStop();
@@ -658,70 +603,19 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 					break;
 				}
 
-				// Same async delay as the primary loop.  Only Plextor needs
-				// pacing; Pioneer and LiteOn block on their SCSI command
-				// sequence.
-				if (usePlextor)
-					std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
-				int rc1 = 0, rc2 = 0, rcu = 0;
-				DWORD rLBA = 0;
-
-				bool rpoll = usePlextor
-					? m_drive.PlextorQCheckPoll(rc1, rc2, rcu, rLBA, recheckDone)
-					: (usePioneer ? m_drive.PioneerScanPoll(rc1, rc2, rcu, rLBA, recheckDone)
-						: m_drive.LiteOnScanPoll(rc1, rc2, rcu, rLBA, recheckDone));
-
-				if (!rpoll) {
-					// Same retry logic as the primary scan — async scans
-					// (Plextor / Pioneer) get one retry on transient failure.
-					if (usePlextor || usePioneer) {
-						std::this_thread::sleep_for(std::chrono::milliseconds(200));
-						rpoll = usePlextor
-							? m_drive.PlextorQCheckPoll(rc1, rc2, rcu, rLBA, recheckDone)
-							: m_drive.PioneerScanPoll(rc1, rc2, rcu, rLBA, recheckDone);
-					}
-					if (!rpoll) {
-						if (usePlextor) m_drive.PlextorQCheckStop();
-						else if (usePioneer) m_drive.PioneerScanStop();
-						else m_drive.LiteOnScanStop();
-						recheckStopped = true;
-						std::cout << "\n  Recheck communication lost — keeping original C2 results.\n";
-						break;
-					}
-				}
-
-				// Same filtering as primary scan: skip empty / duplicate / startup samples.
-				// Pioneer tracks LBA in software starting at firstLBA, so LBA 0
-				// is a valid position — don't apply this filter for Pioneer scans.
-				if (!usePioneer && rLBA == 0 && rc1 == 0 && rc2 == 0 && rcu == 0 && !recheckDone)
-					continue;
-				if (rLBA == recheckLastLBA && !recheckDone)
-					continue;
-				recheckLastLBA = rLBA;
-
-				// Discard first 3 samples (startup artefacts).
-				if (recheckSampleIdx < 3) {
-					recheckSampleIdx++;
-					continue;
-				}
-
-				if (useLiteOn && rLBA >= lastLBA)
-					recheckDone = true;
-
-				recheckC2Total += rc2;
-				recheckSampleIdx++;
+				for (const ScanSlice& slice : slices)
+					recheckC2Total += slice.c2;
+				if (slices.empty()) continue;
+				const ScanSlice latest = slices.back();
+				slices.clear();
 
 				// ── Recheck progress bar ─────────────────────
 				double rpct = 0.0;
-				if (rLBA >= firstLBA && result.totalSectors > 0) {
-					rpct = static_cast<double>(rLBA - firstLBA) * 100.0 / result.totalSectors;
+				if (latest.lba >= firstLBA && result.totalSectors > 0) {
+					rpct = static_cast<double>(latest.lba - firstLBA) * 100.0 / result.totalSectors;
 					if (rpct > 100.0) rpct = 100.0;
 				}
-
-				auto rnow = std::chrono::steady_clock::now();
-				int rElapsed = static_cast<int>(
-					std::chrono::duration_cast<std::chrono::seconds>(rnow - recheckStart).count());
+				int rElapsed = static_cast<int>(latest.timeMs / 1000.0);
 
 				std::ostringstream rline;
 				int rfilled = static_cast<int>(rpct * BAR_WIDTH / 100.0);
@@ -740,6 +634,15 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 				std::cout << routput << std::flush;
 			}
 
+			if (!recheckStopped && recheck.GetState() == ScanSession::State::Failed) {
+				if (usePlextor) m_drive.PlextorQCheckStop();
+				else if (usePioneer) m_drive.PioneerScanStop();
+				else m_drive.LiteOnScanStop();
+				recheckStopped = true;
+				std::cout << "\n  Recheck communication lost — keeping original C2 results.\n";
+			}
+			bool recheckDone = !recheckStopped && recheck.GetState() == ScanSession::State::Done;
+
 			// ── Evaluate recheck results ─────────────────────
 			if (recheckDone) {
 				if (recheckC2Total == 0) {
@@ -781,39 +684,30 @@ bool AudioCDCopier::RunQCheckScan(const DiscInfo& disc, QCheckResult& result, in
 	}
 
 	// ── Bucket C2 / CU errors by track ───────────────────────
-	// Walk every sample and find the audio track whose LBA range contains
-	// the sample.  Aggregate C2 and CU counts per track so the report can
-	// pinpoint which track(s) hold the trouble.  Only audio tracks are
-	// considered — Q-Check skips data tracks during scanning.
+	// Aggregate C2 and CU counts per track so the report can pinpoint
+	// which track(s) hold the trouble.  Each sample is placed by the
+	// layout's LBA table; only audio tracks are in it — Q-Check skips
+	// data tracks during scanning.  Spans are in track order.
 	{
-		result.errorTracks.clear();
+		const auto& spans = layout.Spans();
+		std::vector<QCheckTrackErrors> perSpan(spans.size());
+		std::vector<BYTE> hit(spans.size(), 0);
 		for (const auto& s : result.samples) {
 			if (s.c2 == 0 && s.cu == 0) continue;
-			for (const auto& t : disc.tracks) {
-				if (!t.isAudio) continue;
-				DWORD trackStart = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-				if (s.lba >= trackStart && s.lba <= t.endLBA) {
-					auto it = std::find_if(result.errorTracks.begin(), result.errorTracks.end(),
-						[&](const QCheckTrackErrors& e) { return e.trackNumber == t.trackNumber; });
-					if (it == result.errorTracks.end()) {
-						QCheckTrackErrors entry;
-						entry.trackNumber = t.trackNumber;
-						entry.c2Count = s.c2;
-						entry.cuCount = s.cu;
-						result.errorTracks.push_back(entry);
-					}
-					else {
-						it->c2Count += s.c2;
-						it->cuCount += s.cu;
-					}
-					break;
-				}
-			}
+			const DiscLayout::Span* span = layout.SpanAt(s.lba);
+			if (!span) continue;
+			size_t idx = static_cast<size_t>(span - spans.data());
+			perSpan[idx].c2Count += s.c2;
+			perSpan[idx].cuCount += s.cu;
+			hit[idx] = 1;
+		}
+
+		result.errorTracks.clear();
+		for (size_t i = 0; i < spans.size(); i++) {
+			if (!hit[i]) continue;
+			perSpan[i].trackNumber = spans[i].trackNumber;
+			result.errorTracks.push_back(perSpan[i]);
 		}
-		std::sort(result.errorTracks.begin(), result.errorTracks.end(),
-			[](const QCheckTrackErrors& a, const QCheckTrackErrors& b) {
-				return a.trackNumber < b.trackNumber;
-			});
 	}
 
 	// ── Compute summary statistics ───────────────────────────
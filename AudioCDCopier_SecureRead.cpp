@@ -1,14 +1,17 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "AccurateRip.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include "MenuHelpers.h"
+#include "ReReadScheduler.h"
+#include "RipStream.h"
+#include "SecureSectorTable.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <algorithm>
-#include <map>
 #include <cstring>
-#include <unordered_map>
 
 // ============================================================================
 // Secure Rip Mode
@@ -25,28 +28,30 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 	if (effectiveConfig.maxSpeed > 0) {
 		m_drive.SetSpeed(effectiveConfig.maxSpeed);
 	}
+	// Size the re-read scheduler's cache window for this drive
+	if (effectiveConfig.cacheDefeat) PrepareCacheDefeat(disc);
 
-	DWORD total = 0;
-	for (size_t i = 0; i < disc.tracks.size(); i++) {
-		if (disc.selectedSession > 0 && disc.tracks[i].session != disc.selectedSession) continue;
-		DWORD start = (disc.pregapMode == PregapMode::Skip) ? disc.tracks[i].startLBA : disc.tracks[i].pregapLBA;
-		total += disc.tracks[i].endLBA - start + 1;
-	}
+	DiscLayout layout = DiscLayout::ForRip(disc);
+	DWORD total = layout.TotalSectors();
+	DWORD firstLBA = layout.FirstLBA(), lastLBA = layout.LastLBA();
 
 	result = SecureRipResult{};
 	result.totalSectors = static_cast<int>(total);
 
-	try {
-		disc.rawSectors.clear();
-		disc.rawSectors.reserve(total);
-	}
-	catch (const std::bad_alloc&) {
+	disc.rawSectors.clear();
+	if (!disc.rawSectors.Reserve(total, disc.includeSubchannel)) {
 		std::cerr << "Error: Not enough memory\n";
 		return false;
 	}
 
 	disc.errorCount = 0;
 	disc.badSectors.clear();
+	disc.accurateRipTracks.clear();
+
+	// AccurateRip CRCs are accumulated as sectors arrive; later phases
+	// retract a sector's old contribution whenever they replace its data.
+	AccurateRipStream arStream;
+	arStream.Begin(disc);
 
 	bool trustC2Clean = effectiveConfig.useC2 && effectiveConfig.c2Guided;
 
@@ -60,6 +65,7 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 	log.requiredMatches = effectiveConfig.requiredMatches;
 	log.useC2 = effectiveConfig.useC2;
 	log.cacheDefeat = effectiveConfig.cacheDefeat;
+	log.sampleVote = effectiveConfig.sampleVote && effectiveConfig.useC2;
 	log.totalSectors = static_cast<int>(total);
 
 	bool logToFile = (disc.loggingOutput == LogOutput::File || disc.loggingOutput == LogOutput::Both);
@@ -69,6 +75,7 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 		<< " passes, require " << effectiveConfig.requiredMatches << " matches\n";
 	std::cout << "  Cache defeat: " << (effectiveConfig.cacheDefeat ? "ENABLED" : "DISABLED") << "\n";
 	std::cout << "  C2-guided: " << (trustC2Clean ? "YES (fast path for clean sectors)" : "NO (all sectors verified)") << "\n";
+	std::cout << "  Sample vote: " << (log.sampleVote ? "YES (C2-weighted per-sample reconstruction)" : "NO") << "\n";
 	std::cout << "  (Press ESC or Ctrl+C to cancel)\n" << std::flush;
 
 	if (progress) progress(0, total);
@@ -78,94 +85,115 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 	// ========================================================================
 	// PHASE 1: Fast first pass — read everything, hash each sector
 	// ========================================================================
-	struct SectorState {
-		size_t index;
-		int sectorSize;
-		uint32_t hash;
-		int matchCount;
-		bool isAudio;
-		int track;
-		bool hadC2Errors;
-		bool hasValidHash;
-	};
+	using Table = SecureSectorTable;
 
 	std::vector<DWORD> rereadLBAs;
-	std::map<DWORD, SectorState> sectorStates;
+	// Store indices of rereadLBAs: a streaming writer must keep these
+	// resident for the later phases.
+	std::vector<size_t> pendingIndices;
+	Table sectorStates;
+	if (total > 0) sectorStates.Reset(firstLBA, lastLBA);
 
 	auto phase1Start = std::chrono::steady_clock::now();
 	SecureRipPhaseStats phase1Stats{ 1, 0, 0, 0, 0.0, 0.0 };
 	double phase1TotalReadTime = 0.0;
+	constexpr DWORD PHASE1_BATCH = 26;
 
 	DWORD cur = 0;
-	for (size_t i = 0; i < disc.tracks.size(); i++) {
-		auto& t = disc.tracks[i];
-		if (disc.selectedSession > 0 && t.session != disc.selectedSession) continue;
-		DWORD start = (disc.pregapMode == PregapMode::Skip) ? t.startLBA : t.pregapLBA;
+	for (const auto& span : layout.Spans()) {
+		auto& t = disc.tracks[span.trackIndex];
 		int sectorSize = (disc.includeSubchannel && t.isAudio) ? RAW_SECTOR_SIZE : AUDIO_SECTOR_SIZE;
 
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; ) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				return false;
 			}
 
-			std::vector<BYTE> sec(sectorSize, 0);
-			int c2Errors = 0;
-			bool ok = false;
+			// Read straight into the sector store — audio and subchannel
+			// land in their own planes, no per-sector allocation.  Audio is
+			// read PHASE1_BATCH sectors per READ CD; the drive layer bisects
+			// a failing batch down to the sectors that actually fail.
+			DWORD chunk = t.isAudio ? std::min<DWORD>(PHASE1_BATCH, span.lastLBA - lba + 1) : 1;
+			size_t first = disc.rawSectors.size();
+			if (!disc.rawSectors.AppendSectors(chunk, sectorSize > AUDIO_SECTOR_SIZE)) {
+				std::cerr << "\nError: Not enough memory\n";
+				return false;
+			}
+			std::vector<BYTE> sectorOk(chunk, 0);
+			std::vector<int> chunkC2(chunk, 0);
+			std::vector<BYTE> chunkC2Raw(trustC2Clean ? chunk * C2_ERROR_SIZE : 0);
 
-			auto sectorStart = std::chrono::steady_clock::now();
+			auto chunkStart = std::chrono::steady_clock::now();
 
 			if (t.isAudio && effectiveConfig.useC2) {
 				ScsiDrive::C2ReadOptions c2Opts;
 				c2Opts.countBytes = true;
-				BYTE* subPtr = (sectorSize > AUDIO_SECTOR_SIZE) ? sec.data() + AUDIO_SECTOR_SIZE : nullptr;
-				ok = m_drive.ReadSectorWithC2Ex(lba, sec.data(), subPtr, c2Errors, nullptr, c2Opts);
+				m_drive.ReadSectorsWithC2(lba, chunk, disc.rawSectors.Audio(first),
+					disc.rawSectors.Subchannel(first), trustC2Clean ? chunkC2Raw.data() : nullptr,
+					chunkC2.data(), c2Opts, sectorOk.data());
 			}
 			else if (t.isAudio) {
-				if (sectorSize > AUDIO_SECTOR_SIZE)
-					ok = m_drive.ReadSector(lba, sec.data(), sec.data() + AUDIO_SECTOR_SIZE);
-				else
-					ok = m_drive.ReadSectorAudioOnly(lba, sec.data());
+				m_drive.ReadSectors(lba, chunk, disc.rawSectors.Audio(first),
+					disc.rawSectors.Subchannel(first), sectorOk.data());
 			}
 			else {
-				ok = m_drive.ReadDataSector(lba, sec.data());
+				sectorOk[0] = m_drive.ReadDataSector(lba, disc.rawSectors.Audio(first)) ? 1 : 0;
 			}
 
+			// Per-sector time is the batch time spread evenly over its sectors.
 			double readTimeMs = std::chrono::duration<double, std::milli>(
-				std::chrono::steady_clock::now() - sectorStart).count();
-			phase1TotalReadTime += readTimeMs;
-
-			size_t idx = disc.rawSectors.size();
-			uint32_t hash = ok ? HashSector(sec.data(), AUDIO_SECTOR_SIZE) : 0;
-			disc.rawSectors.push_back(std::move(sec));
-
-			bool phase1Trusted = ok && (c2Errors == 0);
-			sectorStates[lba] = { idx, sectorSize, hash, phase1Trusted ? 1 : 0,
-				t.isAudio, t.trackNumber, (c2Errors > 0), ok };
-
-			phase1Stats.sectorsProcessed++;
+				std::chrono::steady_clock::now() - chunkStart).count() / chunk;
+
+			for (DWORD k = 0; k < chunk; k++, lba++) {
+				size_t idx = first + k;
+				BYTE* sec = disc.rawSectors.Audio(idx);
+				int c2Errors = chunkC2[k];
+				bool ok = sectorOk[k] != 0;
+				phase1TotalReadTime += readTimeMs;
+
+				SectorHash hash = ok ? HashSector(sec, AUDIO_SECTOR_SIZE) : SectorHash{};
+				if (t.isAudio) arStream.AddSector(lba, sec);
+
+				bool phase1Trusted = ok && (c2Errors == 0);
+				BYTE flags = (t.isAudio ? Table::FLAG_AUDIO : 0) |
+					(sectorSize > AUDIO_SECTOR_SIZE ? Table::FLAG_SUBCHANNEL : 0) |
+					(c2Errors > 0 ? Table::FLAG_HAD_C2 : 0) |
+					(ok ? Table::FLAG_VALID_HASH : 0);
+				sectorStates.Set(lba, idx, hash, phase1Trusted ? 1 : 0, flags, t.trackNumber);
+
+				phase1Stats.sectorsProcessed++;
+
+				bool verified = false;
+				if (!ok || c2Errors > 0) {
+					rereadLBAs.push_back(lba);
+					pendingIndices.push_back(idx);
+					log.totalC2Errors += c2Errors;
+					// C2-guided: only the flagged bytes need confirming
+					if (ok && trustC2Clean && t.isAudio) {
+						sectorStates.BeginPartial(lba, chunkC2Raw.data() + static_cast<size_t>(k) * C2_ERROR_SIZE);
+					}
+				}
+				else if (trustC2Clean || !t.isAudio) {
+					result.secureSectors++;
+					result.singlePassSectors++;
+					phase1Stats.sectorsVerified++;
+					verified = true;
+				}
+				else {
+					rereadLBAs.push_back(lba);
+					pendingIndices.push_back(idx);
+				}
 
-			bool verified = false;
-			if (!ok || c2Errors > 0) {
-				rereadLBAs.push_back(lba);
-				log.totalC2Errors += c2Errors;
-			}
-			else if (trustC2Clean || !t.isAudio) {
-				result.secureSectors++;
-				result.singlePassSectors++;
-				phase1Stats.sectorsVerified++;
-				verified = true;
-			}
-			else {
-				rereadLBAs.push_back(lba);
-			}
+				if (logToFile) {
+					log.entries.push_back({ lba, t.trackNumber, 1, 1, phase1Trusted ? 1 : 0,
+						c2Errors, readTimeMs, verified, hash.Prefix() });
+				}
 
-			if (logToFile) {
-				log.entries.push_back({ lba, t.trackNumber, 1, 1, phase1Trusted ? 1 : 0,
-					c2Errors, readTimeMs, verified, hash });
+				cur++;
+				if (progress) progress(cur, total);
 			}
 
-			cur++;
-			if (progress) progress(cur, total);
+			if (m_stream) m_stream->Advance(disc.rawSectors, disc.rawSectors.size(), pendingIndices);
 		}
 	}
 
@@ -181,6 +209,7 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 		log.totalDurationSeconds = phase1Stats.durationSeconds;
 		result.securityConfidence = 100.0;
 		result.qualityAssessment = "Excellent";
+		disc.accurateRipTracks = arStream.Results();
 		std::cout << "\n  All sectors verified — no re-reads needed\n";
 		std::cout << "\n  Secure: " << result.secureSectors << "/" << result.totalSectors
 			<< " (" << std::fixed << std::setprecision(1) << result.securityConfidence << "%)\n";
@@ -190,7 +219,7 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 	std::sort(rereadLBAs.begin(), rereadLBAs.end());
 
 	// ========================================================================
-	// PHASE 2: Sequential sweep re-reads (no per-sector cache defeat)
+	// PHASE 2: Sweep re-reads, run by run in elevator order
 	// ========================================================================
 	std::vector<DWORD> stillUnverified;
 	int maxSweeps = effectiveConfig.maxPasses - 1;
@@ -199,10 +228,19 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 	double phase2TotalReadTime = 0.0;
 	int phase2TotalProcessed = 0;
 
-	// Track consecutive C2 failures per sector to fast-track unrecoverable ones
-	std::unordered_map<DWORD, int> consecutiveC2Failures;
+	// Consecutive C2 failures per sector (Table::C2Failures) fast-track
+	// unrecoverable ones
 	std::vector<DWORD> phase3Pending;  // Fast-tracked sectors waiting for Phase 3
 
+	// Nearby unverified sectors are re-read together as runs; the head keeps
+	// sweeping in one direction, and a run is only preceded by a cache
+	// defeat when the drive could still hold it from its last read.
+	// Phase 1 read every sector, so any run near its end may still be cached.
+	ReReadScheduler scheduler(m_cacheWindowSectors);
+	scheduler.NoteLinearPass(firstLBA, lastLBA);
+	const int normalSpeed = effectiveConfig.maxSpeed > 0 ? effectiveConfig.maxSpeed : 0;
+	DWORD headLBA = lastLBA;    // Phase 1 finished at the end of the disc
+
 	for (int sweep = 0; sweep < maxSweeps && !rereadLBAs.empty(); sweep++) {
 		std::cout << "\n  Phase 2 sweep " << (sweep + 1) << "/" << maxSweeps << ": "
 			<< rereadLBAs.size() << " sectors\n";
@@ -218,102 +256,159 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 		// Reusable read buffer — avoids per-sector heap allocation
 		std::vector<BYTE> buf;
 
-		// Defeat cache at the start of every sweep so re-reads are genuine
-		if (!rereadLBAs.empty()) {
-			DefeatDriveCache(rereadLBAs.front(), disc.leadOutLBA);
-		}
-
-		for (DWORD lba : rereadLBAs) {
-			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
-				sweepProgress.Finish(false, sweepTotal);
-				return false;
+		scheduler.Rebuild(rereadLBAs);
+		for (ReReadRun* run : scheduler.NextSweep(headLBA)) {
+			if (effectiveConfig.cacheDefeat && scheduler.NeedsCacheDefeat(*run)) {
+				DefeatDriveCache(run->first, disc.leadOutLBA);
+				scheduler.NoteCacheDefeat();
 			}
+			// Only runs that keep failing pay for a slower read.
+			const bool slowRun = ReReadScheduler::ShouldSlowDown(*run);
+			if (slowRun) m_drive.SetSpeed(RETRY_SPEED_REDUCTION);
 
-			auto& state = sectorStates[lba];
-			buf.assign(state.sectorSize, 0);
+			scheduler.BeginRun(*run);
+			bool runVerified = false;
 
-			bool ok = false;
-			int c2Errors = 0;
+			for (DWORD lba : run->lbas) {
+				if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+					sweepProgress.Finish(false, sweepTotal);
+					return false;
+				}
 
-			auto sectorStart = std::chrono::steady_clock::now();
+				const int sectorSize = sectorStates.SectorSize(lba);
+				const bool isAudio = sectorStates.IsAudio(lba);
+				const size_t index = sectorStates.StoreIndex(lba);
+				const bool partial = sectorStates.HasPartial(lba);
+				buf.assign(sectorSize, 0);
 
-			if (state.isAudio && effectiveConfig.useC2) {
-				ScsiDrive::C2ReadOptions c2Opts;
-				c2Opts.countBytes = true;
-				BYTE* subPtr = (state.sectorSize > AUDIO_SECTOR_SIZE) ? buf.data() + AUDIO_SECTOR_SIZE : nullptr;
-				ok = m_drive.ReadSectorWithC2Ex(lba, buf.data(), subPtr, c2Errors, nullptr, c2Opts);
-			}
-			else if (state.isAudio) {
-				if (state.sectorSize > AUDIO_SECTOR_SIZE)
-					ok = m_drive.ReadSector(lba, buf.data(), buf.data() + AUDIO_SECTOR_SIZE);
-				else
-					ok = m_drive.ReadSectorAudioOnly(lba, buf.data());
-			}
-			else {
-				ok = m_drive.ReadDataSector(lba, buf.data());
-			}
+				bool ok = false;
+				int c2Errors = 0;
+				BYTE c2Raw[C2_ERROR_SIZE] = {};
 
-			double readTimeMs = std::chrono::duration<double, std::milli>(
-				std::chrono::steady_clock::now() - sectorStart).count();
-			phase2TotalReadTime += readTimeMs;
-			phase2TotalProcessed++;
+				auto sectorStart = std::chrono::steady_clock::now();
 
-			bool requireCleanC2 = state.hadC2Errors && effectiveConfig.useC2;
-			if (requireCleanC2 && sweep >= maxSweeps / 2) {
-				requireCleanC2 = false;
-			}
-			bool readAcceptable = ok && (!requireCleanC2 || c2Errors == 0);
+				if (isAudio && effectiveConfig.useC2) {
+					ScsiDrive::C2ReadOptions c2Opts;
+					c2Opts.countBytes = true;
+					BYTE* subPtr = (sectorSize > AUDIO_SECTOR_SIZE) ? buf.data() + AUDIO_SECTOR_SIZE : nullptr;
+					ok = m_drive.ReadSectorWithC2Ex(lba, buf.data(), subPtr, c2Errors,
+						partial ? c2Raw : nullptr, c2Opts);
+				}
+				else if (isAudio) {
+					if (sectorSize > AUDIO_SECTOR_SIZE)
+						ok = m_drive.ReadSector(lba, buf.data(), buf.data() + AUDIO_SECTOR_SIZE);
+					else
+						ok = m_drive.ReadSectorAudioOnly(lba, buf.data());
+				}
+				else {
+					ok = m_drive.ReadDataSector(lba, buf.data());
+				}
 
-			// Track consecutive C2 failures — skip to Phase 3 early
-			if (!ok || c2Errors > 0) {
-				consecutiveC2Failures[lba]++;
-			}
-			else {
-				consecutiveC2Failures[lba] = 0;
-			}
+				double readTimeMs = std::chrono::duration<double, std::milli>(
+					std::chrono::steady_clock::now() - sectorStart).count();
+				phase2TotalReadTime += readTimeMs;
+				phase2TotalProcessed++;
 
-			bool verified = false;
-			if (readAcceptable) {
-				if (c2Errors > 0) log.totalC2Errors += c2Errors;
+				bool requireCleanC2 = sectorStates.Has(lba, Table::FLAG_HAD_C2) && effectiveConfig.useC2;
+				if (requireCleanC2 && sweep >= maxSweeps / 2) {
+					requireCleanC2 = false;
+				}
+				bool readAcceptable = ok && (!requireCleanC2 || c2Errors == 0);
 
-				uint32_t sweepHash = HashSector(buf.data(), AUDIO_SECTOR_SIZE);
-				if (sweepHash == state.hash && state.hasValidHash) {
-					state.matchCount++;
+				// Track consecutive C2 failures — skip to Phase 3 early
+				uint16_t& c2Failures = sectorStates.C2Failures(lba);
+				if (!ok || c2Errors > 0) {
+					c2Failures++;
 				}
 				else {
-					state.hash = sweepHash;
-					state.hasValidHash = true;
-					state.matchCount = 1;
-					memcpy(disc.rawSectors[state.index].data(), buf.data(), state.sectorSize);
+					c2Failures = 0;
 				}
 
-				if (c2Errors == 0) state.hadC2Errors = false;
-
-				int totalPasses = sweep + 2;
-				if (state.matchCount >= effectiveConfig.requiredMatches &&
-					totalPasses >= effectiveConfig.minPasses) {
-					result.secureSectors++;
-					result.multiPassSectors++;
-					totalPhase2Verified++;
-					verified = true;
-					if (totalPasses > result.maxPassesRequired)
-						result.maxPassesRequired = totalPasses;
+				bool verified = false;
+				if (partial && ok) {
+					// Compare only the bytes the first read's C2 pointers flagged;
+					// this read's clean bytes fill them in, its flagged ones don't
+					// count.
+					if (c2Errors > 0) log.totalC2Errors += c2Errors;
+
+					BYTE* stored = disc.rawSectors.Audio(index);
+					arStream.RemoveSector(lba, stored);
+					auto merge = sectorStates.MergePartial(lba, stored, buf.data(), c2Raw,
+						effectiveConfig.requiredMatches);
+					arStream.AddSector(lba, stored);
+					if (m_stream) m_stream->Patch(disc.rawSectors, index);
+
+					sectorStates.Hash(lba) = HashSector(stored, AUDIO_SECTOR_SIZE);
+					sectorStates.MatchCount(lba) = static_cast<uint16_t>(merge.minMatches);
+
+					int totalPasses = sweep + 2;
+					if (merge.complete && totalPasses >= effectiveConfig.minPasses) {
+						result.secureSectors++;
+						result.multiPassSectors++;
+						totalPhase2Verified++;
+						verified = true;
+						if (totalPasses > result.maxPassesRequired)
+							result.maxPassesRequired = totalPasses;
+					}
+					else {
+						stillUnverified.push_back(lba);
+					}
+				}
+				else if (readAcceptable && !partial) {
+					if (c2Errors > 0) log.totalC2Errors += c2Errors;
+
+					SectorHash sweepHash = HashSector(buf.data(), AUDIO_SECTOR_SIZE);
+					SectorHash& hash = sectorStates.Hash(lba);
+					uint16_t& matchCount = sectorStates.MatchCount(lba);
+					if (sweepHash == hash && sectorStates.Has(lba, Table::FLAG_VALID_HASH)) {
+						matchCount++;
+					}
+					else {
+						hash = sweepHash;
+						sectorStates.SetFlag(lba, Table::FLAG_VALID_HASH, true);
+						matchCount = 1;
+						if (isAudio) {
+							arStream.RemoveSector(lba, disc.rawSectors.Audio(index));
+							arStream.AddSector(lba, buf.data());
+						}
+						disc.rawSectors.StoreRaw(index, buf.data(), sectorSize);
+						if (m_stream) m_stream->Patch(disc.rawSectors, index);
+					}
+
+					if (c2Errors == 0) sectorStates.SetFlag(lba, Table::FLAG_HAD_C2, false);
+
+					int totalPasses = sweep + 2;
+					if (matchCount >= effectiveConfig.requiredMatches &&
+						totalPasses >= effectiveConfig.minPasses) {
+						result.secureSectors++;
+						result.multiPassSectors++;
+						totalPhase2Verified++;
+						verified = true;
+						if (totalPasses > result.maxPassesRequired)
+							result.maxPassesRequired = totalPasses;
+					}
+					else {
+						stillUnverified.push_back(lba);
+					}
 				}
 				else {
+					if (c2Errors > 0) log.totalC2Errors += c2Errors;
 					stillUnverified.push_back(lba);
 				}
-			}
-			else {
-				if (c2Errors > 0) log.totalC2Errors += c2Errors;
-				stillUnverified.push_back(lba);
-			}
 
-			if (logToFile) {
-				log.entries.push_back({ lba, state.track, 2, sweep + 2,
-					state.matchCount, c2Errors, readTimeMs, verified, state.hash });
+				if (logToFile) {
+					log.entries.push_back({ lba, sectorStates.Track(lba), 2, sweep + 2,
+						sectorStates.MatchCount(lba), c2Errors, readTimeMs, verified, sectorStates.Hash(lba).Prefix() });
+				}
+
+				if (verified) runVerified = true;
+				sweepProgress.Update(++sweepCur, sweepTotal);
 			}
 
-			sweepProgress.Update(++sweepCur, sweepTotal);
+			scheduler.NoteRead(static_cast<DWORD>(run->lbas.size()));
+			ReReadScheduler::NoteSweep(*run, runVerified);
+			if (slowRun) m_drive.SetSpeed(normalSpeed);
+			headLBA = run->last;
 		}
 
 		sweepProgress.Finish(true, sweepTotal);
@@ -326,7 +421,7 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 		if (sweep >= MAX_CONSECUTIVE_SWEEP_FAILURES - 1) {
 			std::vector<DWORD> worthRetrying;
 			for (DWORD lba : rereadLBAs) {
-				if (consecutiveC2Failures[lba] >= MAX_CONSECUTIVE_SWEEP_FAILURES) {
+				if (sectorStates.C2Failures(lba) >= MAX_CONSECUTIVE_SWEEP_FAILURES) {
 					phase3Pending.push_back(lba);
 				}
 				else {
@@ -364,53 +459,119 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 
 		int phase3Total = static_cast<int>(rereadLBAs.size());
 		int phase3Cur = 0;
-
-		for (DWORD lba : rereadLBAs) {
-			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
-				phase3Progress.Finish(false, phase3Total);
-				return false;
+		BYTE secBuf[RAW_SECTOR_SIZE];
+
+		// Each pass reads every sector of a short run before the next pass,
+		// so one cache defeat (when needed at all) covers the whole run
+		// rather than every pass of every sector.
+		constexpr DWORD MAX_RESCUE_RUN = 16;
+		scheduler.SetMaxRunLength(MAX_RESCUE_RUN);
+		scheduler.Rebuild(rereadLBAs);
+		std::vector<SectorRescue> rescues(MAX_RESCUE_RUN);
+
+		for (ReReadRun* run : scheduler.NextSweep(headLBA)) {
+			const size_t runSize = run->lbas.size();
+			for (size_t k = 0; k < runSize; k++) {
+				DWORD lba = run->lbas[k];
+				const int sectorSize = sectorStates.SectorSize(lba);
+				memset(secBuf, 0, sizeof(secBuf));
+				disc.rawSectors.LoadRaw(sectorStates.StoreIndex(lba), secBuf, sectorSize);
+				BeginSectorRescue(rescues[k], lba, secBuf, sectorSize, sectorStates.IsAudio(lba));
 			}
 
-			auto& state = sectorStates[lba];
+			auto runStart = std::chrono::steady_clock::now();
+			bool slowRun = false;
 
-			auto sectorStart = std::chrono::steady_clock::now();
+			for (int pass = 0; pass < effectiveConfig.maxPasses; pass++) {
+				if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+					if (slowRun) m_drive.SetSpeed(normalSpeed);
+					phase3Progress.Finish(false, phase3Total);
+					return false;
+				}
 
-			SecureSectorResult secResult;
-			bool ok = ReadSectorSecure(lba, disc.rawSectors[state.index].data(),
-				state.sectorSize, state.isAudio, effectiveConfig, secResult,
-				disc.leadOutLBA);
+				DWORD pending = 0;
+				bool anyAccepted = false;
+				for (size_t k = 0; k < runSize; k++) {
+					if (!rescues[k].finished) pending++;
+					if (rescues[k].ok) anyAccepted = true;
+				}
+				if (pending == 0) break;
+
+				if (effectiveConfig.cacheDefeat && scheduler.NeedsCacheDefeat(*run)) {
+					DefeatDriveCache(run->first, disc.leadOutLBA);
+					scheduler.NoteCacheDefeat();
+					for (size_t k = 0; k < runSize; k++) {
+						if (!rescues[k].finished) rescues[k].result.usedCacheDefeat = true;
+					}
+				}
+				// Half the passes without a single accepted sector — read the
+				// rest of this run slowly.
+				if (!slowRun && !anyAccepted && pass >= effectiveConfig.maxPasses / 2) {
+					m_drive.SetSpeed(RETRY_SPEED_REDUCTION);
+					slowRun = true;
+				}
 
-			double readTimeMs = std::chrono::duration<double, std::milli>(
-				std::chrono::steady_clock::now() - sectorStart).count();
-			phase3TotalReadTime += readTimeMs;
-			phase3Stats.sectorsProcessed++;
-
-			if (secResult.isSecure) {
-				result.secureSectors++;
-				result.multiPassSectors++;
-				phase3Stats.sectorsVerified++;
-			}
-			else {
-				result.unsecureSectors++;
-				result.problemSectors.push_back(secResult);
-				phase3Stats.sectorsFailed++;
+				scheduler.BeginRun(*run);
+				for (size_t k = 0; k < runSize; k++) {
+					SectorRescuePass(rescues[k], effectiveConfig, pass);
+				}
+				scheduler.NoteRead(pending);
 			}
+			if (slowRun) m_drive.SetSpeed(normalSpeed);
 
-			if (!ok) {
-				disc.errorCount++;
-				disc.badSectors.push_back(lba);
-			}
+			double readTimeMs = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - runStart).count() / runSize;
+
+			for (size_t k = 0; k < runSize; k++) {
+				SectorRescue& rescue = rescues[k];
+				FinishSectorRescue(rescue, effectiveConfig);
+
+				const DWORD lba = rescue.lba;
+				const size_t index = sectorStates.StoreIndex(lba);
+				const SecureSectorResult& secResult = rescue.result;
+				if (rescue.ok) {
+					if (rescue.isAudio) {
+						arStream.RemoveSector(lba, disc.rawSectors.Audio(index));
+						arStream.AddSector(lba, rescue.data);
+					}
+					disc.rawSectors.StoreRaw(index, rescue.data, rescue.sectorSize);
+					if (m_stream) m_stream->Patch(disc.rawSectors, index);
+				}
 
-			if (secResult.passesRequired > result.maxPassesRequired)
-				result.maxPassesRequired = secResult.passesRequired;
+				phase3TotalReadTime += readTimeMs;
+				phase3Stats.sectorsProcessed++;
 
-			if (logToFile) {
-				log.entries.push_back({ lba, state.track, 3, secResult.totalPasses,
-					secResult.matchingPasses, secResult.c2ErrorPasses,
-					readTimeMs, secResult.isSecure, secResult.finalHash });
-			}
+				if (secResult.isSecure) {
+					result.secureSectors++;
+					result.multiPassSectors++;
+					phase3Stats.sectorsVerified++;
+				}
+				else {
+					result.unsecureSectors++;
+					result.problemSectors.push_back(secResult);
+					phase3Stats.sectorsFailed++;
+				}
+
+				if (!rescue.ok) {
+					disc.errorCount++;
+					disc.badSectors.push_back(lba);
+				}
 
-			phase3Progress.Update(++phase3Cur, phase3Total);
+				if (secResult.passesRequired > result.maxPassesRequired)
+					result.maxPassesRequired = secResult.passesRequired;
+
+				if (logToFile) {
+					log.entries.push_back({ lba, sectorStates.Track(lba), 3, secResult.totalPasses,
+						secResult.matchingPasses, secResult.c2ErrorPasses,
+						readTimeMs, secResult.isSecure, secResult.finalHash,
+						secResult.contestedSamples, secResult.minSampleConfidence });
+					log.sampleVotes.insert(log.sampleVotes.end(),
+						secResult.sampleConfidence.begin(), secResult.sampleConfidence.end());
+				}
+
+				phase3Progress.Update(++phase3Cur, phase3Total);
+			}
+			headLBA = run->last;
 		}
 
 		phase3Stats.durationSeconds = std::chrono::duration<double>(
@@ -422,6 +583,11 @@ bool AudioCDCopier::ReadDiscSecure(DiscInfo& disc, const SecureRipConfig& config
 		phase3Progress.Finish(true, phase3Total);
 	}
 
+	// Runs were visited in elevator order
+	std::sort(disc.badSectors.begin(), disc.badSectors.end());
+
+	disc.accurateRipTracks = arStream.Results();
+
 	log.totalVerified = result.secureSectors;
 	log.totalUnsecure = result.unsecureSectors;
 	log.totalDurationSeconds = std::chrono::duration<double>(
@@ -1,5 +1,6 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include <iostream>
 #include <iomanip>
@@ -16,18 +17,9 @@ bool AudioCDCopier::RunSeekTimeAnalysis(DiscInfo& disc, std::vector<SeekTimeResu
 	std::cout << "\n=== Seek Time Analysis ===\n";
 	results.clear();
 
-	// Build a list of contiguous audio LBA ranges from the TOC so that
-	// seek tests only target readable audio sectors (skipping data tracks).
-	std::vector<std::pair<DWORD, DWORD>> audioRanges;
-	DWORD totalSectors = 0;
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		// Track 1 may have a hidden pre-gap starting at LBA 0; every other
-		// track's audio begins at its pregapLBA.
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		audioRanges.push_back({ start, t.endLBA });
-		totalSectors += t.endLBA - start + 1;
-	}
+	// Seek tests only target readable audio sectors (skipping data tracks).
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to analyze.\n";
@@ -45,19 +37,7 @@ bool AudioCDCopier::RunSeekTimeAnalysis(DiscInfo& disc, std::vector<SeekTimeResu
 	// audio content even when audio ranges are non-contiguous (e.g. an
 	// Enhanced CD with a data track in the middle).
 	auto mapToAudioLBA = [&](double fraction) -> DWORD {
-		DWORD target = static_cast<DWORD>(totalSectors * fraction);
-		DWORD cumulative = 0;
-		for (const auto& [start, end] : audioRanges) {
-			DWORD rangeLen = end - start + 1;
-			// If the target offset falls within this audio range,
-			// return the exact LBA inside it.
-			if (cumulative + rangeLen > target) {
-				return start + (target - cumulative);
-			}
-			cumulative += rangeLen;
-		}
-		// Clamp to the last audio sector if rounding pushes us past the end.
-		return audioRanges.back().second;
+		return layout.LBAAt(static_cast<DWORD>(totalSectors * fraction));
 		};
 
 	// 11 evenly-spaced positions give 110 directional seek pairs (11×10),
@@ -123,11 +103,11 @@ bool AudioCDCopier::RunSeekTimeAnalysis(DiscInfo& disc, std::vector<SeekTimeResu
 				// Force the head to physically move to fromLBA by defeating
 				// the drive's read-ahead cache, then read that sector so
 				// the head is genuinely positioned there.
-				DefeatDriveCache(fromLBA, audioRanges.back().second);
+				DefeatDriveCache(fromLBA, layout.LastLBA());
 				m_drive.ReadSectorAudioOnly(fromLBA, buf.data());
 				// Also defeat the cache around the destination so the
 				// subsequent seek can't be satisfied from the buffer.
-				DefeatDriveCache(toLBA, audioRanges.back().second);
+				DefeatDriveCache(toLBA, layout.LastLBA());
 
 				// Time only the seek command itself (no data transfer).
 				auto startTime = std::chrono::high_resolution_clock::now();
@@ -1,5 +1,6 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include <iostream>
 #include <iomanip>
@@ -17,67 +18,27 @@ bool AudioCDCopier::RunSpeedComparisonTest(DiscInfo& disc, std::vector<SpeedComp
 		return false;
 	}
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 	if (totalSectors == 0) return false;
 
 	int sampleInterval = std::max(1, static_cast<int>(totalSectors / 100));
-	int totalSamples = std::max(1, static_cast<int>(totalSectors / sampleInterval) + 1);
-	results.clear();
-	int tested = 0;
+	std::vector<std::pair<DWORD, DWORD>> samples;
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba += sampleInterval) {
+			samples.push_back({ lba, span.lastLBA });
+		}
+	}
 
-	std::cout << "Testing ~" << totalSamples << " sample sectors at 4x vs 24x...\n";
+	std::cout << "Testing ~" << samples.size() << " sample sectors at 4x vs 24x...\n";
 	std::cout << "  (Press ESC or Ctrl+C to cancel)\n\n";
 
-	ProgressIndicator progress(40);
-	progress.SetLabel("  Speed Test");
-	progress.Start();
-
-	std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
-
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		for (DWORD lba = start; lba <= t.endLBA; lba += sampleInterval) {
-			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
-				std::cout << "\n\n*** Test cancelled by user ***\n";
-				m_drive.SetSpeed(0);
-				progress.Finish(false);
-				return false;
-			}
-
-			SpeedComparisonResult r = { lba, 0, 0, false };
-			bool lowOk = false, highOk = false;
-
-			DefeatDriveCache(lba, t.endLBA);
-
-			m_drive.SetSpeed(4);
-			Sleep(100);
-			lowOk = m_drive.ReadSectorWithC2(lba, buf.data(), nullptr, r.lowSpeedC2);
-
-			DefeatDriveCache(lba, t.endLBA);
-
-			m_drive.SetSpeed(24);
-			Sleep(100);
-			highOk = m_drive.ReadSectorWithC2(lba, buf.data(), nullptr, r.highSpeedC2);
-
-			if (!lowOk) r.lowSpeedC2 = -1;
-			if (!highOk) r.highSpeedC2 = -1;
-
-			// Improved inconsistency detection: more sensitive to small error counts
-			r.inconsistent =
-				(!lowOk || !highOk) ||
-				(r.lowSpeedC2 == 0 && r.highSpeedC2 > 0) ||
-				(r.highSpeedC2 == 0 && r.lowSpeedC2 > 0) ||
-				(r.highSpeedC2 > 0 && r.highSpeedC2 > r.lowSpeedC2 * 2) ||
-				(r.lowSpeedC2 > 0 && r.lowSpeedC2 > r.highSpeedC2 * 2);
-
-			if (r.lowSpeedC2 != 0 || r.highSpeedC2 != 0) results.push_back(r);
-			tested++;
-			progress.Update(tested, totalSamples);
-		}
+	if (!CompareSpeedsAtSamples(samples, results)) {
+		std::cout << "\n\n*** Test cancelled by user ***\n";
+		return false;
 	}
-	progress.Finish(true); m_drive.SetSpeed(0);
 	m_drive.SpinDown();
+	int tested = static_cast<int>(samples.size());
 
 	int lowSpeedErrors = 0, highSpeedErrors = 0, inconsistentCount = 0;
 	int lowFailures = 0, highFailures = 0;
@@ -150,4 +111,66 @@ bool AudioCDCopier::RunSpeedComparisonTest(DiscInfo& disc, std::vector<SpeedComp
 	std::cout << std::string(60, '=') << "\n";
 
 	return true;
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// CompareSpeedsAtSamples - C2 at 4x, then 24x, for each sample
+//
+// All samples are read at one speed before the drive is switched to the
+// other, so a run costs two speed changes instead of two per sample.  Each
+// read is preceded by a cache defeat so both speeds read from the disc.
+// Only samples with C2 or a failed read at either speed are kept.
+// ============================================================================
+bool AudioCDCopier::CompareSpeedsAtSamples(const std::vector<std::pair<DWORD, DWORD>>& samples,
+	std::vector<SpeedComparisonResult>& results) {
+	results.clear();
+	if (samples.empty()) return true;
+
+	constexpr int LOW_SPEED = 4;
+	constexpr int HIGH_SPEED = 24;
+
+	std::vector<int> lowC2(samples.size(), 0), highC2(samples.size(), 0);
+	std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
+	int total = static_cast<int>(samples.size()) * 2;
+	int done = 0;
+
+	ProgressIndicator progress(40);
+	progress.SetLabel("  Speed Test");
+	progress.Start();
+
+	for (int speed : { LOW_SPEED, HIGH_SPEED }) {
+		std::vector<int>& c2 = (speed == LOW_SPEED) ? lowC2 : highC2;
+		m_drive.SetSpeed(speed);
+		Sleep(100);
+
+		for (size_t i = 0; i < samples.size(); i++) {
+			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
+				m_drive.SetSpeed(0);
+				progress.Finish(false);
+				return false;
+			}
+
+			DefeatDriveCache(samples[i].first, samples[i].second);
+			if (!m_drive.ReadSectorWithC2(samples[i].first, buf.data(), nullptr, c2[i])) c2[i] = -1;
+			progress.Update(++done, total);
+		}
+	}
+	progress.Finish(true);
+	m_drive.SetSpeed(0);
+
+	for (size_t i = 0; i < samples.size(); i++) {
+		SpeedComparisonResult r = { samples[i].first, lowC2[i], highC2[i], false };
+		bool lowOk = r.lowSpeedC2 >= 0, highOk = r.highSpeedC2 >= 0;
+
+		// Improved inconsistency detection: more sensitive to small error counts
+		r.inconsistent =
+			(!lowOk || !highOk) ||
+			(r.lowSpeedC2 == 0 && r.highSpeedC2 > 0) ||
+			(r.highSpeedC2 == 0 && r.lowSpeedC2 > 0) ||
+			(r.highSpeedC2 > 0 && r.highSpeedC2 > r.lowSpeedC2 * 2) ||
+			(r.lowSpeedC2 > 0 && r.lowSpeedC2 > r.highSpeedC2 * 2);
+
+		if (r.lowSpeedC2 != 0 || r.highSpeedC2 != 0) results.push_back(r);
+	}
+	return true;
+}
@@ -1,6 +1,8 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
+#include "RipStream.h"
 #include <iostream>
 #include <conio.h>
 #include <chrono>
@@ -10,31 +12,11 @@
 // ============================================================================
 
 bool AudioCDCopier::ReadDisc(DiscInfo& disc, int errorMode, std::function<void(int, int)> progress) {
-	DWORD total = 0;
-	for (size_t i = 0; i < disc.tracks.size(); i++) {
-		if (disc.selectedSession > 0 && disc.tracks[i].session != disc.selectedSession) continue;
+	DiscLayout layout = DiscLayout::ForRip(disc);
+	DWORD total = layout.TotalSectors();
 
-		DWORD start;
-		if (disc.pregapMode == PregapMode::Skip) {
-			start = disc.tracks[i].startLBA;
-		}
-		else {
-			start = disc.tracks[i].pregapLBA;
-		}
-
-		DWORD count = disc.tracks[i].endLBA - start + 1;
-		if (total > UINT32_MAX - count) {
-			std::cerr << "Error: Disc too large\n";
-			return false;
-		}
-		total += count;
-	}
-
-	try {
-		disc.rawSectors.clear();
-		disc.rawSectors.reserve(total);
-	}
-	catch (const std::bad_alloc&) {
+	disc.rawSectors.clear();
+	if (!disc.rawSectors.Reserve(total, disc.includeSubchannel)) {
 		std::cerr << "Error: Not enough memory for " << total << " sectors\n";
 		return false;
 	}
@@ -44,31 +26,24 @@ bool AudioCDCopier::ReadDisc(DiscInfo& disc, int errorMode, std::function<void(i
 	disc.readLog.clear();
 	if (disc.loggingOutput != LogOutput::None) disc.readLog.reserve(total);
 
+	if (disc.enableCacheDefeat) PrepareCacheDefeat(disc);
 	std::cout << "  (Press ESC or Ctrl+C to cancel)\n" << std::flush;
 
 	if (progress) progress(0, total);
 
 	DWORD cur = 0;
+	DWORD lastDefeat = 0;
 	int totalRetries = 0;
+	const DWORD defeatInterval = CacheDefeatInterval();
 
-	for (size_t i = 0; i < disc.tracks.size(); i++) {
-		auto& t = disc.tracks[i];
-		if (disc.selectedSession > 0 && t.session != disc.selectedSession) continue;
-
-		DWORD start;
-		if (disc.pregapMode == PregapMode::Skip) {
-			start = t.startLBA;
-		}
-		else {
-			start = t.pregapLBA;
-		}
-
+	for (const auto& span : layout.Spans()) {
+		auto& t = disc.tracks[span.trackIndex];
 		int sectorSize = (disc.includeSubchannel && t.isAudio) ? RAW_SECTOR_SIZE : AUDIO_SECTOR_SIZE;
 
 		// Allocate once outside the sector loop
 		std::vector<BYTE> sec(sectorSize, 0);
 
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				g_interrupt.SetInterrupted(true);
 				std::cout << "\n\n*** Read cancelled ***\n";
@@ -76,12 +51,11 @@ bool AudioCDCopier::ReadDisc(DiscInfo& disc, int errorMode, std::function<void(i
 				return false;
 			}
 
-			// Defeat cache every N sectors instead of every sector.
-			// Drive caches are typically 0.5-8 MB (~256-4096 sectors).
-			// Defeating every ~20 sectors balances accuracy vs. speed.
-			constexpr DWORD CACHE_DEFEAT_INTERVAL = 20;
-			if (disc.enableCacheDefeat && cur > 0 && (cur % CACHE_DEFEAT_INTERVAL) == 0) {
+			// Defeat cache every N sectors instead of every sector — the
+			// measured cache size when known, otherwise a fixed ~20.
+			if (disc.enableCacheDefeat && defeatInterval > 0 && cur - lastDefeat >= defeatInterval) {
 				DefeatDriveCache(lba, disc.leadOutLBA);
+				lastDefeat = cur;
 			}
 
 			std::fill(sec.begin(), sec.end(), 0);
@@ -113,9 +87,13 @@ bool AudioCDCopier::ReadDisc(DiscInfo& disc, int errorMode, std::function<void(i
 				disc.readLog.emplace_back(lba, t.trackNumber, sectorTime);
 			}
 
-			disc.rawSectors.push_back(sec);
+			if (!disc.rawSectors.AppendRaw(sec.data(), sec.size())) {
+				std::cerr << "\nError: Not enough memory\n";
+				return false;
+			}
 			cur++;
 			if (progress && (cur & 63) == 0) progress(cur, total);
+			if (m_stream && (cur & 63) == 0) m_stream->Advance(disc.rawSectors, disc.rawSectors.size());
 		}
 	}
 
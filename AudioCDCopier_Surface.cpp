@@ -1,5 +1,6 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include <iostream>
 #include <fstream>
@@ -124,7 +125,8 @@ void AudioCDCopier::GenerateSurfaceMap(DiscInfo& disc, const std::wstring& filen
 	std::cout << "\n=== Generating Disc Surface Map ===\n";
 	m_drive.SetSpeed(scanSpeed);
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to scan.\n";
@@ -162,19 +164,9 @@ void AudioCDCopier::GenerateSurfaceMap(DiscInfo& disc, const std::wstring& filen
 	int errorSectors = 0;
 	bool headerWritten = false;
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-
-		// Calculate range: for Track 1, start at LBA 0; for others, include pregap
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-
-		// Verify track boundaries are valid
-		if (start > t.endLBA) {
-			std::cout << "WARNING: Track " << t.trackNumber << " has invalid boundaries (start > end).\n";
-			continue;
-		}
-
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
+	// Tracks with inverted boundaries are left out of the layout.
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				if (mapFile.is_open()) mapFile.flush();
 				m_drive.SetSpeed(0);
@@ -199,7 +191,7 @@ void AudioCDCopier::GenerateSurfaceMap(DiscInfo& disc, const std::wstring& filen
 					headerWritten = true;
 				}
 
-				const char* region = (lba < t.startLBA) ? "PREGAP" : "AUDIO";
+				const char* region = (lba < span.indexLBA) ? "PREGAP" : "AUDIO";
 
 				// Convert LBA to MM:SS:FF (75 frames per second)
 				DWORD absLba = lba + 150; // adjust for 2-second offset
@@ -216,7 +208,7 @@ void AudioCDCopier::GenerateSurfaceMap(DiscInfo& disc, const std::wstring& filen
 				}
 
 				mapFile << lba << ","
-					<< t.trackNumber << ","
+					<< span.trackNumber << ","
 					<< region << ","
 					<< std::setfill('0') << std::setw(2) << mm << ":"
 					<< std::setw(2) << ss << ":"
@@ -10,39 +10,119 @@
 // ============================================================================
 
 bool AudioCDCopier::DefeatDriveCache(DWORD currentLBA, DWORD maxLBA) {
-	constexpr DWORD CACHE_DEFEAT_DISTANCE = 750;
+	// A drive that was measured not to cache audio has nothing to defeat.
+	if (m_cacheProfile.NoAudioCache()) return true;
 
-	DWORD farLBA;
+	// With a measured cache size: read one sector (when a far read empties
+	// the cache) or a whole cache's worth, far enough away that neither that
+	// span nor its read-ahead reaches currentLBA.  Otherwise seek away.
+	const bool sized = m_cacheProfile.Sized();
+	DWORD span = 1;
+	DWORD distance = SeekDefeatDistance();
+	if (sized) {
+		span = m_cacheProfile.farReadEvicts ? 1 : m_cacheProfile.cacheSectors;
+		distance = span + m_cacheProfile.readAheadSectors + CACHE_DEFEAT_MARGIN;
+	}
 
-	if (currentLBA > CACHE_DEFEAT_DISTANCE) {
-		farLBA = currentLBA - CACHE_DEFEAT_DISTANCE;
+	DWORD farLBA;
+	if (currentLBA > distance) {
+		farLBA = currentLBA - distance;
 	}
-	else if (maxLBA > 0 && currentLBA + CACHE_DEFEAT_DISTANCE * 2 < maxLBA) {
-		farLBA = currentLBA + CACHE_DEFEAT_DISTANCE;
+	else if (maxLBA > 0 && currentLBA + distance * 2 < maxLBA) {
+		farLBA = currentLBA + distance;
 	}
 	else {
-		// currentLBA <= CACHE_DEFEAT_DISTANCE here, so jump forward
-		farLBA = currentLBA + CACHE_DEFEAT_DISTANCE;
-		if (maxLBA > 0 && farLBA >= maxLBA) {
-			farLBA = maxLBA > CACHE_DEFEAT_DISTANCE ? maxLBA - CACHE_DEFEAT_DISTANCE : 0;
+		// currentLBA <= distance here, so jump forward
+		farLBA = currentLBA + distance;
+		if (maxLBA > 0 && farLBA + span >= maxLBA) {
+			farLBA = maxLBA > distance ? maxLBA - distance : 0;
 		}
 	}
 
-	if (m_drive.SeekToLBA(farLBA)) {
-		return true;
+	if (!sized) {
+		if (m_drive.SeekToLBA(farLBA)) {
+			return true;
+		}
+
+		std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
+		return m_drive.ReadSectorAudioOnly(farLBA, buf.data());
 	}
 
-	std::vector<BYTE> buf(AUDIO_SECTOR_SIZE);
-	return m_drive.ReadSectorAudioOnly(farLBA, buf.data());
+	constexpr DWORD BATCH_SECTORS = 32;
+	std::vector<BYTE> buf(static_cast<size_t>(BATCH_SECTORS) * AUDIO_SECTOR_SIZE);
+	bool ok = true;
+	for (DWORD done = 0; done < span; done += BATCH_SECTORS) {
+		DWORD n = std::min(BATCH_SECTORS, span - done);
+		if (!m_drive.ReadSectorsAudioOnly(farLBA + done, n, buf.data())) ok = false;
+	}
+	return ok;
 }
 
-uint32_t AudioCDCopier::HashSector(const BYTE* data, int size) {
-	uint32_t hash = 2166136261u;
-	for (int i = 0; i < size; i++) {
-		hash ^= data[i];
-		hash *= 16777619u;
+void AudioCDCopier::PrepareCacheDefeat(const DiscInfo& disc) {
+	// Probe over the longest stretch of consecutive audio tracks.
+	DWORD bestFirst = 0, bestLast = 0;
+	DWORD runFirst = 0, runLast = 0;
+	bool inRun = false;
+	for (const auto& t : disc.tracks) {
+		if (!t.isAudio || (disc.selectedSession > 0 && t.session != disc.selectedSession)) {
+			inRun = false;
+			continue;
+		}
+		if (!inRun) runFirst = t.startLBA;
+		runLast = t.endLBA;
+		inRun = true;
+		if (runLast - runFirst > bestLast - bestFirst) {
+			bestFirst = runFirst;
+			bestLast = runLast;
+		}
+	}
+
+	// Start from the defaults so a failed probe doesn't leave an earlier
+	// disc's (or drive's) profile in force.
+	m_cacheProfile = DriveCacheProfile{};
+	m_cacheWindowSectors = CACHE_DEFEAT_DISTANCE;
+
+	std::cout << "  Drive cache: " << std::flush;
+	DriveCacheProfile profile;
+	if (!m_drive.GetCacheProfile(bestFirst, bestLast, profile)) {
+		std::cout << "not measured (disc too short or read failed) - fixed defeat distance\n";
+		return;
+	}
+
+	m_cacheProfile = profile;
+	if (profile.NoAudioCache()) {
+		m_cacheWindowSectors = 0;
+		std::cout << "no audio caching - cache defeat not needed\n";
+	}
+	else if (profile.Sized()) {
+		m_cacheWindowSectors = profile.cacheSectors + profile.readAheadSectors;
+		std::cout << profile.cacheSectors << " sectors, " << profile.readAheadSectors
+			<< " read-ahead" << (profile.farReadEvicts ? ", emptied by any far read" : "") << "\n";
 	}
-	return hash;
+	else {
+		m_cacheWindowSectors = SeekDefeatDistance();
+		std::cout << "size unknown";
+		if (profile.cacheSectors > 0) std::cout << " (over " << profile.cacheSectors << " sectors)";
+		std::cout << ", " << profile.readAheadSectors << " read-ahead - seek defeat every "
+			<< CACHE_DEFEAT_INTERVAL << " sectors\n";
+	}
+}
+
+DWORD AudioCDCopier::CacheDefeatInterval() const {
+	if (m_cacheProfile.NoAudioCache()) return 0;
+	// The fixed interval assumed a small cache; with the size known, one
+	// defeat per cache-full bounds how much can come from the buffer.
+	// Unknown sizes keep the fixed interval.
+	return m_cacheProfile.Sized() ? m_cacheProfile.cacheSectors : CACHE_DEFEAT_INTERVAL;
+}
+
+DWORD AudioCDCopier::SeekDefeatDistance() const {
+	// Past any measured read-ahead, and never nearer than the fixed distance.
+	return std::max(CACHE_DEFEAT_DISTANCE, m_cacheProfile.readAheadSectors + CACHE_DEFEAT_MARGIN);
+}
+
+SectorHash AudioCDCopier::HashSector(const BYTE* data, int size) {
+	return SectorHash::Compute(data, static_cast<size_t>(size));
 }
 
 void AudioCDCopier::ApplyOffsetCorrection(DiscInfo& disc) {
@@ -57,26 +137,7 @@ void AudioCDCopier::ApplyOffsetCorrection(DiscInfo& disc) {
 		return;
 	}
 
-	std::vector<BYTE> allAudio;
-	allAudio.reserve(disc.rawSectors.size() * AUDIO_SECTOR_SIZE);
-
-	for (auto& sec : disc.rawSectors)
-		allAudio.insert(allAudio.end(), sec.begin(), sec.begin() + AUDIO_SECTOR_SIZE);
-
-	std::vector<BYTE> corrected;
-	if (byteOffset > 0) {
-		corrected.assign(allAudio.begin() + static_cast<size_t>(byteOffset), allAudio.end());
-		corrected.resize(allAudio.size(), 0);
-	}
-	else {
-		corrected.resize(static_cast<size_t>(-byteOffset), 0);
-		corrected.insert(corrected.end(), allAudio.begin(), allAudio.end() + byteOffset);
-	}
-
-	size_t pos = 0;
-	for (auto& sec : disc.rawSectors) {
-		if (pos + AUDIO_SECTOR_SIZE <= corrected.size())
-			memcpy(sec.data(), &corrected[pos], AUDIO_SECTOR_SIZE);
-		pos += AUDIO_SECTOR_SIZE;
-	}
+	// The audio plane is one contiguous buffer, so the shift is a single
+	// in-place move — no flattened copy of the whole disc.
+	ApplySampleOffset(disc.rawSectors, disc.driveOffset);
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 ﻿#define NOMINMAX
 #include "AudioCDCopier.h"
+#include "Crc32.h"
+#include "DiscLayout.h"
 #include "InterruptHandler.h"
 #include "MenuHelpers.h"
+#include "SampleShifter.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
@@ -23,7 +26,8 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 
 	m_drive.SetSpeed(scanSpeed);
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to verify.\n";
 		return false;
@@ -33,12 +37,8 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 
 	// Count expected samples accurately (sampling restarts per track)
 	int totalSamples = 0;
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		if (t.endLBA < start) continue; // guard malformed track bounds
-		DWORD trackSectors = t.endLBA - start + 1;
-		totalSamples += static_cast<int>((trackSectors + sampleInterval - 1) / sampleInterval);
+	for (const auto& span : layout.Spans()) {
+		totalSamples += static_cast<int>((span.Count() + sampleInterval - 1) / sampleInterval);
 	}
 	totalSamples = std::max(1, totalSamples);
 
@@ -52,14 +52,10 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 	progress.Start();
 
 	std::vector<std::vector<BYTE>> reads(passes, std::vector<BYTE>(AUDIO_SECTOR_SIZE));
-	std::vector<uint32_t> hashes(passes);
+	std::vector<SectorHash> hashes(passes);
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
-		if (t.endLBA < start) continue; // guard malformed track bounds
-
-		for (DWORD lba = start; lba <= t.endLBA; lba += sampleInterval) {
+	for (const auto& span : layout.Spans()) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba += sampleInterval) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				std::cout << "\n\n*** Verification cancelled by user ***\n";
 				m_drive.SetSpeed(0);
@@ -71,7 +67,7 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 
 			for (int i = 0; i < passes; i++) {
 				if (i > 0 && !m_hasAccurateStream) {
-					DefeatDriveCache(lba, t.endLBA);
+					DefeatDriveCache(lba, span.lastLBA);
 				}
 
 				if (!m_drive.ReadSectorAudioOnly(lba, reads[i].data())) {
@@ -96,19 +92,22 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 				continue;
 			}
 
-			std::unordered_map<uint32_t, int> counts;
-			counts.reserve(static_cast<size_t>(passes));
-			for (int i = 0; i < passes; i++) {
-				counts[hashes[i]]++;
-			}
-
-			int distinctCount = static_cast<int>(counts.size());
-			uint32_t majorityHash = 0;
+			// Only a handful of passes — tally agreement directly.
+			int distinctCount = 0;
+			SectorHash majorityHash;
 			int maxCount = 0;
-			for (const auto& kv : counts) {
-				if (kv.second > maxCount) {
-					maxCount = kv.second;
-					majorityHash = kv.first;
+			for (int i = 0; i < passes; i++) {
+				bool seen = false;
+				for (int j = 0; j < i && !seen; j++) seen = (hashes[j] == hashes[i]);
+				if (seen) continue;
+				distinctCount++;
+				int count = 0;
+				for (int j = i; j < passes; j++) {
+					if (hashes[j] == hashes[i]) count++;
+				}
+				if (count > maxCount) {
+					maxCount = count;
+					majorityHash = hashes[i];
 				}
 			}
 
@@ -137,7 +136,7 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 			r.passesMatched = matchCount;
 			r.totalPasses = passes;
 			r.allMatch = allMatch;
-			r.majorityHash = majorityHash;
+			r.majorityHash = majorityHash.Prefix();
 
 			if (allMatch) {
 				perfectMatches++;
@@ -198,13 +197,8 @@ bool AudioCDCopier::RunMultiPassVerification(DiscInfo& disc, std::vector<MultiPa
 	return true;
 }
 
-uint32_t AudioCDCopier::CalculateSectorHash(const BYTE* data) {
-	uint32_t hash = 2166136261u;
-	for (int i = 0; i < AUDIO_SECTOR_SIZE; i++) {
-		hash ^= data[i];
-		hash *= 16777619u;
-	}
-	return hash;
+SectorHash AudioCDCopier::CalculateSectorHash(const BYTE* data) {
+	return SectorHash::Compute(data, AUDIO_SECTOR_SIZE);
 }
 
 bool AudioCDCopier::FlushDriveCache() {
@@ -216,7 +210,8 @@ bool AudioCDCopier::VerifySubchannelIntegrity(DiscInfo& disc, int& errorCount, i
 	std::cout << "\n=== Subchannel Integrity Verification ===\n";
 	errorCount = 0;
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to verify.\n";
@@ -252,12 +247,11 @@ bool AudioCDCopier::VerifySubchannelIntegrity(DiscInfo& disc, int& errorCount, i
 	auto lastSpeedUpdate = startTime;
 	constexpr double CD_1X_BYTES_PER_SEC = 176400.0;
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
+	for (const auto& span : layout.Spans()) {
 		if (abortedEarly) break;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
+		const auto& t = disc.tracks[span.trackIndex];
 
-		for (DWORD lba = start; lba <= t.endLBA; lba++) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba++) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				m_drive.SetSpeed(0);
 				progress.Finish(false);
@@ -472,7 +466,8 @@ bool AudioCDCopier::VerifySubchannelBurnStatus(DiscInfo& disc, SubchannelBurnRes
 		std::cout << "Media type detected: " << result.mediaTypeName << "\n";
 	}
 
-	DWORD totalSectors = CalculateTotalAudioSectors(disc);
+	DiscLayout layout = DiscLayout::ForScan(disc);
+	DWORD totalSectors = layout.TotalSectors();
 	if (totalSectors == 0) {
 		std::cout << "No audio tracks to verify.\n";
 		return false;
@@ -498,15 +493,14 @@ bool AudioCDCopier::VerifySubchannelBurnStatus(DiscInfo& disc, SubchannelBurnRes
 
 	int prevAbsMin = -1, prevAbsSec = -1, prevAbsFrame = -1;
 
-	for (const auto& t : disc.tracks) {
-		if (!t.isAudio) continue;
-		DWORD start = (t.trackNumber == 1) ? 0 : t.pregapLBA;
+	for (const auto& span : layout.Spans()) {
+		const auto& t = disc.tracks[span.trackIndex];
 
 		prevAbsMin = -1;
 		prevAbsSec = -1;
 		prevAbsFrame = -1;
 
-		for (DWORD lba = start; lba <= t.endLBA; lba += sampleInterval) {
+		for (DWORD lba = span.firstLBA; lba <= span.lastLBA; lba += sampleInterval) {
 			if (g_interrupt.IsInterrupted() || g_interrupt.CheckEscapeKey()) {
 				m_drive.SetSpeed(0);
 				progress.Finish(false);
@@ -891,175 +885,126 @@ bool AudioCDCopier::CompareDiscCRCs(const std::vector<std::pair<int, uint32_t>>&
 	return mismatchCount == 0 && missingCount == 0;
 }
 
-int AudioCDCopier::DetectSampleOffset(
-	const std::vector<std::vector<BYTE>>& origSectors,
-	const std::vector<std::vector<BYTE>>& copySectors,
+// Five windows spread across the disc catch a copy whose offset drifts or
+// that was mastered differently part-way through; 32 sectors is ~0.4 s,
+// enough for a 16384-sample reference window.
+static constexpr size_t OFFSET_PROBE_COUNT = 5;
+static constexpr size_t OFFSET_PROBE_SECTORS = 32;
+
+std::vector<size_t> AudioCDCopier::ExtractOffsetProbes(const SectorStore& sectors, SectorStore& probes) {
+	std::vector<size_t> starts;
+	probes.clear();
+	size_t total = sectors.size();
+	if (total < OFFSET_PROBE_SECTORS) return starts;
+
+	for (size_t i = 0; i < OFFSET_PROBE_COUNT; i++) {
+		size_t centre = total * (i + 1) / (OFFSET_PROBE_COUNT + 1);
+		size_t first = (centre > OFFSET_PROBE_SECTORS / 2) ? centre - OFFSET_PROBE_SECTORS / 2 : 0;
+		first = std::min(first, total - OFFSET_PROBE_SECTORS);
+		if (!probes.AppendFrom(sectors, first, OFFSET_PROBE_SECTORS)) break;
+		starts.push_back(first);
+	}
+	return starts;
+}
+
+SampleOffsetResult AudioCDCopier::DetectDiscSampleOffset(const SectorStore& origProbes,
+	const std::vector<size_t>& probeStarts, const SectorStore& copySectors,
 	int maxOffsetSamples)
 {
-	// Convert raw sector bytes to int16 sample arrays for correlation.
-	// Only use the first ~100 sectors -- enough for reliable detection
-	// without excessive memory or compute.
-	auto toSamples = [](const std::vector<std::vector<BYTE>>& sectors, size_t maxSecs) {
-		std::vector<int16_t> out;
-		size_t n = std::min(maxSecs, sectors.size());
-		out.reserve(n * (AUDIO_SECTOR_SIZE / 2));
-		for (size_t i = 0; i < n; i++) {
-			const auto& s = sectors[i];
-			for (size_t j = 0; j + 1 < s.size() && j + 1 < AUDIO_SECTOR_SIZE; j += 2) {
-				out.push_back(static_cast<int16_t>(s[j] | (s[j + 1] << 8)));
-			}
-		}
-		return out;
-	};
-
-	auto orig = toSamples(origSectors, 100);
-	auto copy = toSamples(copySectors, 100);
-
-	if (orig.size() < 5000 || copy.size() < 5000)
-		return 0;
-
-	// Compare in the middle of the probe to avoid lead-in / boundary artefacts.
-	size_t winStart = orig.size() / 4;
-	size_t winLen = std::min<size_t>(orig.size() / 4, 20000);
-
-	int64_t bestSSD = INT64_MAX;
-	int     bestOff = 0;
-	size_t  bestCnt = 0;
-
-	for (int off = -maxOffsetSamples; off <= maxOffsetSamples; off++) {
-		// Each stereo sample pair = 2 int16 values in the interleaved array.
-		int shift = off * 2;
-		int64_t ssd = 0;
-		size_t  cnt = 0;
-
-		for (size_t i = 0; i < winLen; i++) {
-			ptrdiff_t oi = static_cast<ptrdiff_t>(winStart + i);
-			ptrdiff_t ci = oi + shift;
-			if (ci < 0 || ci >= static_cast<ptrdiff_t>(copy.size()))
-				continue;
-
-			int d = static_cast<int>(orig[oi]) - static_cast<int>(copy[ci]);
-			ssd += static_cast<int64_t>(d) * d;
-			cnt++;
-		}
-
-		if (cnt > 0 && ssd < bestSSD) {
-			bestSSD = ssd;
-			bestOff = off;
-			bestCnt = cnt;
+	// Copy range for each window: the same sectors, padded on both sides by
+	// the search radius so every candidate offset has a full window.
+	const size_t samplesPerSector = AUDIO_SECTOR_SIZE / 4;
+	const size_t margin = static_cast<size_t>(maxOffsetSamples) / samplesPerSector + 1;
+
+	std::vector<OffsetEstimate> windows;
+	for (size_t i = 0; i < probeStarts.size(); i++) {
+		size_t start = probeStarts[i];
+		if (start >= copySectors.size()) {
+			windows.push_back(OffsetEstimate());
+			continue;
 		}
+		size_t copyFirst = (start > margin) ? start - margin : 0;
+		size_t lead = start - copyFirst;
+		SectorSpan orig = origProbes.AudioSpan(i * OFFSET_PROBE_SECTORS, OFFSET_PROBE_SECTORS);
+		SectorSpan copy = copySectors.AudioSpan(copyFirst, lead + OFFSET_PROBE_SECTORS + margin);
+		windows.push_back(OffsetCorrelator::Estimate(orig, copy, lead, maxOffsetSamples));
 	}
-
-	// Reject if the best alignment is still noisy -- means genuinely different audio.
-	if (bestCnt == 0) return 0;
-	double avgSSD = static_cast<double>(bestSSD) / bestCnt;
-	if (avgSSD > 10.0) return 0;
-
-	return bestOff;
+	return OffsetCorrelator::Combine(windows);
 }
 
-void AudioCDCopier::ApplySampleOffset(std::vector<std::vector<BYTE>>& rawSectors, int offsetSamples)
+void AudioCDCopier::ApplySampleOffset(SectorStore& sectors, int offsetSamples)
 {
-	if (offsetSamples == 0 || rawSectors.empty()) return;
-
-	int64_t byteOffset = static_cast<int64_t>(offsetSamples) * 4;
-
-	// Flatten into one contiguous buffer
-	std::vector<BYTE> all;
-	all.reserve(rawSectors.size() * AUDIO_SECTOR_SIZE);
-	for (auto& s : rawSectors)
-		all.insert(all.end(), s.begin(),
-			s.begin() + std::min(s.size(), static_cast<size_t>(AUDIO_SECTOR_SIZE)));
-
-	// Shift
-	std::vector<BYTE> shifted;
-	if (byteOffset > 0) {
-		if (static_cast<size_t>(byteOffset) >= all.size()) return;
-		shifted.assign(all.begin() + byteOffset, all.end());
-		shifted.resize(all.size(), 0);
-	}
-	else {
-		// Negative shift: prepend |byteOffset| zeros, then copy the input up
-		// to (end - |byteOffset|). Bound check prevents iterator underflow
-		// when an absurdly large negative offset is requested for a tiny buffer.
-		size_t absOff = static_cast<size_t>(-byteOffset);
-		if (absOff >= all.size()) return;
-		shifted.resize(absOff, 0);
-		shifted.insert(shifted.end(), all.begin(), all.end() + byteOffset);
-	}
-
-	// Write back into per-sector buffers
-	size_t pos = 0;
-	for (auto& s : rawSectors) {
-		size_t len = std::min(static_cast<size_t>(AUDIO_SECTOR_SIZE), shifted.size() - pos);
-		if (pos < shifted.size())
-			memcpy(s.data(), &shifted[pos], len);
-		pos += AUDIO_SECTOR_SIZE;
-	}
+	// The audio plane is contiguous, so the shift is one memmove inside the
+	// store plus zero-fill of the vacated edge.
+	SampleShifter::ShiftInPlace(sectors.MutableAudioSpan(), offsetSamples);
 }
 
-uint32_t AudioCDCopier::CalculateTrackCRC(const DiscInfo& disc, int trackIndex) {
-	if (trackIndex < 0 || trackIndex >= static_cast<int>(disc.tracks.size())) return 0;
-	if (disc.rawSectors.empty()) return 0;
-
-	// For disc-to-disc comparison, use INDEX 01 boundaries (startLBA) and
-	// avoid fragile pregap-derived edge sectors that can differ on CD-R copies.
-	constexpr DWORD EDGE_TRIM_SECTORS = 16; // 16 * 2352 = 37632 bytes at each edge
-
+// For disc-to-disc comparison, tracks span INDEX 01 (startLBA) to the next
+// track's INDEX 01, avoiding fragile pregap-derived edge sectors that can
+// differ on CD-R copies.  Returns 0 for a degenerate entry.
+static DWORD CanonicalTrackSectors(const DiscInfo& disc, size_t trackIndex) {
 	const auto& track = disc.tracks[trackIndex];
-
-	// Start from INDEX 01 (stable TOC anchor)
-	DWORD trackStart = track.startLBA;
-
-	// Prefer canonical end from next track INDEX 01 when available
 	DWORD canonicalEnd = track.endLBA;
-	if (trackIndex + 1 < static_cast<int>(disc.tracks.size())) {
+	if (trackIndex + 1 < disc.tracks.size()) {
 		DWORD nextStart = disc.tracks[trackIndex + 1].startLBA;
 		if (nextStart > 0) {
 			DWORD endFromNext = nextStart - 1;
 			if (endFromNext < canonicalEnd) canonicalEnd = endFromNext;
 		}
 	}
+	if (canonicalEnd < track.startLBA) return 0;
+	return canonicalEnd - track.startLBA + 1;
+}
 
-	if (canonicalEnd < trackStart) return 0;
-	DWORD trackSectors = canonicalEnd - trackStart + 1;
-
-	// Compute starting raw-sector index using the same canonical scheme
+// Raw-sector index of every track's first canonical sector, computed in one
+// pass so per-track CRCs cost O(tracks) overall instead of O(tracks²).
+static std::vector<size_t> CanonicalTrackOffsets(const DiscInfo& disc) {
+	std::vector<size_t> offsets(disc.tracks.size());
 	size_t sectorIdx = 0;
-	for (int i = 0; i < trackIndex; i++) {
-		DWORD s = disc.tracks[i].startLBA;
-		DWORD e = disc.tracks[i].endLBA;
-		if (i + 1 < static_cast<int>(disc.tracks.size())) {
-			DWORD nextStart = disc.tracks[i + 1].startLBA;
-			if (nextStart > 0) {
-				DWORD endFromNext = nextStart - 1;
-				if (endFromNext < e) e = endFromNext;
-			}
-		}
-		if (e >= s) sectorIdx += static_cast<size_t>(e - s + 1);
+	for (size_t i = 0; i < disc.tracks.size(); i++) {
+		offsets[i] = sectorIdx;
+		sectorIdx += CanonicalTrackSectors(disc, i);
 	}
+	return offsets;
+}
 
+static uint32_t TrackRangeCRC(const DiscInfo& disc, size_t sectorIdx, DWORD trackSectors) {
 	// Trim edge sectors to remove boundary/pregap variance
+	constexpr DWORD EDGE_TRIM_SECTORS = 16; // 16 * 2352 = 37632 bytes at each edge
 	DWORD trim = (trackSectors > EDGE_TRIM_SECTORS * 2) ? EDGE_TRIM_SECTORS : 0;
 	DWORD startSector = trim;
 	DWORD endSectorExclusive = trackSectors - trim;
 
-	uint32_t crc = 0xFFFFFFFF;
-	const uint32_t polynomial = 0xEDB88320;
+	// The span clamps to the stored range, matching the old early break.
+	SectorSpan audio = disc.rawSectors.AudioSpan(sectorIdx + startSector,
+		endSectorExclusive - startSector);
+	return Crc32::Compute(audio.data, audio.Bytes());
+}
 
-	for (DWORD i = startSector; i < endSectorExclusive; i++) {
-		size_t idx = sectorIdx + i;
-		if (idx >= disc.rawSectors.size()) break;
+uint32_t AudioCDCopier::CalculateTrackCRC(const DiscInfo& disc, int trackIndex) {
+	if (trackIndex < 0 || trackIndex >= static_cast<int>(disc.tracks.size())) return 0;
+	if (disc.rawSectors.empty()) return 0;
 
-		const auto& sector = disc.rawSectors[idx];
-		const size_t len = std::min(sector.size(), static_cast<size_t>(AUDIO_SECTOR_SIZE));
-		for (size_t j = 0; j < len; j++) {
-			crc ^= sector[j];
-			for (int bit = 0; bit < 8; bit++) {
-				crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
-			}
-		}
+	DWORD trackSectors = CanonicalTrackSectors(disc, trackIndex);
+	if (trackSectors == 0) return 0;
+
+	size_t sectorIdx = 0;
+	for (int i = 0; i < trackIndex; i++) {
+		sectorIdx += CanonicalTrackSectors(disc, i);
 	}
+	return TrackRangeCRC(disc, sectorIdx, trackSectors);
+}
+
+std::vector<std::pair<int, uint32_t>> AudioCDCopier::CalculateTrackCRCs(const DiscInfo& disc) {
+	std::vector<std::pair<int, uint32_t>> crcs;
+	std::vector<size_t> offsets = CanonicalTrackOffsets(disc);
 
-	return ~crc;
+	for (size_t i = 0; i < disc.tracks.size(); i++) {
+		if (!disc.tracks[i].isAudio) continue;
+		DWORD trackSectors = CanonicalTrackSectors(disc, i);
+		uint32_t crc = (trackSectors == 0 || disc.rawSectors.empty())
+			? 0 : TrackRangeCRC(disc, offsets[i], trackSectors);
+		crcs.push_back({ disc.tracks[i].trackNumber, crc });
+	}
+	return crcs;
 }
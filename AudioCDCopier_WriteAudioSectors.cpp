@@ -5,12 +5,136 @@
 #include "InterruptHandler.h"
 #include "WriteDiscInternal.h"
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <conio.h>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <windows.h>
 
+namespace {
+	// Used when the drive does not answer READ BUFFER CAPACITY: the historic
+	// batch sizes, which fit a 64 KB transfer.
+	constexpr DWORD FALLBACK_SECTORS_AUDIO = 27;
+	constexpr DWORD FALLBACK_SECTORS_SUB = 20;
+	// One WRITE should not take more than this share of the drive buffer,
+	// so the drive always has room to accept the next one.
+	constexpr DWORD BUFFER_FRACTION_PER_WRITE = 8;
+	constexpr DWORD MIN_SECTORS_PER_WRITE = 8;
+	// Host-side read-ahead: enough filled batches to refill the drive buffer
+	// twice over, within these bounds.
+	constexpr size_t MIN_RING_SLOTS = 8;
+	constexpr size_t MAX_RING_SLOTS = 256;
+	constexpr DWORD BUFFER_POLL_MS = 500;
+
+	// ── WriteBufferRing ─────────────────────────────────────────────────
+	// Fixed ring of write batches.  A reader thread fills slots in order
+	// (file reads, deinterleave, Q synthesis) while the writer thread sends
+	// them, so host-side stalls are absorbed by the ring instead of the
+	// drive buffer.  Batches are never refilled: a retried WRITE resends the
+	// slot it already holds.
+	class WriteBufferRing {
+	public:
+		struct Slot {
+			std::vector<BYTE> data;
+			DWORD first = 0;        // index into the write stream (0 = LBA -150)
+			DWORD count = 0;
+		};
+
+		WriteBufferRing(size_t slots, size_t slotBytes) : m_slots(slots) {
+			for (auto& slot : m_slots) slot.data.resize(slotBytes);
+		}
+
+		~WriteBufferRing() {
+			Stop();
+			if (m_reader.joinable()) m_reader.join();
+		}
+
+		// fill(slot) writes slot.count sectors starting at slot.first.
+		template <typename Fill>
+		void Start(DWORD totalSectors, DWORD sectorsPerBatch, Fill fill) {
+			m_reader = std::thread([this, totalSectors, sectorsPerBatch, fill]() {
+				for (DWORD next = 0; next < totalSectors; ) {
+					Slot* slot = nullptr;
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_spaceCv.wait(lock, [&]() { return m_stop || m_filled - m_sent < m_slots.size(); });
+						if (m_stop) return;
+						slot = &m_slots[m_filled % m_slots.size()];
+					}
+					slot->first = next;
+					slot->count = std::min(sectorsPerBatch, totalSectors - next);
+					fill(*slot);
+					next += slot->count;
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_filled++;
+					}
+					m_dataCv.notify_one();
+				}
+			});
+		}
+
+		// The oldest filled batch; waits for the reader if the ring is empty.
+		const Slot* Front() {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_filled == m_sent) {
+				m_underruns++;
+				m_dataCv.wait(lock, [&]() { return m_stop || m_filled > m_sent; });
+			}
+			if (m_filled == m_sent) return nullptr;
+			return &m_slots[m_sent % m_slots.size()];
+		}
+
+		// Release the batch returned by Front() once the drive accepted it.
+		void PopFront() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_sent++;
+			}
+			m_spaceCv.notify_one();
+		}
+
+		void Stop() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_spaceCv.notify_all();
+			m_dataCv.notify_all();
+		}
+
+		size_t Filled() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_filled - m_sent;
+		}
+
+		size_t Slots() const { return m_slots.size(); }
+
+		// Times the writer found no batch ready.
+		int Underruns() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_underruns;
+		}
+
+	private:
+		std::vector<Slot> m_slots;
+		size_t m_filled = 0;        // batches produced so far
+		size_t m_sent = 0;          // batches released so far
+		int m_underruns = 0;
+		bool m_stop = false;
+		std::mutex m_mutex;
+		std::condition_variable m_spaceCv;
+		std::condition_variable m_dataCv;
+		std::thread m_reader;
+	};
+}
+
 // ============================================================================
 // WriteAudioSectors - Write pregap silence + audio/data sectors (+ optional subchannel)
 //
@@ -22,6 +146,12 @@
 // Mixed-mode discs are supported: data tracks (MODE1/2352, MODE2/2352) are
 // written from the same BIN file as raw 2352-byte sectors.  The Q-channel CTL
 // field is set to 0x04 for data tracks and 0x00 for audio tracks.
+//
+// Batches are prepared on a reader thread into a WriteBufferRing and sent
+// from this one, so file I/O and Q synthesis never delay the next WRITE.
+// Batch size and ring depth follow the drive buffer size from READ BUFFER
+// CAPACITY; the same command, polled while writing, drives the buffer-fill
+// readout on the progress line and the summary at the end.
 // ============================================================================
 bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 	const std::wstring& subFile,
@@ -88,34 +218,35 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 		Console::Warning("Drive not ready after CUE sheet (attempting write anyway)\n");
 	}
 
-	ProgressIndicator progress(35);
-	progress.SetLabel("Writing");
-	progress.Start();
+	// ── Batch size and ring depth from the drive buffer ─────────────────
+	DWORD driveBufferBytes = 0, driveBlankBytes = 0;
+	bool canPollBuffer = WriteDiscInternal::ReadBufferCapacity(m_drive, driveBufferBytes, driveBlankBytes)
+		&& driveBufferBytes > 0;
+
+	DWORD sectorsPerWrite = hasSubchannel ? FALLBACK_SECTORS_SUB : FALLBACK_SECTORS_AUDIO;
+	size_t ringSlots = MIN_RING_SLOTS;
+	if (canPollBuffer) {
+		DWORD fromBuffer = driveBufferBytes / BUFFER_FRACTION_PER_WRITE / sectorSize;
+		sectorsPerWrite = std::max(MIN_SECTORS_PER_WRITE,
+			std::min(fromBuffer, m_drive.GetMaxTransferSectors(sectorSize)));
+		size_t batchBytes = static_cast<size_t>(sectorsPerWrite) * sectorSize;
+		ringSlots = std::clamp<size_t>(2 * driveBufferBytes / batchBytes, MIN_RING_SLOTS, MAX_RING_SLOTS);
+
+		Console::Info("Drive buffer: ");
+		std::cout << (driveBufferBytes / 1024) << " KB, " << sectorsPerWrite << " sectors/write, "
+			<< ringSlots << " batches read ahead\n";
+	}
+	else {
+		Console::Info("Drive buffer: size not reported, ");
+		std::cout << sectorsPerWrite << " sectors/write\n";
+	}
 
-	const DWORD SECTORS_PER_WRITE = hasSubchannel ? 20 : 27;
-	std::vector<BYTE> writeBuffer(sectorSize * SECTORS_PER_WRITE);
+	// ── Batch preparation (reader thread) ───────────────────────────────
 	BYTE rawSub[SUBCHANNEL_SIZE];
-
-	DWORD sectorsWritten = 0;
-	int32_t currentLBA = -150;
-	int consecutiveErrors = 0;
-	size_t currentTrackIdx = 0;
-
-	while (sectorsWritten < writeTotalSectors) {
-		if (InterruptHandler::Instance().IsInterrupted()) {
-			Console::Error("\nWrite operation cancelled by user\n");
-			progress.Finish(false);
-			binInput.close();
-			if (hasSubFile) subInput.close();
-			return false;
-		}
-
-		DWORD remaining = writeTotalSectors - sectorsWritten;
-		DWORD batchSize = (remaining < SECTORS_PER_WRITE) ? remaining : SECTORS_PER_WRITE;
-
-		for (DWORD s = 0; s < batchSize; s++) {
-			BYTE* dest = writeBuffer.data() + s * sectorSize;
-			DWORD globalSector = sectorsWritten + s;
+	auto fillBatch = [&](WriteBufferRing::Slot& slot) {
+		for (DWORD s = 0; s < slot.count; s++) {
+			BYTE* dest = slot.data.data() + static_cast<size_t>(s) * sectorSize;
+			DWORD globalSector = slot.first + s;
 
 			if (globalSector < PREGAP_SECTORS) {
 				// ── Pregap sector (LBA -150 to -1) ──────────────────────
@@ -250,8 +381,63 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 				}
 			}
 		}
+	};
+
+	WriteBufferRing ring(ringSlots, static_cast<size_t>(sectorsPerWrite) * sectorSize);
+	ring.Start(writeTotalSectors, sectorsPerWrite, fillBatch);
+
+	// Let the reader get ahead before the first WRITE.
+	for (int wait = 0; wait < 200 && ring.Filled() < ring.Slots() / 2 &&
+		ring.Filled() * sectorsPerWrite < writeTotalSectors; wait++) {
+		Sleep(5);
+	}
+
+	ProgressIndicator progress(35);
+	progress.SetLabel("Writing");
+	progress.Start();
+
+	// ── Buffer-fill telemetry ───────────────────────────────────────────
+	int minFillPct = 100;
+	long long fillPctSum = 0;
+	int fillSamples = 0;
+	auto lastPoll = std::chrono::steady_clock::now();
+	auto pollDriveBuffer = [&]() {
+		if (!canPollBuffer) return;
+		auto now = std::chrono::steady_clock::now();
+		if (std::chrono::duration_cast<std::chrono::milliseconds>(now - lastPoll).count() < BUFFER_POLL_MS) return;
+		lastPoll = now;
+
+		DWORD length = 0, blank = 0;
+		if (!WriteDiscInternal::ReadBufferCapacity(m_drive, length, blank) || length == 0) return;
+		int pct = static_cast<int>((static_cast<unsigned long long>(length - std::min(blank, length)) * 100) / length);
+		minFillPct = std::min(minFillPct, pct);
+		fillPctSum += pct;
+		fillSamples++;
+
+		std::ostringstream label;
+		label << "Writing (buf " << std::setw(3) << pct << "%)";
+		progress.SetLabel(label.str());
+	};
+
+	int32_t currentLBA = -150;
+	DWORD sectorsWritten = 0;
+	int consecutiveErrors = 0;
+	size_t currentTrackIdx = 0;
+
+	while (sectorsWritten < writeTotalSectors) {
+		if (InterruptHandler::Instance().IsInterrupted()) {
+			Console::Error("\nWrite operation cancelled by user\n");
+			progress.Finish(false);
+			return false;
+		}
 
-		DWORD transferBytes = batchSize * sectorSize;
+		const WriteBufferRing::Slot* batch = ring.Front();
+		if (!batch) {
+			progress.Finish(false);
+			return false;
+		}
+
+		DWORD transferBytes = batch->count * sectorSize;
 
 		BYTE writeCmd[10] = { 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 		DWORD lbaUnsigned = static_cast<DWORD>(currentLBA);
@@ -259,13 +445,14 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 		writeCmd[3] = static_cast<BYTE>((lbaUnsigned >> 16) & 0xFF);
 		writeCmd[4] = static_cast<BYTE>((lbaUnsigned >> 8) & 0xFF);
 		writeCmd[5] = static_cast<BYTE>(lbaUnsigned & 0xFF);
-		writeCmd[7] = static_cast<BYTE>((batchSize >> 8) & 0xFF);
-		writeCmd[8] = static_cast<BYTE>(batchSize & 0xFF);
+		writeCmd[7] = static_cast<BYTE>((batch->count >> 8) & 0xFF);
+		writeCmd[8] = static_cast<BYTE>(batch->count & 0xFF);
 
 		BYTE senseKey = 0, asc = 0, ascq = 0;
 		bool writeOk = m_drive.SendSCSIWithSense(writeCmd, sizeof(writeCmd),
-			writeBuffer.data(), transferBytes, &senseKey, &asc, &ascq, false);
+			const_cast<BYTE*>(batch->data.data()), transferBytes, &senseKey, &asc, &ascq, false);
 
+		// A failed batch stays at the front of the ring and is resent as is.
 		if (!writeOk) {
 			if (senseKey == 0x02 && asc == 0x04) {
 				if (!WriteDiscInternal::WaitForDriveReady(m_drive, 30)) {
@@ -273,16 +460,10 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 					if (consecutiveErrors >= 5) {
 						Console::Error("\nDrive not recovering - aborting\n");
 						progress.Finish(false);
-						binInput.close();
-						if (hasSubFile) subInput.close();
 						return false;
 					}
 					continue;
 				}
-				DWORD binSector = (sectorsWritten >= PREGAP_SECTORS) ? sectorsWritten - PREGAP_SECTORS : 0;
-				binInput.seekg(static_cast<long long>(binSector) * AUDIO_SECTOR_SIZE);
-				if (hasSubFile)
-					subInput.seekg(static_cast<long long>(binSector) * SUBCHANNEL_SIZE);
 				consecutiveErrors = 0;
 				continue;
 			}
@@ -295,22 +476,18 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 			if (consecutiveErrors >= 5) {
 				Console::Error("Too many consecutive write errors - aborting\n");
 				progress.Finish(false);
-				binInput.close();
-				if (hasSubFile) subInput.close();
 				return false;
 			}
 
-			DWORD binSector = (sectorsWritten >= PREGAP_SECTORS) ? sectorsWritten - PREGAP_SECTORS : 0;
-			binInput.seekg(static_cast<long long>(binSector) * AUDIO_SECTOR_SIZE);
-			if (hasSubFile)
-				subInput.seekg(static_cast<long long>(binSector) * SUBCHANNEL_SIZE);
 			Sleep(1000);
 			continue;
 		}
 
 		consecutiveErrors = 0;
-		sectorsWritten += batchSize;
-		currentLBA += batchSize;
+		sectorsWritten += batch->count;
+		currentLBA += batch->count;
+		ring.PopFront();
+		pollDriveBuffer();
 		progress.Update(sectorsWritten, writeTotalSectors);
 
 		DWORD binPosition = (sectorsWritten > PREGAP_SECTORS) ? sectorsWritten - PREGAP_SECTORS : 0;
@@ -326,8 +503,6 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 	}
 
 	progress.Finish(true);
-	binInput.close();
-	if (hasSubFile) subInput.close();
 
 	Console::Success("Successfully wrote ");
 	std::cout << sectorsWritten << " sectors";
@@ -338,5 +513,15 @@ bool AudioCDCopier::WriteAudioSectors(const std::wstring& binFile,
 		std::cout << ")";
 	}
 	std::cout << "\n";
+
+	if (fillSamples > 0) {
+		Console::Info("Drive buffer fill: ");
+		std::cout << "average " << (fillPctSum / fillSamples) << "%, minimum " << minFillPct << "%\n";
+	}
+	int hostStalls = ring.Underruns();
+	if (hostStalls > 0) {
+		Console::Warning("Host reader fell behind the writer ");
+		std::cout << hostStalls << " time(s)\n";
+	}
 	return true;
-}
\ No newline at end of file
+}
@@ -53,6 +53,21 @@ bool WriteDiscInternal::SynchronizeCache(ScsiDrive& drive) {
 	return true;
 }
 
+// ============================================================================
+// Helper: Query the drive write buffer via READ BUFFER CAPACITY (0x5C)
+// ============================================================================
+bool WriteDiscInternal::ReadBufferCapacity(ScsiDrive& drive, DWORD& bufferBytes, DWORD& blankBytes) {
+	BYTE cdb[10] = { 0x5C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x00 };
+	BYTE data[12] = { 0 };
+	BYTE sk = 0, asc = 0, ascq = 0;
+	if (!drive.SendSCSIWithSense(cdb, sizeof(cdb), data, sizeof(data), &sk, &asc, &ascq, true)) {
+		return false;
+	}
+	bufferBytes = (static_cast<DWORD>(data[4]) << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+	blankBytes = (static_cast<DWORD>(data[8]) << 24) | (data[9] << 16) | (data[10] << 8) | data[11];
+	return true;
+}
+
 // ============================================================================
 // Helper: Deinterleave raw P-W subchannel to packed format
 // ============================================================================
@@ -0,0 +1,165 @@
+﻿// ============================================================================
+// C2Kernel.cpp - Scalar / POPCNT / SSE2 C2 pointer counting kernels
+// ============================================================================
+#include "C2Kernel.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define C2_KERNEL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC accepts POPCNT intrinsics in any function; GCC/Clang need the target
+// enabled per function so the rest of the file stays baseline code.
+#if defined(__GNUC__) || defined(__clang__)
+#define C2_KERNEL_TARGET_POPCNT __attribute__((target("popcnt")))
+#else
+#define C2_KERNEL_TARGET_POPCNT
+#endif
+
+namespace {
+	using CountFn = int (*)(const unsigned char*, size_t);
+
+	int PopCountScalar(uint64_t x) {
+		x = x - ((x >> 1) & 0x5555555555555555ULL);
+		x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+	}
+
+	// Word-at-a-time over the block, then the tail bytes.
+	int CountBitsScalar(const unsigned char* data, size_t size) {
+		int count = 0;
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			uint64_t word;
+			memcpy(&word, data + i, sizeof(word));
+			count += PopCountScalar(word);
+		}
+		for (; i < size; i++) count += PopCountScalar(data[i]);
+		return count;
+	}
+
+	// A byte b is 0x00 or 0xFF exactly when b ^ (b >> 1 within the byte)
+	// clears all seven low bits, i.e. all eight bits are equal.  Done on a
+	// whole word: every byte of `diff` is zero only for 0x00 / 0xFF bytes,
+	// and the high bit of each byte of `nonzero` marks the rest.
+	int CountBytesScalar(const unsigned char* data, size_t size) {
+		constexpr uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+		int count = 0;
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			uint64_t word;
+			memcpy(&word, data + i, sizeof(word));
+			uint64_t diff = (word ^ (word >> 1)) & LOW7;
+			uint64_t nonzero = (diff + LOW7) & ~LOW7;
+			count += PopCountScalar(nonzero);
+		}
+		for (; i < size; i++) {
+			if (data[i] != 0x00 && data[i] != 0xFF) count++;
+		}
+		return count;
+	}
+
+#ifdef C2_KERNEL_X86
+	C2_KERNEL_TARGET_POPCNT
+	int PopCountHw(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<int>(__popcnt64(x));
+#elif defined(_MSC_VER)
+		return static_cast<int>(__popcnt(static_cast<unsigned>(x)) + __popcnt(static_cast<unsigned>(x >> 32)));
+#else
+		return __builtin_popcountll(x);
+#endif
+	}
+
+	C2_KERNEL_TARGET_POPCNT
+	int CountBitsPopcnt(const unsigned char* data, size_t size) {
+		int count = 0;
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			uint64_t word;
+			memcpy(&word, data + i, sizeof(word));
+			count += PopCountHw(word);
+		}
+		for (; i < size; i++) count += PopCountHw(data[i]);
+		return count;
+	}
+
+	// 16 bytes per step: compare against 0x00 and 0xFF, and count the lanes
+	// that matched neither from the movemask.
+	int CountBytesSSE2(const unsigned char* data, size_t size) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi8(static_cast<char>(0xFF));
+		int count = 0;
+		size_t i = 0;
+		for (; i + 16 <= size; i += 16) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			__m128i clean = _mm_or_si128(_mm_cmpeq_epi8(x, zero), _mm_cmpeq_epi8(x, ones));
+			unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(clean));
+			count += 16 - PopCountScalar(mask);
+		}
+		return count + CountBytesScalar(data + i, size - i);
+	}
+
+	bool CpuHasPopcnt() {
+#ifdef _MSC_VER
+		int regs[4] = {};
+		__cpuid(regs, 1);
+		return (regs[2] & (1 << 23)) != 0;
+#else
+		return __builtin_cpu_supports("popcnt");
+#endif
+	}
+
+	bool CpuHasSSE2() {
+#if defined(_M_X64) || defined(__x86_64__)
+		return true;    // part of the x64 baseline
+#elif defined(_MSC_VER)
+		int regs[4] = {};
+		__cpuid(regs, 1);
+		return (regs[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+#endif
+
+	struct Dispatch {
+		CountFn bits = CountBitsScalar;
+		CountFn bytes = CountBytesScalar;
+		const char* name = "scalar";
+	};
+
+	const Dispatch& Selected() {
+		static const Dispatch selected = [] {
+			Dispatch d;
+#ifdef C2_KERNEL_X86
+			bool popcnt = CpuHasPopcnt();
+			bool sse2 = CpuHasSSE2();
+			if (popcnt) d.bits = CountBitsPopcnt;
+			if (sse2) d.bytes = CountBytesSSE2;
+			d.name = popcnt ? (sse2 ? "POPCNT / SSE2" : "POPCNT / scalar")
+				: (sse2 ? "scalar / SSE2" : "scalar");
+#endif
+			return d;
+		}();
+		return selected;
+	}
+}
+
+int C2Kernel::CountBits(const unsigned char* data, size_t size) {
+	return Selected().bits(data, size);
+}
+
+int C2Kernel::CountBytes(const unsigned char* data, size_t size) {
+	return Selected().bytes(data, size);
+}
+
+const char* C2Kernel::Name() {
+	return Selected().name;
+}
@@ -0,0 +1,25 @@
+﻿// ============================================================================
+// C2Kernel.h - Vectorised C2 pointer counting
+//
+// Every C2 read (single-sector, batched, and the scans built on them) ends
+// in the same reduction over the 294-byte pointer block of a sector:
+//   bits    one bit per erroneous byte of audio (the MMC definition)
+//   bytes   one count per pointer byte that is neither 0x00 nor 0xFF
+//           (PlexTools-style; 0xFF marks "no error sample pointer")
+// The implementation is chosen once per process from CPUID: POPCNT for
+// bits, SSE2 for bytes, or portable scalar code.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+
+class C2Kernel {
+public:
+	// Set bits in data[0, size).
+	static int CountBits(const unsigned char* data, size_t size);
+	// Bytes in data[0, size) that are neither 0x00 nor 0xFF.
+	static int CountBytes(const unsigned char* data, size_t size);
+
+	// Implementations selected for this CPU, e.g. "POPCNT / SSE2".
+	static const char* Name();
+};
@@ -4,7 +4,9 @@
 #pragma once
 
 #include "Constants.h"
+#include "SectorStore.h"
 #include <windows.h>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <tuple>
@@ -52,13 +54,46 @@ enum class PregapMode {
 	Separate = 2        // Write each pre-gap as its own file
 };
 
+// ── AccurateRip database entry ──────────────────────────────────────────────
+// One pressing from a dBAR response.  tracks[] is indexed by audio track
+// (0-based, data tracks excluded).  crcV1 holds the pressing's checksum —
+// a V1 CRC, or a V2 CRC for chunks submitted by V2-aware rippers.  crc450
+// is the CRC of frame 450 alone, 0 when the response used 5-byte entries.
+struct AccurateRipTrackRef {
+	int confidence = 0;             // Number of submissions agreeing
+	uint32_t crcV1 = 0;
+	uint32_t crc450 = 0;
+};
+
+struct AccurateRipPressing {
+	uint32_t discId1 = 0;           // Disc IDs echoed in the chunk header
+	uint32_t discId2 = 0;
+	uint32_t cddbId = 0;
+	std::vector<AccurateRipTrackRef> tracks;
+};
+
+// ── AccurateRip checksums of a rip ──────────────────────────────────────────
+// Filled while the sectors are read (see AccurateRipStream).  The checksums
+// describe the audio as it will look after ApplyOffsetCorrection with
+// readOffset, so they are only valid while disc.driveOffset == readOffset.
+struct AccurateRipTrackCRC {
+	int trackNumber = 0;
+	uint32_t crcV1 = 0;
+	uint32_t crcV2 = 0;
+	int readOffset = 0;             // Offset correction the CRCs assume
+	int64_t samplesFed = 0;         // Checksummed samples accumulated so far
+	int64_t samplesExpected = 0;    // Samples inside the AccurateRip window
+
+	bool IsComplete() const { return samplesExpected > 0 && samplesFed == samplesExpected; }
+};
+
 // ── Master disc state ───────────────────────────────────────────────────────
 // The single authoritative object that tracks everything about the disc
 // currently being processed: TOC, raw sector data, error lists, rip settings,
 // AccurateRip CRC, CD-TEXT, and more.
 struct DiscInfo {
 	std::vector<TrackInfo> tracks;                      // TOC track list
-	std::vector<std::vector<BYTE>> rawSectors;          // Cached raw audio sectors
+	SectorStore rawSectors;                             // Cached sectors (audio / subchannel / C2 planes)
 	bool includeSubchannel = true;                      // Request subchannel data during reads
 	int sessionCount = 1;                               // Number of sessions on the disc
 	int selectedSession = 0;                            // Session to rip (0 = all)
@@ -71,6 +106,8 @@ struct DiscInfo {
 	LogOutput loggingOutput = LogOutput::Console;       // Where to send log messages
 	std::vector<std::tuple<DWORD, int, double>> readLog;// Per-sector read log: (LBA, errors, timeMs)
 	uint32_t accurateRipCRC = 0;                        // AccurateRip CRC for verification
+	std::vector<AccurateRipPressing> accurateRipPressings; // Pressings returned by AccurateRip::Lookup
+	std::vector<AccurateRipTrackCRC> accurateRipTracks; // Per-track V1/V2 computed during the last rip
 	int driveOffset = 0;                                // Sample-level read offset correction
 	PregapMode pregapMode = PregapMode::Include;        // How to handle pre-gaps
 	bool extractHiddenTrack = false;                    // Extract hidden track one audio (HTOA)
@@ -95,12 +132,13 @@ struct DiscInfo {
 // ── DiscInfo ────────────────────────────────────────────────────────────
 // Master state object threaded through the entire application.  Holds:
 //   • tracks[]         – TOC track list
-//   • rawSectors[]     – cached raw 2352-byte audio sectors
+//   • rawSectors       – contiguous sector store (see SectorStore.h)
 //   • badSectors[]     – LBAs that failed to read
 //   • c2ErrorSectors[] – LBAs with C2 error flags
 //   • readLog[]        – per-sector (LBA, errors, timeMs) tuples
 //   • cdText           – embedded CD-TEXT metadata
 //   • accurateRipCRC   – verification CRC from the AR database
+//   • accurateRipPressings[] / accurateRipTracks[] – AR reference and rip CRCs
 //   • driveOffset      – sample-level read offset correction
 //   • pregapMode       – Include / Skip / Separate pre-gap audio
 //   • tocRepaired      – whether corrupt TOC LBAs were clamped
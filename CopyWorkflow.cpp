@@ -5,6 +5,7 @@
 #include "Progress.h"
 #include "MenuHelpers.h"
 #include "PioneerVendor.h"
+#include "RipStream.h"
 #include <windows.h>
 #include <iostream>
 #include <conio.h>
@@ -151,6 +152,10 @@ bool RunCopyWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstring&
 		silentMode = (silentChoice == 1);
 	}
 
+	int ripOutput = copier.SelectRipOutput();
+	if (ripOutput == -1) return false;
+	bool streaming = (ripOutput == 1);
+
 	std::wstring path;
 	while (true) {
 		std::cout << "\nOutput path (no extension, or 0 to go back):\n";
@@ -374,6 +379,18 @@ bool RunCopyWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstring&
 		}
 	}
 
+	// Streaming: the image files are created now and filled during the read.
+	RipStreamWriter stream;
+	if (streaming) {
+		if (!stream.OpenImage(disc, path)) {
+			Console::Error("Failed to create output files!\n");
+			if (hideCDR) copier.GetDriveRef().SetHideCDRMedia(false);
+			if (silentMode) copier.GetDriveRef().SetSilentMode(false);
+			return false;
+		}
+		copier.SetRipStream(&stream);
+	}
+
 	Console::Info("\nReading disc...\n");
 	ProgressIndicator prog;
 	prog.SetLabel("Reading");
@@ -401,22 +418,42 @@ bool RunCopyWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstring&
 		copier.GetDriveRef().SetSilentMode(false);
 	}
 
+	copier.SetRipStream(nullptr);
+
 	if (!readSuccess) {
 		prog.Finish(false);
+		if (streaming) stream.Abort();
 		return false;
 	}
 	prog.Finish(true);
 
-	// Ensure offset correction is applied before saving.
-	if (disc.driveOffset != 0) {
+	// Ensure offset correction is applied before saving.  A streamed rip
+	// was corrected on its way to disk.
+	if (streaming) {
+		if (!stream.Finish(disc.rawSectors)) {
+			Console::Error("Failed to write output files!\n");
+			return false;
+		}
+	}
+	else if (disc.driveOffset != 0) {
 		copier.ApplyOffsetCorrection(disc);
 	}
 
+	// CRCs were accumulated during the read, so this is a table lookup
+	// unless part of an AccurateRip window was not read.
+	if (!disc.accurateRipPressings.empty()) {
+		AccurateRip::VerifyCRCs(disc);
+	}
+
 	Console::Info("Saving files...\n");
-	if (!copier.SaveToFile(disc, path)) {
+	bool saved = streaming
+		? copier.SaveCueSheet(disc, path, stream.PregapFiles())
+		: copier.SaveToFile(disc, path);
+	if (!saved) {
 		Console::Error("Failed to save!\n");
 		return false;
 	}
+	if (streaming) disc.rawSectors.clear();
 
 	std::wstring logPath = path + L".log";
 	if (copier.SaveReadLog(disc, logPath)) {
@@ -0,0 +1,194 @@
+﻿// ============================================================================
+// Crc32.cpp - Slice-by-16 and PCLMULQDQ CRC-32 implementations
+// ============================================================================
+#include "Crc32.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CRC32_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CRC32_TARGET_PCLMUL __attribute__((target("pclmul,sse2")))
+#else
+#define CRC32_TARGET_PCLMUL
+#endif
+
+namespace {
+	// ── Slice-by-16 ─────────────────────────────────────────────────────────
+	// table[0] is the classic byte-at-a-time table; table[k][b] is the CRC
+	// contribution of byte b followed by k zero bytes, so sixteen lookups
+	// advance the CRC by sixteen bytes with no dependency between them.
+	struct SliceTables {
+		uint32_t t[16][256];
+
+		SliceTables() {
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = i;
+				for (int bit = 0; bit < 8; bit++) {
+					c = (c >> 1) ^ ((c & 1) ? 0xEDB88320u : 0);
+				}
+				t[0][i] = c;
+			}
+			for (int k = 1; k < 16; k++) {
+				for (uint32_t i = 0; i < 256; i++) {
+					uint32_t prev = t[k - 1][i];
+					t[k][i] = (prev >> 8) ^ t[0][prev & 0xFF];
+				}
+			}
+		}
+	};
+
+	const SliceTables& Tables() {
+		static const SliceTables tables;
+		return tables;
+	}
+
+	// crc is the internal (inverted) register value on entry and exit.
+	uint32_t UpdateSlice16(uint32_t crc, const unsigned char* p, size_t len) {
+		const auto& t = Tables().t;
+
+		while (len >= 16) {
+			uint32_t w[4];
+			memcpy(w, p, sizeof(w));
+			w[0] ^= crc;
+			crc = t[15][w[0] & 0xFF] ^ t[14][(w[0] >> 8) & 0xFF] ^
+				t[13][(w[0] >> 16) & 0xFF] ^ t[12][w[0] >> 24] ^
+				t[11][w[1] & 0xFF] ^ t[10][(w[1] >> 8) & 0xFF] ^
+				t[9][(w[1] >> 16) & 0xFF] ^ t[8][w[1] >> 24] ^
+				t[7][w[2] & 0xFF] ^ t[6][(w[2] >> 8) & 0xFF] ^
+				t[5][(w[2] >> 16) & 0xFF] ^ t[4][w[2] >> 24] ^
+				t[3][w[3] & 0xFF] ^ t[2][(w[3] >> 8) & 0xFF] ^
+				t[1][(w[3] >> 16) & 0xFF] ^ t[0][w[3] >> 24];
+			p += 16;
+			len -= 16;
+		}
+		while (len-- > 0) {
+			crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+		}
+		return crc;
+	}
+
+#ifdef CRC32_X86
+	// ── PCLMULQDQ folding ───────────────────────────────────────────────────
+	// Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ"
+	// in the bit-reflected domain: four 128-bit lanes are folded forward 64
+	// bytes per step, merged into one lane, then Barrett-reduced to 32 bits.
+	// Requires len >= 64 and a multiple of 16; crc is the internal value.
+	CRC32_TARGET_PCLMUL
+	inline __m128i Fold128(__m128i acc, __m128i next, __m128i k) {
+		__m128i lo = _mm_clmulepi64_si128(acc, k, 0x00);
+		__m128i hi = _mm_clmulepi64_si128(acc, k, 0x11);
+		return _mm_xor_si128(_mm_xor_si128(hi, next), lo);
+	}
+
+	CRC32_TARGET_PCLMUL
+	uint32_t UpdateFold(uint32_t crc, const unsigned char* buf, size_t len) {
+		const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+		const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+		const __m128i k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+		const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+		const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+		__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+		__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+		__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+		__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+		x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+		buf += 64;
+		len -= 64;
+
+		while (len >= 64) {
+			__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+			__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+			__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+			__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+			x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+			x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+			x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00)));
+			x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10)));
+			x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20)));
+			x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30)));
+			buf += 64;
+			len -= 64;
+		}
+
+		// Fold the four lanes into one.
+		x1 = Fold128(x1, x2, k3k4);
+		x1 = Fold128(x1, x3, k3k4);
+		x1 = Fold128(x1, x4, k3k4);
+
+		while (len >= 16) {
+			x1 = Fold128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf)), k3k4);
+			buf += 16;
+			len -= 16;
+		}
+
+		// 128 -> 64 bits.
+		x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+		x2 = _mm_srli_si128(x1, 4);
+		x1 = _mm_and_si128(x1, low32);
+		x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		// Barrett reduction to 32 bits.
+		x2 = _mm_and_si128(x1, low32);
+		x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+		x2 = _mm_and_si128(x2, low32);
+		x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+	}
+
+	bool CpuHasPclmul() {
+#ifdef _MSC_VER
+		int regs[4] = {};
+		__cpuid(regs, 1);
+		bool sse2 = (regs[3] & (1 << 26)) != 0;
+		bool pclmul = (regs[2] & (1 << 1)) != 0;
+		return sse2 && pclmul;
+#else
+		return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+#endif
+	}
+#endif
+
+	bool UseFold() {
+#ifdef CRC32_X86
+		static const bool useFold = CpuHasPclmul();
+		return useFold;
+#else
+		return false;
+#endif
+	}
+}
+
+uint32_t Crc32::Update(uint32_t crc, const void* data, size_t length) {
+	const auto* p = static_cast<const unsigned char*>(data);
+	crc = ~crc;
+
+#ifdef CRC32_X86
+	// Folding has a fixed setup and reduction cost; short buffers are
+	// cheaper through the tables.
+	if (length >= 256 && UseFold()) {
+		size_t folded = length & ~static_cast<size_t>(15);
+		crc = UpdateFold(crc, p, folded);
+		p += folded;
+		length -= folded;
+	}
+#endif
+
+	return ~UpdateSlice16(crc, p, length);
+}
+
+const char* Crc32::Name() {
+	return UseFold() ? "PCLMUL" : "slice-by-16";
+}
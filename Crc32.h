@@ -0,0 +1,25 @@
+﻿// ============================================================================
+// Crc32.h - CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320)
+//
+// Same checksum as zlib's crc32().  Large buffers are folded 64 bytes at a
+// time with PCLMULQDQ when the CPU supports it; otherwise, and for the
+// tails, a slice-by-16 table consumes 16 bytes per step.  The choice is
+// made once per process from CPUID.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Crc32 {
+public:
+	// Continue a CRC over `length` more bytes.  Start from crc = 0; the
+	// pre- and post-inversion are handled internally, so chunks can be fed
+	// one after another:  crc = Update(Update(0, a, n), b, m).
+	static uint32_t Update(uint32_t crc, const void* data, size_t length);
+
+	static uint32_t Compute(const void* data, size_t length) { return Update(0, data, length); }
+
+	// Implementation selected for this CPU: "PCLMUL" or "slice-by-16".
+	static const char* Name();
+};
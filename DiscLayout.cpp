@@ -0,0 +1,79 @@
+﻿#define NOMINMAX
+#include "DiscLayout.h"
+#include <algorithm>
+
+// ============================================================================
+// DiscLayout
+// ============================================================================
+
+DiscLayout DiscLayout::ForScan(const DiscInfo& disc) {
+	DiscLayout layout;
+	for (size_t i = 0; i < disc.tracks.size(); i++) {
+		const auto& t = disc.tracks[i];
+		if (!t.isAudio) continue;
+		layout.Add(i, t, (t.trackNumber == 1) ? 0 : t.pregapLBA);
+	}
+	layout.BuildIndex();
+	return layout;
+}
+
+DiscLayout DiscLayout::ForRip(const DiscInfo& disc) {
+	DiscLayout layout;
+	for (size_t i = 0; i < disc.tracks.size(); i++) {
+		const auto& t = disc.tracks[i];
+		if (disc.selectedSession > 0 && t.session != disc.selectedSession) continue;
+		layout.Add(i, t, (disc.pregapMode == PregapMode::Skip) ? t.startLBA : t.pregapLBA);
+	}
+	layout.BuildIndex();
+	return layout;
+}
+
+void DiscLayout::Add(size_t trackIndex, const TrackInfo& track, DWORD firstLBA) {
+	if (track.endLBA < firstLBA) return;   // malformed TOC entry
+
+	Span span;
+	span.trackIndex = trackIndex;
+	span.trackNumber = track.trackNumber;
+	span.isAudio = track.isAudio;
+	span.firstLBA = firstLBA;
+	span.indexLBA = track.startLBA;
+	span.lastLBA = track.endLBA;
+	span.linearStart = m_total;
+	m_total += span.Count();
+	m_spans.push_back(span);
+}
+
+void DiscLayout::BuildIndex() {
+	if (m_spans.empty()) return;
+
+	m_firstLBA = m_spans.front().firstLBA;
+	m_lastLBA = m_spans.front().lastLBA;
+	for (const auto& span : m_spans) {
+		m_firstLBA = std::min(m_firstLBA, span.firstLBA);
+		m_lastLBA = std::max(m_lastLBA, span.lastLBA);
+	}
+
+	m_spanAt.assign(static_cast<size_t>(m_lastLBA - m_firstLBA) + 1, 0);
+	for (size_t s = 0; s < m_spans.size() && s < 255; s++) {    // at most 99 tracks
+		const Span& span = m_spans[s];
+		std::fill(m_spanAt.begin() + (span.firstLBA - m_firstLBA),
+			m_spanAt.begin() + (span.lastLBA - m_firstLBA) + 1, static_cast<BYTE>(s + 1));
+	}
+}
+
+DWORD DiscLayout::LBAAt(DWORD linear) const {
+	auto it = std::upper_bound(m_spans.begin(), m_spans.end(), linear,
+		[](DWORD value, const Span& span) { return value < span.linearStart; });
+	if (it == m_spans.begin()) return m_firstLBA;
+	--it;
+	return it->firstLBA + std::min(linear - it->linearStart, it->Count() - 1);
+}
+
+std::pair<size_t, size_t> DiscLayout::SpansIn(DWORD first, DWORD last) const {
+	// Spans come in TOC order, which is ascending LBA.
+	auto begin = std::lower_bound(m_spans.begin(), m_spans.end(), first,
+		[](const Span& span, DWORD lba) { return span.lastLBA < lba; });
+	auto end = std::upper_bound(begin, m_spans.end(), last,
+		[](DWORD lba, const Span& span) { return lba < span.firstLBA; });
+	return { static_cast<size_t>(begin - m_spans.begin()), static_cast<size_t>(end - m_spans.begin()) };
+}
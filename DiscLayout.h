@@ -0,0 +1,94 @@
+﻿// ============================================================================
+// DiscLayout.h - Immutable LBA / track map of the sectors a scan or rip covers
+//
+// Scans and rip loops each used to rebuild first / last LBA, sector totals
+// and per-track start rules from disc.tracks, with slightly different
+// conventions.  DiscLayout captures the two conventions in one place:
+//   ForScan   audio tracks; track 1 from LBA 0, later tracks from INDEX 00
+//   ForRip    tracks of disc.selectedSession (0 = all); from INDEX 00, or
+//             from INDEX 01 when disc.pregapMode is Skip
+// and answers per-sector questions without searching the track list:
+//   SpanAt / TrackAt / IndexAt / Linear   O(1), one table entry per LBA
+//   SpansIn / LBAAt                       O(log n) over the spans
+//   SecondOf / SecondStartLBA             75-sector buckets of the linear
+//                                         position (per-second statistics)
+// Build it at the start of a scan or rip: pregap detection and the session
+// and pregap-mode choices all change the spans after the TOC is read.
+// ============================================================================
+#pragma once
+
+#include "CDStructures.h"
+#include <utility>
+#include <vector>
+
+class DiscLayout {
+public:
+	// One track's covered sectors, [firstLBA, lastLBA].
+	struct Span {
+		size_t trackIndex = 0;      // into disc.tracks
+		int trackNumber = 0;
+		bool isAudio = true;
+		DWORD firstLBA = 0;
+		DWORD indexLBA = 0;         // INDEX 01 (TrackInfo::startLBA)
+		DWORD lastLBA = 0;
+		DWORD linearStart = 0;      // covered sectors before this span
+
+		DWORD Count() const { return lastLBA - firstLBA + 1; }
+	};
+
+	static constexpr DWORD NOT_COVERED = 0xFFFFFFFF;
+
+	static DiscLayout ForScan(const DiscInfo& disc);
+	static DiscLayout ForRip(const DiscInfo& disc);
+
+	const std::vector<Span>& Spans() const { return m_spans; }
+	bool Empty() const { return m_spans.empty(); }
+	// Lowest and highest covered LBA.
+	DWORD FirstLBA() const { return m_firstLBA; }
+	DWORD LastLBA() const { return m_lastLBA; }
+	DWORD TotalSectors() const { return m_total; }
+	DWORD TotalSeconds() const { return (m_total + 74) / 75; }
+
+	// Span covering lba, or nullptr.
+	const Span* SpanAt(DWORD lba) const {
+		if (lba < m_firstLBA || lba - m_firstLBA >= m_spanAt.size()) return nullptr;
+		BYTE slot = m_spanAt[lba - m_firstLBA];
+		return slot ? &m_spans[slot - 1] : nullptr;
+	}
+	// Track number at lba, 0 if not covered.
+	int TrackAt(DWORD lba) const {
+		const Span* span = SpanAt(lba);
+		return span ? span->trackNumber : 0;
+	}
+	// 0 in the pregap, 1 from INDEX 01 on, -1 if not covered.
+	int IndexAt(DWORD lba) const {
+		const Span* span = SpanAt(lba);
+		return span ? (lba < span->indexLBA ? 0 : 1) : -1;
+	}
+	// Position of lba among the covered sectors, or NOT_COVERED.
+	DWORD Linear(DWORD lba) const {
+		const Span* span = SpanAt(lba);
+		return span ? span->linearStart + (lba - span->firstLBA) : NOT_COVERED;
+	}
+	// Per-second bucket of lba (Linear / 75), or NOT_COVERED.
+	DWORD SecondOf(DWORD lba) const {
+		DWORD linear = Linear(lba);
+		return linear == NOT_COVERED ? NOT_COVERED : linear / 75;
+	}
+	// Inverse of Linear; positions past the end map to LastLBA().
+	DWORD LBAAt(DWORD linear) const;
+	// LBA of the first sector of a per-second bucket.
+	DWORD SecondStartLBA(DWORD second) const { return LBAAt(second * 75); }
+	// Spans intersecting [first, last], as [begin, end) indices into Spans().
+	std::pair<size_t, size_t> SpansIn(DWORD first, DWORD last) const;
+
+private:
+	void Add(size_t trackIndex, const TrackInfo& track, DWORD firstLBA);
+	void BuildIndex();
+
+	std::vector<Span> m_spans;
+	std::vector<BYTE> m_spanAt;     // per LBA from m_firstLBA: span index + 1, 0 = gap
+	DWORD m_firstLBA = 0;
+	DWORD m_lastLBA = 0;
+	DWORD m_total = 0;
+};
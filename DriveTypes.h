@@ -20,6 +20,27 @@ struct DriveHealthCheck {
 	int firmwareErrors = 0;        // Firmware-reported error count
 };
 
+// ── Audio cache profile ─────────────────────────────────────────────────────
+// Measured by ScsiDrive::ProbeCache from read latencies and stored per
+// vendor / model / firmware, so each drive model is only probed once.
+// When no amount of sequential reading the probe tried evicted a sector,
+// the capacity is unknown (cacheSizeKnown false) and cacheSectors is only
+// a lower bound; callers then keep a seek-based defeat.
+struct DriveCacheProfile {
+	bool measured = false;             // False = not probed; callers use fixed defaults
+	bool cacheSizeKnown = false;       // cacheSectors is the measured capacity
+	DWORD cacheSectors = 0;            // Sequential reading that evicts a sector (0 = none kept)
+	DWORD readAheadSectors = 0;        // Sectors prefetched past the last one requested
+	bool farReadEvicts = false;        // A single read elsewhere empties the cache
+	double hitMs = 0.0;                // Median re-read latency of a cached sector
+	double missMs = 0.0;               // Median read latency after a far seek
+
+	// Neither re-reads nor read-ahead were ever served from a cache.
+	bool NoAudioCache() const { return measured && cacheSizeKnown && cacheSectors == 0 && readAheadSectors == 0; }
+	// A cache whose capacity was measured, so defeats can be sized from it.
+	bool Sized() const { return measured && cacheSizeKnown && cacheSectors > 0; }
+};
+
 // ── CD-ROM chipset / controller identification ──────────────────────────────
 // Populated by probing SCSI INQUIRY data, vendor strings, firmware signatures,
 // and known model-to-chipset mappings.  Useful for understanding drive quirks
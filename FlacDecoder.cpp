@@ -0,0 +1,520 @@
+﻿// ============================================================================
+// FlacDecoder.cpp - Metadata, frame decoding and the read window
+// ============================================================================
+#define NOMINMAX
+#include "FlacDecoder.h"
+#include "FlacFormat.h"
+#include "Md5.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+	constexpr size_t INITIAL_WINDOW = 1 << 20;
+	constexpr size_t MAX_WINDOW = 64 << 20;
+	constexpr uint32_t MAX_BLOCK_SIZE = 65536;
+
+	inline int LeadingZeros64(uint64_t v) {    // v != 0
+#ifdef _MSC_VER
+		unsigned long index = 0;
+		if (_BitScanReverse(&index, static_cast<unsigned long>(v >> 32))) return 31 - static_cast<int>(index);
+		_BitScanReverse(&index, static_cast<unsigned long>(v));
+		return 63 - static_cast<int>(index);
+#else
+		return __builtin_clzll(v);
+#endif
+	}
+
+	// ── Bit reader ─────────────────────────────────────────────────────────
+	// MSB-first over a memory range.  Reading past the end returns zeros
+	// and sets Overrun(), so a frame cut off by the read window can be
+	// retried once more of the file is in.
+	class BitReader {
+	public:
+		BitReader(const uint8_t* data, size_t size) : m_data(data), m_next(data), m_end(data + size) {}
+
+		// bits <= 32
+		uint32_t Read(int bits) {
+			if (bits == 0) return 0;
+			if (m_cacheBits < bits) Refill();
+			if (m_cacheBits < bits) {
+				m_overrun = true;
+				m_cache = 0;
+				m_cacheBits = 0;
+				return 0;
+			}
+			uint32_t v = static_cast<uint32_t>(m_cache >> (64 - bits));
+			m_cache <<= bits;
+			m_cacheBits -= bits;
+			return v;
+		}
+
+		int32_t ReadSigned(int bits) {
+			if (bits == 0) return 0;
+			uint32_t v = Read(bits);
+			return static_cast<int32_t>(v << (32 - bits)) >> (32 - bits);
+		}
+
+		// Zero bits up to the next one, which is consumed.
+		uint32_t ReadUnary() {
+			uint32_t zeros = 0;
+			for (;;) {
+				// Bits below the cached ones are always zero, so any set bit
+				// is a real one.
+				if (m_cache != 0) {
+					int lz = LeadingZeros64(m_cache);
+					m_cache <<= lz;
+					m_cache <<= 1;
+					m_cacheBits -= lz + 1;
+					return zeros + static_cast<uint32_t>(lz);
+				}
+				zeros += static_cast<uint32_t>(m_cacheBits);
+				m_cacheBits = 0;
+				Refill();
+				if (m_cacheBits == 0) {
+					m_overrun = true;
+					return 0;
+				}
+			}
+		}
+
+		void AlignByte() {
+			int drop = m_cacheBits & 7;
+			m_cache <<= drop;
+			m_cacheBits -= drop;
+		}
+
+		// Bytes consumed; only meaningful on a byte boundary.
+		size_t BytePosition() const { return static_cast<size_t>(m_next - m_data) - m_cacheBits / 8; }
+		bool Overrun() const { return m_overrun; }
+
+	private:
+		void Refill() {
+			while (m_cacheBits <= 56 && m_next < m_end) {
+				m_cache |= static_cast<uint64_t>(*m_next++) << (56 - m_cacheBits);
+				m_cacheBits += 8;
+			}
+		}
+
+		const uint8_t* m_data;
+		const uint8_t* m_next;
+		const uint8_t* m_end;
+		uint64_t m_cache = 0;       // MSB-aligned, zero below m_cacheBits
+		int m_cacheBits = 0;
+		bool m_overrun = false;
+	};
+
+	// ── Frames ─────────────────────────────────────────────────────────────
+
+	enum class FrameResult { Ok, NeedMore, Corrupt };
+
+	class FrameDecoder {
+	public:
+		// Decodes the frame at the start of [data, data + size) into `out`
+		// (room for `maxSamples`).  NeedMore when the frame runs past `size`
+		// and more of the file exists.
+		FrameResult Decode(const uint8_t* data, size_t size, bool eof, uint8_t* out, uint64_t maxSamples,
+			uint32_t& samples, size_t& frameBytes, std::string& error) {
+			BitReader br(data, size);
+			bool ok = DecodeFrame(br, data, samples, error);
+			if (br.Overrun()) {
+				if (!eof) return FrameResult::NeedMore;
+				error = "file is truncated";
+				return FrameResult::Corrupt;
+			}
+			if (!ok) return FrameResult::Corrupt;
+			if (samples > maxSamples) {
+				error = "more audio than STREAMINFO declares";
+				return FrameResult::Corrupt;
+			}
+			frameBytes = br.BytePosition();
+
+			for (uint32_t i = 0; i < samples; i++) {
+				int32_t l = m_left[i], r = m_right[i];
+				if (l < INT16_MIN || l > INT16_MAX || r < INT16_MIN || r > INT16_MAX) {
+					error = "sample out of 16-bit range";
+					return FrameResult::Corrupt;
+				}
+				uint8_t* s = out + static_cast<size_t>(i) * 4;
+				s[0] = static_cast<uint8_t>(l);
+				s[1] = static_cast<uint8_t>(l >> 8);
+				s[2] = static_cast<uint8_t>(r);
+				s[3] = static_cast<uint8_t>(r >> 8);
+			}
+			return FrameResult::Ok;
+		}
+
+	private:
+		bool DecodeFrame(BitReader& br, const uint8_t* data, uint32_t& samples, std::string& error) {
+			if (br.Read(15) != 0x7FFC) {
+				error = "lost frame sync";
+				return false;
+			}
+			br.Read(1);                 // Blocking strategy: either is fine
+			uint32_t bsCode = br.Read(4);
+			uint32_t rateCode = br.Read(4);
+			uint32_t channels = br.Read(4);
+			uint32_t sizeCode = br.Read(3);
+			if (br.Read(1) != 0 || bsCode == 0 || rateCode == 15 || channels > 10) {
+				error = "invalid frame header";
+				return false;
+			}
+			if (channels != 1 && channels < 8) {
+				error = "frame is not stereo";
+				return false;
+			}
+			if (sizeCode != 0 && sizeCode != 4) {
+				error = "frame is not 16-bit";
+				return false;
+			}
+
+			// Frame or sample number, UTF-8 style; only its form is checked.
+			uint32_t lead = br.Read(8);
+			int extra = 0;
+			while (extra < 8 && (lead & (0x80u >> extra))) extra++;
+			if (extra == 1 || extra == 8) {
+				error = "invalid frame number";
+				return false;
+			}
+			for (int i = 1; i < extra; i++) {
+				if ((br.Read(8) & 0xC0) != 0x80) {
+					error = "invalid frame number";
+					return false;
+				}
+			}
+
+			uint32_t n = 0;
+			if (bsCode == 1) n = 192;
+			else if (bsCode <= 5) n = 576u << (bsCode - 2);
+			else if (bsCode == 6) n = br.Read(8) + 1;
+			else if (bsCode == 7) n = br.Read(16) + 1;
+			else n = 256u << (bsCode - 8);
+
+			uint32_t rate = Flac::CD_SAMPLE_RATE;
+			if (rateCode == 12) rate = br.Read(8) * 1000;
+			else if (rateCode == 13) rate = br.Read(16);
+			else if (rateCode == 14) rate = br.Read(16) * 10;
+			else if (rateCode != 0 && rateCode != 9) rate = 0;
+			if (rate != Flac::CD_SAMPLE_RATE) {
+				error = "frame is not 44100 Hz";
+				return false;
+			}
+
+			size_t headerBytes = br.BytePosition();
+			if (br.Read(8) != Flac::Crc8(data, headerBytes) && !br.Overrun()) {
+				error = "frame header CRC mismatch";
+				return false;
+			}
+
+			m_left.resize(n);
+			m_right.resize(n);
+			// 8 = left/side, 9 = side/right, 10 = mid/side; the side channel
+			// carries one extra bit.
+			const int bps = static_cast<int>(Flac::CD_BITS_PER_SAMPLE);
+			if (!Subframe(br, m_left.data(), n, bps + (channels == 9 ? 1 : 0), error) ||
+				!Subframe(br, m_right.data(), n, bps + (channels == 8 || channels == 10 ? 1 : 0), error)) {
+				return false;
+			}
+
+			br.AlignByte();
+			size_t bodyBytes = br.BytePosition();
+			if (br.Read(16) != Flac::Crc16(data, bodyBytes) && !br.Overrun()) {
+				error = "frame CRC mismatch";
+				return false;
+			}
+
+			for (uint32_t i = 0; i < n; i++) {
+				int32_t a = m_left[i], b = m_right[i];
+				switch (channels) {
+				case 8: m_right[i] = a - b; break;
+				case 9: m_left[i] = a + b; break;
+				case 10: {
+					int32_t mid = (a * 2) | (b & 1);
+					m_left[i] = (mid + b) >> 1;
+					m_right[i] = (mid - b) >> 1;
+					break;
+				}
+				default: break;
+				}
+			}
+			samples = n;
+			return true;
+		}
+
+		bool Subframe(BitReader& br, int32_t* x, uint32_t n, int bps, std::string& error) {
+			if (br.Read(1) != 0) {
+				error = "invalid subframe header";
+				return false;
+			}
+			uint32_t type = br.Read(6);
+			int wasted = 0;
+			if (br.Read(1)) wasted = static_cast<int>(br.ReadUnary()) + 1;
+			if (wasted >= bps) {
+				error = "invalid wasted bits";
+				return false;
+			}
+			bps -= wasted;
+
+			if (type == 0) {
+				std::fill(x, x + n, br.ReadSigned(bps));
+			}
+			else if (type == 1) {
+				for (uint32_t i = 0; i < n; i++) x[i] = br.ReadSigned(bps);
+			}
+			else if (type >= 8 && type <= 12) {
+				uint32_t order = type - 8;
+				if (order > n) {
+					error = "predictor order exceeds block size";
+					return false;
+				}
+				for (uint32_t i = 0; i < order; i++) x[i] = br.ReadSigned(bps);
+				if (!Residual(br, x + order, n, order, error)) return false;
+				for (uint32_t i = order; i < n; i++) {
+					int64_t r = x[i];
+					switch (order) {
+					case 0: break;
+					case 1: r += x[i - 1]; break;
+					case 2: r += 2 * static_cast<int64_t>(x[i - 1]) - x[i - 2]; break;
+					case 3: r += 3 * static_cast<int64_t>(x[i - 1]) - 3 * static_cast<int64_t>(x[i - 2]) + x[i - 3]; break;
+					default: r += 4 * static_cast<int64_t>(x[i - 1]) - 6 * static_cast<int64_t>(x[i - 2]) +
+						4 * static_cast<int64_t>(x[i - 3]) - x[i - 4]; break;
+					}
+					x[i] = static_cast<int32_t>(r);
+				}
+			}
+			else if (type >= 32) {
+				uint32_t order = type - 31;
+				if (order > n) {
+					error = "predictor order exceeds block size";
+					return false;
+				}
+				for (uint32_t i = 0; i < order; i++) x[i] = br.ReadSigned(bps);
+				int precision = static_cast<int>(br.Read(4)) + 1;
+				int shift = br.ReadSigned(5);
+				if (precision == 16 || shift < 0) {
+					error = "invalid LPC parameters";
+					return false;
+				}
+				int32_t coefs[32];
+				for (uint32_t j = 0; j < order; j++) coefs[j] = br.ReadSigned(precision);
+				if (!Residual(br, x + order, n, order, error)) return false;
+				for (uint32_t i = order; i < n; i++) {
+					int64_t sum = 0;
+					for (uint32_t j = 0; j < order; j++) sum += static_cast<int64_t>(coefs[j]) * x[i - 1 - j];
+					x[i] = static_cast<int32_t>(x[i] + (sum >> shift));
+				}
+			}
+			else {
+				error = "reserved subframe type";
+				return false;
+			}
+
+			if (wasted > 0) {
+				for (uint32_t i = 0; i < n; i++) x[i] = static_cast<int32_t>(static_cast<uint32_t>(x[i]) << wasted);
+			}
+			return true;
+		}
+
+		// Residual of an order-`order` predictor for an n-sample block.
+		bool Residual(BitReader& br, int32_t* residual, uint32_t n, uint32_t order, std::string& error) {
+			uint32_t method = br.Read(2);
+			if (method > 1) {
+				error = "reserved residual coding method";
+				return false;
+			}
+			const int paramBits = method == 0 ? 4 : 5;
+			const uint32_t escape = (1u << paramBits) - 1;
+			uint32_t po = br.Read(4);
+			uint32_t partSize = n >> po;
+			if ((partSize << po) != n || partSize < order) {
+				error = "invalid residual partition order";
+				return false;
+			}
+
+			uint32_t pos = 0;
+			for (uint32_t p = 0; p < (1u << po); p++) {
+				uint32_t count = partSize - (p == 0 ? order : 0);
+				uint32_t k = br.Read(paramBits);
+				if (k == escape) {
+					int bits = static_cast<int>(br.Read(5));
+					for (uint32_t i = 0; i < count; i++) residual[pos++] = br.ReadSigned(bits);
+					continue;
+				}
+				for (uint32_t i = 0; i < count; i++) {
+					uint32_t q = br.ReadUnary();
+					if (q > (UINT32_MAX >> k)) {
+						error = "residual out of range";
+						return false;
+					}
+					uint32_t u = (q << k) | br.Read(static_cast<int>(k));
+					residual[pos++] = static_cast<int32_t>(u >> 1) ^ -static_cast<int32_t>(u & 1);
+				}
+				if (br.Overrun()) return true;  // Caller sees the overrun
+			}
+			return true;
+		}
+
+		std::vector<int32_t> m_left;
+		std::vector<int32_t> m_right;
+	};
+}
+
+// ============================================================================
+// Metadata
+// ============================================================================
+
+bool FlacDecoder::Open(const std::wstring& path, std::string& error) {
+	m_in.close();
+	m_in.clear();
+	m_in.open(std::filesystem::path(path), std::ios::binary);
+	if (!m_in) {
+		error = "cannot open file";
+		return false;
+	}
+
+	uint8_t magic[10] = {};
+	m_in.read(reinterpret_cast<char*>(magic), 4);
+	if (memcmp(magic, "ID3", 3) == 0) {
+		// An ID3v2 tag in front of the stream (some taggers add one).
+		m_in.read(reinterpret_cast<char*>(magic + 4), 6);
+		uint32_t tagBytes = ((magic[6] & 0x7F) << 21) | ((magic[7] & 0x7F) << 14) |
+			((magic[8] & 0x7F) << 7) | (magic[9] & 0x7F);
+		if (magic[5] & 0x10) tagBytes += 10;    // Footer
+		m_in.seekg(tagBytes, std::ios::cur);
+		m_in.read(reinterpret_cast<char*>(magic), 4);
+	}
+	if (!m_in || memcmp(magic, "fLaC", 4) != 0) {
+		error = "not a FLAC file";
+		return false;
+	}
+
+	bool first = true;
+	bool last = false;
+	uint32_t sampleRate = 0, channels = 0, bitsPerSample = 0;
+	while (!last) {
+		uint8_t header[4];
+		m_in.read(reinterpret_cast<char*>(header), 4);
+		if (!m_in) {
+			error = "truncated metadata";
+			return false;
+		}
+		last = (header[0] & 0x80) != 0;
+		uint32_t type = header[0] & 0x7F;
+		uint32_t length = (header[1] << 16) | (header[2] << 8) | header[3];
+
+		if (first != (type == 0)) {
+			error = "STREAMINFO is not the first metadata block";
+			return false;
+		}
+		first = false;
+
+		if (type != 0) {
+			m_in.seekg(length, std::ios::cur);
+			continue;
+		}
+
+		uint8_t info[34];
+		if (length != sizeof(info) || !m_in.read(reinterpret_cast<char*>(info), sizeof(info))) {
+			error = "invalid STREAMINFO";
+			return false;
+		}
+		BitReader br(info, sizeof(info));
+		br.Read(16);                    // Min block size
+		uint32_t maxBlock = br.Read(16);
+		br.Read(24);                    // Min frame size
+		m_maxFrameBytes = br.Read(24);
+		sampleRate = br.Read(20);
+		channels = br.Read(3) + 1;
+		bitsPerSample = br.Read(5) + 1;
+		m_totalSamples = static_cast<uint64_t>(br.Read(4)) << 32;
+		m_totalSamples |= br.Read(32);
+		memcpy(m_md5, info + 18, 16);
+		if (maxBlock > MAX_BLOCK_SIZE) {
+			error = "invalid STREAMINFO";
+			return false;
+		}
+	}
+
+	if (sampleRate != Flac::CD_SAMPLE_RATE) { error = "sample rate is not 44100 Hz"; return false; }
+	if (channels != Flac::CD_CHANNELS) { error = "not stereo"; return false; }
+	if (bitsPerSample != Flac::CD_BITS_PER_SAMPLE) { error = "not 16-bit"; return false; }
+	if (m_totalSamples == 0) { error = "stream length not recorded in STREAMINFO"; return false; }
+
+	m_buffer.clear();
+	m_pos = 0;
+	m_len = 0;
+	m_eof = false;
+	return true;
+}
+
+// ============================================================================
+// Audio
+// ============================================================================
+
+// At least `minimum` unconsumed bytes, or everything up to the end of the
+// file.  Reads ahead by as much again, so compaction stays rare.
+bool FlacDecoder::Fill(size_t minimum) {
+	if (m_len - m_pos >= minimum || m_eof) return true;
+
+	memmove(m_buffer.data(), m_buffer.data() + m_pos, m_len - m_pos);
+	m_len -= m_pos;
+	m_pos = 0;
+	if (m_buffer.size() < 2 * minimum) m_buffer.resize(2 * minimum);
+
+	m_in.read(reinterpret_cast<char*>(m_buffer.data() + m_len),
+		static_cast<std::streamsize>(m_buffer.size() - m_len));
+	m_len += static_cast<size_t>(m_in.gcount());
+	if (m_in.eof()) m_eof = true;
+	else if (!m_in) return false;
+	return true;
+}
+
+bool FlacDecoder::DecodeTo(uint8_t* out, std::string& error) {
+	FrameDecoder frame;
+	Md5 md5;
+	uint64_t done = 0;
+	size_t window = std::max<size_t>(INITIAL_WINDOW, 2 * static_cast<size_t>(m_maxFrameBytes));
+
+	while (done < m_totalSamples) {
+		if (!Fill(window)) {
+			error = "read error";
+			return false;
+		}
+		if (m_pos == m_len) {
+			error = "file ends before the last sample";
+			return false;
+		}
+
+		uint32_t samples = 0;
+		size_t frameBytes = 0;
+		uint8_t* dst = out + done * 4;
+		FrameResult result = frame.Decode(m_buffer.data() + m_pos, m_len - m_pos, m_eof, dst,
+			m_totalSamples - done, samples, frameBytes, error);
+		if (result == FrameResult::NeedMore) {
+			if (window >= MAX_WINDOW) {
+				error = "frame too large";
+				return false;
+			}
+			window *= 2;
+			continue;
+		}
+		if (result == FrameResult::Corrupt) return false;
+
+		md5.Update(dst, static_cast<size_t>(samples) * 4);
+		done += samples;
+		m_pos += frameBytes;
+	}
+
+	// An all-zero signature means the encoder did not compute one.
+	uint8_t digest[16];
+	md5.Final(digest);
+	static const uint8_t unset[16] = {};
+	if (memcmp(m_md5, unset, 16) != 0 && memcmp(m_md5, digest, 16) != 0) {
+		error = "MD5 mismatch — decoded audio differs from what was encoded";
+		return false;
+	}
+	return true;
+}
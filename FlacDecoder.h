@@ -0,0 +1,46 @@
+﻿// ============================================================================
+// FlacDecoder.h - Streaming FLAC decoder for CD-format audio
+//
+// Decodes a 16-bit stereo 44100 Hz FLAC file straight into caller memory
+// in the CD sample layout (little-endian L/R pairs) — e.g. a SectorStore
+// range, with no intermediate WAV.  The file is read through a window a
+// few frames deep, so memory use does not grow with the track.
+//
+// Every frame's CRC-8 and CRC-16 is checked and the output is hashed on the
+// way through; a STREAMINFO MD5 that does not match fails the decode.
+// Any valid encoder's output is accepted: fixed or variable block sizes,
+// every stereo decorrelation, wasted bits, escaped Rice partitions.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class FlacDecoder {
+public:
+	// Reads the metadata.  False, with `error` set, unless the file is a
+	// FLAC stream of 16-bit stereo 44100 Hz audio of known length.
+	bool Open(const std::wstring& path, std::string& error);
+
+	uint64_t TotalSamples() const { return m_totalSamples; }
+	uint64_t PcmBytes() const { return m_totalSamples * 4; }
+
+	// Decodes the whole stream into `out` (PcmBytes() bytes).
+	bool DecodeTo(uint8_t* out, std::string& error);
+
+private:
+	bool Fill(size_t minimum);
+
+	std::ifstream m_in;
+	std::vector<uint8_t> m_buffer;  // Unconsumed file bytes in [m_pos, m_len)
+	size_t m_pos = 0;
+	size_t m_len = 0;
+	bool m_eof = false;
+
+	uint64_t m_totalSamples = 0;
+	uint32_t m_maxFrameBytes = 0;
+	uint8_t m_md5[16] = {};
+};
@@ -0,0 +1,637 @@
+﻿// ============================================================================
+// FlacEncoder.cpp - Frame analysis, bitstream writer and the encode queue
+// ============================================================================
+#define NOMINMAX
+#include "FlacEncoder.h"
+#include "FlacFormat.h"
+#include "Md5.h"
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace {
+	constexpr uint32_t SAMPLE_RATE = Flac::CD_SAMPLE_RATE;
+	constexpr uint32_t BLOCK_SIZE = 4096;
+	constexpr int BITS_PER_SAMPLE = Flac::CD_BITS_PER_SAMPLE;
+	constexpr int MAX_FIXED_ORDER = 4;
+	constexpr int MAX_LPC_ORDER = 12;
+	constexpr int QLP_PRECISION = 15;       // Coefficient bits, sign included
+	constexpr int MAX_PARTITION_ORDER = 8;
+	constexpr int MAX_RICE_PARAM = 14;      // 4-bit parameters; 15 is the escape
+	constexpr int MAX_RICE2_PARAM = 30;     // 5-bit parameters; 31 is the escape
+	constexpr uint32_t PADDING_BYTES = 8192;
+	constexpr const char* VENDOR = "AudioCopy";
+
+	using Flac::Crc8;
+	using Flac::Crc16;
+
+	// ── Bit writer ─────────────────────────────────────────────────────────
+	// MSB-first, as every FLAC field is.
+	class BitWriter {
+	public:
+		void Clear() { m_bytes.clear(); m_acc = 0; m_bits = 0; }
+
+		// bits <= 32
+		void Write(uint32_t value, int bits) {
+			if (bits == 0) return;
+			m_acc = (m_acc << bits) | (value & (0xFFFFFFFFull >> (32 - bits)));
+			m_bits += bits;
+			while (m_bits >= 8) {
+				m_bits -= 8;
+				m_bytes.push_back(static_cast<uint8_t>(m_acc >> m_bits));
+			}
+		}
+		void WriteSigned(int32_t value, int bits) { Write(static_cast<uint32_t>(value), bits); }
+
+		// `zeros` zero bits and a one.
+		void WriteUnary(uint32_t zeros) {
+			while (zeros >= 32) {
+				Write(0, 32);
+				zeros -= 32;
+			}
+			Write(1, static_cast<int>(zeros) + 1);
+		}
+
+		void WriteRice(uint32_t folded, int param) {
+			uint32_t q = folded >> param;
+			if (q + 1 + param <= 32) {
+				// Quotient zeros, stop bit and remainder in one go.
+				Write((1u << param) | (folded & ((1u << param) - 1)), static_cast<int>(q) + 1 + param);
+				return;
+			}
+			WriteUnary(q);
+			Write(folded, param);
+		}
+
+		// UTF-8-style coding of the frame number.
+		void WriteUtf8(uint32_t v) {
+			if (v < 0x80) { Write(v, 8); return; }
+			int extra = v < 0x800 ? 1 : v < 0x10000 ? 2 : v < 0x200000 ? 3 : v < 0x4000000 ? 4 : 5;
+			Write((0xFF00u >> (extra + 1)) | (v >> (6 * extra)), 8);
+			for (int i = extra - 1; i >= 0; i--) Write(0x80 | ((v >> (6 * i)) & 0x3F), 8);
+		}
+
+		void AlignByte() { if (m_bits > 0) Write(0, 8 - m_bits); }
+
+		const std::vector<uint8_t>& Bytes() const { return m_bytes; }
+
+	private:
+		std::vector<uint8_t> m_bytes;
+		uint64_t m_acc = 0;
+		int m_bits = 0;
+	};
+
+	inline uint32_t Fold(int32_t r) {
+		return (static_cast<uint32_t>(r) << 1) ^ static_cast<uint32_t>(r >> 31);
+	}
+
+	// ── Residual coding plan ───────────────────────────────────────────────
+
+	struct RicePlan {
+		int partitionOrder = 0;
+		bool rice2 = false;
+		int params[1 << MAX_PARTITION_ORDER] = {};
+		uint64_t bits = 0;      // Partition header, parameters and codes
+	};
+
+	// Best parameter for `n` folded residuals summing to `sum`, and its cost
+	// under the usual n * (k + 1) + sum / 2^k estimate.
+	int RiceParam(uint64_t sum, uint32_t n, uint64_t& bits) {
+		if (n == 0) {
+			bits = 0;
+			return 0;
+		}
+		int k = 0;
+		while (k < MAX_RICE2_PARAM && (static_cast<uint64_t>(n) << (k + 1)) <= sum) k++;
+		int best = k;
+		bits = UINT64_MAX;
+		for (int c = std::max(0, k - 1); c <= std::min(MAX_RICE2_PARAM, k + 1); c++) {
+			uint64_t b = static_cast<uint64_t>(n) * (c + 1) + (sum >> c);
+			if (b < bits) {
+				bits = b;
+				best = c;
+			}
+		}
+		return best;
+	}
+
+	// Chooses the partition order and parameters for residual[0, n - order)
+	// of an n-sample block.  `sums` is scratch.
+	void PlanRice(const int32_t* residual, uint32_t n, int order, std::vector<uint64_t>& sums,
+		RicePlan& plan) {
+		int maxOrder = 0;
+		while (maxOrder < MAX_PARTITION_ORDER && (n % (2u << maxOrder)) == 0 &&
+			(n >> (maxOrder + 1)) > static_cast<uint32_t>(order)) {
+			maxOrder++;
+		}
+
+		// Sums at the finest order; coarser orders add neighbours.
+		const uint32_t parts = 1u << maxOrder;
+		const uint32_t partSize = n >> maxOrder;
+		sums.assign(parts, 0);
+		uint32_t pos = 0;
+		for (uint32_t p = 0; p < parts; p++) {
+			uint32_t end = (p + 1) * partSize - order;
+			uint64_t s = 0;
+			for (; pos < end; pos++) s += Fold(residual[pos]);
+			sums[p] = s;
+		}
+
+		plan.bits = UINT64_MAX;
+		for (int po = maxOrder; po >= 0; po--) {
+			const uint32_t count = 1u << po;
+			uint64_t bits = 6;      // Coding method and partition order
+			bool rice2 = false;
+			int params[1 << MAX_PARTITION_ORDER];
+			for (uint32_t p = 0; p < count; p++) {
+				uint32_t samples = (n >> po) - (p == 0 ? order : 0);
+				uint64_t b = 0;
+				params[p] = RiceParam(sums[p], samples, b);
+				if (params[p] > MAX_RICE_PARAM) rice2 = true;
+				bits += b;
+			}
+			bits += static_cast<uint64_t>(count) * (rice2 ? 5 : 4);
+			if (bits < plan.bits) {
+				plan.bits = bits;
+				plan.partitionOrder = po;
+				plan.rice2 = rice2;
+				std::copy(params, params + count, plan.params);
+			}
+			if (po > 0) {
+				for (uint32_t p = 0; p < count / 2; p++) sums[p] = sums[2 * p] + sums[2 * p + 1];
+			}
+		}
+	}
+
+	void WriteResidual(BitWriter& bw, const int32_t* residual, uint32_t n, int order,
+		const RicePlan& plan) {
+		bw.Write(plan.rice2 ? 1 : 0, 2);
+		bw.Write(static_cast<uint32_t>(plan.partitionOrder), 4);
+		const int paramBits = plan.rice2 ? 5 : 4;
+		const uint32_t count = 1u << plan.partitionOrder;
+		uint32_t pos = 0;
+		for (uint32_t p = 0; p < count; p++) {
+			uint32_t samples = (n >> plan.partitionOrder) - (p == 0 ? order : 0);
+			int k = plan.params[p];
+			bw.Write(static_cast<uint32_t>(k), paramBits);
+			for (uint32_t i = 0; i < samples; i++, pos++) bw.WriteRice(Fold(residual[pos]), k);
+		}
+	}
+
+	// ── Subframes ──────────────────────────────────────────────────────────
+
+	enum class SubframeType { Constant, Verbatim, Fixed, Lpc };
+
+	struct Subframe {
+		SubframeType type = SubframeType::Verbatim;
+		int order = 0;
+		int shift = 0;
+		int32_t coefs[MAX_LPC_ORDER] = {};
+		std::vector<int32_t> residual;
+		RicePlan rice;
+		uint64_t bits = 0;
+	};
+
+	// Everything one channel needs, reused across blocks.
+	class ChannelAnalyzer {
+	public:
+		// Fills `out` with the cheapest encoding of x[0, n) at `bps` bits.
+		void Analyze(const int32_t* x, uint32_t n, int bps, Subframe& out) {
+			out.type = SubframeType::Verbatim;
+			out.bits = 8 + static_cast<uint64_t>(n) * bps;
+
+			if (std::all_of(x + 1, x + n, [&](int32_t v) { return v == x[0]; })) {
+				out.type = SubframeType::Constant;
+				out.bits = 8 + bps;
+				return;
+			}
+
+			TryFixed(x, n, bps, out);
+			TryLpc(x, n, bps, out);
+		}
+
+	private:
+		void TryFixed(const int32_t* x, uint32_t n, int bps, Subframe& out) {
+			// Pick the order with the smallest absolute residual, then cost it.
+			uint64_t err[MAX_FIXED_ORDER + 1] = {};
+			for (uint32_t i = MAX_FIXED_ORDER; i < n; i++) {
+				int64_t e0 = x[i];
+				int64_t e1 = e0 - x[i - 1];
+				int64_t e2 = e1 - (static_cast<int64_t>(x[i - 1]) - x[i - 2]);
+				int64_t e3 = e2 - (static_cast<int64_t>(x[i - 1]) - 2 * static_cast<int64_t>(x[i - 2]) + x[i - 3]);
+				int64_t e4 = e3 - (static_cast<int64_t>(x[i - 1]) - 3 * static_cast<int64_t>(x[i - 2]) +
+					3 * static_cast<int64_t>(x[i - 3]) - x[i - 4]);
+				err[0] += static_cast<uint64_t>(e0 < 0 ? -e0 : e0);
+				err[1] += static_cast<uint64_t>(e1 < 0 ? -e1 : e1);
+				err[2] += static_cast<uint64_t>(e2 < 0 ? -e2 : e2);
+				err[3] += static_cast<uint64_t>(e3 < 0 ? -e3 : e3);
+				err[4] += static_cast<uint64_t>(e4 < 0 ? -e4 : e4);
+			}
+			int order = 0;
+			const int maxOrder = std::min<int>(MAX_FIXED_ORDER, static_cast<int>(n) - 1);
+			for (int o = 1; o <= maxOrder; o++) {
+				if (err[o] < err[order]) order = o;
+			}
+
+			m_residual.resize(n);
+			for (uint32_t i = order; i < n; i++) {
+				int64_t r;
+				switch (order) {
+				case 0: r = x[i]; break;
+				case 1: r = static_cast<int64_t>(x[i]) - x[i - 1]; break;
+				case 2: r = static_cast<int64_t>(x[i]) - 2 * static_cast<int64_t>(x[i - 1]) + x[i - 2]; break;
+				case 3: r = static_cast<int64_t>(x[i]) - 3 * static_cast<int64_t>(x[i - 1]) +
+					3 * static_cast<int64_t>(x[i - 2]) - x[i - 3]; break;
+				default: r = static_cast<int64_t>(x[i]) - 4 * static_cast<int64_t>(x[i - 1]) +
+					6 * static_cast<int64_t>(x[i - 2]) - 4 * static_cast<int64_t>(x[i - 3]) + x[i - 4]; break;
+				}
+				m_residual[i - order] = static_cast<int32_t>(r);
+			}
+
+			RicePlan plan;
+			PlanRice(m_residual.data(), n, order, m_sums, plan);
+			uint64_t bits = 8 + static_cast<uint64_t>(order) * bps + plan.bits;
+			if (bits < out.bits) {
+				out.type = SubframeType::Fixed;
+				out.order = order;
+				out.rice = plan;
+				out.bits = bits;
+				out.residual.assign(m_residual.begin(), m_residual.begin() + (n - order));
+			}
+		}
+
+		void TryLpc(const int32_t* x, uint32_t n, int bps, Subframe& out) {
+			const int maxOrder = std::min<int>(MAX_LPC_ORDER, static_cast<int>(n) - 1);
+			if (maxOrder < 1) return;
+
+			// Tukey(0.5) window: flat middle, raised-cosine quarter at each end.
+			if (m_window.size() != n) {
+				m_window.resize(n);
+				const uint32_t taper = std::max<uint32_t>(1, n / 4);
+				const double pi = 3.14159265358979323846;
+				for (uint32_t i = 0; i < n; i++) {
+					double w = 1.0;
+					if (i < taper) w = 0.5 - 0.5 * std::cos(pi * i / taper);
+					else if (i >= n - taper) w = 0.5 - 0.5 * std::cos(pi * (n - 1 - i) / taper);
+					m_window[i] = w;
+				}
+			}
+			m_windowed.resize(n);
+			for (uint32_t i = 0; i < n; i++) m_windowed[i] = x[i] * m_window[i];
+
+			double autoc[MAX_LPC_ORDER + 1];
+			for (int lag = 0; lag <= maxOrder; lag++) {
+				double s = 0.0;
+				for (uint32_t i = lag; i < n; i++) s += m_windowed[i] * m_windowed[i - lag];
+				autoc[lag] = s;
+			}
+			if (autoc[0] <= 0.0) return;
+
+			// Levinson-Durbin: lp[o - 1] predicts with order o.
+			double lp[MAX_LPC_ORDER][MAX_LPC_ORDER];
+			double error[MAX_LPC_ORDER];
+			double a[MAX_LPC_ORDER] = {};
+			double err = autoc[0];
+			int orders = maxOrder;
+			for (int i = 0; i < maxOrder; i++) {
+				double r = -autoc[i + 1];
+				for (int j = 0; j < i; j++) r -= a[j] * autoc[i - j];
+				r /= err;
+				a[i] = r;
+				for (int j = 0; j < i / 2; j++) {
+					double t = a[j];
+					a[j] += r * a[i - 1 - j];
+					a[i - 1 - j] += r * t;
+				}
+				if (i & 1) a[i / 2] += a[i / 2] * r;
+				err *= (1.0 - r * r);
+				for (int j = 0; j <= i; j++) lp[i][j] = -a[j];
+				error[i] = err;
+				if (err <= 0.0) {
+					orders = i + 1;
+					break;
+				}
+			}
+
+			// Order with the fewest expected bits: residual entropy from the
+			// prediction error, plus warm-up samples and coefficients.
+			int order = 1;
+			double bestBits = 1e300;
+			for (int o = 1; o <= orders; o++) {
+				double perSample = error[o - 1] > 0.0
+					? std::max(0.0, 0.5 * std::log2(0.5 * error[o - 1] / n)) : 0.0;
+				double bits = perSample * (n - o) + static_cast<double>(o) * (bps + QLP_PRECISION);
+				if (bits < bestBits) {
+					bestBits = bits;
+					order = o;
+				}
+			}
+
+			int32_t qlp[MAX_LPC_ORDER];
+			int shift = 0;
+			if (!Quantize(lp[order - 1], order, qlp, shift)) return;
+
+			m_residual.resize(n);
+			for (uint32_t i = order; i < n; i++) {
+				int64_t sum = 0;
+				for (int j = 0; j < order; j++) sum += static_cast<int64_t>(qlp[j]) * x[i - 1 - j];
+				int64_t r = x[i] - (sum >> shift);
+				// Residuals must fit the 32-bit range the format allows.
+				if (r > INT32_MAX / 2 || r < INT32_MIN / 2) return;
+				m_residual[i - order] = static_cast<int32_t>(r);
+			}
+
+			RicePlan plan;
+			PlanRice(m_residual.data(), n, order, m_sums, plan);
+			uint64_t bits = 8 + static_cast<uint64_t>(order) * bps + 4 + 5 +
+				static_cast<uint64_t>(order) * QLP_PRECISION + plan.bits;
+			if (bits < out.bits) {
+				out.type = SubframeType::Lpc;
+				out.order = order;
+				out.shift = shift;
+				std::copy(qlp, qlp + order, out.coefs);
+				out.rice = plan;
+				out.bits = bits;
+				out.residual.assign(m_residual.begin(), m_residual.begin() + (n - order));
+			}
+		}
+
+		// Coefficients to QLP_PRECISION-bit integers with a shared shift;
+		// rounding error is carried into the next coefficient.
+		static bool Quantize(const double* lp, int order, int32_t* qlp, int& shift) {
+			double cmax = 0.0;
+			for (int j = 0; j < order; j++) cmax = std::max(cmax, std::fabs(lp[j]));
+			if (cmax <= 0.0) return false;
+
+			int log2cmax = 0;
+			std::frexp(cmax, &log2cmax);
+			shift = QLP_PRECISION - 1 - log2cmax;
+			if (shift > 15) shift = 15;
+			if (shift < 0) return false;    // Coefficients too large to represent
+
+			const int32_t qmax = (1 << (QLP_PRECISION - 1)) - 1;
+			const int32_t qmin = -(1 << (QLP_PRECISION - 1));
+			double carry = 0.0;
+			for (int j = 0; j < order; j++) {
+				carry += lp[j] * (1 << shift);
+				int32_t q = static_cast<int32_t>(std::lround(carry));
+				q = std::max(qmin, std::min(qmax, q));
+				carry -= q;
+				qlp[j] = q;
+			}
+			return true;
+		}
+
+		std::vector<double> m_window;
+		std::vector<double> m_windowed;
+		std::vector<int32_t> m_residual;
+		std::vector<uint64_t> m_sums;
+	};
+
+	void WriteSubframe(BitWriter& bw, const Subframe& sf, const int32_t* x, uint32_t n, int bps) {
+		switch (sf.type) {
+		case SubframeType::Constant:
+			bw.Write(0x00, 8);
+			bw.WriteSigned(x[0], bps);
+			break;
+		case SubframeType::Verbatim:
+			bw.Write(0x02, 8);
+			for (uint32_t i = 0; i < n; i++) bw.WriteSigned(x[i], bps);
+			break;
+		case SubframeType::Fixed:
+			bw.Write(0x10 | (sf.order << 1), 8);
+			for (int i = 0; i < sf.order; i++) bw.WriteSigned(x[i], bps);
+			WriteResidual(bw, sf.residual.data(), n, sf.order, sf.rice);
+			break;
+		case SubframeType::Lpc:
+			bw.Write(0x40 | ((sf.order - 1) << 1), 8);
+			for (int i = 0; i < sf.order; i++) bw.WriteSigned(x[i], bps);
+			bw.Write(QLP_PRECISION - 1, 4);
+			bw.WriteSigned(sf.shift, 5);
+			for (int i = 0; i < sf.order; i++) bw.WriteSigned(sf.coefs[i], QLP_PRECISION);
+			WriteResidual(bw, sf.residual.data(), n, sf.order, sf.rice);
+			break;
+		}
+	}
+
+	// ── Frames ─────────────────────────────────────────────────────────────
+
+	class FrameEncoder {
+	public:
+		// Encodes samples [first, first + n) of the interleaved PCM as frame
+		// `frameNumber`; the frame bytes are left in Bytes().
+		void Encode(const uint8_t* pcm, uint32_t n, uint32_t frameNumber) {
+			for (auto& ch : m_channels) ch.resize(n);
+			int32_t* left = m_channels[0].data();
+			int32_t* right = m_channels[1].data();
+			int32_t* mid = m_channels[2].data();
+			int32_t* side = m_channels[3].data();
+			for (uint32_t i = 0; i < n; i++) {
+				const uint8_t* s = pcm + static_cast<size_t>(i) * 4;
+				left[i] = static_cast<int16_t>(s[0] | (s[1] << 8));
+				right[i] = static_cast<int16_t>(s[2] | (s[3] << 8));
+				mid[i] = (left[i] + right[i]) >> 1;
+				side[i] = left[i] - right[i];
+			}
+
+			for (int c = 0; c < 4; c++) {
+				m_analyzers[c].Analyze(m_channels[c].data(), n, Bps(c), m_subframes[c]);
+			}
+
+			// Channel assignment 0b0001 independent, 0b1000 left/side,
+			// 0b1001 side/right, 0b1010 mid/side.
+			struct Choice { uint32_t code; int first; int second; };
+			const Choice choices[] = { { 0x1, 0, 1 }, { 0x8, 0, 3 }, { 0x9, 3, 1 }, { 0xA, 2, 3 } };
+			const Choice* best = &choices[0];
+			uint64_t bestBits = UINT64_MAX;
+			for (const auto& c : choices) {
+				uint64_t bits = m_subframes[c.first].bits + m_subframes[c.second].bits;
+				if (bits < bestBits) {
+					bestBits = bits;
+					best = &c;
+				}
+			}
+
+			m_bw.Clear();
+			m_bw.Write(0xFFF8, 16);     // Sync, fixed block size
+			bool standard = (n == BLOCK_SIZE);
+			m_bw.Write(standard ? 0xC : 0x7, 4);
+			m_bw.Write(0x9, 4);         // 44.1 kHz
+			m_bw.Write(best->code, 4);
+			m_bw.Write(0x4, 3);         // 16 bits per sample
+			m_bw.Write(0, 1);
+			m_bw.WriteUtf8(frameNumber);
+			if (!standard) m_bw.Write(n - 1, 16);
+			m_bw.Write(Crc8(m_bw.Bytes().data(), m_bw.Bytes().size()), 8);
+
+			for (int c : { best->first, best->second }) {
+				WriteSubframe(m_bw, m_subframes[c], m_channels[c].data(), n, Bps(c));
+			}
+			m_bw.AlignByte();
+			m_bw.Write(Crc16(m_bw.Bytes().data(), m_bw.Bytes().size()), 16);
+		}
+
+		const std::vector<uint8_t>& Bytes() const { return m_bw.Bytes(); }
+
+	private:
+		// The side channel needs one extra bit.
+		static int Bps(int channel) { return channel == 3 ? BITS_PER_SAMPLE + 1 : BITS_PER_SAMPLE; }
+
+		std::vector<int32_t> m_channels[4];     // left, right, mid, side
+		ChannelAnalyzer m_analyzers[4];
+		Subframe m_subframes[4];
+		BitWriter m_bw;
+	};
+
+	// ── Metadata ───────────────────────────────────────────────────────────
+
+	void WriteBlockHeader(BitWriter& bw, bool last, uint32_t type, uint32_t length) {
+		bw.Write(last ? 1 : 0, 1);
+		bw.Write(type, 7);
+		bw.Write(length, 24);
+	}
+
+	void WriteStreamInfo(BitWriter& bw, uint32_t minFrame, uint32_t maxFrame, uint64_t samples,
+		const uint8_t md5[16]) {
+		WriteBlockHeader(bw, false, 0, 34);
+		bw.Write(BLOCK_SIZE, 16);
+		bw.Write(BLOCK_SIZE, 16);
+		bw.Write(minFrame, 24);
+		bw.Write(maxFrame, 24);
+		bw.Write(SAMPLE_RATE, 20);
+		bw.Write(2 - 1, 3);
+		bw.Write(BITS_PER_SAMPLE - 1, 5);
+		bw.Write(static_cast<uint32_t>(samples >> 32), 4);
+		bw.Write(static_cast<uint32_t>(samples), 32);
+		for (int i = 0; i < 16; i++) bw.Write(md5[i], 8);
+	}
+
+	void WriteLE32(BitWriter& bw, uint32_t v) {
+		for (int i = 0; i < 4; i++) bw.Write((v >> (8 * i)) & 0xFF, 8);
+	}
+
+	void WriteString(BitWriter& bw, const std::string& s) {
+		WriteLE32(bw, static_cast<uint32_t>(s.size()));
+		for (char c : s) bw.Write(static_cast<uint8_t>(c), 8);
+	}
+
+	void WriteVorbisComment(BitWriter& bw, const FlacTags& tags) {
+		uint32_t length = 4 + static_cast<uint32_t>(strlen(VENDOR)) + 4;
+		for (const auto& f : tags.fields) {
+			length += 4 + static_cast<uint32_t>(f.first.size() + 1 + f.second.size());
+		}
+		WriteBlockHeader(bw, false, 4, length);
+		WriteString(bw, VENDOR);
+		WriteLE32(bw, static_cast<uint32_t>(tags.fields.size()));
+		for (const auto& f : tags.fields) WriteString(bw, f.first + "=" + f.second);
+	}
+}
+
+// ============================================================================
+// FlacEncoder
+// ============================================================================
+
+bool FlacEncoder::EncodeFile(const std::wstring& path, const uint8_t* pcm, size_t bytes,
+	const FlacTags& tags) {
+	const uint64_t samples = bytes / 4;
+	if (samples == 0 || !pcm) return false;
+
+	std::ofstream out(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+	if (!out) return false;
+
+	uint8_t md5[16];
+	{
+		Md5 hash;
+		hash.Update(pcm, static_cast<size_t>(samples) * 4);
+		hash.Final(md5);
+	}
+
+	// Header with placeholder frame sizes; STREAMINFO is rewritten at the end.
+	BitWriter meta;
+	meta.Write(0x664C6143, 32);     // "fLaC"
+	WriteStreamInfo(meta, 0, 0, samples, md5);
+	WriteVorbisComment(meta, tags);
+	WriteBlockHeader(meta, true, 1, PADDING_BYTES);
+	for (uint32_t i = 0; i < PADDING_BYTES; i++) meta.Write(0, 8);
+	out.write(reinterpret_cast<const char*>(meta.Bytes().data()),
+		static_cast<std::streamsize>(meta.Bytes().size()));
+
+	FrameEncoder frame;
+	uint32_t minFrame = UINT32_MAX, maxFrame = 0;
+	uint32_t frameNumber = 0;
+	for (uint64_t pos = 0; pos < samples && out; pos += BLOCK_SIZE, frameNumber++) {
+		uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(BLOCK_SIZE, samples - pos));
+		frame.Encode(pcm + pos * 4, n, frameNumber);
+		uint32_t size = static_cast<uint32_t>(frame.Bytes().size());
+		minFrame = std::min(minFrame, size);
+		maxFrame = std::max(maxFrame, size);
+		out.write(reinterpret_cast<const char*>(frame.Bytes().data()), size);
+	}
+
+	BitWriter info;
+	WriteStreamInfo(info, minFrame, maxFrame, samples, md5);
+	out.seekp(4);
+	out.write(reinterpret_cast<const char*>(info.Bytes().data()),
+		static_cast<std::streamsize>(info.Bytes().size()));
+	out.close();
+
+	if (out.fail()) {
+		DeleteFileW(path.c_str());
+		return false;
+	}
+	return true;
+}
+
+// ============================================================================
+// FlacEncodeQueue
+// ============================================================================
+
+FlacEncodeQueue::FlacEncodeQueue(size_t threads) {
+	if (threads == 0) {
+		unsigned cores = std::thread::hardware_concurrency();
+		threads = cores > 1 ? cores - 1 : 1;
+	}
+	for (size_t i = 0; i < threads; i++) m_workers.emplace_back(&FlacEncodeQueue::WorkerLoop, this);
+}
+
+FlacEncodeQueue::~FlacEncodeQueue() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	for (auto& worker : m_workers) worker.join();
+}
+
+std::future<bool> FlacEncodeQueue::Submit(Job job) {
+	// packaged_task needs a copyable callable on some standard libraries.
+	auto shared = std::make_shared<Job>(std::move(job));
+	std::packaged_task<bool()> task([shared] {
+		return FlacEncoder::EncodeFile(shared->path, shared->pcm, shared->bytes, shared->tags);
+	});
+	std::future<bool> result = task.get_future();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(std::move(task));
+	}
+	m_cv.notify_one();
+	return result;
+}
+
+void FlacEncodeQueue::WorkerLoop() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_cv.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+		if (m_queue.empty()) return;    // stopping and nothing left to do
+
+		std::packaged_task<bool()> task = std::move(m_queue.front());
+		m_queue.pop_front();
+		lock.unlock();
+		task();
+		lock.lock();
+	}
+}
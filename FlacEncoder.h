@@ -0,0 +1,81 @@
+﻿// ============================================================================
+// FlacEncoder.h - Native FLAC encoder for 16-bit stereo 44100 Hz audio
+//
+// Fixed 4096-sample blocks (the last one shorter), each coded with the
+// cheapest of independent / left-side / right-side / mid-side stereo.  Per
+// channel the encoder costs constant, verbatim, one fixed predictor (the
+// order 0-4 with the smallest residual) and one LPC predictor (Tukey
+// window, Levinson-Durbin, the order up to 12 with the fewest estimated
+// bits), and keeps the smallest; residuals use partitioned Rice coding.
+// There is no wasted-bits detection and no exhaustive order search.
+// STREAMINFO carries the MD5 of the PCM; a VORBIS_COMMENT block carries
+// the tags and 8 KB of PADDING leaves room for taggers.
+//
+// Input is the CD sample layout itself (little-endian L/R pairs) so a
+// track is encoded straight from its SectorStore span.  FlacEncodeQueue
+// runs whole-track encodes on worker threads: the rip submits each track
+// as soon as its sectors are final and keeps reading.
+// ============================================================================
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// VORBIS_COMMENT fields ("TITLE", value), UTF-8, in output order.
+struct FlacTags {
+	std::vector<std::pair<std::string, std::string>> fields;
+
+	// Empty values are skipped.
+	void Add(const std::string& name, const std::string& value) {
+		if (!value.empty()) fields.emplace_back(name, value);
+	}
+};
+
+class FlacEncoder {
+public:
+	// Encode `bytes` of CD audio (a multiple of 4) to `path`.  False if the
+	// file cannot be written; a partial file is deleted.
+	static bool EncodeFile(const std::wstring& path, const uint8_t* pcm, size_t bytes,
+		const FlacTags& tags);
+};
+
+// Whole-file encodes on a fixed set of worker threads.  The caller keeps
+// every submitted `pcm` range alive and unchanged until its future is ready.
+class FlacEncodeQueue {
+public:
+	struct Job {
+		std::wstring path;
+		const uint8_t* pcm = nullptr;
+		size_t bytes = 0;
+		FlacTags tags;
+		// When set, `pcm` points into it — audio that had to be assembled
+		// (zero-padded track edges) rather than read from the store.
+		std::vector<uint8_t> owned;
+	};
+
+	// 0 = one thread per core, less one for the read loop.
+	explicit FlacEncodeQueue(size_t threads = 0);
+	~FlacEncodeQueue();
+	FlacEncodeQueue(const FlacEncodeQueue&) = delete;
+	FlacEncodeQueue& operator=(const FlacEncodeQueue&) = delete;
+
+	std::future<bool> Submit(Job job);
+
+private:
+	void WorkerLoop();
+
+	std::vector<std::thread> m_workers;
+	std::deque<std::packaged_task<bool()>> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+};
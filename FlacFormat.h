@@ -0,0 +1,52 @@
+﻿// ============================================================================
+// FlacFormat.h - Constants and checksums shared by FlacEncoder / FlacDecoder
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Flac {
+	constexpr uint32_t CD_SAMPLE_RATE = 44100;
+	constexpr uint32_t CD_CHANNELS = 2;
+	constexpr uint32_t CD_BITS_PER_SAMPLE = 16;
+
+	// Frame header CRC-8 (poly 0x07) and frame CRC-16 (poly 0x8005), both
+	// MSB first with a zero initial value.
+	struct CrcTables {
+		uint8_t crc8[256];
+		uint16_t crc16[256];
+
+		CrcTables() {
+			for (int i = 0; i < 256; i++) {
+				uint8_t c8 = static_cast<uint8_t>(i);
+				uint16_t c16 = static_cast<uint16_t>(i << 8);
+				for (int bit = 0; bit < 8; bit++) {
+					c8 = static_cast<uint8_t>((c8 & 0x80) ? (c8 << 1) ^ 0x07 : c8 << 1);
+					c16 = static_cast<uint16_t>((c16 & 0x8000) ? (c16 << 1) ^ 0x8005 : c16 << 1);
+				}
+				crc8[i] = c8;
+				crc16[i] = c16;
+			}
+		}
+	};
+
+	inline const CrcTables& Crc() {
+		static const CrcTables tables;
+		return tables;
+	}
+
+	inline uint8_t Crc8(const uint8_t* data, size_t n) {
+		uint8_t crc = 0;
+		for (size_t i = 0; i < n; i++) crc = Crc().crc8[crc ^ data[i]];
+		return crc;
+	}
+
+	inline uint16_t Crc16(const uint8_t* data, size_t n) {
+		uint16_t crc = 0;
+		for (size_t i = 0; i < n; i++) {
+			crc = static_cast<uint16_t>((crc << 8) ^ Crc().crc16[(crc >> 8) ^ data[i]]);
+		}
+		return crc;
+	}
+}
@@ -0,0 +1,67 @@
+﻿#define NOMINMAX
+#include "GuidedC2Plan.h"
+#include <algorithm>
+
+// ============================================================================
+// C1-guided C2 plan
+// ============================================================================
+
+std::vector<int> PlanGuidedC2(const QCheckResult& c1Result, const DiscLayout& layout) {
+	enum : BYTE { UNKNOWN = 0, CLEAN = 1, HOT = 2 };
+	const DWORD seconds = layout.TotalSeconds();
+	if (c1Result.samples.empty() || seconds == 0) return {};
+
+	// Each slice covers (previous slice LBA, slice LBA]; rates are per 75 sectors.
+	struct Slice { DWORD from, to; double c1Rate; bool flagged; };
+	std::vector<Slice> slices;
+	std::vector<double> rates;
+	bool havePrev = false;
+	DWORD prev = 0;
+	for (const auto& s : c1Result.samples) {
+		if (havePrev && s.lba <= prev) continue;
+		DWORD from = havePrev ? prev + 1 : (s.lba >= 74 ? s.lba - 74 : 0);
+		havePrev = true;
+		prev = s.lba;
+		DWORD span = s.lba - from + 1;
+		if (span > ROT_MAX_SLICE_SECONDS * 75) continue;
+		double rate = s.c1 * 75.0 / span;
+		slices.push_back({ from, s.lba, rate, s.c2 > 0 || s.cu > 0 });
+		rates.push_back(rate);
+	}
+	if (rates.empty()) return {};
+
+	std::nth_element(rates.begin(), rates.begin() + rates.size() / 2, rates.end());
+	double threshold = std::max<double>(ROT_C1_HOT_MIN, rates[rates.size() / 2] * 4.0);
+
+	std::vector<BYTE> state(seconds, UNKNOWN);
+	for (const auto& slice : slices) {
+		BYTE mark = (slice.flagged || slice.c1Rate > threshold) ? HOT : CLEAN;
+		for (DWORD lba = slice.from; lba <= slice.to; lba++) {
+			DWORD sec = layout.SecondOf(lba);
+			if (sec != DiscLayout::NOT_COVERED) state[sec] = std::max(state[sec], mark);
+		}
+	}
+
+	std::vector<int> plan(seconds, 0);
+	DWORD readSeconds = 0;
+	for (DWORD sec = 0; sec < seconds; sec++) {
+		bool read = state[sec] != CLEAN
+			|| (sec > 0 && state[sec - 1] == HOT)
+			|| (sec + 1 < seconds && state[sec + 1] == HOT);
+		if (read) { plan[sec] = 1; readSeconds++; }
+	}
+	for (DWORD group = 0; group < seconds; group += ROT_BASELINE_STRIDE) {
+		DWORD end = std::min(seconds, group + ROT_BASELINE_STRIDE);
+		DWORD baseline = end;
+		int clean = 0;
+		for (DWORD sec = group; sec < end; sec++) {
+			if (plan[sec] != 0) continue;
+			if (baseline == end) baseline = sec;
+			clean++;
+		}
+		if (baseline != end) { plan[baseline] = clean; readSeconds++; }
+	}
+
+	if (readSeconds * 2 > seconds) return {};
+	return plan;
+}
@@ -0,0 +1,28 @@
+﻿// ============================================================================
+// GuidedC2Plan.h - C1-guided choice of the seconds the disc rot C2 phase reads
+//
+// The vendor C1 scans own the drive while they run (the Pioneer and LiteOn
+// polls are read commands themselves, and host reads during a Q-Check
+// disturb its counts), so the C2 phase can't be interleaved with them.
+// Instead it reads where the C1 map says to look:
+//   - seconds whose C1 rate is above max(50, 4 x median), or where the
+//     vendor scan saw C2 / CU, plus one second either side
+//   - seconds the map doesn't place (startup, trimmed spikes, gaps)
+//   - one baseline second in every ROT_BASELINE_STRIDE of the rest,
+//     standing in for the clean seconds of its group so the zone rates
+//     remain whole-disc estimates
+// ============================================================================
+#pragma once
+
+#include "DiscLayout.h"
+#include "ScanResults.h"
+#include <vector>
+
+constexpr int ROT_C1_HOT_MIN = 50;              // C1/sec, as c1OverallHigh in AnalyzeC1RotPatterns
+constexpr DWORD ROT_BASELINE_STRIDE = 10;
+constexpr DWORD ROT_MAX_SLICE_SECONDS = 4;      // wider slices don't locate their C1
+
+// Returns a weight per DiscLayout second: 0 = skip, 1 = read, n > 1 = a
+// baseline second standing in for n.  Empty = read the whole disc (no
+// usable map, or the guided plan would read more than half of it).
+std::vector<int> PlanGuidedC2(const QCheckResult& c1Result, const DiscLayout& layout);
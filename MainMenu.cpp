@@ -1,9 +1,11 @@
-#include "MainMenu.h"
+﻿#include "MainMenu.h"
 #include "AccurateRip.h"
+#include "AccurateRipCache.h"
 #include "CopyWorkflow.h"
 #include "Drive.h"
 #include "DriveOffsetDatabase.h"
 #include "DriveSelection.h"
+#include "FileUtils.h"
 #include "InterruptHandler.h"
 #include "MenuHelpers.h"
 #include "MenuUI.h"
@@ -14,6 +16,7 @@
 #include "UpdateChecker.h"
 #include "WriteTracksWorkflow.h"
 #include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <thread>
 #include <vector>
@@ -245,6 +248,62 @@ void RunPioneerCdCheck(AudioCDCopier& copier, DiscInfo& disc) {
     }
 }
 
+// AccurateRip cache — bulk import of dBAR files and the offline switch for
+// stations without network access.  Lookup consults the cache first either
+// way; offline mode only stops it from falling back to accuraterip.com.
+void RunAccurateRipCacheMenu(const std::wstring& workDir) {
+    auto& cache = AccurateRipCache::Instance();
+
+    std::cout << "\nAccurateRip cache: ";
+    std::wcout << cache.GetCachePath().wstring() << L"\n";
+    std::cout << "  Entries:      " << cache.Count() << "\n";
+    std::cout << "  Offline mode: " << (cache.IsOffline() ? "ON" : "OFF") << "\n\n";
+    std::cout << "  1. Import dBAR .bin files from a folder\n";
+    std::cout << "  2. " << (cache.IsOffline() ? "Disable" : "Enable") << " offline mode\n";
+    std::cout << "  0. Back\n";
+    std::cout << Console::Sym::Arrow << " Choice: ";
+
+    int choice = GetMenuChoice(0, 2, 0);
+    if (choice == 1) {
+        std::cout << "Folder path (or Enter for working directory): ";
+        std::cin.clear();
+        FlushConsoleInputBuffer(GetStdHandle(STD_INPUT_HANDLE));
+
+        std::string narrowFolder;
+        std::getline(std::cin, narrowFolder);
+
+        std::wstring folder;
+        if (!narrowFolder.empty()) {
+            int wlen = MultiByteToWideChar(CP_UTF8, 0, narrowFolder.c_str(), -1, nullptr, 0);
+            if (wlen > 1) {
+                folder.resize(wlen - 1);
+                MultiByteToWideChar(CP_UTF8, 0, narrowFolder.c_str(), -1, &folder[0], wlen);
+            }
+        }
+        folder = NormalizePath(folder);
+        if (folder.empty()) folder = workDir;
+
+        AccurateRipImportStats stats;
+        if (!cache.ImportFolder(folder, stats)) {
+            Console::Error("Import failed: ");
+            std::wcout << folder << L"\n";
+            return;
+        }
+        Console::Success("Import complete: ");
+        std::cout << stats.imported << " dBAR file(s) added, " << stats.rejected
+            << " rejected, cache now holds " << cache.Count() << " disc(s)\n";
+    }
+    else if (choice == 2) {
+        bool offline = !cache.IsOffline();
+        if (cache.SetOffline(offline)) {
+            Console::Success(offline ? "Offline mode enabled.\n" : "Offline mode disabled.\n");
+        }
+        else {
+            Console::Error("Failed to update the AccurateRip cache.\n");
+        }
+    }
+}
+
 }  // namespace
 
 int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& workDir, wchar_t& audioDrive, bool& hasTOC) {
@@ -294,7 +353,8 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 		PrintMenuItem(27, "Help (test descriptions)");
 		PrintMenuItem(28, "Pioneer CD Check (audio quality)");
 		PrintMenuItem(29, "Jitter / beta scan (LiteOn) *");
-		PrintMenuItem(30, "Exit", true);
+		PrintMenuItem(30, "AccurateRip cache (import / offline mode)");
+		PrintMenuItem(31, "Exit", true);
 
 		Console::SetColor(Console::Color::DarkGray);
 		std::cout << "  * Uses pre-gap analysis (scan range includes pregap sectors)\n";
@@ -303,7 +363,7 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 		Console::BoxFooter();
 		std::cout << Console::Sym::Arrow << " Choice: ";
 
-		int choice = GetMenuChoice(1, 30, 1);
+		int choice = GetMenuChoice(1, 31, 1);
 		std::cin.clear();
 		if (std::cin.peek() == '\n') {
 			std::cin.ignore();
@@ -500,26 +560,12 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 				break;
 			}
 
-			// Keep probe sectors for offset detection before freeing
-			std::vector<std::vector<BYTE>> origProbe;
-			{
-				size_t total = originalDisc.rawSectors.size();
-				size_t probeSize = std::min<size_t>(100, total);
-				size_t midStart = (total > probeSize) ? (total - probeSize) / 2 : 0;
-				origProbe.assign(originalDisc.rawSectors.begin() + midStart,
-					originalDisc.rawSectors.begin() + midStart + probeSize);
-			}
+			// Keep probe windows across the disc for offset detection before freeing
+			SectorStore origProbes;
+			std::vector<size_t> probeStarts = copier.ExtractOffsetProbes(originalDisc.rawSectors, origProbes);
 
 			// Compute original CRCs, then free the bulk data
-			std::vector<std::pair<int, uint32_t>> originalCRCs;
-			for (int i = 0; i < static_cast<int>(originalDisc.tracks.size()); i++) {
-				if (originalDisc.tracks[i].isAudio) {
-					originalCRCs.push_back({
-						originalDisc.tracks[i].trackNumber,
-						copier.CalculateTrackCRC(originalDisc, i)
-						});
-				}
-			}
+			std::vector<std::pair<int, uint32_t>> originalCRCs = copier.CalculateTrackCRCs(originalDisc);
 			originalDisc.rawSectors.clear();
 			originalDisc.rawSectors.shrink_to_fit();
 
@@ -595,17 +641,26 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 
 			// ── Detect and compensate for write offset ─────────────────
 			int detectedOffset = 0;
-			if (!origProbe.empty() && !copyDisc.rawSectors.empty()) {
-				// Build a matching mid-disc probe from the copy
-				size_t total = copyDisc.rawSectors.size();
-				size_t probeSize = std::min<size_t>(100, total);
-				size_t midStart = (total > probeSize) ? (total - probeSize) / 2 : 0;
-				std::vector<std::vector<BYTE>> copyProbe(
-					copyDisc.rawSectors.begin() + midStart,
-					copyDisc.rawSectors.begin() + midStart + probeSize);
-				detectedOffset = copier.DetectSampleOffset(origProbe, copyProbe);
-			}
-			origProbe.clear();
+			if (!origProbes.empty() && !copyDisc.rawSectors.empty()) {
+				SampleOffsetResult detection = copier.DetectDiscSampleOffset(origProbes,
+					probeStarts, copyDisc.rawSectors);
+				if (detection.found) {
+					detectedOffset = detection.offset;
+					std::cout << "Offset search: " << detection.windowsAgreeing << "/"
+						<< detection.windowsTotal << " windows agree, peak ratio "
+						<< std::fixed << std::setprecision(2) << detection.peakRatio
+						<< std::defaultfloat << "\n";
+				}
+				if (!detection.consistent) {
+					Console::Warning("Probe windows disagree on the offset:");
+					for (const auto& w : detection.windows) {
+						if (w.found) std::cout << " " << w.offset;
+						else std::cout << " ?";
+					}
+					std::cout << "\n";
+				}
+			}
+			origProbes.clear();
 
 			if (detectedOffset != 0) {
 				Console::Info("\nWrite offset detected: ");
@@ -619,15 +674,7 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 			}
 
 			// ── Compute copy CRCs (from offset-compensated data) ───────
-			std::vector<std::pair<int, uint32_t>> copyCRCs;
-			for (int i = 0; i < static_cast<int>(copyDisc.tracks.size()); i++) {
-				if (copyDisc.tracks[i].isAudio) {
-					copyCRCs.push_back({
-						copyDisc.tracks[i].trackNumber,
-						copier.CalculateTrackCRC(copyDisc, i)
-						});
-				}
-			}
+			std::vector<std::pair<int, uint32_t>> copyCRCs = copier.CalculateTrackCRCs(copyDisc);
 			copyDisc.rawSectors.clear();
 			copyDisc.rawSectors.shrink_to_fit();
 
@@ -949,8 +996,7 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 			if (hasTOC) {
 				copier.ReadCDText(disc);
 				copier.ReadISRC(disc);
-				std::vector<std::vector<uint32_t>> pressingCRCs;
-				AccurateRip::Lookup(disc, pressingCRCs);
+				AccurateRip::Lookup(disc);
 				PrintDiscInfo(disc);
 				Console::Success("Disc rescan complete.\n");
 			}
@@ -996,8 +1042,13 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 			break;
 		}
 
-			// ── 30. Exit ─────────────────────────────────────────────
+			// ── 30. AccurateRip cache ───────────────────────────────
 		case 30:
+			RunAccurateRipCacheMenu(workDir);
+			break;
+
+			// ── 31. Exit ─────────────────────────────────────────────
+		case 31:
 			copier.Close();
 			Console::Success("\nGoodbye!\n");
 			return 0;
@@ -1007,7 +1058,7 @@ int RunMainMenuLoop(AudioCDCopier& copier, DiscInfo& disc, const std::wstring& w
 			break;
 		}
 
-		if (choice != 30) {
+		if (choice != 31) {
 			WaitForKey();
 		}
 	}
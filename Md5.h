@@ -0,0 +1,28 @@
+﻿// ============================================================================
+// Md5.h - MD5 message digest (RFC 1321)
+//
+// Only used where a format mandates it — the FLAC STREAMINFO signature of
+// the decoded PCM.  Not a security primitive.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Md5 {
+public:
+	Md5() { Reset(); }
+
+	void Reset();
+	void Update(const void* data, size_t length);
+	// Pads, writes the 16-byte digest and leaves the object to be Reset.
+	void Final(uint8_t digest[16]);
+
+private:
+	void Transform(const uint8_t block[64]);
+
+	uint32_t m_state[4];
+	uint64_t m_length = 0;      // Bytes hashed so far
+	uint8_t m_buffer[64];
+	size_t m_buffered = 0;
+};
@@ -121,8 +121,8 @@ void PrintHelpMenu() {
 		"   Supports burst and secure (C2-guided) rip modes, drive speed selection,\n"
 		"   and drive offset correction.\n"
 		"\n"
-		"   FLAC encoding requires flac.exe in your system PATH or working directory.\n"
-		"   If FLAC encoding fails, the WAV file is kept as a fallback.",
+		"   FLAC is encoded by the built-in encoder, several tracks in parallel,\n"
+		"   and tagged from CD-Text and ISRC codes.",
 		"Extracting specific tracks as standalone audio files for playback or archiving." });
 
 	PrintEntry({ "3. Write Disc (.bin/.cue/.sub Files)",
@@ -137,7 +137,7 @@ void PrintHelpMenu() {
 		"   chosen folder are matched to audio tracks alphabetically. The new disc\n"
 		"   reproduces the source disc's track-to-track gap timing exactly.\n"
 		"\n"
-		"   FLAC inputs are decoded via flac.exe on the system PATH.\n"
+		"   FLAC inputs are decoded built-in; each file's MD5 signature is checked.\n"
 		"\n"
 		"   Pregap audio (between INDEX 00 and INDEX 01 of each track) is captured\n"
 		"   fresh from the source disc at write time, with read-offset correction\n"
@@ -408,7 +408,15 @@ void PrintHelpMenu() {
 		"   Output is a CSV log of (lba, jitter, beta) plus a summary report.",
 		"Pressing-quality diagnostics and early-warning disc/drive health checks." });
 
-	PrintEntry({ "30. Exit",
+	PrintEntry({ "30. AccurateRip Cache (Import / Offline Mode)",
+		"Manages the local cache of AccurateRip dBAR files used by every lookup.\n"
+		"   Import scans a folder (recursively) for dBAR-*.bin files and adds them\n"
+		"   in one pass; each file is keyed by the disc IDs in its own header.\n"
+		"   Discs fetched online are added automatically.  Offline mode answers\n"
+		"   lookups from the cache only and never opens a network connection.",
+		"Repeated verification of the same titles and air-gapped ingest stations." });
+
+	PrintEntry({ "31. Exit",
 		"Exits the program.",
 		"Closing the tool when done." });
 
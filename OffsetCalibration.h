@@ -3,6 +3,8 @@
 // ============================================================================
 #pragma once
 #include "ScsiDrive.h"
+#include "CDStructures.h"
+#include "SectorStore.h"
 #include <vector>
 #include <functional>
 
@@ -24,13 +26,26 @@ public:
     CalibrationResult CalibrateWithDisc(
         std::function<void(int progress, const std::string& status)> progressCallback = nullptr);
     
-    // Quick calibration testing common offsets only
+    // Calibration over the typical -1200..+1200 sample range
     CalibrationResult QuickCalibrate(
         std::function<void(int progress, const std::string& status)> progressCallback = nullptr);
     
 private:
     ScsiDrive& m_drive;
     
+    // One track read once with overread margin on both sides.  The audio
+    // plane of the store doubles as the packed sample array.
+    struct TrackSamples {
+        SectorStore sectors;
+        size_t trackStart = 0;       // first nominal sample of the track
+        size_t trackLength = 0;      // nominal length in samples
+        
+        const uint32_t* Samples() const {
+            return reinterpret_cast<const uint32_t*>(sectors.AudioSpan().data);
+        }
+        size_t SampleCount() const { return sectors.size() * 588; }
+    };
+    
     // Common drive offsets to test first (covers ~90% of drives)
     static constexpr int CommonOffsets[] = {
         0, +6, +12, +30, +48, +97, +99, +102, +103, +116, +120,
@@ -38,9 +53,10 @@ private:
         -24, -472, -491, -582, -1164
     };
     
-    uint32_t CalculateAccurateRipCRC(const std::vector<int16_t>& samples, 
-                                      int trackNumber, int totalTracks);
-    std::vector<uint32_t> FetchAccurateRipChecksums(const std::string& discId);
-    std::string CalculateDiscId();
-    uint32_t ReadTrackAndCalculateCRC(int trackNumber, int offsetSamples);
+    CalibrationResult RunCalibration(int minOffset, int maxOffset,
+        std::function<void(int progress, const std::string& status)> progressCallback);
+    // Tracks and lead-out from the drive's TOC — enough for the AccurateRip
+    // disc IDs and track windows.
+    bool ReadTocLayout(DiscInfo& disc);
+    bool ReadTrackSamples(DWORD startLBA, DWORD endLBA, int maxOffset, TrackSamples& out);
 };
\ No newline at end of file
@@ -0,0 +1,188 @@
+﻿// ============================================================================
+// OffsetCorrelator.cpp - Radix-2 FFT and normalised cross-correlation
+// ============================================================================
+#define NOMINMAX
+#include "OffsetCorrelator.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <map>
+
+namespace {
+	using Complex = std::complex<double>;
+
+	constexpr size_t MAX_WINDOW_SAMPLES = 16384;
+	constexpr size_t MIN_WINDOW_SAMPLES = 2048;
+	constexpr int PEAK_EXCLUSION = 16;          // samples around the peak ignored for the ratio
+	constexpr double MAX_MEAN_SQUARED_ERROR = 10.0;
+	constexpr size_t SAMPLES_PER_SECTOR = AUDIO_SECTOR_SIZE / 4;
+
+	// In-place iterative radix-2 FFT; n must be a power of two.
+	void Fft(std::vector<Complex>& a, bool inverse) {
+		const size_t n = a.size();
+		for (size_t i = 1, j = 0; i < n; i++) {
+			size_t bit = n >> 1;
+			for (; j & bit; bit >>= 1) j ^= bit;
+			j ^= bit;
+			if (i < j) std::swap(a[i], a[j]);
+		}
+
+		// Twiddles for the largest stage; smaller stages stride through them.
+		const double pi = 3.14159265358979323846;
+		std::vector<Complex> w(n / 2);
+		for (size_t k = 0; k < n / 2; k++) {
+			double angle = 2.0 * pi * static_cast<double>(k) / static_cast<double>(n);
+			w[k] = Complex(std::cos(angle), inverse ? std::sin(angle) : -std::sin(angle));
+		}
+
+		for (size_t len = 2; len <= n; len <<= 1) {
+			size_t half = len / 2;
+			size_t step = n / len;
+			for (size_t i = 0; i < n; i += len) {
+				for (size_t k = 0; k < half; k++) {
+					Complex u = a[i + k];
+					Complex v = a[i + k + half] * w[k * step];
+					a[i + k] = u + v;
+					a[i + k + half] = u - v;
+				}
+			}
+		}
+
+		if (inverse) {
+			double scale = 1.0 / static_cast<double>(n);
+			for (auto& x : a) x *= scale;
+		}
+	}
+
+	int16_t SampleAt(const SectorSpan& span, size_t frame, int channel) {
+		const BYTE* sector = span.Sector(frame / SAMPLES_PER_SECTOR);
+		int16_t v;
+		memcpy(&v, sector + (frame % SAMPLES_PER_SECTOR) * 4 + channel * 2, sizeof(v));
+		return v;
+	}
+
+	double MonoAt(const SectorSpan& span, size_t frame) {
+		return static_cast<double>(SampleAt(span, frame, 0)) + SampleAt(span, frame, 1);
+	}
+}
+
+OffsetEstimate OffsetCorrelator::Estimate(const SectorSpan& orig, const SectorSpan& copy,
+	size_t copyLeadSectors, int maxOffsetSamples) {
+	OffsetEstimate result;
+	if (maxOffsetSamples < 0) return result;
+
+	const size_t origFrames = orig.count * SAMPLES_PER_SECTOR;
+	const int64_t copyFrames = static_cast<int64_t>(copy.count * SAMPLES_PER_SECTOR);
+	const size_t window = std::min(origFrames, MAX_WINDOW_SAMPLES);
+	if (window < MIN_WINDOW_SAMPLES) return result;
+
+	const size_t refStart = (origFrames - window) / 2;
+	const int64_t maxOff = maxOffsetSamples;
+	// Copy frame aligned with refStart at offset 0, and the first frame of
+	// the search region (offset -maxOff).
+	const int64_t base = static_cast<int64_t>(copyLeadSectors * SAMPLES_PER_SECTOR + refStart);
+	const int64_t searchStart = base - maxOff;
+	const size_t searchLen = window + 2 * static_cast<size_t>(maxOff);
+
+	size_t n = 1;
+	while (n < searchLen) n <<= 1;
+
+	// Pack both real signals into one complex FFT: original in the real
+	// part, copy search region in the imaginary part.
+	std::vector<Complex> x(n);
+	double refEnergy = 0.0;
+	for (size_t i = 0; i < window; i++) {
+		double v = MonoAt(orig, refStart + i);
+		x[i].real(v);
+		refEnergy += v * v;
+	}
+	if (refEnergy <= 0.0) return result;    // digital silence: nothing to align
+
+	std::vector<double> searchEnergy(searchLen + 1, 0.0);   // prefix sums of squares
+	for (size_t i = 0; i < searchLen; i++) {
+		int64_t frame = searchStart + static_cast<int64_t>(i);
+		double v = (frame >= 0 && frame < copyFrames) ? MonoAt(copy, static_cast<size_t>(frame)) : 0.0;
+		x[i].imag(v);
+		searchEnergy[i + 1] = searchEnergy[i] + v * v;
+	}
+
+	Fft(x, false);
+
+	// Unpack A (original) and B (copy), then form conj(A)·B, whose inverse
+	// transform is the correlation sum_i a[i]·b[i+j].
+	std::vector<Complex> r(n);
+	for (size_t k = 0; k < n; k++) {
+		Complex xk = x[k];
+		Complex xnk = std::conj(x[(n - k) & (n - 1)]);
+		Complex a = (xk + xnk) * 0.5;
+		Complex b = (xk - xnk) * Complex(0.0, -0.5);
+		r[k] = std::conj(a) * b;
+	}
+	Fft(r, true);
+
+	// Normalised correlation for every candidate whose window lies fully
+	// inside the copy.
+	std::vector<double> ncc(2 * static_cast<size_t>(maxOff) + 1, -2.0);
+	int bestJ = -1;
+	for (int64_t j = 0; j <= 2 * maxOff; j++) {
+		int64_t first = searchStart + j;
+		if (first < 0 || first + static_cast<int64_t>(window) > copyFrames) continue;
+		double energy = searchEnergy[j + window] - searchEnergy[j];
+		if (energy <= 0.0) continue;
+		ncc[j] = r[j].real() / std::sqrt(refEnergy * energy);
+		if (bestJ < 0 || ncc[j] > ncc[bestJ]) bestJ = static_cast<int>(j);
+	}
+	if (bestJ < 0) return result;
+
+	double second = 0.0;
+	for (int64_t j = 0; j <= 2 * maxOff; j++) {
+		if (std::abs(j - bestJ) <= PEAK_EXCLUSION) continue;
+		second = std::max(second, ncc[j]);
+	}
+	result.offset = bestJ - maxOffsetSamples;
+	result.peakRatio = (second > 1e-9) ? ncc[bestJ] / second : ncc[bestJ] / 1e-9;
+
+	// Confirm with an exact comparison of both channels.
+	int64_t copyFirst = base + result.offset;
+	double ssd = 0.0;
+	for (size_t i = 0; i < window; i++) {
+		for (int ch = 0; ch < 2; ch++) {
+			double d = static_cast<double>(SampleAt(orig, refStart + i, ch)) -
+				SampleAt(copy, static_cast<size_t>(copyFirst) + i, ch);
+			ssd += d * d;
+		}
+	}
+	result.meanSquaredError = ssd / static_cast<double>(window * 2);
+	result.found = result.meanSquaredError <= MAX_MEAN_SQUARED_ERROR;
+	return result;
+}
+
+SampleOffsetResult OffsetCorrelator::Combine(const std::vector<OffsetEstimate>& windows) {
+	SampleOffsetResult result;
+	result.windows = windows;
+	result.windowsTotal = static_cast<int>(windows.size());
+
+	std::map<int, int> votes;
+	for (const auto& w : windows) {
+		if (!w.found) continue;
+		result.windowsUsable++;
+		votes[w.offset]++;
+	}
+	if (votes.empty()) return result;
+
+	auto best = std::max_element(votes.begin(), votes.end(),
+		[](const auto& a, const auto& b) { return a.second < b.second; });
+	result.offset = best->first;
+	result.windowsAgreeing = best->second;
+	result.consistent = (votes.size() == 1);
+	result.found = (result.windowsAgreeing * 2 > result.windowsUsable);
+
+	result.peakRatio = 0.0;
+	for (const auto& w : windows) {
+		if (!w.found || w.offset != result.offset) continue;
+		if (result.peakRatio == 0.0 || w.peakRatio < result.peakRatio) result.peakRatio = w.peakRatio;
+	}
+	return result;
+}
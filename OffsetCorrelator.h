@@ -0,0 +1,49 @@
+﻿// ============================================================================
+// OffsetCorrelator.h - FFT cross-correlation for sample-offset detection
+//
+// Finds the sample shift between two reads of the same audio (an original
+// and its copy) by normalised cross-correlation computed with one forward
+// and one inverse FFT, so a ±1 second search costs O(n log n) instead of
+// one sum of squared differences per candidate offset.  The peak is then
+// confirmed by an exact sample comparison, as the old brute-force search
+// did, so a copy with different audio is still rejected.
+// ============================================================================
+#pragma once
+
+#include "SectorStore.h"
+#include <vector>
+
+// Offset convention matches ApplySampleOffset: copy sample i + offset is
+// original sample i, so ApplySampleOffset(copy, offset) aligns the copy.
+struct OffsetEstimate {
+	bool found = false;
+	int offset = 0;
+	double peakRatio = 0.0;         // best correlation / best one >16 samples away
+	double meanSquaredError = 0.0;  // per int16 value at the chosen offset
+};
+
+struct SampleOffsetResult {
+	bool found = false;
+	int offset = 0;
+	double peakRatio = 0.0;         // weakest among the agreeing windows
+	int windowsAgreeing = 0;
+	int windowsUsable = 0;          // windows that produced an estimate
+	int windowsTotal = 0;
+	bool consistent = true;         // false when usable windows disagree
+	std::vector<OffsetEstimate> windows;
+};
+
+class OffsetCorrelator {
+public:
+	static constexpr int ONE_SECOND_SAMPLES = 44100;
+
+	// Search offsets in [-maxOffsetSamples, +maxOffsetSamples].  copy sector
+	// `copyLeadSectors` is nominally aligned with orig sector 0, so a caller
+	// can hand over a copy range padded on both sides by the search radius.
+	// The reference window is the middle of `orig` (at most 16384 samples).
+	static OffsetEstimate Estimate(const SectorSpan& orig, const SectorSpan& copy,
+		size_t copyLeadSectors, int maxOffsetSamples);
+
+	// Majority vote over several windows.
+	static SampleOffsetResult Combine(const std::vector<OffsetEstimate>& windows);
+};
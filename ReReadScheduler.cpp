@@ -0,0 +1,107 @@
+﻿// ============================================================================
+// ReReadScheduler.cpp - Run grouping and elevator ordering for re-reads
+// ============================================================================
+#include "ReReadScheduler.h"
+#include <algorithm>
+
+void ReReadScheduler::NoteLinearPass(DWORD first, DWORD last) {
+	if (last < first) return;
+	m_linearFirst = first;
+	m_linearLast = last;
+	m_linearStartStamp = m_readCounter;
+	m_hasLinearPass = true;
+	m_readCounter += static_cast<uint64_t>(last - first) + 1;
+	AddVisit(last);
+}
+
+void ReReadScheduler::Rebuild(std::vector<DWORD> lbas) {
+	std::sort(lbas.begin(), lbas.end());
+	lbas.erase(std::unique(lbas.begin(), lbas.end()), lbas.end());
+
+	std::vector<ReReadRun> runs;
+	for (DWORD lba : lbas) {
+		bool extend = !runs.empty() && lba - runs.back().last <= RUN_GAP &&
+			(m_maxRunLength == 0 || runs.back().lbas.size() < m_maxRunLength);
+		if (!extend) {
+			runs.emplace_back();
+			runs.back().first = lba;
+		}
+		runs.back().last = lba;
+		runs.back().lbas.push_back(lba);
+	}
+
+	// Carry history over: both lists are sorted, so one forward walk pairs
+	// every new run with the old runs it overlaps.
+	size_t o = 0;
+	for (auto& run : runs) {
+		while (o < m_runs.size() && m_runs[o].last < run.first) o++;
+		for (size_t k = o; k < m_runs.size() && m_runs[k].first <= run.last; k++) {
+			const auto& old = m_runs[k];
+			run.failedSweeps = std::max(run.failedSweeps, old.failedSweeps);
+			if (old.everRead && (!run.everRead || old.readStamp > run.readStamp)) {
+				run.readStamp = old.readStamp;
+				run.everRead = true;
+			}
+		}
+		// Otherwise the run was last read by the linear pass, when the head
+		// reached its end.
+		if (!run.everRead && m_hasLinearPass && run.last >= m_linearFirst && run.first <= m_linearLast) {
+			run.readStamp = m_linearStartStamp + (std::min(run.last, m_linearLast) - m_linearFirst);
+			run.everRead = true;
+		}
+	}
+
+	m_runs = std::move(runs);
+}
+
+std::vector<ReReadRun*> ReReadScheduler::NextSweep(DWORD headLBA) {
+	std::vector<ReReadRun*> order;
+	order.reserve(m_runs.size());
+	if (m_runs.empty()) return order;
+
+	// First run at or beyond the head; runs before it lie behind.
+	size_t split = 0;
+	while (split < m_runs.size() && m_runs[split].last < headLBA) split++;
+
+	if (m_ascending) {
+		for (size_t i = split; i < m_runs.size(); i++) order.push_back(&m_runs[i]);
+		for (size_t i = split; i-- > 0; ) order.push_back(&m_runs[i]);
+		if (split > 0) m_ascending = false;     // Ended heading down
+	}
+	else {
+		for (size_t i = split; i-- > 0; ) order.push_back(&m_runs[i]);
+		for (size_t i = split; i < m_runs.size(); i++) order.push_back(&m_runs[i]);
+		if (split < m_runs.size()) m_ascending = true;
+	}
+	return order;
+}
+
+void ReReadScheduler::BeginRun(ReReadRun& run) {
+	run.readStamp = m_readCounter;
+	run.everRead = true;
+	AddVisit(run.first);
+}
+
+void ReReadScheduler::AddVisit(DWORD lba) {
+	while (!m_visits.empty() && (m_visits.front().first < m_lastDefeatStamp ||
+		m_readCounter - m_visits.front().first >= m_cacheSectors)) {
+		m_visits.pop_front();
+	}
+	m_visits.emplace_back(m_readCounter, lba);
+}
+
+bool ReReadScheduler::NeedsCacheDefeat(const ReReadRun& run) const {
+	if (!run.everRead) return false;
+	if (run.readStamp < m_lastDefeatStamp) return false;
+	if (m_readCounter - run.readStamp >= m_cacheSectors) return false;
+
+	// Any read far enough away since then has pushed the run out of the
+	// cache, the same way DefeatDriveCache's far seek does.
+	for (size_t i = m_visits.size(); i-- > 0; ) {
+		const auto& visit = m_visits[i];
+		if (visit.first <= run.readStamp) break;
+		DWORD distance = (visit.second > run.first) ? visit.second - run.first : run.first - visit.second;
+		if (distance >= m_cacheSectors) return false;
+	}
+	return true;
+}
@@ -0,0 +1,111 @@
+﻿// ============================================================================
+// ReReadScheduler.h - Seek-aware ordering of secure rip re-reads
+//
+// Phase 2 used to re-read every unverified LBA in ascending order each sweep
+// (one cache defeat per sweep, a full seek back to the lowest LBA before the
+// next), and phase 3 rescued sectors one at a time with a cache-defeat seek
+// before every pass of every sector.  On a damaged disc the time went into
+// seeks, not reads.
+//
+// The scheduler groups unverified LBAs into runs of nearby sectors and hands
+// them out in elevator (SCAN) order: it keeps moving the head in one
+// direction, and reverses only when nothing is left ahead of it.  It also
+// decides, per run, whether a cache defeat is needed at all.  The drive can
+// only return a stale copy of a run if, since the run was last read:
+//   - fewer than a cache's worth of other sectors were read,
+//   - the head never went further than a cache's worth away, and
+//   - no cache defeat was issued.
+// Runs that keep failing are tracked so only those are read at reduced
+// speed.
+// ============================================================================
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+struct ReReadRun {
+	DWORD first = 0;                // First LBA of the run
+	DWORD last = 0;                 // Last LBA (inclusive)
+	std::vector<DWORD> lbas;        // Unverified LBAs in [first, last], ascending
+	int failedSweeps = 0;           // Consecutive sweeps in which none verified
+	uint64_t readStamp = 0;         // Read counter when the run was last read
+	bool everRead = false;
+};
+
+class ReReadScheduler {
+public:
+	// LBAs at most this far apart share a run.
+	static constexpr DWORD RUN_GAP = 16;
+	// A run that failed this many sweeps in a row is read at reduced speed.
+	static constexpr int SLOW_AFTER_FAILURES = 2;
+
+	// cacheSectors: how many sectors the drive may still hold from earlier
+	// reads.  maxRunLength: split longer runs (0 = unlimited).
+	explicit ReReadScheduler(DWORD cacheSectors, DWORD maxRunLength = 0)
+		: m_cacheSectors(cacheSectors), m_maxRunLength(maxRunLength) {}
+
+	// Applies from the next Rebuild().
+	void SetMaxRunLength(DWORD maxRunLength) { m_maxRunLength = maxRunLength; }
+
+	// Record a straight pass over [first, last] that ended at `last` (the
+	// phase 1 read).  Runs inside it that have no history of their own are
+	// stamped with the point in the pass where they were read.
+	void NoteLinearPass(DWORD first, DWORD last);
+
+	// Replace the pending LBAs (any order).  New runs inherit the failure
+	// count and read stamp of the old runs they overlap.
+	void Rebuild(std::vector<DWORD> lbas);
+
+	// Every run once, in elevator order starting from headLBA.  Pointers stay
+	// valid until the next Rebuild().
+	std::vector<ReReadRun*> NextSweep(DWORD headLBA);
+
+	// True when the drive may still be caching sectors of `run` from its
+	// previous read (runs never read, even by a linear pass, need none).
+	bool NeedsCacheDefeat(const ReReadRun& run) const;
+
+	// Note that `run` is about to be read: stamps it and records the head
+	// position.
+	void BeginRun(ReReadRun& run);
+
+	// Count `sectors` just read from the disc.
+	void NoteRead(DWORD sectors) { m_readCounter += sectors; }
+
+	// A cache defeat was just issued — nothing read before it is cached.
+	void NoteCacheDefeat() { m_lastDefeatStamp = ++m_readCounter; }
+
+	// Record the outcome of one sweep over `run`.
+	static void NoteSweep(ReReadRun& run, bool anyVerified) {
+		run.failedSweeps = anyVerified ? 0 : run.failedSweeps + 1;
+	}
+
+	static bool ShouldSlowDown(const ReReadRun& run) {
+		return run.failedSweeps >= SLOW_AFTER_FAILURES;
+	}
+
+	size_t RunCount() const { return m_runs.size(); }
+
+private:
+	DWORD m_cacheSectors;
+	DWORD m_maxRunLength;
+	std::vector<ReReadRun> m_runs;      // Sorted by first LBA, non-overlapping
+	uint64_t m_readCounter = 0;
+	uint64_t m_lastDefeatStamp = 0;
+	bool m_ascending = true;
+
+	// The pass recorded by NoteLinearPass (valid when m_hasLinearPass).
+	DWORD m_linearFirst = 0;
+	DWORD m_linearLast = 0;
+	uint64_t m_linearStartStamp = 0;
+	bool m_hasLinearPass = false;
+
+	// Where the head went and when (read counter, LBA), oldest first.  Only
+	// visits a cache's worth of reads back and after the last defeat can
+	// matter, so older ones are dropped.
+	std::deque<std::pair<uint64_t, DWORD>> m_visits;
+
+	void AddVisit(DWORD lba);
+};
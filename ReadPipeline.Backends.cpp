@@ -0,0 +1,155 @@
+﻿// ============================================================================
+// ReadPipeline.Backends.cpp - Overlapped and threaded READ CD backends
+// ============================================================================
+#include "ReadPipeline.h"
+#include <cstring>
+
+// ── Backend selection ───────────────────────────────────────────────────────
+
+std::unique_ptr<ReadBackend> ReadBackend::Create(ScsiDrive& drive, size_t depth) {
+	if (drive.GetDriveLetter() != 0) {
+		auto overlapped = OverlappedReadBackend::Open(drive.GetDriveLetter(), depth);
+		if (overlapped) return overlapped;
+	}
+	return std::make_unique<ThreadedReadBackend>(drive, depth);
+}
+
+// ── Overlapped DeviceIoControl backend ─────────────────────────────────────
+
+std::unique_ptr<OverlappedReadBackend> OverlappedReadBackend::Open(wchar_t driveLetter, size_t depth) {
+	if (depth == 0) return nullptr;
+
+	// The main ScsiDrive handle is synchronous; overlapped requests need a
+	// handle of their own opened with FILE_FLAG_OVERLAPPED.
+	std::wstring path = L"\\\\.\\" + std::wstring(1, driveLetter) + L":";
+	HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) return nullptr;
+
+	std::unique_ptr<OverlappedReadBackend> backend(new OverlappedReadBackend());
+	backend->m_handle = handle;
+	backend->m_slots.resize(depth);
+	for (auto& slot : backend->m_slots) {
+		slot.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		if (!slot.overlapped.hEvent) return nullptr;
+	}
+	return backend;
+}
+
+OverlappedReadBackend::~OverlappedReadBackend() {
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		if (m_slots[i].pending) Complete(i);
+		if (m_slots[i].overlapped.hEvent) CloseHandle(m_slots[i].overlapped.hEvent);
+	}
+	if (m_handle != INVALID_HANDLE_VALUE) CloseHandle(m_handle);
+}
+
+bool OverlappedReadBackend::Submit(size_t slot, const BYTE* cdb, BYTE cdbLength,
+	BYTE* buffer, DWORD bufferSize) {
+	constexpr DWORD SENSE_SIZE = 32;
+	Slot& s = m_slots[slot];
+	s.sptd.assign(sizeof(SCSI_PASS_THROUGH_DIRECT) + SENSE_SIZE, 0);
+	auto* sptd = reinterpret_cast<SCSI_PASS_THROUGH_DIRECT*>(s.sptd.data());
+
+	sptd->Length = sizeof(SCSI_PASS_THROUGH_DIRECT);
+	sptd->CdbLength = cdbLength;
+	sptd->SenseInfoLength = SENSE_SIZE;
+	sptd->DataIn = SCSI_IOCTL_DATA_IN;
+	sptd->DataTransferLength = bufferSize;
+	sptd->TimeOutValue = 60;
+	sptd->DataBuffer = buffer;
+	sptd->SenseInfoOffset = sizeof(SCSI_PASS_THROUGH_DIRECT);
+	memcpy(sptd->Cdb, cdb, cdbLength);
+
+	ResetEvent(s.overlapped.hEvent);
+	DWORD bytesReturned = 0;
+	BOOL result = DeviceIoControl(m_handle, IOCTL_SCSI_PASS_THROUGH_DIRECT,
+		sptd, static_cast<DWORD>(s.sptd.size()),
+		sptd, static_cast<DWORD>(s.sptd.size()),
+		&bytesReturned, &s.overlapped);
+
+	s.pending = !result && GetLastError() == ERROR_IO_PENDING;
+	s.issued = result || s.pending;
+	return s.issued;
+}
+
+bool OverlappedReadBackend::Complete(size_t slot) {
+	Slot& s = m_slots[slot];
+	if (!s.issued) return false;
+	s.issued = false;
+
+	if (s.pending) {
+		s.pending = false;
+		DWORD bytes = 0;
+		if (!GetOverlappedResult(m_handle, &s.overlapped, &bytes, TRUE)) return false;
+	}
+
+	// Same status rules as ScsiDrive::SendSCSI.
+	auto* sptd = reinterpret_cast<SCSI_PASS_THROUGH_DIRECT*>(s.sptd.data());
+	if (sptd->ScsiStatus == 0) return true;
+	if (sptd->ScsiStatus == 0x02) {
+		BYTE* sense = s.sptd.data() + sizeof(SCSI_PASS_THROUGH_DIRECT);
+		return (sense[2] & 0x0F) <= 0x01;
+	}
+	return false;
+}
+
+// ── Threaded synchronous backend ───────────────────────────────────────────
+
+ThreadedReadBackend::ThreadedReadBackend(ScsiDrive& drive, size_t depth)
+	: m_drive(drive), m_slots(depth == 0 ? 1 : depth) {
+	m_thread = std::thread(&ThreadedReadBackend::IoLoop, this);
+}
+
+ThreadedReadBackend::~ThreadedReadBackend() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+}
+
+bool ThreadedReadBackend::Submit(size_t slot, const BYTE* cdb, BYTE cdbLength,
+	BYTE* buffer, DWORD bufferSize) {
+	if (cdbLength > sizeof(Slot::cdb)) return false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Slot& s = m_slots[slot];
+		memcpy(s.cdb, cdb, cdbLength);
+		s.cdbLength = cdbLength;
+		s.buffer = buffer;
+		s.bufferSize = bufferSize;
+		s.done = false;
+		s.ok = false;
+		m_queue.push_back(slot);
+	}
+	m_cv.notify_all();
+	return true;
+}
+
+bool ThreadedReadBackend::Complete(size_t slot) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv.wait(lock, [&] { return m_slots[slot].done; });
+	return m_slots[slot].ok;
+}
+
+void ThreadedReadBackend::IoLoop() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_cv.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+		if (m_queue.empty()) return;    // stopping and nothing left to do
+
+		size_t slot = m_queue.front();
+		m_queue.pop_front();
+		Slot s = m_slots[slot];
+		lock.unlock();
+
+		bool ok = m_drive.SendSCSI(s.cdb, s.cdbLength, s.buffer, s.bufferSize);
+
+		lock.lock();
+		m_slots[slot].ok = ok;
+		m_slots[slot].done = true;
+		m_cv.notify_all();
+	}
+}
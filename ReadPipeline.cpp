@@ -0,0 +1,98 @@
+﻿// ============================================================================
+// ReadPipeline.cpp - In-order pipelined READ CD with a consumer thread
+// ============================================================================
+#include "ReadPipeline.h"
+#include <cstring>
+
+ReadPipeline::ReadPipeline(ReadBackend& backend, CompletionFn onComplete, ConsumerFn consume)
+	: m_backend(backend), m_onComplete(std::move(onComplete)), m_consume(std::move(consume)) {
+	for (size_t i = backend.Depth(); i-- > 0; ) m_freeSlots.push_back(i);
+	m_worker = std::thread(&ReadPipeline::WorkerLoop, this);
+}
+
+ReadPipeline::~ReadPipeline() {
+	// Outstanding commands still target caller buffers — finish them before
+	// anything can be released.
+	Drain();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_workCv.notify_all();
+	m_worker.join();
+}
+
+void ReadPipeline::BuildReadCdAudio(BYTE cdb[12], DWORD lba, DWORD count) {
+	memset(cdb, 0, 12);
+	cdb[0] = SCSI_READ_CD;
+	cdb[1] = 0x04; // Expected sector type: CD-DA
+	cdb[2] = (lba >> 24) & 0xFF;
+	cdb[3] = (lba >> 16) & 0xFF;
+	cdb[4] = (lba >> 8) & 0xFF;
+	cdb[5] = lba & 0xFF;
+	cdb[6] = (count >> 16) & 0xFF;
+	cdb[7] = (count >> 8) & 0xFF;
+	cdb[8] = count & 0xFF;
+	cdb[9] = 0xF8; // User data + header + EDC/ECC
+	cdb[10] = 0x00; // No subchannel
+}
+
+void ReadPipeline::Submit(DWORD lba, DWORD count, BYTE* buffer) {
+	if (m_freeSlots.empty()) CompleteOldest();
+
+	size_t slot = m_freeSlots.back();
+	m_freeSlots.pop_back();
+
+	BYTE cdb[12];
+	BuildReadCdAudio(cdb, lba, count);
+	PipelineRead read;
+	read.lba = lba;
+	read.count = count;
+	read.buffer = buffer;
+	bool issued = m_backend.Submit(slot, cdb, sizeof(cdb), buffer, count * AUDIO_SECTOR_SIZE);
+	m_inFlight.push_back({ slot, issued, read });
+}
+
+void ReadPipeline::CompleteOldest() {
+	Outstanding next = m_inFlight.front();
+	m_inFlight.pop_front();
+
+	// A command that never started still completes, in order, as a failure.
+	next.read.ok = next.issued && m_backend.Complete(next.slot);
+	m_freeSlots.push_back(next.slot);
+
+	if (m_onComplete) m_onComplete(next.read);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCv.wait(lock, [&] { return m_ready.size() < MAX_BACKLOG; });
+	m_ready.push_back(next.read);
+	lock.unlock();
+	m_workCv.notify_one();
+}
+
+void ReadPipeline::Drain() {
+	while (!m_inFlight.empty()) CompleteOldest();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCv.wait(lock, [&] { return m_ready.empty() && !m_workerBusy; });
+}
+
+void ReadPipeline::WorkerLoop() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_workCv.wait(lock, [&] { return m_stop || !m_ready.empty(); });
+		if (m_ready.empty()) return;
+
+		PipelineRead read = m_ready.front();
+		m_ready.pop_front();
+		m_workerBusy = true;
+		lock.unlock();
+		m_idleCv.notify_all();
+
+		if (m_consume) m_consume(read);
+
+		lock.lock();
+		m_workerBusy = false;
+		m_idleCv.notify_all();
+	}
+}
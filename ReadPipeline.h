@@ -0,0 +1,167 @@
+﻿// ============================================================================
+// ReadPipeline.h - Pipelined READ CD engine
+//
+// The rip loops used to issue one READ CD, wait for it, process the data and
+// only then issue the next — the drive idled during every bit of host work.
+// ReadPipeline keeps up to Depth() commands queued at the drive, completes
+// them strictly in submission order, and hands each finished read to a
+// worker thread, so hashing / AccurateRip accumulation / file writing run
+// while the drive is already transferring the next batch.
+//
+// Backends:
+//   OverlappedReadBackend  second handle opened with FILE_FLAG_OVERLAPPED,
+//                          one OVERLAPPED + SPTD block per slot (Windows)
+//   ThreadedReadBackend    synchronous SendSCSI calls on an I/O thread;
+//                          works on any ScsiDrive (and emulated drives)
+// ============================================================================
+#pragma once
+
+#include "ScsiDrive.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One READ CD for `count` CD-DA sectors at `lba`, landing in `buffer`
+// (count * 2352 bytes, valid until the read has been consumed).
+struct PipelineRead {
+	DWORD lba = 0;
+	DWORD count = 0;
+	BYTE* buffer = nullptr;
+	bool ok = false;
+};
+
+class ReadBackend {
+public:
+	virtual ~ReadBackend() = default;
+
+	// Number of commands that may be outstanding at once.
+	virtual size_t Depth() const = 0;
+
+	// Start the command in `slot` (0 <= slot < Depth()).  Returns false if
+	// it could not be issued at all.
+	virtual bool Submit(size_t slot, const BYTE* cdb, BYTE cdbLength,
+		BYTE* buffer, DWORD bufferSize) = 0;
+
+	// Block until the command in `slot` finishes; true on SCSI GOOD (or a
+	// recovered-error CHECK CONDITION, as ScsiDrive::SendSCSI accepts).
+	virtual bool Complete(size_t slot) = 0;
+
+	// Overlapped backend when the drive can be reopened for overlapped I/O,
+	// otherwise the threaded one.
+	static std::unique_ptr<ReadBackend> Create(ScsiDrive& drive, size_t depth);
+};
+
+class OverlappedReadBackend : public ReadBackend {
+public:
+	~OverlappedReadBackend() override;
+
+	static std::unique_ptr<OverlappedReadBackend> Open(wchar_t driveLetter, size_t depth);
+
+	size_t Depth() const override { return m_slots.size(); }
+	bool Submit(size_t slot, const BYTE* cdb, BYTE cdbLength,
+		BYTE* buffer, DWORD bufferSize) override;
+	bool Complete(size_t slot) override;
+
+private:
+	struct Slot {
+		std::vector<BYTE> sptd;         // SCSI_PASS_THROUGH_DIRECT + sense
+		OVERLAPPED overlapped = {};
+		bool pending = false;
+		bool issued = false;
+	};
+
+	OverlappedReadBackend() = default;
+
+	HANDLE m_handle = INVALID_HANDLE_VALUE;
+	std::vector<Slot> m_slots;
+};
+
+class ThreadedReadBackend : public ReadBackend {
+public:
+	ThreadedReadBackend(ScsiDrive& drive, size_t depth);
+	~ThreadedReadBackend() override;
+
+	size_t Depth() const override { return m_slots.size(); }
+	bool Submit(size_t slot, const BYTE* cdb, BYTE cdbLength,
+		BYTE* buffer, DWORD bufferSize) override;
+	bool Complete(size_t slot) override;
+
+private:
+	struct Slot {
+		BYTE cdb[16] = {};
+		BYTE cdbLength = 0;
+		BYTE* buffer = nullptr;
+		DWORD bufferSize = 0;
+		bool done = true;
+		bool ok = false;
+	};
+
+	void IoLoop();
+
+	ScsiDrive& m_drive;
+	std::vector<Slot> m_slots;
+	std::deque<size_t> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+	std::thread m_thread;
+};
+
+class ReadPipeline {
+public:
+	// onComplete runs on the submitting thread, in order, before the read
+	// is handed on — the place to patch a failed batch with single-sector
+	// re-reads.  consume runs on the worker thread, in the same order.
+	using CompletionFn = std::function<void(PipelineRead&)>;
+	using ConsumerFn = std::function<void(const PipelineRead&)>;
+
+	ReadPipeline(ReadBackend& backend, CompletionFn onComplete, ConsumerFn consume);
+	~ReadPipeline();
+
+	ReadPipeline(const ReadPipeline&) = delete;
+	ReadPipeline& operator=(const ReadPipeline&) = delete;
+
+	// Queue a CD-DA read; blocks while Depth() reads are outstanding by
+	// completing the oldest one.
+	void Submit(DWORD lba, DWORD count, BYTE* buffer);
+
+	// Complete every outstanding read and wait until the worker has
+	// consumed all of them.
+	void Drain();
+
+	size_t InFlight() const { return m_inFlight.size(); }
+
+	static void BuildReadCdAudio(BYTE cdb[12], DWORD lba, DWORD count);
+
+private:
+	struct Outstanding {
+		size_t slot;
+		bool issued;
+		PipelineRead read;
+	};
+
+	// Reads handed to the worker but not yet consumed; bounds memory when
+	// callers recycle buffers.
+	static constexpr size_t MAX_BACKLOG = 64;
+
+	void CompleteOldest();
+	void WorkerLoop();
+
+	ReadBackend& m_backend;
+	CompletionFn m_onComplete;
+	ConsumerFn m_consume;
+	std::deque<Outstanding> m_inFlight;
+	std::vector<size_t> m_freeSlots;
+
+	std::mutex m_mutex;
+	std::condition_variable m_workCv;
+	std::condition_variable m_idleCv;
+	std::deque<PipelineRead> m_ready;
+	bool m_workerBusy = false;
+	bool m_stop = false;
+	std::thread m_worker;
+};
@@ -0,0 +1,423 @@
+﻿// ============================================================================
+// RipStream.cpp - Offset-corrected output written during the read
+// ============================================================================
+#define NOMINMAX
+#include "RipStream.h"
+#include "DiscLayout.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+	constexpr uint64_t WAV_HEADER_BYTES = 44;
+	constexpr uint64_t UNKNOWN_POSITION = UINT64_MAX;
+
+	const BYTE* ZeroSector() {
+		static const BYTE zeros[AUDIO_SECTOR_SIZE] = {};
+		return zeros;
+	}
+}
+
+void WriteWavHeader(std::ostream& out, uint32_t dataBytes) {
+	uint32_t fileSize = dataBytes + 36;
+	uint16_t audioFmt = 1, ch = 2, bps = 16;
+	uint32_t rate = 44100;
+	uint16_t blockAlign = ch * (bps / 8);
+	uint32_t byteRate = rate * blockAlign;
+	uint32_t fmtSize = 16;
+
+	out.write("RIFF", 4);
+	out.write(reinterpret_cast<const char*>(&fileSize), 4);
+	out.write("WAVE", 4);
+	out.write("fmt ", 4);
+	out.write(reinterpret_cast<const char*>(&fmtSize), 4);
+	out.write(reinterpret_cast<const char*>(&audioFmt), 2);
+	out.write(reinterpret_cast<const char*>(&ch), 2);
+	out.write(reinterpret_cast<const char*>(&rate), 4);
+	out.write(reinterpret_cast<const char*>(&byteRate), 4);
+	out.write(reinterpret_cast<const char*>(&blockAlign), 2);
+	out.write(reinterpret_cast<const char*>(&bps), 2);
+	out.write("data", 4);
+	out.write(reinterpret_cast<const char*>(&dataBytes), 4);
+}
+
+RipStreamWriter::~RipStreamWriter() {
+	CloseAll();
+}
+
+// ============================================================================
+// Layout
+// ============================================================================
+
+// The sector count the read loops store: every selected track from its read
+// start (pregap or INDEX 01) to its end.
+void RipStreamWriter::Reset(const DiscInfo& disc) {
+	WaitFlac();
+	CloseAll();
+	m_flac.clear();
+	m_files.clear();
+	m_audio.clear();
+	m_sub.clear();
+	m_pregapFiles.clear();
+	m_audioDone = 0;
+	m_subDone = 0;
+	m_failed = false;
+
+	m_total = DiscLayout::ForRip(disc).TotalSectors();
+
+	// Same bound as ApplyOffsetCorrection: an offset the size of the whole
+	// rip is not applied at all.
+	m_offsetBytes = static_cast<int64_t>(disc.driveOffset) * 4;
+	if (static_cast<uint64_t>(std::abs(m_offsetBytes)) >=
+		static_cast<uint64_t>(m_total) * AUDIO_SECTOR_SIZE) {
+		m_offsetBytes = 0;
+	}
+}
+
+bool RipStreamWriter::AddFile(const std::wstring& path, bool subchannel, size_t& index) {
+	OutFile file;
+	file.path = path;
+	file.subchannel = subchannel;
+	file.stream.open(path, std::ios::binary | std::ios::trunc);
+	if (!file.stream) return false;
+	index = m_files.size();
+	m_files.push_back(std::move(file));
+	return true;
+}
+
+void RipStreamWriter::AddSegment(std::vector<Segment>& segments, size_t first, size_t count,
+	size_t file) {
+	if (count == 0) return;
+	Segment seg;
+	seg.first = first;
+	seg.count = count;
+	seg.file = file;
+	for (const auto& s : segments) {
+		if (s.file == file) seg.fileSector += s.count;
+	}
+	segments.push_back(seg);
+	m_files[file].endSector = std::max(m_files[file].endSector, first + count);
+}
+
+bool RipStreamWriter::OpenImage(const DiscInfo& disc, const std::wstring& basePath) {
+	Reset(disc);
+
+	size_t bin = 0, sub = 0;
+	if (!AddFile(basePath + L".bin", false, bin)) return false;
+	if (disc.includeSubchannel && !AddFile(basePath + L".sub", true, sub)) {
+		Abort();
+		return false;
+	}
+
+	// Mirrors SaveToFile's walk over the store.
+	size_t sectorIdx = 0;
+	for (const auto& t : disc.tracks) {
+		if (disc.selectedSession > 0 && t.session != disc.selectedSession) continue;
+
+		DWORD start = t.pregapLBA;
+		if (t.endLBA < start) continue;
+		DWORD count = t.endLBA - start + 1;
+
+		if (disc.pregapMode == PregapMode::Skip) {
+			start = t.startLBA;
+			if (t.endLBA < start) continue;
+			count = t.endLBA - start + 1;
+		}
+		else if (disc.pregapMode == PregapMode::Separate && t.pregapLBA < t.startLBA) {
+			std::wstring pregapPath = basePath + L"_track" +
+				std::to_wstring(t.trackNumber) + L"_pregap.bin";
+			size_t pregapFile = 0;
+			if (!AddFile(pregapPath, false, pregapFile)) {
+				Abort();
+				return false;
+			}
+			DWORD pregapCount = t.startLBA - t.pregapLBA;
+			AddSegment(m_audio, sectorIdx, pregapCount, pregapFile);
+			m_pregapFiles.push_back(pregapPath);
+			sectorIdx += pregapCount;
+
+			start = t.startLBA;
+			if (t.endLBA < t.startLBA) continue;
+			count = t.endLBA - t.startLBA + 1;
+		}
+
+		AddSegment(m_audio, sectorIdx, count, bin);
+		if (disc.includeSubchannel && t.isAudio) AddSegment(m_sub, sectorIdx, count, sub);
+		sectorIdx += count;
+	}
+	return true;
+}
+
+bool RipStreamWriter::OpenTrackFiles(const DiscInfo& disc, const std::vector<TrackFile>& files) {
+	Reset(disc);
+
+	for (const auto& tf : files) {
+		if (tf.sectorCount == 0 || tf.firstSector + tf.sectorCount > m_total) {
+			Abort();
+			return false;
+		}
+
+		if (tf.flac) {
+			FlacTrack ft;
+			ft.file = tf;
+			int64_t from = static_cast<int64_t>(tf.firstSector) * AUDIO_SECTOR_SIZE + m_offsetBytes;
+			int64_t to = from + static_cast<int64_t>(tf.sectorCount) * AUDIO_SECTOR_SIZE;
+			ft.inFirst = from <= 0 ? 0 : static_cast<size_t>(from / AUDIO_SECTOR_SIZE);
+			ft.inEnd = to <= 0 ? 0 : std::min(m_total,
+				static_cast<size_t>((to + AUDIO_SECTOR_SIZE - 1) / AUDIO_SECTOR_SIZE));
+			m_flac.push_back(std::move(ft));
+			if (!m_encoder) m_encoder = std::make_unique<FlacEncodeQueue>();
+			continue;
+		}
+
+		uint64_t dataBytes = static_cast<uint64_t>(tf.sectorCount) * AUDIO_SECTOR_SIZE;
+		size_t index = 0;
+		if (dataBytes > 0xFFFFFFFFull - 36ull || !AddFile(tf.path, false, index)) {
+			Abort();
+			return false;
+		}
+		OutFile& file = m_files[index];
+		WriteWavHeader(file.stream, static_cast<uint32_t>(dataBytes));
+		file.headerBytes = WAV_HEADER_BYTES;
+		file.position = WAV_HEADER_BYTES;
+		AddSegment(m_audio, tf.firstSector, tf.sectorCount, index);
+	}
+	return true;
+}
+
+// ============================================================================
+// Streaming
+// ============================================================================
+
+void RipStreamWriter::Advance(SectorStore& store, size_t upTo, const std::vector<size_t>& keep) {
+	if (!IsOpen()) return;
+	upTo = std::min(upTo, m_total);
+
+	if (upTo > m_subDone) {
+		WriteSubchannel(store, m_subDone, upTo - m_subDone);
+		m_subDone = upTo;
+	}
+
+	// Output sector j is input bytes [j * 2352 + offset, (j + 1) * 2352 +
+	// offset); it can go once all of those are in.
+	size_t ready = m_total;
+	if (upTo < m_total) {
+		int64_t avail = static_cast<int64_t>(upTo) * AUDIO_SECTOR_SIZE - m_offsetBytes;
+		ready = avail <= 0 ? 0 : std::min<size_t>(static_cast<size_t>(avail / AUDIO_SECTOR_SIZE), m_total);
+	}
+	if (ready > m_audioDone) {
+		WriteAudio(store, m_audioDone, ready - m_audioDone);
+		m_audioDone = ready;
+	}
+	SubmitFlac(store, upTo, keep);
+
+	// Everything before the input of the next output sector is out.
+	int64_t needed = static_cast<int64_t>(m_audioDone) * AUDIO_SECTOR_SIZE + m_offsetBytes;
+	size_t releaseTo = needed <= 0 ? 0
+		: std::min(static_cast<size_t>(needed / AUDIO_SECTOR_SIZE), m_subDone);
+	store.ReleaseBelow(releaseTo, HeldSectors(releaseTo, keep));
+
+	CloseFinished();
+}
+
+void RipStreamWriter::Patch(const SectorStore& store, size_t index) {
+	if (m_files.empty() || index >= m_total || index >= store.size()) return;
+
+	// The sector's audio sits `offset` bytes earlier in the output; only the
+	// part already written needs rewriting, the rest goes out from the store.
+	int64_t from = static_cast<int64_t>(index) * AUDIO_SECTOR_SIZE - m_offsetBytes;
+	int64_t to = from + AUDIO_SECTOR_SIZE;
+	from = std::max<int64_t>(from, 0);
+	to = std::min<int64_t>(to, static_cast<int64_t>(m_audioDone) * AUDIO_SECTOR_SIZE);
+
+	const BYTE* input = store.Audio(0);
+	for (const auto& seg : m_audio) {
+		int64_t segFrom = static_cast<int64_t>(seg.first) * AUDIO_SECTOR_SIZE;
+		int64_t segTo = static_cast<int64_t>(seg.first + seg.count) * AUDIO_SECTOR_SIZE;
+		int64_t a = std::max(from, segFrom);
+		int64_t b = std::min(to, segTo);
+		if (a >= b) continue;
+		const OutFile& file = m_files[seg.file];
+		WriteAt(seg.file, file.headerBytes + static_cast<uint64_t>(seg.fileSector) * AUDIO_SECTOR_SIZE +
+			static_cast<uint64_t>(a - segFrom), input + a + m_offsetBytes, static_cast<size_t>(b - a));
+	}
+
+	if (index < m_subDone) WriteSubchannel(store, index, 1);
+}
+
+bool RipStreamWriter::Finish(SectorStore& store) {
+	Advance(store, m_total);
+	WaitFlac();
+	CloseAll();
+	return !m_failed;
+}
+
+void RipStreamWriter::Abort() {
+	WaitFlac();
+	CloseAll();
+	for (const auto& file : m_files) DeleteFileW(file.path.c_str());
+	for (const auto& ft : m_flac) {
+		if (ft.submitted) DeleteFileW(ft.file.path.c_str());
+	}
+	m_files.clear();
+	m_flac.clear();
+	m_audio.clear();
+	m_sub.clear();
+	m_pregapFiles.clear();
+}
+
+// ============================================================================
+// FLAC tracks
+// ============================================================================
+
+void RipStreamWriter::SubmitFlac(const SectorStore& store, size_t upTo, const std::vector<size_t>& keep) {
+	const int64_t inputBytes = static_cast<int64_t>(std::min(store.size(), m_total)) * AUDIO_SECTOR_SIZE;
+	for (auto& ft : m_flac) {
+		if (ft.submitted) continue;
+		if (upTo < ft.inEnd) break;     // Tracks are ascending; later ones need more
+		auto it = std::lower_bound(keep.begin(), keep.end(), ft.inFirst);
+		if (it != keep.end() && *it < ft.inEnd) continue;
+
+		FlacEncodeQueue::Job job;
+		job.path = ft.file.path;
+		job.tags = ft.file.tags;
+		job.bytes = ft.file.sectorCount * AUDIO_SECTOR_SIZE;
+		int64_t from = static_cast<int64_t>(ft.file.firstSector) * AUDIO_SECTOR_SIZE + m_offsetBytes;
+		int64_t to = from + static_cast<int64_t>(job.bytes);
+		if (from >= 0 && to <= inputBytes) {
+			job.pcm = store.Audio(0) + from;
+		}
+		else {
+			// Shifted past either end of the rip: those samples are silence.
+			job.owned.assign(job.bytes, 0);
+			int64_t a = std::max<int64_t>(from, 0);
+			int64_t b = std::min(to, inputBytes);
+			if (a < b) {
+				memcpy(job.owned.data() + (a - from), store.Audio(0) + a, static_cast<size_t>(b - a));
+			}
+			job.pcm = job.owned.data();
+		}
+		ft.result = m_encoder->Submit(std::move(job));
+		ft.submitted = true;
+	}
+}
+
+std::vector<size_t> RipStreamWriter::HeldSectors(size_t releaseTo, const std::vector<size_t>& keep) {
+	std::vector<size_t> held = keep;
+	for (auto& ft : m_flac) {
+		if (ft.done || ft.inFirst >= releaseTo) continue;
+		if (ft.submitted && ft.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			if (!ft.result.get()) m_failed = true;
+			ft.done = true;
+			continue;
+		}
+		// Ascending, at most one sector shared between neighbours.
+		for (size_t i = ft.inFirst; i < std::min(ft.inEnd, releaseTo); i++) held.push_back(i);
+	}
+	if (held.size() > keep.size()) {
+		std::inplace_merge(held.begin(), held.begin() + keep.size(), held.end());
+	}
+	return held;
+}
+
+void RipStreamWriter::WaitFlac() {
+	for (auto& ft : m_flac) {
+		if (!ft.submitted || ft.done) continue;
+		if (!ft.result.get()) m_failed = true;
+		ft.done = true;
+	}
+}
+
+// ============================================================================
+// File access
+// ============================================================================
+
+void RipStreamWriter::WriteAudio(const SectorStore& store, size_t first, size_t count) {
+	const int64_t inputBytes = static_cast<int64_t>(std::min(store.size(), m_total)) * AUDIO_SECTOR_SIZE;
+	const BYTE* input = store.Audio(0);
+
+	for (const auto& seg : m_audio) {
+		size_t a = std::max(first, seg.first);
+		size_t b = std::min(first + count, seg.first + seg.count);
+		if (a >= b) continue;
+
+		// The output run is one contiguous input byte range; only its ends
+		// can fall outside the rip and read as silence.
+		uint64_t out = m_files[seg.file].headerBytes +
+			static_cast<uint64_t>(seg.fileSector + (a - seg.first)) * AUDIO_SECTOR_SIZE;
+		int64_t src = static_cast<int64_t>(a) * AUDIO_SECTOR_SIZE + m_offsetBytes;
+		int64_t end = static_cast<int64_t>(b) * AUDIO_SECTOR_SIZE + m_offsetBytes;
+
+		if (src < 0) {
+			size_t n = static_cast<size_t>(std::min<int64_t>(-src, end - src));
+			WriteAt(seg.file, out, nullptr, n);
+			out += n;
+			src += n;
+		}
+		if (src < end && src < inputBytes) {
+			size_t n = static_cast<size_t>(std::min(end, inputBytes) - src);
+			WriteAt(seg.file, out, input + src, n);
+			out += n;
+			src += n;
+		}
+		if (src < end) WriteAt(seg.file, out, nullptr, static_cast<size_t>(end - src));
+	}
+}
+
+void RipStreamWriter::WriteSubchannel(const SectorStore& store, size_t first, size_t count) {
+	for (const auto& seg : m_sub) {
+		size_t a = std::max(first, seg.first);
+		size_t b = std::min(first + count, seg.first + seg.count);
+		for (size_t i = a; i < b; i++) {
+			WriteAt(seg.file, static_cast<uint64_t>(seg.fileSector + (i - seg.first)) * SUBCHANNEL_SIZE,
+				store.Subchannel(i), SUBCHANNEL_SIZE);
+		}
+	}
+}
+
+void RipStreamWriter::WriteAt(size_t index, uint64_t offset, const BYTE* data, size_t bytes) {
+	OutFile& file = m_files[index];
+	if (file.closed) {
+		// A patch after the file was finished.
+		file.stream.open(file.path, std::ios::in | std::ios::out | std::ios::binary);
+		file.closed = false;
+		file.position = UNKNOWN_POSITION;
+	}
+	if (file.position != offset) {
+		file.stream.seekp(static_cast<std::streamoff>(offset));
+	}
+
+	if (data) {
+		file.stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+	}
+	else {
+		for (size_t done = 0; done < bytes; ) {
+			size_t n = std::min<size_t>(bytes - done, AUDIO_SECTOR_SIZE);
+			file.stream.write(reinterpret_cast<const char*>(ZeroSector()), static_cast<std::streamsize>(n));
+			done += n;
+		}
+	}
+	file.position = offset + bytes;
+	if (!file.stream) m_failed = true;
+}
+
+void RipStreamWriter::CloseFinished() {
+	for (auto& file : m_files) {
+		size_t done = file.subchannel ? m_subDone : m_audioDone;
+		if (!file.closed && done >= file.endSector) {
+			file.stream.close();
+			if (file.stream.fail()) m_failed = true;
+			file.closed = true;
+		}
+	}
+}
+
+void RipStreamWriter::CloseAll() {
+	for (auto& file : m_files) {
+		if (file.closed) continue;
+		file.stream.close();
+		if (file.stream.fail()) m_failed = true;
+		file.closed = true;
+	}
+}
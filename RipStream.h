@@ -0,0 +1,139 @@
+﻿// ============================================================================
+// RipStream.h - Write rip output while the disc is still being read
+//
+// Without it every rip mode holds the whole disc in DiscInfo::rawSectors
+// (~800 MB with subchannel) until SaveToFile / WriteWavFile run.  A
+// RipStreamWriter is handed to AudioCDCopier::SetRipStream before the read;
+// the read loops call Advance as sectors become final, and the writer
+//   - applies the drive offset (output sample i = input sample i + offset,
+//     the ApplyOffsetCorrection convention) straight from the store,
+//   - writes audio and subchannel to their output files at their final
+//     positions, closing each file as soon as its last sector is out, and
+//   - releases the store pages behind it (SectorStore::ReleaseBelow).
+// Sectors the secure engine still has to re-read are passed as `keep`: they
+// are written with their current data and stay resident; Patch rewrites
+// them once a later phase replaces them.
+//
+// Layouts:
+//   OpenImage       <base>.bin, <base>.sub and the PregapMode::Separate
+//                   pregap files — byte-for-byte what SaveToFile writes
+//   OpenTrackFiles  one WAV or FLAC per store range; sectors outside every
+//                   range (TrackRip's gap-fill tracks) are read but not written
+//
+// A FLAC track cannot be patched, so it is encoded in one piece: once all
+// of its input is final (read, none of it in `keep`) it goes to a
+// FlacEncodeQueue worker that reads straight from the store, and its
+// sectors stay resident until that encode is done.
+// ============================================================================
+#pragma once
+
+#include "CDStructures.h"
+#include "FlacEncoder.h"
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The 44-byte RIFF/WAVE header for 16-bit stereo 44100 Hz PCM.
+void WriteWavHeader(std::ostream& out, uint32_t dataBytes);
+
+class RipStreamWriter {
+public:
+	struct TrackFile {
+		std::wstring path;
+		size_t firstSector = 0;     // Store index of the first sector
+		size_t sectorCount = 0;
+		bool flac = false;          // Encode to FLAC instead of writing a WAV
+		FlacTags tags;
+	};
+
+	RipStreamWriter() = default;
+	~RipStreamWriter();
+	RipStreamWriter(const RipStreamWriter&) = delete;
+	RipStreamWriter& operator=(const RipStreamWriter&) = delete;
+
+	// Create the output files for the sectors ReadDisc* will store for
+	// `disc` (selected session and pregap mode as set now).
+	bool OpenImage(const DiscInfo& disc, const std::wstring& basePath);
+	// `files` in ascending, non-overlapping store order.
+	bool OpenTrackFiles(const DiscInfo& disc, const std::vector<TrackFile>& files);
+
+	// Sectors [0, upTo) of the store are final apart from those in `keep`
+	// (store indices, ascending).  Writes everything that depends only on
+	// them and releases what is no longer needed.
+	void Advance(SectorStore& store, size_t upTo, const std::vector<size_t>& keep = {});
+	// Sector `index` was replaced; rewrite whatever of it is already out.
+	void Patch(const SectorStore& store, size_t index);
+	// Write the rest (zero-filled past the end of the input, as the offset
+	// shift does), wait for the FLAC encodes, close every file.  False if
+	// any write or encode failed.
+	bool Finish(SectorStore& store);
+	// Close and delete every file (read cancelled or failed).  Encodes
+	// already running are waited for — they read from the store.
+	void Abort();
+
+	bool IsOpen() const { return !m_files.empty() || !m_flac.empty(); }
+	size_t TotalSectors() const { return m_total; }
+	// Pregap files of an image layout, for the cue listing.
+	const std::vector<std::wstring>& PregapFiles() const { return m_pregapFiles; }
+
+private:
+	struct OutFile {
+		std::wstring path;
+		std::ofstream stream;
+		uint64_t position = 0;      // Put position, UINT64_MAX after a reopen
+		uint64_t headerBytes = 0;   // WAV header before the payload
+		size_t endSector = 0;       // Stream position past its last sector
+		bool subchannel = false;    // Fed from m_sub rather than m_audio
+		bool closed = false;
+	};
+	// Stream positions [first, first + count) land in file `file` from its
+	// `fileSector`-th sector on.
+	struct Segment {
+		size_t first = 0;
+		size_t count = 0;
+		size_t file = 0;
+		size_t fileSector = 0;
+	};
+
+	// A FLAC output: input store sectors [inFirst, inEnd) once offset.
+	struct FlacTrack {
+		TrackFile file;
+		size_t inFirst = 0;
+		size_t inEnd = 0;
+		bool submitted = false;
+		bool done = false;
+		std::future<bool> result;
+	};
+
+	void Reset(const DiscInfo& disc);
+	bool AddFile(const std::wstring& path, bool subchannel, size_t& index);
+	void AddSegment(std::vector<Segment>& segments, size_t first, size_t count, size_t file);
+
+	void SubmitFlac(const SectorStore& store, size_t upTo, const std::vector<size_t>& keep);
+	// Input sectors unfinished FLAC encodes still need, merged into `keep`.
+	std::vector<size_t> HeldSectors(size_t releaseTo, const std::vector<size_t>& keep);
+	void WaitFlac();
+
+	void WriteAudio(const SectorStore& store, size_t first, size_t count);
+	void WriteSubchannel(const SectorStore& store, size_t first, size_t count);
+	// data == nullptr writes zeros.
+	void WriteAt(size_t file, uint64_t offset, const BYTE* data, size_t bytes);
+	void CloseFinished();
+	void CloseAll();
+
+	std::vector<OutFile> m_files;
+	std::vector<Segment> m_audio;       // by output (offset-corrected) position
+	std::vector<Segment> m_sub;         // by store index — subchannel is not shifted
+	std::vector<std::wstring> m_pregapFiles;
+	std::vector<FlacTrack> m_flac;
+	std::unique_ptr<FlacEncodeQueue> m_encoder;
+
+	size_t m_total = 0;                 // Sectors the read will store
+	int64_t m_offsetBytes = 0;          // Drive offset in bytes
+	size_t m_audioDone = 0;             // Output sectors written
+	size_t m_subDone = 0;               // Store sectors whose subchannel is written
+	bool m_failed = false;
+};
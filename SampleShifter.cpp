@@ -0,0 +1,109 @@
+﻿// ============================================================================
+// SampleShifter.cpp - In-place and streaming sample-offset shifting
+// ============================================================================
+#include "SampleShifter.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+void SampleShifter::Reset(int offsetSamples) {
+	m_offset = offsetSamples;
+	size_t absOff = static_cast<size_t>(std::abs(static_cast<int64_t>(offsetSamples) * 4));
+
+	// The ring never holds more than the delayed bytes plus one sector.
+	m_ring.assign(std::max<size_t>(absOff, AUDIO_SECTOR_SIZE) + AUDIO_SECTOR_SIZE, 0);
+	m_head = 0;
+	m_fill = 0;
+	m_inputSectors = 0;
+	m_outputSectors = 0;
+
+	if (offsetSamples > 0) {
+		m_skip = absOff;
+	}
+	else {
+		// A negative offset delays the stream: the head is silence.
+		m_skip = 0;
+		WriteZeros(absOff);
+	}
+}
+
+void SampleShifter::Write(const BYTE* src, size_t bytes) {
+	size_t tail = (m_head + m_fill) % m_ring.size();
+	size_t first = std::min(bytes, m_ring.size() - tail);
+	memcpy(m_ring.data() + tail, src, first);
+	memcpy(m_ring.data(), src + first, bytes - first);
+	m_fill += bytes;
+}
+
+void SampleShifter::WriteZeros(size_t bytes) {
+	size_t tail = (m_head + m_fill) % m_ring.size();
+	size_t first = std::min(bytes, m_ring.size() - tail);
+	memset(m_ring.data() + tail, 0, first);
+	memset(m_ring.data(), 0, bytes - first);
+	m_fill += bytes;
+}
+
+void SampleShifter::Read(BYTE* dst, size_t bytes) {
+	size_t first = std::min(bytes, m_ring.size() - m_head);
+	memcpy(dst, m_ring.data() + m_head, first);
+	memcpy(dst + first, m_ring.data(), bytes - first);
+	m_head = (m_head + bytes) % m_ring.size();
+	m_fill -= bytes;
+}
+
+size_t SampleShifter::Push(const BYTE* in, size_t count, BYTE* out) {
+	size_t written = 0;
+	for (size_t i = 0; i < count; i++) {
+		const BYTE* src = in + i * AUDIO_SECTOR_SIZE;
+		size_t bytes = AUDIO_SECTOR_SIZE;
+		if (m_skip > 0) {
+			size_t drop = std::min(m_skip, bytes);
+			src += drop;
+			bytes -= drop;
+			m_skip -= drop;
+		}
+		Write(src, bytes);
+		m_inputSectors++;
+
+		// Output never runs ahead of input; with a negative offset the bytes
+		// left in the ring at the end are the ones pushed off the tail.
+		while (m_fill >= AUDIO_SECTOR_SIZE && m_outputSectors < m_inputSectors) {
+			Read(out + written * AUDIO_SECTOR_SIZE, AUDIO_SECTOR_SIZE);
+			m_outputSectors++;
+			written++;
+		}
+	}
+	return written;
+}
+
+size_t SampleShifter::Finish(BYTE* out) {
+	size_t written = 0;
+	while (m_outputSectors < m_inputSectors) {
+		if (m_fill < AUDIO_SECTOR_SIZE) WriteZeros(AUDIO_SECTOR_SIZE - m_fill);
+		Read(out + written * AUDIO_SECTOR_SIZE, AUDIO_SECTOR_SIZE);
+		m_outputSectors++;
+		written++;
+	}
+	Reset(m_offset);
+	return written;
+}
+
+void SampleShifter::ShiftInPlace(MutableSectorSpan audio, int offsetSamples) {
+	if (offsetSamples == 0 || audio.empty()) return;
+
+	size_t total = audio.Bytes();
+	size_t absOff = static_cast<size_t>(std::abs(static_cast<int64_t>(offsetSamples) * 4));
+
+	// Bound check: an absurdly large offset for a tiny buffer is a no-op,
+	// matching the old flatten/shift behaviour.
+	if (absOff >= total) return;
+
+	if (offsetSamples > 0) {
+		memmove(audio.data, audio.data + absOff, total - absOff);
+		memset(audio.data + total - absOff, 0, absOff);
+	}
+	else {
+		memmove(audio.data + absOff, audio.data, total - absOff);
+		memset(audio.data, 0, absOff);
+	}
+}
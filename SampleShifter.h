@@ -0,0 +1,56 @@
+﻿// ============================================================================
+// SampleShifter.h - Sample-offset shifting without full-disc copies
+//
+// An offset of +N samples means output sample i is input sample i + N (the
+// stream moves earlier, the tail is zero-filled); -N moves it later and
+// zero-fills the head.  This is the convention of ApplyOffsetCorrection.
+//
+// ShiftInPlace handles a whole contiguous audio span with one memmove.
+// SampleShifter does the same to a stream of sectors that is never held in
+// memory at once (rip-to-disk, BIN writing): it keeps a carry ring of
+// |offset| + one sector of bytes and emits exactly one output sector per
+// input sector, so the result matches ShiftInPlace over the concatenation.
+// ============================================================================
+#pragma once
+
+#include "SectorStore.h"
+#include <cstdint>
+#include <vector>
+
+class SampleShifter {
+public:
+	explicit SampleShifter(int offsetSamples = 0) { Reset(offsetSamples); }
+
+	// Start a new stream with the given offset.
+	void Reset(int offsetSamples);
+	int Offset() const { return m_offset; }
+
+	// Feed `count` input sectors of 2352 bytes.  Up to `count` shifted
+	// sectors are written to `out` (which must not overlap `in`); returns
+	// how many.  A positive offset lags by ceil(|offset|*4 / 2352) sectors.
+	size_t Push(const BYTE* in, size_t count, BYTE* out);
+
+	// Sectors fed but not yet emitted.
+	size_t Pending() const { return static_cast<size_t>(m_inputSectors - m_outputSectors); }
+
+	// Emit the Pending() sectors that are still owed, zero-padding the tail,
+	// and start over.  `out` needs room for Pending() sectors.
+	size_t Finish(BYTE* out);
+
+	// Shift a contiguous span in place, zero-filling the vacated edge.  An
+	// offset at least as large as the span is a no-op.
+	static void ShiftInPlace(MutableSectorSpan audio, int offsetSamples);
+
+private:
+	void Write(const BYTE* src, size_t bytes);
+	void WriteZeros(size_t bytes);
+	void Read(BYTE* dst, size_t bytes);
+
+	int m_offset = 0;
+	size_t m_skip = 0;              // input bytes still to drop (positive offset)
+	std::vector<BYTE> m_ring;       // carry buffer
+	size_t m_head = 0;
+	size_t m_fill = 0;
+	uint64_t m_inputSectors = 0;
+	uint64_t m_outputSectors = 0;
+};
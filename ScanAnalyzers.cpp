@@ -0,0 +1,234 @@
+﻿#define NOMINMAX
+#include "ScanAnalyzers.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// ============================================================================
+// BlerAnalyzer
+// ============================================================================
+
+AudioCDCopier::BlerAnalyzer::BlerAnalyzer(AudioCDCopier& owner, BlerResult& result,
+	const DiscLayout& layout, bool hasC1, int scanSpeed)
+	: m_owner(owner), m_result(result), m_layout(layout), m_hasC1(hasC1), m_scanSpeed(scanSpeed) {
+	m_result = BlerResult{};
+	m_result.totalSectors = layout.TotalSectors();
+	m_result.totalSeconds = layout.TotalSeconds();
+	m_result.perSecondC2.resize(m_result.totalSeconds + 1, { 0, 0 });
+	m_result.hasC1Data = hasC1;
+	if (hasC1) {
+		m_result.perSecondC1.resize(m_result.totalSeconds + 1, { 0, 0 });
+	}
+}
+
+void AudioCDCopier::BlerAnalyzer::AddSector(const ScanSector& sector) {
+	// Buckets follow the layout's linear position, so non-audio gaps
+	// between tracks on mixed-mode discs do not open empty seconds
+	DWORD linear = m_layout.Linear(sector.lba);
+	if (linear == DiscLayout::NOT_COVERED) return;
+	Accumulate(sector, linear / 75, linear % 75 == 0);
+}
+
+void AudioCDCopier::BlerAnalyzer::AddBatch(const ScanSector* sectors, size_t count) {
+	if (count == 0) return;
+	DWORD linear = m_layout.Linear(sectors[0].lba);
+	if (linear == DiscLayout::NOT_COVERED) {
+		ScanAnalyzer::AddBatch(sectors, count);
+		return;
+	}
+
+	size_t secIdx = linear / 75;
+	DWORD inSecond = linear % 75;
+	for (size_t i = 0; i < count; i++) {
+		Accumulate(sectors[i], secIdx, inSecond == 0);
+		if (++inSecond == 75) {
+			inSecond = 0;
+			secIdx++;
+		}
+	}
+}
+
+void AudioCDCopier::BlerAnalyzer::Accumulate(const ScanSector& sector, size_t secIdx, bool bucketStart) {
+	// Record the starting LBA for each time bucket
+	if (bucketStart) {
+		m_result.perSecondC2[secIdx].first = sector.lba;
+		if (m_hasC1)
+			m_result.perSecondC1[secIdx].first = sector.lba;
+	}
+
+	int zoneError = 0;
+
+	if (sector.readOk) {
+		// Collect C1 block errors (when available)
+		if (m_hasC1 && sector.c1BlockErrors > 0) {
+			m_result.totalC1Errors += sector.c1BlockErrors;
+			m_result.totalC1Sectors++;
+			m_result.perSecondC1[secIdx].second += sector.c1BlockErrors;
+
+			if (sector.c1BlockErrors > m_result.maxC1InSingleSector) {
+				m_result.maxC1InSingleSector = sector.c1BlockErrors;
+				m_result.worstC1SectorLBA = sector.lba;
+			}
+		}
+
+		int effectiveC2 = std::max(sector.c2Errors, sector.c2BlockErrors);
+
+		if (effectiveC2 > 0) {
+			if (!sector.recovered) {
+				m_result.totalC2Errors += effectiveC2;
+				m_result.totalC2Sectors++;
+				m_result.perSecondC2[secIdx].second += effectiveC2;
+
+				if (effectiveC2 > m_result.maxC2InSingleSector) {
+					m_result.maxC2InSingleSector = effectiveC2;
+					m_result.worstSectorLBA = sector.lba;
+				}
+
+				zoneError = 1;
+				m_errorLBAs.push_back(sector.lba);
+				m_sectorErrors.push_back({ sector.lba, effectiveC2 });
+
+				m_errorRun++;
+				if (m_errorRun > m_result.consecutiveErrorSectors) {
+					m_result.consecutiveErrorSectors = m_errorRun;
+				}
+			}
+			else {
+				m_errorRun = 0;
+				m_result.recoveredC2Errors += effectiveC2;
+				m_result.recoveredC2Sectors++;
+			}
+		}
+		else {
+			m_errorRun = 0;
+		}
+	}
+	else {
+		m_result.totalReadFailures++;
+		m_result.perSecondC2[secIdx].second++;   // register in per-second data
+		zoneError = 1;
+		m_errorLBAs.push_back(sector.lba);
+
+		m_errorRun++;
+		if (m_errorRun > m_result.consecutiveErrorSectors) {
+			m_result.consecutiveErrorSectors = m_errorRun;
+		}
+	}
+
+	m_owner.ClassifyZone(sector.lba, m_layout.FirstLBA(), m_layout.LastLBA(), zoneError, m_result.zoneStats);
+}
+
+void AudioCDCopier::BlerAnalyzer::Finish() {
+	// Sort and keep top 10 worst C2 sectors by error count
+	std::sort(m_sectorErrors.begin(), m_sectorErrors.end(),
+		[](const auto& a, const auto& b) { return a.second > b.second; });
+	if (m_sectorErrors.size() > 10) m_sectorErrors.resize(10);
+	m_result.topWorstC2Sectors = std::move(m_sectorErrors);
+
+	m_owner.AnalyzeBlerResults(m_result, m_errorLBAs, m_scanSpeed);
+}
+
+// ============================================================================
+// RotZoneAnalyzer
+// ============================================================================
+
+AudioCDCopier::RotZoneAnalyzer::RotZoneAnalyzer(AudioCDCopier& owner, DiscRotAnalysis& result,
+	const DiscLayout& layout, int scanSpeed)
+	: m_owner(owner), m_result(result), m_layout(layout), m_scanSpeed(scanSpeed) {}
+
+void AudioCDCopier::RotZoneAnalyzer::AddSector(const ScanSector& sector) {
+	bool isError = !sector.readOk || sector.verifiedC2 > 0;
+	m_owner.ClassifyZone(sector.lba, m_layout.FirstLBA(), m_layout.LastLBA(), isError ? 1 : 0, m_result.zones,
+		sector.weight);
+	if (isError) m_errorLBAs.push_back(sector.lba);
+	if (sector.readOk && sector.verifiedC2 > m_maxC2) m_maxC2 = sector.verifiedC2;
+}
+
+void AudioCDCopier::RotZoneAnalyzer::Finish() {
+	std::sort(m_errorLBAs.begin(), m_errorLBAs.end());
+	m_owner.DetectErrorClusters(m_errorLBAs, m_result.clusters, m_scanSpeed);
+	m_result.maxC2InSingleSector = m_maxC2;
+}
+
+// ============================================================================
+// AudioContentAnalyzer
+// ============================================================================
+
+void AudioCDCopier::AudioContentAnalyzer::AddSector(const ScanSector& sector) {
+	m_tested++;
+	if (!sector.readOk) {
+		m_readFailures++;
+		return;
+	}
+
+	const BYTE* buf = sector.audio;
+	bool suspicious = false;
+	bool silent = m_owner.IsSectorSilent(buf);
+
+	if (silent) {
+		m_result.silentSectors++;
+	}
+	if (m_owner.IsSectorClipped(buf)) {
+		m_result.clippedSectors++;
+		suspicious = true;
+	}
+
+	// Calculate RMS level for accurate low-level detection
+	int64_t sampleSum = 0;
+	int sampleCount = AUDIO_SECTOR_SIZE / 2;
+	for (int i = 0; i < AUDIO_SECTOR_SIZE; i += 2) {
+		int16_t sample = *reinterpret_cast<const int16_t*>(buf + i);
+		sampleSum += static_cast<int64_t>(sample) * sample;  // RMS calculation
+	}
+	double rms = std::sqrt(static_cast<double>(sampleSum) / sampleCount);
+
+	// Low-level if RMS < 1000 (about 3% of max)
+	if (rms > 50 && rms < 1000 && !silent) {
+		m_result.lowLevelSectors++;
+		suspicious = true;
+	}
+
+	// Per-channel DC offset detection
+	// Check each channel independently so single-channel bias is not masked
+	int64_t dcSumL = 0, dcSumR = 0;
+	int channelSamples = AUDIO_SECTOR_SIZE / 4;  // samples per channel
+	for (int i = 0; i < AUDIO_SECTOR_SIZE; i += 4) {
+		dcSumL += *reinterpret_cast<const int16_t*>(buf + i);
+		dcSumR += *reinterpret_cast<const int16_t*>(buf + i + 2);
+	}
+	double dcOffsetL = std::abs(static_cast<double>(dcSumL) / channelSamples);
+	double dcOffsetR = std::abs(static_cast<double>(dcSumR) / channelSamples);
+	double dcOffset = std::max(dcOffsetL, dcOffsetR);
+	if (dcOffset > 1000.0) {  // ~3% of max: filters normal audio asymmetry
+		m_result.dcOffsetSectors++;
+		suspicious = true;
+	}
+
+	if (suspicious) {
+		m_result.suspiciousLBAs.push_back(sector.lba);
+	}
+}
+
+// ============================================================================
+// SectorHashAnalyzer
+// ============================================================================
+
+SectorHashAnalyzer::SectorHashAnalyzer(const DiscLayout& layout)
+	: m_layout(layout) {
+	m_hashes.resize(layout.TotalSectors());
+	m_valid.resize(layout.TotalSectors(), 0);
+}
+
+void SectorHashAnalyzer::AddSector(const ScanSector& sector) {
+	if (!sector.readOk) return;
+	DWORD idx = m_layout.Linear(sector.lba);
+	if (idx == DiscLayout::NOT_COVERED) return;
+	m_hashes[idx] = SectorHash::Compute(sector.audio, AUDIO_SECTOR_SIZE);
+	m_valid[idx] = 1;
+}
+
+const SectorHash* SectorHashAnalyzer::Find(DWORD lba) const {
+	DWORD idx = m_layout.Linear(lba);
+	if (idx == DiscLayout::NOT_COVERED || !m_valid[idx]) return nullptr;
+	return &m_hashes[idx];
+}
@@ -0,0 +1,132 @@
+﻿// ============================================================================
+// ScanAnalyzers.h - Per-sector analyzers shared by the quality scans
+//
+// A scan pass reads each sector once and hands the result to every analyzer
+// attached to it.  The comprehensive scan runs BLER bucketing, disc rot
+// zoning, audio content statistics and per-sector hashing off a single read
+// of the disc; the stand-alone BLER, disc rot and audio content scans feed
+// the same analyzers from their own passes, so both report identically.
+//
+// The BLER, rot and audio analyzers are nested in AudioCDCopier because
+// they share its private classification helpers.
+// ============================================================================
+#pragma once
+
+#include "AudioCDCopier.h"
+#include "DiscLayout.h"
+#include <vector>
+
+// ── ScanSector ──────────────────────────────────────────────────────────
+// One sector as returned by a scan read.
+struct ScanSector {
+	DWORD lba = 0;
+	const BYTE* audio = nullptr;    // AUDIO_SECTOR_SIZE bytes, valid when readOk
+	bool readOk = false;
+	bool recovered = false;         // sense 0x01 — the drive corrected it internally
+	int c2Errors = 0;               // C2 count from the read
+	int verifiedC2 = 0;             // C2 after any verification re-read (rot zoning)
+	int c1BlockErrors = 0;          // per-sector block counts, when the drive reports them
+	int c2BlockErrors = 0;
+	int weight = 1;                 // sectors this one stands for in a sampled pass (zone rates)
+};
+
+class ScanAnalyzer {
+public:
+	virtual ~ScanAnalyzer() = default;
+	// Before the first sector of each audio track.
+	virtual void BeginTrack() {}
+	virtual void AddSector(const ScanSector& sector) = 0;
+	// Consecutive LBAs within one track, as returned by one batched read.
+	virtual void AddBatch(const ScanSector* sectors, size_t count) {
+		for (size_t i = 0; i < count; i++) AddSector(sectors[i]);
+	}
+	// After the last sector of the pass.
+	virtual void Finish() {}
+};
+
+// ── BLER buckets ────────────────────────────────────────────────────────
+// Per-second C1/C2 buckets, worst sectors, error runs and zone statistics.
+// Finish() runs AnalyzeBlerResults.
+class AudioCDCopier::BlerAnalyzer : public ScanAnalyzer {
+public:
+	BlerAnalyzer(AudioCDCopier& owner, BlerResult& result, const DiscLayout& layout,
+		bool hasC1, int scanSpeed);
+
+	void BeginTrack() override { m_errorRun = 0; }
+	void AddSector(const ScanSector& sector) override;
+	// One layout lookup per batch; the bucket advances by counting.
+	void AddBatch(const ScanSector* sectors, size_t count) override;
+	void Finish() override;
+
+private:
+	void Accumulate(const ScanSector& sector, size_t secIdx, bool bucketStart);
+
+	AudioCDCopier& m_owner;
+	BlerResult& m_result;
+	const DiscLayout& m_layout;
+	bool m_hasC1;
+	int m_scanSpeed;
+	int m_errorRun = 0;
+	std::vector<DWORD> m_errorLBAs;
+	std::vector<std::pair<DWORD, int>> m_sectorErrors;
+};
+
+// ── Disc rot zones ──────────────────────────────────────────────────────
+// Inner / middle / outer error rates, error LBAs and clusters.  Uses
+// ScanSector::verifiedC2.
+class AudioCDCopier::RotZoneAnalyzer : public ScanAnalyzer {
+public:
+	RotZoneAnalyzer(AudioCDCopier& owner, DiscRotAnalysis& result, const DiscLayout& layout,
+		int scanSpeed);
+
+	void AddSector(const ScanSector& sector) override;
+	void Finish() override;
+
+	// Sorted after Finish().
+	const std::vector<DWORD>& ErrorLBAs() const { return m_errorLBAs; }
+
+private:
+	AudioCDCopier& m_owner;
+	DiscRotAnalysis& m_result;
+	const DiscLayout& m_layout;
+	int m_scanSpeed;
+	int m_maxC2 = 0;
+	std::vector<DWORD> m_errorLBAs;
+};
+
+// ── Audio content ───────────────────────────────────────────────────────
+// Silence, clipping, low level and DC offset per sector.
+class AudioCDCopier::AudioContentAnalyzer : public ScanAnalyzer {
+public:
+	AudioContentAnalyzer(AudioCDCopier& owner, AudioAnalysisResult& result)
+		: m_owner(owner), m_result(result) {}
+
+	void AddSector(const ScanSector& sector) override;
+
+	int Tested() const { return m_tested; }
+	int ReadFailures() const { return m_readFailures; }
+
+private:
+	AudioCDCopier& m_owner;
+	AudioAnalysisResult& m_result;
+	int m_tested = 0;
+	int m_readFailures = 0;
+};
+
+// ── Sector hashes ───────────────────────────────────────────────────────
+// SectorHash of every sector read, for later re-read consistency checks
+// without a second full pass.  Indexed by DiscLayout::Linear.
+class SectorHashAnalyzer : public ScanAnalyzer {
+public:
+	explicit SectorHashAnalyzer(const DiscLayout& layout);
+
+	void AddSector(const ScanSector& sector) override;
+
+	// nullptr if the sector is outside the layout or failed to read.
+	const SectorHash* Find(DWORD lba) const;
+
+private:
+	const DiscLayout& m_layout;
+	std::vector<SectorHash> m_hashes;
+	std::vector<BYTE> m_valid;
+};
@@ -184,6 +184,12 @@ struct DiscRotAnalysis {
 	int pioneerE22Peak = 0;                     // Peak Pioneer E22 diagnostic count in Phase 0
 	std::string pioneerE22Rating;               // Ideal / Good / Acceptable / Concerning
 
+	// Phase 0 C1 and Phase 1 C2 on one time axis (DiscLayout::ForScan seconds)
+	std::vector<int> perSecondC1;               // vendor-scan C1 per second; empty without C1
+	std::vector<int> perSecondC2;               // C2 / failed sectors per second; -1 = not read
+	bool c2Guided = false;                      // Phase 1 read only where the C1 map pointed
+	DWORD c2SectorsRead = 0;                    // Phase 1 sectors actually read
+
 	// Heuristic disc-rot pattern flags
 	bool edgeConcentration = false;             // Errors concentrated at inner/outer edges
 	bool progressivePattern = false;            // Error rate increases toward the outer edge
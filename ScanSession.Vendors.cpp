@@ -0,0 +1,55 @@
+﻿// ============================================================================
+// ScanSession.Vendors.cpp - Session configurations for the drive scan commands
+// ============================================================================
+#include "ScanSession.h"
+#include "ScsiDrive.h"
+
+ScanSession::Config ScanSession::ForQualityScan(ScsiDrive& drive, Vendor vendor,
+	DWORD firstLBA, DWORD lastLBA, int scanSpeed) {
+	Config config;
+	config.firstLBA = firstLBA;
+	config.lastLBA = lastLBA;
+
+	switch (vendor) {
+	case Vendor::PlextorQCheck:
+		// Scans at ~1x on its own, whatever the spindle speed
+		config.poll = [&drive](int& c1, int& c2, int& cu, DWORD& lba, bool& done) {
+			return drive.PlextorQCheckPoll(c1, c2, cu, lba, done);
+		};
+		config.pacing = Pacing::Async;
+		config.retryOnce = true;
+		break;
+	case Vendor::Pioneer:
+		// LBA is tracked in software from firstLBA, so 0 is a real position
+		config.poll = [&drive](int& c1, int& c2, int& cu, DWORD& lba, bool& done) {
+			return drive.PioneerScanPoll(c1, c2, cu, lba, done);
+		};
+		config.retryOnce = true;
+		config.lbaZeroValid = true;
+		break;
+	case Vendor::LiteOn:
+		// Scans at the spindle speed and never sets done
+		config.poll = [&drive](int& c1, int& c2, int& cu, DWORD& lba, bool& done) {
+			return drive.LiteOnScanPoll(c1, c2, cu, lba, done);
+		};
+		config.scanSpeed = scanSpeed;
+		config.endAtLastLBA = true;
+		break;
+	}
+	return config;
+}
+
+ScanSession::Config ScanSession::ForJitterScan(ScsiDrive& drive, DWORD firstLBA, DWORD lastLBA,
+	int scanSpeed) {
+	Config config;
+	config.poll = [&drive](int& jitter, int& beta, int& cu, DWORD& lba, bool& done) {
+		cu = 0;
+		return drive.LiteOnJitterPoll(jitter, beta, lba, done);
+	};
+	config.firstLBA = firstLBA;
+	config.lastLBA = lastLBA;
+	config.scanSpeed = scanSpeed;
+	config.endAtLastLBA = true;
+	config.levels = true;
+	return config;
+}
@@ -0,0 +1,207 @@
+﻿#define NOMINMAX
+#include "ScanSession.h"
+#include <algorithm>
+
+// ============================================================================
+// ScanSession
+// ============================================================================
+
+ScanSession::ScanSession(Config config)
+	: m_config(std::move(config)), m_ring(RING_SIZE) {
+	double speed = m_config.scanSpeed > 0 ? m_config.scanSpeed : 1.0;
+	m_sectorsPerMs = speed * SLICE_SECTORS / 1000.0;
+	m_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+}
+
+ScanSession::~ScanSession() {
+	Stop();
+	if (m_event) CloseHandle(m_event);
+}
+
+void ScanSession::Start() {
+	if (m_thread.joinable()) return;
+	m_start = Clock::now();
+	m_state = State::Running;
+	m_thread = std::thread([this]() { Run(); });
+}
+
+void ScanSession::Stop() {
+	m_stopRequested = true;
+	if (m_thread.joinable()) m_thread.join();
+}
+
+double ScanSession::NowMs() const {
+	return std::chrono::duration<double, std::milli>(Clock::now() - m_start).count();
+}
+
+double ScanSession::ElapsedMs() const {
+	double end = m_endMs.load();
+	return end >= 0.0 ? end : NowMs();
+}
+
+void ScanSession::Finish(State state) {
+	m_endMs = NowMs();
+	m_state = state;
+	if (m_event) SetEvent(m_event);
+}
+
+bool ScanSession::Push(const ScanSlice& slice) {
+	// Never drop a slice: if the UI has fallen a whole ring behind, wait
+	// for it rather than overwrite.
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	while (tail - m_head.load(std::memory_order_acquire) >= RING_SIZE) {
+		if (m_stopRequested) return false;
+		Sleep(1);
+	}
+	m_ring[tail % RING_SIZE] = slice;
+	m_tail.store(tail + 1, std::memory_order_release);
+	if (m_event) SetEvent(m_event);
+	return true;
+}
+
+bool ScanSession::Wait(std::vector<ScanSlice>& out, DWORD timeoutMs) {
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (head == m_tail.load(std::memory_order_acquire) && GetState() == State::Running && m_event) {
+		WaitForSingleObject(m_event, timeoutMs);
+	}
+
+	// Read the state before the tail: a finished session has published
+	// every slice before it changes state.
+	bool running = GetState() == State::Running;
+	size_t tail = m_tail.load(std::memory_order_acquire);
+	for (; head != tail; head++) out.push_back(m_ring[head % RING_SIZE]);
+	m_head.store(head, std::memory_order_release);
+
+	return running || !out.empty();
+}
+
+// ── Poll pacing ─────────────────────────────────────────────────────────
+// The drive produces a slice every SLICE_SECTORS / rate ms.  Polling at a
+// fraction of that keeps a slice from being overtaken by the next one; the
+// fraction shrinks when a slice arrives late and grows back while polls
+// keep finding nothing new.  Near the end the sleep is cut to the time the
+// drive needs to reach lastLBA, so "done" is seen without a full interval.
+
+void ScanSession::Observe(DWORD lba, double timeMs, bool recorded) {
+	if (m_prevMs >= 0.0 && lba > m_prevLBA && timeMs > m_prevMs) {
+		DWORD advance = lba - m_prevLBA;
+		double rate = advance / (timeMs - m_prevMs);
+		// The first measurement replaces the scanSpeed guess outright.
+		m_sectorsPerMs = m_rateMeasured ? m_sectorsPerMs * 0.7 + rate * 0.3 : rate;
+		m_rateMeasured = true;
+
+		if (recorded && advance > SLICE_SECTORS * 3 / 2) {
+			m_pollScale = std::max(0.2, m_pollScale * 0.75);
+		}
+	}
+	m_prevLBA = lba;
+	m_prevMs = timeMs;
+}
+
+double ScanSession::PollIntervalMs(DWORD lba) const {
+	if (m_sectorsPerMs <= 0.0) return MAX_POLL_MS;
+	double interval = m_pollScale * SLICE_SECTORS / m_sectorsPerMs;
+	if (lba >= m_config.firstLBA && lba < m_config.lastLBA) {
+		double remaining = (m_config.lastLBA - lba) / m_sectorsPerMs;
+		interval = std::min(interval, remaining);
+	}
+	return std::clamp(interval, MIN_POLL_MS, MAX_POLL_MS);
+}
+
+// ── Session thread ──────────────────────────────────────────────────────
+// Filtering matches what the scan loops did inline: empty responses while
+// the drive seeks, repeated positions, and the first startupSlices slices
+// (accumulated spin-up errors) are dropped; a done slice is always kept,
+// even during startup.
+
+bool ScanSession::PushSplit(const ScanSlice& slice, DWORD fromLBA, double fromMs) {
+	DWORD advance = slice.lba > fromLBA ? slice.lba - fromLBA : 0;
+	if (fromMs < 0.0 || advance <= SLICE_SECTORS * 3 / 2) return Push(slice);
+
+	// One part per second covered (rounded), the last ending at the slice.
+	const DWORD parts = (advance + SLICE_SECTORS / 2) / SLICE_SECTORS;
+	auto share = [parts](int total, DWORD k) {
+		// Integer shares that add back up to the total.
+		int base = total / static_cast<int>(parts);
+		int rest = total % static_cast<int>(parts);
+		return base + (static_cast<int>(k) < rest ? 1 : 0);
+	};
+
+	m_lateSlices++;
+	for (DWORD k = 0; k < parts; k++) {
+		ScanSlice part = slice;
+		part.lba = fromLBA + static_cast<DWORD>(static_cast<uint64_t>(advance) * (k + 1) / parts);
+		part.timeMs = fromMs + (slice.timeMs - fromMs) * (k + 1) / parts;
+		if (!m_config.levels) {
+			part.c1 = share(slice.c1, k);
+			part.c2 = share(slice.c2, k);
+			part.cu = share(slice.cu, k);
+		}
+		if (!Push(part)) return false;
+	}
+	return true;
+}
+
+void ScanSession::Run() {
+	const bool async = (m_config.pacing == Pacing::Async);
+	DWORD lastReportedLBA = DWORD(-1);
+	int startupLeft = m_config.startupSlices;
+	bool waitBeforePoll = async;
+
+	while (!m_stopRequested) {
+		if (waitBeforePoll) {
+			Sleep(static_cast<DWORD>(PollIntervalMs(m_prevMs >= 0.0 ? m_prevLBA : m_config.firstLBA)));
+			if (m_stopRequested) break;
+		}
+
+		ScanSlice slice;
+		bool done = false;
+		bool ok = m_config.poll(slice.c1, slice.c2, slice.cu, slice.lba, done);
+		if (!ok && m_config.retryOnce && !m_stopRequested) {
+			// Transient SCSI timeouts are common while the drive is busy
+			// with its internal scan loop.
+			Sleep(RETRY_DELAY_MS);
+			ok = m_config.poll(slice.c1, slice.c2, slice.cu, slice.lba, done);
+		}
+		if (!ok) {
+			Finish(State::Failed);
+			return;
+		}
+		slice.timeMs = NowMs();
+
+		bool empty = !m_config.lbaZeroValid && slice.lba == 0
+			&& slice.c1 == 0 && slice.c2 == 0 && slice.cu == 0;
+		bool repeated = (slice.lba == lastReportedLBA);
+		if (!done && (empty || repeated)) {
+			// Nothing new: back off a little, and pace blocking scans too.
+			m_pollScale = std::min(1.0, m_pollScale * 1.1);
+			waitBeforePoll = true;
+			continue;
+		}
+		lastReportedLBA = slice.lba;
+		waitBeforePoll = async;
+
+		if (m_config.endAtLastLBA && slice.lba >= m_config.lastLBA) done = true;
+
+		// Startup slices are not kept, but they already show the rate.
+		if (startupLeft > 0 && !done) {
+			startupLeft--;
+			Observe(slice.lba, slice.timeMs, false);
+			continue;
+		}
+
+		const bool startup = startupLeft > 0;
+		const DWORD fromLBA = m_prevLBA;
+		const double fromMs = m_prevMs;
+		Observe(slice.lba, slice.timeMs, !startup);
+		// A done slice during startup carries spin-up errors of unknown
+		// span, so it is kept whole.
+		if (!(startup ? Push(slice) : PushSplit(slice, fromLBA, fromMs))) break;
+		if (done) {
+			Finish(State::Done);
+			return;
+		}
+	}
+
+	Finish(m_stopRequested ? State::Stopped : State::Done);
+}
@@ -0,0 +1,142 @@
+﻿// ============================================================================
+// ScanSession.h - Background polling of a hardware quality scan
+//
+// The Q-Check, Pioneer and LiteOn C1/C2/CU scans and the LiteOn jitter scan
+// all run inside the drive; the host only polls for time slices.  The scan
+// loops used to poll from the UI thread with fixed delays, so a slow console
+// update or an early poll cost wall time, and a poll that came back late
+// folded two slices into one.  ScanSession owns the polling instead:
+//   - a background thread polls, filters and timestamps the slices
+//     (steady clock, milliseconds from Start)
+//   - Async scans (the drive scans on its own: Plextor) sleep between polls
+//     for half the predicted slice time, from the LBA rate observed so far
+//     (scanSpeed until then), and never past the predicted end of the scan;
+//     Blocking scans (each poll waits for the slice: Pioneer, LiteOn) only
+//     wait after a poll that returned no new slice
+//   - a slice that still comes back late, covering several seconds, is
+//     split into one slice per second it covers (counts shared out, level
+//     readings repeated, LBA and time interpolated) so per-second consumers
+//     keep one sample per second
+//   - slices go to a single-producer / single-consumer ring (atomics, no
+//     lock) that the UI thread drains with Wait()
+//   - the session ends the moment the drive reports done
+// The poll function runs on the session thread; the caller must not use the
+// drive between Start() and the end of the session (or Stop()).
+// ============================================================================
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+class ScsiDrive;
+
+// One time slice as reported by the drive.
+struct ScanSlice {
+	DWORD lba = 0;          // drive position at the end of the slice
+	int c1 = 0;             // jitter scans: jitter
+	int c2 = 0;             // jitter scans: beta
+	int cu = 0;
+	double timeMs = 0.0;    // when the poll returned, from Start()
+};
+
+class ScanSession {
+public:
+	// Same contract as ScsiDrive::PlextorQCheckPoll and friends.
+	using PollFn = std::function<bool(int& c1, int& c2, int& cu, DWORD& lba, bool& done)>;
+
+	enum class Pacing {
+		Async,      // the drive scans on its own; polls only read the latest slice
+		Blocking    // each poll waits for the drive to finish the next slice
+	};
+
+	enum class State { Idle, Running, Done, Failed, Stopped };
+
+	struct Config {
+		PollFn poll;
+		Pacing pacing = Pacing::Blocking;
+		DWORD firstLBA = 0;
+		DWORD lastLBA = 0;
+		int scanSpeed = 0;            // initial rate estimate; 0 = assume 1x
+		bool retryOnce = false;       // retry a failed poll once (busy async drives)
+		bool lbaZeroValid = false;    // LBA 0 is a real position, not "no data yet"
+		bool endAtLastLBA = false;    // the drive never reports done by itself
+		bool levels = false;          // c1/c2/cu are levels, not counts (jitter scans)
+		int startupSlices = 3;        // discarded spin-up / seek-settle slices
+	};
+
+	// Hardware C1/C2/CU scans (already started on the drive)
+	enum class Vendor { PlextorQCheck, Pioneer, LiteOn };
+	static Config ForQualityScan(ScsiDrive& drive, Vendor vendor, DWORD firstLBA, DWORD lastLBA,
+		int scanSpeed);
+	// LiteOn jitter / beta scan (already started): c1 = jitter, c2 = beta
+	static Config ForJitterScan(ScsiDrive& drive, DWORD firstLBA, DWORD lastLBA, int scanSpeed);
+
+	explicit ScanSession(Config config);
+	~ScanSession();
+
+	ScanSession(const ScanSession&) = delete;
+	ScanSession& operator=(const ScanSession&) = delete;
+
+	void Start();
+	// Ask the thread to finish and join it.  Does not stop the drive's scan.
+	void Stop();
+
+	// Append queued slices to `out`, waiting up to timeoutMs for the first.
+	// False once the session has ended and every slice has been handed out.
+	bool Wait(std::vector<ScanSlice>& out, DWORD timeoutMs);
+
+	State GetState() const { return m_state.load(); }
+	// Start() to the poll that reported done (or to now while running).
+	double ElapsedMs() const;
+	// Slices that arrived more than one slice late and were split into one
+	// slice per second they covered.
+	int LateSlices() const { return m_lateSlices.load(); }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr size_t RING_SIZE = 8192;     // > 2 h of one-second slices
+	static constexpr DWORD SLICE_SECTORS = 75;    // nominal: one second of audio
+	static constexpr double MIN_POLL_MS = 20.0;
+	static constexpr double MAX_POLL_MS = 500.0;
+	static constexpr DWORD RETRY_DELAY_MS = 200;
+
+	void Run();
+	void Finish(State state);
+	bool Push(const ScanSlice& slice);
+	// Push `slice`, split into per-second parts when it covers more than
+	// one slice since (fromLBA, fromMs).
+	bool PushSplit(const ScanSlice& slice, DWORD fromLBA, double fromMs);
+	double NowMs() const;
+	// Sleep before the next poll, from the observed rate and position.
+	double PollIntervalMs(DWORD lba) const;
+	// Update the rate from a new slice; late `recorded` slices tighten the
+	// poll interval.
+	void Observe(DWORD lba, double timeMs, bool recorded);
+
+	Config m_config;
+	Clock::time_point m_start;
+	std::atomic<double> m_endMs{ -1.0 };
+	std::atomic<State> m_state{ State::Idle };
+	std::atomic<bool> m_stopRequested{ false };
+	std::atomic<int> m_lateSlices{ 0 };
+
+	// SPSC ring: the session thread advances m_tail, Wait() advances m_head.
+	std::vector<ScanSlice> m_ring;
+	std::atomic<size_t> m_head{ 0 };
+	std::atomic<size_t> m_tail{ 0 };
+	HANDLE m_event = nullptr;     // auto-reset; set on every push and at the end
+
+	// Rate estimate (session thread only)
+	double m_sectorsPerMs = 0.0;
+	bool m_rateMeasured = false;
+	double m_pollScale = 0.5;     // fraction of the predicted slice time to sleep
+	DWORD m_prevLBA = 0;
+	double m_prevMs = -1.0;
+
+	std::thread m_thread;
+};
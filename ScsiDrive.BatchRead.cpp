@@ -0,0 +1,248 @@
+﻿// ============================================================================
+// ScsiDrive.BatchRead.cpp - Multi-sector READ CD with subchannel / C2
+// ============================================================================
+#include "ScsiDrive.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace {
+	// Conservative limit when the adapter cannot be queried: every Windows
+	// storage stack accepts 64 KB pass-through transfers.
+	constexpr DWORD DEFAULT_MAX_TRANSFER = 64 * 1024;
+	// Beyond this the gain is negligible and a bad chunk costs more to bisect.
+	constexpr DWORD MAX_BATCH_SECTORS = 64;
+
+	void BuildReadCd(BYTE cdb[12], DWORD lba, DWORD count, BYTE flags, BYTE subchannel) {
+		memset(cdb, 0, 12);
+		cdb[0] = SCSI_READ_CD;
+		cdb[1] = 0x04;  // Expected sector type: CD-DA
+		cdb[2] = (lba >> 24) & 0xFF;
+		cdb[3] = (lba >> 16) & 0xFF;
+		cdb[4] = (lba >> 8) & 0xFF;
+		cdb[5] = lba & 0xFF;
+		cdb[6] = (count >> 16) & 0xFF;
+		cdb[7] = (count >> 8) & 0xFF;
+		cdb[8] = count & 0xFF;
+		cdb[9] = flags;
+		cdb[10] = subchannel;
+	}
+
+	// Read [lba, lba+count) with readChunk(lba, count, firstIndex).  A failed
+	// range is split in half until single sectors remain, so the good
+	// sectors around a bad one are still read in multi-sector commands.
+	bool BisectRead(DWORD lba, DWORD count, DWORD firstIndex,
+		const std::function<bool(DWORD, DWORD, DWORD)>& readChunk, BYTE* sectorOk) {
+		if (readChunk(lba, count, firstIndex)) {
+			if (sectorOk) memset(sectorOk + firstIndex, 1, count);
+			return true;
+		}
+		if (count == 1) {
+			if (sectorOk) sectorOk[firstIndex] = 0;
+			return false;
+		}
+		DWORD half = count / 2;
+		bool lo = BisectRead(lba, half, firstIndex, readChunk, sectorOk);
+		bool hi = BisectRead(lba + half, count - half, firstIndex + half, readChunk, sectorOk);
+		return lo && hi;
+	}
+}
+
+// ── GetMaxTransferSectors ───────────────────────────────────────────────
+// The adapter descriptor reports both a byte limit and a scatter/gather
+// page limit; an unaligned buffer can span one extra page, so the usable
+// size is the smaller of MaximumTransferLength and (pages - 1) * 4 KB.
+
+DWORD ScsiDrive::GetMaxTransferSectors(DWORD bytesPerSector) {
+	if (m_maxTransferBytes == 0) {
+		m_maxTransferBytes = DEFAULT_MAX_TRANSFER;
+
+		STORAGE_PROPERTY_QUERY query = {};
+		query.PropertyId = StorageAdapterProperty;
+		query.QueryType = PropertyStandardQuery;
+
+		BYTE adapterBuf[256] = {};
+		DWORD ret = 0;
+		if (m_handle != INVALID_HANDLE_VALUE &&
+			DeviceIoControl(m_handle, IOCTL_STORAGE_QUERY_PROPERTY,
+				&query, sizeof(query), adapterBuf, sizeof(adapterBuf), &ret, nullptr)) {
+			auto* desc = reinterpret_cast<STORAGE_ADAPTER_DESCRIPTOR*>(adapterBuf);
+			DWORD limit = desc->MaximumTransferLength;
+			if (desc->MaximumPhysicalPages > 1) {
+				limit = std::min<DWORD>(limit, (desc->MaximumPhysicalPages - 1) * 4096);
+			}
+			if (limit >= static_cast<DWORD>(FULL_SECTOR_WITH_C2)) m_maxTransferBytes = limit;
+		}
+	}
+
+	DWORD sectors = (bytesPerSector > 0) ? m_maxTransferBytes / bytesPerSector : 1;
+	return std::max<DWORD>(1, std::min(sectors, MAX_BATCH_SECTORS));
+}
+
+// ── TransferBuffer ──────────────────────────────────────────────────────
+// Page-aligned, so a chunk of GetMaxTransferSectors never straddles one
+// page more than its size requires, and reused so a full-disc scan does
+// not allocate per command.
+
+BYTE* ScsiDrive::TransferBuffer(size_t bytes) {
+	if (bytes <= m_transferCapacity) return m_transferBuffer;
+	if (m_transferBuffer) VirtualFree(m_transferBuffer, 0, MEM_RELEASE);
+	m_transferBuffer = static_cast<BYTE*>(VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+	m_transferCapacity = m_transferBuffer ? bytes : 0;
+	return m_transferBuffer;
+}
+
+// ── ReadSectors ─────────────────────────────────────────────────────────
+// Batched ReadSector: audio (0xF8) plus raw P–W subchannel when requested.
+
+bool ScsiDrive::ReadSectors(DWORD startLBA, DWORD count, BYTE* audio, BYTE* subchannel,
+	BYTE* sectorOk) {
+	if (count == 0) return true;
+
+	const DWORD stride = subchannel ? RAW_SECTOR_SIZE : AUDIO_SECTOR_SIZE;
+	const DWORD maxSectors = GetMaxTransferSectors(stride);
+	BYTE* buffer = TransferBuffer(static_cast<size_t>(maxSectors) * stride);
+	if (!buffer) return false;
+
+	auto readChunk = [&](DWORD lba, DWORD n, DWORD firstIndex) {
+		BYTE cdb[12];
+		BuildReadCd(cdb, lba, n, 0xF8, subchannel ? 0x01 : 0x00);
+		if (!SendSCSI(cdb, 12, buffer, n * stride)) return false;
+
+		for (DWORD k = 0; k < n; k++) {
+			const BYTE* src = buffer + static_cast<size_t>(k) * stride;
+			memcpy(audio + static_cast<size_t>(firstIndex + k) * AUDIO_SECTOR_SIZE, src, AUDIO_SECTOR_SIZE);
+			if (subchannel) {
+				memcpy(subchannel + static_cast<size_t>(firstIndex + k) * SUBCHANNEL_SIZE,
+					src + AUDIO_SECTOR_SIZE, SUBCHANNEL_SIZE);
+			}
+		}
+		return true;
+	};
+
+	bool allOk = true;
+	for (DWORD done = 0; done < count; done += maxSectors) {
+		DWORD n = std::min(maxSectors, count - done);
+		if (!BisectRead(startLBA + done, n, done, readChunk, sectorOk)) allOk = false;
+	}
+	return allOk;
+}
+
+// ── ReadSectorsWithC2 ───────────────────────────────────────────────────
+// Batched ReadSectorWithC2Ex.  Per sector the drive returns audio, then the
+// 296-byte C2 block, then (optionally) 96 bytes of subchannel — the same
+// layout as the single-sector command, repeated.  The C2 field selection
+// (pointers 0x04, falling back to block 0x02) follows m_c2Mode exactly as
+// the single-sector path does.  Sense is reported per command, so when
+// status is requested a multi-sector chunk with recovered sense (0x01) is
+// bisected like a failed one until the sense belongs to a single sector.
+
+bool ScsiDrive::ReadSectorsWithC2(DWORD startLBA, DWORD count, BYTE* audio, BYTE* subchannel,
+	BYTE* c2Raw, int* c2Errors, const C2ReadOptions& options, BYTE* sectorOk,
+	C2SectorStatus* status) {
+	if (count == 0) return true;
+	if (status) std::fill(status, status + count, C2SectorStatus{});
+
+	// Vendor and multi-pass reads have no multi-sector form.
+	if (m_c2Mode == C2Mode::PlextorD8 || (options.multiPass && options.passCount > 1)) {
+		bool allOk = true;
+		for (DWORD k = 0; k < count; k++) {
+			int errors = 0;
+			C2SectorStatus s;
+			bool ok = ReadSectorWithC2Ex(startLBA + k, audio + static_cast<size_t>(k) * AUDIO_SECTOR_SIZE,
+				subchannel ? subchannel + static_cast<size_t>(k) * SUBCHANNEL_SIZE : nullptr,
+				errors, c2Raw ? c2Raw + static_cast<size_t>(k) * C2_ERROR_SIZE : nullptr, options,
+				&s.senseKey, &s.asc, &s.ascq, &s.c1BlockErrors, &s.c2BlockErrors);
+			s.ok = ok;
+			s.c2Errors = ok ? errors : 0;
+			if (status) status[k] = s;
+			if (c2Errors) c2Errors[k] = s.c2Errors;
+			if (sectorOk) sectorOk[k] = ok ? 1 : 0;
+			if (!ok) allOk = false;
+		}
+		return allOk;
+	}
+
+	const DWORD stride = subchannel ? FULL_SECTOR_WITH_C2 : SECTOR_WITH_C2_SIZE;
+	const DWORD maxSectors = GetMaxTransferSectors(stride);
+	BYTE* buffer = TransferBuffer(static_cast<size_t>(maxSectors) * stride);
+	if (!buffer) return false;
+
+	auto readChunk = [&](DWORD lba, DWORD n, DWORD firstIndex) {
+		BYTE cdb[12];
+		BYTE senseKey = 0, asc = 0, ascq = 0;
+		bool useErrorBlock = (m_c2Mode == C2Mode::ErrorBlock);
+
+		BuildReadCd(cdb, lba, n, 0xF8 | (useErrorBlock ? 0x02 : 0x04), subchannel ? 0x01 : 0x00);
+		bool ok = SendSCSIWithSense(cdb, 12, buffer, n * stride, &senseKey, &asc, &ascq);
+		if (!ok && senseKey != 0x01 && !useErrorBlock) {
+			// First mode failed — try fallback
+			cdb[9] = 0xF8 | 0x02;
+			ok = SendSCSIWithSense(cdb, 12, buffer, n * stride, &senseKey, &asc, &ascq);
+			useErrorBlock = true;
+		}
+		if (!ok && senseKey != 0x01) {
+			if (status && n == 1) {
+				status[firstIndex].senseKey = senseKey;
+				status[firstIndex].asc = asc;
+				status[firstIndex].ascq = ascq;
+			}
+			return false;
+		}
+		// Recovered-error sense applies to the whole command; bisect until
+		// it can be pinned on the one sector that raised it.
+		if (senseKey == 0x01 && n > 1) return false;
+
+		for (DWORD k = 0; k < n; k++) {
+			size_t idx = firstIndex + k;
+			const BYTE* src = buffer + static_cast<size_t>(k) * stride;
+			memcpy(audio + idx * AUDIO_SECTOR_SIZE, src, AUDIO_SECTOR_SIZE);
+			int c1Blocks = 0, c2Blocks = 0;
+			int errors = ParseC2Block(src + AUDIO_SECTOR_SIZE, useErrorBlock, senseKey,
+				options.countBytes, c2Raw ? c2Raw + idx * C2_ERROR_SIZE : nullptr, &c1Blocks, &c2Blocks);
+			if (c2Errors) c2Errors[idx] = errors;
+			if (status) {
+				status[idx] = { true, errors, c1Blocks, c2Blocks, senseKey, asc, ascq };
+			}
+			if (subchannel) {
+				memcpy(subchannel + idx * SUBCHANNEL_SIZE,
+					src + AUDIO_SECTOR_SIZE + C2_ERROR_SIZE, SUBCHANNEL_SIZE);
+			}
+		}
+		return true;
+	};
+
+	bool allOk = true;
+	for (DWORD done = 0; done < count; done += maxSectors) {
+		DWORD n = std::min(maxSectors, count - done);
+		if (c2Errors) std::fill(c2Errors + done, c2Errors + done + n, 0);
+		if (!BisectRead(startLBA + done, n, done, readChunk, sectorOk)) allOk = false;
+	}
+	return allOk;
+}
+
+// ── ReadSectorsQ ────────────────────────────────────────────────────────
+// One raw-subchannel READ CD per chunk, Q de-interleaved and CRC-checked per
+// sector.  Sectors that fail CRC (or sit in an unreadable sub-range) get the
+// single-sector treatment, including its formatted-Q fallback.
+
+bool ScsiDrive::ReadSectorsQ(DWORD startLBA, DWORD count, int* qTrack, int* qIndex, BYTE* qValid) {
+	if (count == 0) return true;
+
+	std::vector<BYTE> audio(static_cast<size_t>(count) * AUDIO_SECTOR_SIZE);
+	std::vector<BYTE> sub(static_cast<size_t>(count) * SUBCHANNEL_SIZE);
+	std::vector<BYTE> ok(count, 0);
+	ReadSectors(startLBA, count, audio.data(), sub.data(), ok.data());
+
+	bool allValid = true;
+	for (DWORD k = 0; k < count; k++) {
+		int t = 0, idx = -1;
+		bool valid = ok[k] && ParseRawSubchannel(sub.data() + static_cast<size_t>(k) * SUBCHANNEL_SIZE, t, idx);
+		if (!valid) valid = ReadSectorQSingle(startLBA + k, t, idx);
+		qTrack[k] = t;
+		qIndex[k] = idx;
+		qValid[k] = valid ? 1 : 0;
+		if (!valid) allValid = false;
+	}
+	return allValid;
+}
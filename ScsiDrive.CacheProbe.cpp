@@ -0,0 +1,251 @@
+﻿// ============================================================================
+// ScsiDrive.CacheProbe.cpp - Audio cache size / read-ahead measurement
+//
+// A cached read never touches the disc: it completes in well under a
+// millisecond, while any real read waits for at least part of a revolution.
+// Every question below is answered by reading one sector twice and timing
+// the second read:
+//   hit vs miss       re-read at once, and read a never-read sector
+//   far read evicts   read L, read one sector far away, re-read L
+//   read-ahead        read P, idle, read P+k (prefetched or not)
+//   capacity          read L, read n sectors after it, re-read L
+// The result is stored per vendor / model / firmware in
+// %LOCALAPPDATA%\AudioCopy\drivecache.tsv, so a drive is probed once.
+// ============================================================================
+#include "ScsiDrive.h"
+#include <shlobj.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+	constexpr int TRIALS = 3;
+	// A cache hit needs no media access; a re-read from the disc costs at
+	// least part of a revolution (~6 ms even at top speed).
+	constexpr double MAX_HIT_MS = 3.0;
+	// Larger caches are reported as this (~19 MB of audio).
+	constexpr DWORD MAX_PROBE_CACHE = 8192;
+	// Spacing between never-read probe sectors — beyond any read-ahead.
+	constexpr DWORD FRESH_SPACING = 1500;
+	constexpr DWORD READ_AHEAD_STEPS[] = { 16, 64, 256, 1024 };
+	// The probe needs room for all of the above plus a far region.
+	constexpr DWORD MIN_PROBE_RANGE = 20000;    // ~4.4 minutes
+
+	constexpr DWORD BATCH_SECTORS = 32;         // ReadSectorsAudioOnly limit
+
+	double Median(std::vector<double> values) {
+		std::sort(values.begin(), values.end());
+		return values[values.size() / 2];
+	}
+
+	struct StoredCacheProfile {
+		std::string vendor;
+		std::string model;
+		std::string firmware;
+		DriveCacheProfile profile;
+	};
+
+	std::filesystem::path ProfileStorePath() {
+		wchar_t* appDataPath = nullptr;
+		if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &appDataPath))) {
+			std::filesystem::path dir = std::filesystem::path(appDataPath) / L"AudioCopy";
+			CoTaskMemFree(appDataPath);
+			std::error_code ec;
+			std::filesystem::create_directories(dir, ec);
+			return dir / L"drivecache.tsv";
+		}
+		return L"drivecache.tsv";
+	}
+
+	std::vector<StoredCacheProfile> LoadProfileStore() {
+		std::vector<StoredCacheProfile> entries;
+		std::ifstream file(ProfileStorePath());
+		std::string line;
+		while (std::getline(file, line)) {
+			if (line.empty() || line[0] == '#') continue;
+
+			std::istringstream ss(line);
+			StoredCacheProfile e;
+			std::string cache, sizeKnown, readAhead, farEvicts, hit, miss;
+			if (!std::getline(ss, e.vendor, '\t') || !std::getline(ss, e.model, '\t') ||
+				!std::getline(ss, e.firmware, '\t') || !std::getline(ss, cache, '\t') ||
+				!std::getline(ss, sizeKnown, '\t') || !std::getline(ss, readAhead, '\t') ||
+				!std::getline(ss, farEvicts, '\t')) {
+				continue;
+			}
+			std::getline(ss, hit, '\t');
+			std::getline(ss, miss, '\t');
+
+			try {
+				e.profile.cacheSectors = static_cast<DWORD>(std::stoul(cache));
+				e.profile.cacheSizeKnown = (sizeKnown == "1");
+				e.profile.readAheadSectors = static_cast<DWORD>(std::stoul(readAhead));
+				e.profile.farReadEvicts = (farEvicts == "1");
+				e.profile.hitMs = hit.empty() ? 0.0 : std::stod(hit);
+				e.profile.missMs = miss.empty() ? 0.0 : std::stod(miss);
+			}
+			catch (...) { continue; }
+			e.profile.measured = true;
+			entries.push_back(std::move(e));
+		}
+		return entries;
+	}
+
+	bool SaveProfileStore(const std::vector<StoredCacheProfile>& entries) {
+		std::ofstream file(ProfileStorePath(), std::ios::trunc);
+		if (!file.is_open()) return false;
+
+		file << "# AudioCopy Drive Cache Profiles\n";
+		file << "# vendor\tmodel\tfirmware\tcacheSectors\tcacheSizeKnown\treadAheadSectors\tfarReadEvicts\thitMs\tmissMs\n";
+		for (const auto& e : entries) {
+			file << e.vendor << "\t" << e.model << "\t" << e.firmware << "\t"
+				<< e.profile.cacheSectors << "\t" << (e.profile.cacheSizeKnown ? 1 : 0) << "\t"
+				<< e.profile.readAheadSectors << "\t"
+				<< (e.profile.farReadEvicts ? 1 : 0) << "\t"
+				<< e.profile.hitMs << "\t" << e.profile.missMs << "\n";
+		}
+		return true;
+	}
+}
+
+// ── ProbeCache ──────────────────────────────────────────────────────────
+
+bool ScsiDrive::ProbeCache(DWORD firstLBA, DWORD lastLBA, DriveCacheProfile& profile) {
+	profile = DriveCacheProfile{};
+	if (lastLBA <= firstLBA || lastLBA - firstLBA < MIN_PROBE_RANGE) return false;
+
+	// Work a quarter of the way in: track starts and the end of the disc
+	// are what TOC and pregap analysis just read, so may still be cached.
+	const DWORD base = firstLBA + (lastLBA - firstLBA) / 4;
+	const DWORD farLBA = lastLBA - 150;
+
+	std::vector<BYTE> buf(static_cast<size_t>(BATCH_SECTORS) * AUDIO_SECTOR_SIZE);
+	auto timedRead = [&](DWORD lba) {
+		auto start = std::chrono::steady_clock::now();
+		if (!ReadSectorAudioOnly(lba, buf.data())) return -1.0;
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	};
+	auto readSpan = [&](DWORD lba, DWORD count) {
+		for (DWORD done = 0; done < count; done += BATCH_SECTORS) {
+			DWORD n = std::min(BATCH_SECTORS, count - done);
+			if (!ReadSectorsAudioOnly(lba + done, n, buf.data())) return false;
+		}
+		return true;
+	};
+
+	// ── Hit and miss latency ──
+	// Fresh sectors are taken in descending order, so no earlier read's
+	// read-ahead can have fetched them.
+	std::vector<double> hits, misses;
+	for (int trial = 0; trial < TRIALS; trial++) {
+		DWORD fresh = base + FRESH_SPACING * (TRIALS - trial);
+		ReadSectorAudioOnly(farLBA, buf.data());
+		double miss = timedRead(fresh);
+		double hit = timedRead(fresh);
+		if (miss < 0 || hit < 0) return false;
+		misses.push_back(miss);
+		hits.push_back(hit);
+	}
+	profile.missMs = Median(misses);
+	profile.hitMs = Median(hits);
+	profile.measured = true;
+
+	const double hitThreshold = std::min(MAX_HIT_MS, profile.missMs / 4.0);
+	auto isHit = [&](double ms) { return ms >= 0 && ms < hitThreshold; };
+	const bool rereadHits = isHit(profile.hitMs);
+
+	// ── Read-ahead ──
+	// Run even when re-reads miss: a drive can prefetch without keeping
+	// what it already returned, and a prefetched sector is as stale as a
+	// kept one.
+	// Read a fresh sector, give the drive time to prefetch, and look k
+	// sectors further on.  Each step starts from its own fresh sector.
+	DWORD probeLBA = base + FRESH_SPACING * (TRIALS + 1);
+	for (DWORD k : READ_AHEAD_STEPS) {
+		ReadSectorAudioOnly(farLBA, buf.data());
+		if (!ReadSectorAudioOnly(probeLBA, buf.data())) break;
+		Sleep(150);
+		if (!isHit(timedRead(probeLBA + k))) break;
+		profile.readAheadSectors = k;
+		probeLBA += FRESH_SPACING;
+	}
+
+	if (!rereadHits) {
+		// Re-reads go to the disc.  Only when read-ahead missed as well is
+		// there nothing to defeat; otherwise the capacity is left unknown.
+		profile.cacheSizeKnown = (profile.readAheadSectors == 0);
+		profile.farReadEvicts = true;
+		return true;
+	}
+
+	// ── Does one far read empty the cache? ──
+	int evicted = 0;
+	for (int trial = 0; trial < TRIALS; trial++) {
+		ReadSectorAudioOnly(base, buf.data());
+		ReadSectorAudioOnly(farLBA - trial, buf.data());
+		if (!isHit(timedRead(base))) evicted++;
+	}
+	profile.farReadEvicts = (evicted * 2 > TRIALS);
+
+	// ── Capacity ──
+	// How much sequential reading after L pushes L out.  Reported as the
+	// first amount that did, so it errs on the large side.  When even the
+	// largest span left L cached, the size is unknown and cacheSectors only
+	// records how far the probe got.
+	const DWORD maxSpan = std::min(MAX_PROBE_CACHE, (farLBA - base) / 2);
+	profile.cacheSectors = maxSpan;
+	for (DWORD n = 16; n <= maxSpan; n *= 2) {
+		ReadSectorAudioOnly(farLBA, buf.data());
+		if (!ReadSectorAudioOnly(base, buf.data())) break;
+		if (!readSpan(base + 1, n)) break;
+		if (!isHit(timedRead(base))) {
+			profile.cacheSectors = n;
+			profile.cacheSizeKnown = true;
+			break;
+		}
+	}
+
+	return true;
+}
+
+// ── GetCacheProfile ─────────────────────────────────────────────────────
+
+bool ScsiDrive::GetCacheProfile(DWORD firstLBA, DWORD lastLBA, DriveCacheProfile& profile,
+	bool reprobe) {
+	if (m_cacheProfile.measured && !reprobe) {
+		profile = m_cacheProfile;
+		return true;
+	}
+
+	std::string vendor, model, firmware;
+	if (!GetDriveInfo(vendor, model, &firmware)) return false;
+
+	auto entries = LoadProfileStore();
+	auto it = std::find_if(entries.begin(), entries.end(), [&](const StoredCacheProfile& e) {
+		return e.vendor == vendor && e.model == model && e.firmware == firmware;
+	});
+	if (it != entries.end() && !reprobe) {
+		m_cacheProfile = it->profile;
+		profile = m_cacheProfile;
+		return true;
+	}
+
+	DriveCacheProfile measured;
+	if (!ProbeCache(firstLBA, lastLBA, measured)) return false;
+
+	if (it != entries.end()) {
+		it->profile = measured;
+	}
+	else {
+		entries.push_back({ vendor, model, firmware, measured });
+	}
+	SaveProfileStore(entries);
+
+	m_cacheProfile = measured;
+	profile = measured;
+	return true;
+}
@@ -86,7 +86,7 @@ bool ScsiDrive::CheckC2Support() {
 	return false;
 }
 
-bool ScsiDrive::GetDriveInfo(std::string& vendor, std::string& model) {
+bool ScsiDrive::GetDriveInfo(std::string& vendor, std::string& model, std::string* firmware) {
 	BYTE cdb[6] = { 0x12, 0, 0, 0, 96, 0 };
 	std::vector<BYTE> buffer(96, 0);
 	if (!SendSCSI(cdb, 6, buffer.data(), 96)) return false;
@@ -95,6 +95,10 @@ bool ScsiDrive::GetDriveInfo(std::string& vendor, std::string& model) {
 	model = std::string(reinterpret_cast<char*>(&buffer[16]), 16);
 	while (!vendor.empty() && vendor.back() == ' ') vendor.pop_back();
 	while (!model.empty() && model.back() == ' ') model.pop_back();
+	if (firmware) {
+		*firmware = std::string(reinterpret_cast<char*>(&buffer[32]), 4);
+		while (!firmware->empty() && firmware->back() == ' ') firmware->pop_back();
+	}
 	return true;
 }
 
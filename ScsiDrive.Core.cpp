@@ -52,6 +52,9 @@ bool ScsiDrive::Open(wchar_t driveLetter) {
 		m_liteonScanProbed = -1;
 		m_pioneerScanProbed = -1;
 		m_pioneerSpeedMode = 0;
+		m_driveLetter = driveLetter;
+		m_maxTransferBytes = 0;
+		m_cacheProfile = DriveCacheProfile{};
 	}
 
 	return m_handle != INVALID_HANDLE_VALUE;
@@ -62,6 +65,12 @@ void ScsiDrive::Close() {
 		CloseHandle(m_handle);
 		m_handle = INVALID_HANDLE_VALUE;
 	}
+	if (m_transferBuffer) {
+		VirtualFree(m_transferBuffer, 0, MEM_RELEASE);
+		m_transferBuffer = nullptr;
+		m_transferCapacity = 0;
+	}
+	m_driveLetter = 0;
 }
 
 bool ScsiDrive::SendSCSI(void* cdb, BYTE cdbLength, void* buffer, DWORD bufferSize,
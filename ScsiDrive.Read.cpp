@@ -2,6 +2,7 @@
 // ScsiDrive.Read.cpp - SCSI sector reading and C2 handling
 // ============================================================================
 #include "ScsiDrive.h"
+#include "C2Kernel.h"
 #include <climits>
 #include <vector>
 
@@ -152,27 +153,30 @@ bool ScsiDrive::ReadSectorWithC2Ex(DWORD lba, BYTE* audio, BYTE* subchannel,
 
 	memcpy(audio, buffer.data(), AUDIO_SECTOR_SIZE);
 
-	c2Errors = 0;
-	const BYTE* c2Data = buffer.data() + AUDIO_SECTOR_SIZE;
+	c2Errors = ParseC2Block(buffer.data() + AUDIO_SECTOR_SIZE, useErrorBlock, senseKey,
+		options.countBytes, c2Raw, outC1BlockErrors, outC2BlockErrors);
+
+	if (outSenseKey) *outSenseKey = senseKey;
+	if (outASC) *outASC = asc;
+	if (outASCQ) *outASCQ = ascq;
 
+	if (subchannel) {
+		memcpy(subchannel, buffer.data() + AUDIO_SECTOR_SIZE + C2_ERROR_SIZE, SUBCHANNEL_SIZE);
+	}
+
+	return true;
+}
+
+int ScsiDrive::ParseC2Block(const BYTE* c2Data, bool useErrorBlock, BYTE senseKey,
+	bool countBytes, BYTE* c2Raw, int* outC1BlockErrors, int* outC2BlockErrors) const {
 	// Only count the 294 actual C2 error pointer bytes.  Bytes 294-295
 	// in ErrorPointers mode are C1/C2 block error statistics — C1 counts are
 	// routinely non-zero on perfect discs and were causing false positives.
 	// In countBytes (PlexTools-style) mode, 0xFF means "no error sample
 	// pointer" and must also be excluded.
-	for (int i = 0; i < C2_POINTER_BYTES; i++) {
-		if (options.countBytes) {
-			if (c2Data[i] != 0 && c2Data[i] != 0xFF) c2Errors++;
-		}
-		else {
-			BYTE b = c2Data[i];
-			while (b) { c2Errors += b & 1; b >>= 1; }
-		}
-	}
-
-	if (outSenseKey) *outSenseKey = senseKey;
-	if (outASC) *outASC = asc;
-	if (outASCQ) *outASCQ = ascq;
+	int c2Errors = countBytes
+		? C2Kernel::CountBytes(c2Data, C2_POINTER_BYTES)
+		: C2Kernel::CountBits(c2Data, C2_POINTER_BYTES);
 
 	if (c2Raw) {
 		memset(c2Raw, 0, C2_ERROR_SIZE);
@@ -205,11 +209,7 @@ bool ScsiDrive::ReadSectorWithC2Ex(DWORD lba, BYTE* audio, BYTE* subchannel,
 		if (outC2BlockErrors) *outC2BlockErrors = 0;
 	}
 
-	if (subchannel) {
-		memcpy(subchannel, buffer.data() + AUDIO_SECTOR_SIZE + C2_ERROR_SIZE, SUBCHANNEL_SIZE);
-	}
-
-	return true;
+	return c2Errors;
 }
 
 // FIX B: Cache defeat between multi-pass reads
@@ -560,20 +560,22 @@ bool ScsiDrive::ReadSectorQ(DWORD lba, int& qTrack, int& qIndex) {
 	return true;
 }
 
+bool ScsiDrive::IsNearQTransition(DWORD lba, DWORD pregapLBA, DWORD startLBA) {
+	constexpr DWORD TRANSITION_MARGIN = 75;  // +/- 1 second (75 sectors) around boundaries
+
+	if (lba >= pregapLBA && lba < pregapLBA + TRANSITION_MARGIN) return true;
+	if (lba >= startLBA && lba < startLBA + TRANSITION_MARGIN) return true;
+	if (pregapLBA > TRANSITION_MARGIN && lba >= pregapLBA - TRANSITION_MARGIN && lba < pregapLBA)
+		return true;
+	return false;
+}
+
 // Adaptive Q subchannel read — uses a single read for sectors deep within a
 // track and falls back to majority voting only near index transition points
 // (pregap/start boundaries) where drives commonly return stale data.
 bool ScsiDrive::ReadSectorQAdaptive(DWORD lba, int& qTrack, int& qIndex,
 	DWORD pregapLBA, DWORD startLBA) {
-	constexpr DWORD TRANSITION_MARGIN = 75;  // +/- 1 second (75 sectors) around boundaries
-
-	bool nearTransition = false;
-	if (lba >= pregapLBA && lba < pregapLBA + TRANSITION_MARGIN) nearTransition = true;
-	if (lba >= startLBA && lba < startLBA + TRANSITION_MARGIN)  nearTransition = true;
-	if (pregapLBA > TRANSITION_MARGIN && lba >= pregapLBA - TRANSITION_MARGIN && lba < pregapLBA)
-		nearTransition = true;
-
-	if (nearTransition) {
+	if (IsNearQTransition(lba, pregapLBA, startLBA)) {
 		return ReadSectorQ(lba, qTrack, qIndex);  // Full 3-read majority voting
 	}
 
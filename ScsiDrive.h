@@ -12,15 +12,31 @@
 #include <vector>
 #include <string>
 
+// Per-sector result of a batched C2 read (ScsiDrive::ReadSectorsWithC2)
+struct C2SectorStatus {
+	bool ok = false;
+	int c2Errors = 0;
+	int c1BlockErrors = 0;    // bytes 294-295, ErrorPointers mode only
+	int c2BlockErrors = 0;
+	BYTE senseKey = 0;        // 0x01 = recovered; failure sense when !ok
+	BYTE asc = 0;
+	BYTE ascq = 0;
+};
+
 class ScsiDrive {
 private:
 	HANDLE m_handle = INVALID_HANDLE_VALUE;
+	wchar_t m_driveLetter = 0;
 	WORD m_currentSpeed = CD_SPEED_MAX;
 	C2Mode m_c2Mode = C2Mode::NotSupported;
 	bool m_c1BlockErrorsAvailable = false;     // True if bytes 294-295 contain valid C1 data
 	int m_maxRetries = 5;
 	int m_retryDelayMs = 100;
 	bool m_c2Functional = true;        // C2 pointer data is actually populated
+	DWORD m_maxTransferBytes = 0;      // 0 = adapter not queried yet
+	DriveCacheProfile m_cacheProfile;  // measured == false until GetCacheProfile
+	BYTE* m_transferBuffer = nullptr;  // page-aligned batch buffer, see TransferBuffer
+	size_t m_transferCapacity = 0;
 
 	// Current Pioneer SET CD SPEED byte-10 mode (bits 0-5 of speed-mode value).
 	// Sticky for the lifetime of the open handle so that SetSpeed/Quiet/Perf
@@ -49,6 +65,9 @@ public:
 	bool Open(wchar_t driveLetter);
 	void Close();
 	bool IsOpen() const { return m_handle != INVALID_HANDLE_VALUE; }
+	// Letter passed to Open (0 when closed) — lets ReadPipeline open its
+	// own overlapped handle to the same device.
+	wchar_t GetDriveLetter() const { return m_driveLetter; }
 
 	// ── Speed control ────────────────────────────────────────
 	void SetSpeed(int multiplier, int writeMultiplier = -1);
@@ -72,6 +91,34 @@ public:
 	bool ReadSectorQAdaptive(DWORD lba, int& qTrack, int& qIndex,
 		DWORD pregapLBA, DWORD startLBA);
 	bool ReadSectorQAnyType(DWORD lba, int& qTrack, int& qIndex);
+	// True within ±75 sectors of a pregap / INDEX 01 boundary, where drives
+	// commonly return stale Q and reads need majority voting.
+	static bool IsNearQTransition(DWORD lba, DWORD pregapLBA, DWORD startLBA);
+
+	// ── Batched sector reading (ScsiDrive.BatchRead.cpp) ─────
+	// One READ CD per chunk of consecutive sectors, split into separate
+	// planes: audio count*2352, subchannel count*96, C2 count*296 bytes
+	// (each plane optional except audio).  Chunks are sized from the
+	// adapter's maximum transfer length; a failing chunk is bisected so one
+	// bad sector costs about 2*log2(N) extra commands instead of N.  sectorOk
+	// (optional, count entries) is set to 1 for every sector read.
+	// Returns true when every sector was read.
+	bool ReadSectors(DWORD startLBA, DWORD count, BYTE* audio, BYTE* subchannel,
+		BYTE* sectorOk = nullptr);
+	// Batched ReadSectorWithC2Ex: c2Errors receives one count per sector.
+	// status (optional, count entries) adds the C1/C2 block counts and the
+	// sense of each sector: a chunk reporting recovered sense is bisected
+	// down to the sector that caused it.  PlextorD8 drives and multi-pass
+	// options fall back to per-sector reads.
+	bool ReadSectorsWithC2(DWORD startLBA, DWORD count, BYTE* audio, BYTE* subchannel,
+		BYTE* c2Raw, int* c2Errors, const C2ReadOptions& options,
+		BYTE* sectorOk = nullptr, C2SectorStatus* status = nullptr);
+	// Batched single-read Q (raw P-W, CRC-checked).  Sectors whose Q fails
+	// CRC are re-read with ReadSectorQSingle; qValid marks the results.
+	bool ReadSectorsQ(DWORD startLBA, DWORD count, int* qTrack, int* qIndex, BYTE* qValid);
+	// Sectors per READ CD for a given per-sector transfer size, from the
+	// storage adapter descriptor (cached per handle).
+	DWORD GetMaxTransferSectors(DWORD bytesPerSector);
 
 	// ── Enhanced C2 reading ──────────────────────────────────
 	bool ReadSectorWithC2Ex(DWORD lba, BYTE* audio, BYTE* subchannel, int& c2Errors,
@@ -127,11 +174,25 @@ public:
 
 	// ── Drive capabilities ───────────────────────────────────────
 	bool CheckC2Support();
-	bool GetDriveInfo(std::string& vendor, std::string& model);
+	bool GetDriveInfo(std::string& vendor, std::string& model, std::string* firmware = nullptr);
 	bool DetectCapabilities(DriveCapabilities& caps);
 	bool GetModePage2A(std::vector<BYTE>& pageData);
 	bool TestOverread(bool leadIn);
 
+	// ── Audio cache profile (ScsiDrive.CacheProbe.cpp) ───────────
+	// ProbeCache times re-reads of one sector inside [firstLBA, lastLBA]
+	// (an audio range of at least ~3 minutes) to find whether the drive
+	// caches audio, how much sequential reading evicts a sector, how far it
+	// reads ahead and whether one far read empties the cache.  A drive counts
+	// as not caching only when both re-reads and read-ahead miss; a cache
+	// that no probed span evicted is reported with its size unknown.
+	// Takes 10-30 s.
+	bool ProbeCache(DWORD firstLBA, DWORD lastLBA, DriveCacheProfile& profile);
+	// Stored profile for this vendor/model/firmware; probes and stores it on
+	// first use (or when reprobe is set).  Cached per handle.
+	bool GetCacheProfile(DWORD firstLBA, DWORD lastLBA, DriveCacheProfile& profile,
+		bool reprobe = false);
+
 	// ── Chipset / controller identification ──────────────────────
 	bool DetectChipset(ChipsetInfo& info);
 
@@ -232,6 +293,13 @@ public:
 
 private:
 	bool ReadSectorQRaw(DWORD lba, int& qTrack, int& qIndex);
+	// Page-aligned buffer of at least `bytes`, reused by the batched reads
+	// and released in Close().  nullptr if the allocation fails.
+	BYTE* TransferBuffer(size_t bytes);
+	// Count C2 errors in one 296-byte block and copy it to c2Raw; shared by
+	// the single-sector and batched READ CD paths.
+	int ParseC2Block(const BYTE* c2Data, bool useErrorBlock, BYTE senseKey,
+		bool countBytes, BYTE* c2Raw, int* outC1BlockErrors, int* outC2BlockErrors) const;
 	bool ParseRawSubchannel(const BYTE* sub, int& qTrack, int& qIndex);
 	bool ProbeC1BlockErrors();
 	bool ProbeC2Liveness();
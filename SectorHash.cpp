@@ -0,0 +1,192 @@
+﻿// ============================================================================
+// SectorHash.cpp - XXH3-style 128-bit hash (SSE2 and scalar accumulators)
+// ============================================================================
+#include "SectorHash.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SECTORHASH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace {
+	constexpr size_t STRIPE = 64;
+	constexpr size_t SECRET_SIZE = 192;
+	constexpr size_t SECRET_STEP = 8;                       // Secret advance per stripe
+	constexpr size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE) / SECRET_STEP;
+
+	constexpr uint64_t PRIME32_1 = 0x9E3779B1u;
+	constexpr uint64_t PRIME32_2 = 0x85EBCA77u;
+	constexpr uint64_t PRIME32_3 = 0xC2B2AE3Du;
+	constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+	// Key material, expanded once from a fixed seed with splitmix64.
+	struct Secret {
+		alignas(16) unsigned char bytes[SECRET_SIZE];
+
+		Secret() {
+			uint64_t state = 0x5EC7024A55D1C0DEull;
+			for (size_t i = 0; i < SECRET_SIZE; i += 8) {
+				uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+				z ^= z >> 31;
+				memcpy(bytes + i, &z, 8);
+			}
+		}
+	};
+
+	const unsigned char* SecretBytes() {
+		static const Secret secret;
+		return secret.bytes;
+	}
+
+	uint64_t Read64(const unsigned char* p) {
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	// Full 64x64 -> 128 product, folded to 64 bits by xoring the halves.
+	uint64_t Mul128Fold64(uint64_t a, uint64_t b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+		uint64_t high;
+		uint64_t low = _umul128(a, b, &high);
+		return low ^ high;
+#elif defined(__SIZEOF_INT128__)
+		unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+		uint64_t aLo = a & 0xFFFFFFFFu, aHi = a >> 32;
+		uint64_t bLo = b & 0xFFFFFFFFu, bHi = b >> 32;
+		uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+		uint64_t cross = (ll >> 32) + (hl & 0xFFFFFFFFu) + lh;
+		uint64_t high = hh + (hl >> 32) + (cross >> 32);
+		uint64_t low = (cross << 32) | (ll & 0xFFFFFFFFu);
+		return low ^ high;
+#endif
+	}
+
+	uint64_t Avalanche(uint64_t h) {
+		h ^= h >> 37;
+		h *= 0x165667919E3779F9ull;
+		h ^= h >> 32;
+		return h;
+	}
+
+	// ── Stripe accumulation ─────────────────────────────────────────────────
+	// Per 64-bit lane j:  acc[j] += lo32(d ^ k) * hi32(d ^ k);  acc[j^1] += d.
+	// The multiply mixes the key into the lane, the raw add keeps every input
+	// bit reachable even when the product is zero.
+
+#ifdef SECTORHASH_SSE2
+	void Accumulate(uint64_t* acc, const unsigned char* input, const unsigned char* secret,
+		size_t stripes) {
+		__m128i a[4];
+		for (int i = 0; i < 4; i++) a[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+
+		for (size_t s = 0; s < stripes; s++) {
+			const unsigned char* in = input + s * STRIPE;
+			const unsigned char* key = secret + s * SECRET_STEP;
+			for (int i = 0; i < 4; i++) {
+				__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in) + i);
+				__m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i);
+				__m128i dk = _mm_xor_si128(d, k);
+				__m128i dkHi = _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1));
+				__m128i product = _mm_mul_epu32(dk, dkHi);
+				__m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+				a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, swapped));
+			}
+		}
+
+		for (int i = 0; i < 4; i++) _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, a[i]);
+	}
+#else
+	void Accumulate(uint64_t* acc, const unsigned char* input, const unsigned char* secret,
+		size_t stripes) {
+		for (size_t s = 0; s < stripes; s++) {
+			const unsigned char* in = input + s * STRIPE;
+			const unsigned char* key = secret + s * SECRET_STEP;
+			for (int j = 0; j < 8; j++) {
+				uint64_t d = Read64(in + 8 * j);
+				uint64_t dk = d ^ Read64(key + 8 * j);
+				acc[j ^ 1] += d;
+				acc[j] += (dk & 0xFFFFFFFFu) * (dk >> 32);
+			}
+		}
+	}
+#endif
+
+	// Runs once per 16 stripes so lane bits cannot pile up in the high end.
+	void Scramble(uint64_t* acc, const unsigned char* key) {
+		for (int j = 0; j < 8; j++) {
+			uint64_t a = acc[j];
+			a ^= a >> 47;
+			a ^= Read64(key + 8 * j);
+			acc[j] = a * PRIME32_1;
+		}
+	}
+
+	uint64_t Merge(const uint64_t* acc, const unsigned char* key, uint64_t start) {
+		uint64_t result = start;
+		for (int i = 0; i < 4; i++) {
+			result += Mul128Fold64(acc[2 * i] ^ Read64(key + 16 * i),
+				acc[2 * i + 1] ^ Read64(key + 16 * i + 8));
+		}
+		return Avalanche(result);
+	}
+}
+
+SectorHash SectorHash::Compute(const void* data, size_t length) {
+	const unsigned char* secret = SecretBytes();
+	const unsigned char* input = static_cast<const unsigned char*>(data);
+
+	// Inputs shorter than one stripe are zero-padded; the length is mixed
+	// into the result, so padding cannot alias a longer input.
+	unsigned char padded[STRIPE];
+	if (length < STRIPE) {
+		memset(padded, 0, sizeof(padded));
+		if (length > 0) memcpy(padded, input, length);
+		input = padded;
+	}
+	size_t bodyLength = (length < STRIPE) ? STRIPE : length;
+
+	uint64_t acc[8] = { PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+		PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1 };
+
+	// Every stripe but the last, in blocks that share one pass over the secret.
+	size_t stripes = (bodyLength - 1) / STRIPE;
+	const unsigned char* p = input;
+	while (stripes >= STRIPES_PER_BLOCK) {
+		Accumulate(acc, p, secret, STRIPES_PER_BLOCK);
+		Scramble(acc, secret + SECRET_SIZE - STRIPE);
+		p += STRIPES_PER_BLOCK * STRIPE;
+		stripes -= STRIPES_PER_BLOCK;
+	}
+	Accumulate(acc, p, secret, stripes);
+
+	// The last stripe always ends at the last byte (it may overlap the
+	// previous one) and uses a key offset no regular stripe uses.
+	Accumulate(acc, input + bodyLength - STRIPE, secret + SECRET_SIZE - STRIPE - 7, 1);
+
+	SectorHash h;
+	h.lo = Merge(acc, secret + 11, static_cast<uint64_t>(length) * PRIME64_1);
+	h.hi = Merge(acc, secret + SECRET_SIZE - STRIPE - 11, ~(static_cast<uint64_t>(length) * PRIME64_2));
+	return h;
+}
+
+const char* SectorHash::Name() {
+#ifdef SECTORHASH_SSE2
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,32 @@
+﻿// ============================================================================
+// SectorHash.h - 128-bit sector fingerprint for read-match decisions
+//
+// The secure rip decides that two reads of a sector agree by comparing
+// hashes, so the hash is the only evidence behind a "verified" sector.  The
+// old 32-bit byte-at-a-time FNV-1a was both slow and, across a full disc
+// read eight times, likely to produce a false match somewhere.  SectorHash
+// is an XXH3-style 128-bit hash: eight 64-bit lanes absorb 64-byte stripes
+// (SSE2 on x86, plain 64-bit arithmetic elsewhere), with the lanes merged
+// into two independent 64-bit halves at the end.  Non-cryptographic — it
+// guards against accidental collisions, not adversarial ones.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct SectorHash {
+	uint64_t lo = 0;
+	uint64_t hi = 0;
+
+	bool operator==(const SectorHash& other) const { return lo == other.lo && hi == other.hi; }
+	bool operator!=(const SectorHash& other) const { return !(*this == other); }
+
+	// 64-bit prefix recorded in logs and reports.
+	uint64_t Prefix() const { return lo; }
+
+	static SectorHash Compute(const void* data, size_t length);
+
+	// Implementation selected at build time: "SSE2" or "scalar".
+	static const char* Name();
+};
@@ -0,0 +1,364 @@
+﻿#define NOMINMAX
+#include "SectorStore.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// ============================================================================
+// Plane management
+// ============================================================================
+
+namespace {
+	// Pages are committed in 1 MB steps so a sector-by-sector append loop
+	// does not make a VirtualAlloc call per sector.
+	constexpr size_t COMMIT_CHUNK = 1024 * 1024;
+	// Minimum reservation when the caller never called Reserve().
+	constexpr size_t MIN_RESERVE_SECTORS = 4096;
+
+	size_t RoundUp(size_t value, size_t multiple) {
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+	size_t PageSize() {
+		static const size_t pageSize = [] {
+			SYSTEM_INFO si{};
+			GetSystemInfo(&si);
+			return static_cast<size_t>(si.dwPageSize);
+		}();
+		return pageSize;
+	}
+
+	size_t ReserveGranularity() {
+		static const size_t granularity = [] {
+			SYSTEM_INFO si{};
+			GetSystemInfo(&si);
+			return static_cast<size_t>(si.dwAllocationGranularity);
+		}();
+		return granularity;
+	}
+}
+
+bool SectorStore::Plane::Reserve(size_t sectors) {
+	size_t bytes = RoundUp(std::max<size_t>(sectors, 1) * stride, ReserveGranularity());
+	if (bytes <= reservedBytes) return true;
+	// Released pages cannot be copied; the plane has to stay where it is.
+	if (releasedBytes > 0) return false;
+
+	BYTE* newBase = static_cast<BYTE*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_READWRITE));
+	if (!newBase) return false;
+
+	// Rare path: the store outgrew its reservation.  Move the committed
+	// bytes into the larger region once; callers that Reserve() the full
+	// sector count up front never get here.
+	if (committedBytes > 0) {
+		if (!VirtualAlloc(newBase, committedBytes, MEM_COMMIT, PAGE_READWRITE)) {
+			VirtualFree(newBase, 0, MEM_RELEASE);
+			return false;
+		}
+		memcpy(newBase, base, committedBytes);
+	}
+	if (base) VirtualFree(base, 0, MEM_RELEASE);
+
+	base = newBase;
+	reservedBytes = bytes;
+	return true;
+}
+
+bool SectorStore::Plane::Commit(size_t sectors) {
+	size_t need = sectors * stride;
+	if (need <= committedBytes) return true;
+
+	if (need > reservedBytes) {
+		size_t reservedSectors = reservedBytes / stride;
+		size_t target = std::max({ sectors, reservedSectors * 2, MIN_RESERVE_SECTORS });
+		if (!Reserve(target)) return false;
+	}
+
+	size_t target = std::min(reservedBytes, RoundUp(need, COMMIT_CHUNK));
+	if (!VirtualAlloc(base + committedBytes, target - committedBytes, MEM_COMMIT, PAGE_READWRITE)) {
+		// Retry with the exact page-rounded size before giving up.
+		target = RoundUp(need, PageSize());
+		if (!VirtualAlloc(base + committedBytes, target - committedBytes, MEM_COMMIT, PAGE_READWRITE))
+			return false;
+	}
+	committedBytes = target;
+	return true;
+}
+
+void SectorStore::Plane::Decommit(size_t sectors) {
+	size_t keep = RoundUp(sectors * stride, PageSize());
+	if (!base || keep >= committedBytes) return;
+	VirtualFree(base + keep, committedBytes - keep, MEM_DECOMMIT);
+	committedBytes = keep;
+}
+
+void SectorStore::Plane::ReleaseBelow(size_t upTo, const std::vector<size_t>& keep) {
+	if (!base) return;
+	const size_t page = PageSize();
+	auto holdsKept = [&](size_t offset) {
+		size_t firstSector = offset / stride;
+		size_t lastSector = (offset + page - 1) / stride;
+		auto it = std::lower_bound(keep.begin(), keep.end(), firstSector);
+		return it != keep.end() && *it <= lastSector;
+	};
+
+	// Pages held back by an earlier call whose sectors are no longer kept.
+	auto held = std::remove_if(heldPages.begin(), heldPages.end(), [&](size_t offset) {
+		if (holdsKept(offset)) return false;
+		VirtualFree(base + offset, page, MEM_DECOMMIT);
+		return true;
+	});
+	heldPages.erase(held, heldPages.end());
+
+	// Whole pages only: the page holding the first byte of sector upTo
+	// may still be needed.  Contiguous free pages go in one call.
+	size_t end = std::min(upTo * stride / page * page, committedBytes);
+	size_t runStart = releasedBytes;
+	for (size_t offset = releasedBytes; offset < end; offset += page) {
+		if (!holdsKept(offset)) continue;
+		if (offset > runStart) VirtualFree(base + runStart, offset - runStart, MEM_DECOMMIT);
+		heldPages.push_back(offset);
+		runStart = offset + page;
+	}
+	if (end > runStart) VirtualFree(base + runStart, end - runStart, MEM_DECOMMIT);
+	releasedBytes = std::max(releasedBytes, end);
+}
+
+void SectorStore::Plane::Release() {
+	if (base) VirtualFree(base, 0, MEM_RELEASE);
+	base = nullptr;
+	reservedBytes = 0;
+	committedBytes = 0;
+	releasedBytes = 0;
+	heldPages.clear();
+}
+
+// ============================================================================
+// Construction / copy / move
+// ============================================================================
+
+SectorStore::SectorStore() {
+	m_audio.stride = AUDIO_SECTOR_SIZE;
+	m_sub.stride = SUBCHANNEL_SIZE;
+	m_c2.stride = C2_ERROR_SIZE;
+}
+
+SectorStore::~SectorStore() {
+	clear();
+}
+
+SectorStore::SectorStore(const SectorStore& other) : SectorStore() {
+	AppendFrom(other, 0, other.m_count);
+}
+
+SectorStore& SectorStore::operator=(const SectorStore& other) {
+	if (this != &other) {
+		SectorStore copy(other);
+		*this = std::move(copy);
+	}
+	return *this;
+}
+
+SectorStore::SectorStore(SectorStore&& other) noexcept : SectorStore() {
+	*this = std::move(other);
+}
+
+SectorStore& SectorStore::operator=(SectorStore&& other) noexcept {
+	if (this != &other) {
+		std::swap(m_audio, other.m_audio);
+		std::swap(m_sub, other.m_sub);
+		std::swap(m_c2, other.m_c2);
+		std::swap(m_flags, other.m_flags);
+		std::swap(m_count, other.m_count);
+		std::swap(m_released, other.m_released);
+		other.clear();
+	}
+	return *this;
+}
+
+// ============================================================================
+// Capacity
+// ============================================================================
+
+void SectorStore::clear() {
+	m_audio.Release();
+	m_sub.Release();
+	m_c2.Release();
+	std::vector<BYTE>().swap(m_flags);
+	m_count = 0;
+	m_released = false;
+}
+
+void SectorStore::shrink_to_fit() {
+	if (m_count == 0) {
+		clear();
+		return;
+	}
+	m_audio.Decommit(m_count);
+	m_sub.Decommit(m_count);
+	m_c2.Decommit(m_count);
+	m_flags.shrink_to_fit();
+}
+
+bool SectorStore::Reserve(size_t sectorCount, bool withSubchannel, bool withC2) {
+	if (!m_audio.Reserve(sectorCount)) return false;
+	if (withSubchannel && !m_sub.Reserve(sectorCount)) return false;
+	if (withC2 && !m_c2.Reserve(sectorCount)) return false;
+	m_flags.reserve(sectorCount);
+	return true;
+}
+
+// An active optional plane is always committed for every stored sector so
+// record i sits at base + i * stride regardless of which sectors carry it.
+bool SectorStore::Grow(size_t newCount, bool withSubchannel, bool withC2) {
+	if (!m_audio.Commit(newCount)) return false;
+	if ((withSubchannel || m_sub.base) && !m_sub.Commit(newCount)) return false;
+	if ((withC2 || m_c2.base) && !m_c2.Commit(newCount)) return false;
+	return true;
+}
+
+// ============================================================================
+// Appending
+// ============================================================================
+
+BYTE* SectorStore::AppendSector(bool withSubchannel, bool withC2) {
+	if (!Grow(m_count + 1, withSubchannel, withC2)) return nullptr;
+
+	BYTE flags = 0;
+	if (withSubchannel) flags |= FLAG_SUBCHANNEL;
+	if (withC2) flags |= FLAG_C2;
+	m_flags.push_back(flags);
+
+	return m_audio.base + (m_count++) * AUDIO_SECTOR_SIZE;
+}
+
+BYTE* SectorStore::AppendSectors(size_t count, bool withSubchannel, bool withC2) {
+	if (!Grow(m_count + count, withSubchannel, withC2)) return nullptr;
+
+	BYTE flags = 0;
+	if (withSubchannel) flags |= FLAG_SUBCHANNEL;
+	if (withC2) flags |= FLAG_C2;
+
+	BYTE* first = m_audio.base + m_count * AUDIO_SECTOR_SIZE;
+	m_flags.resize(m_count + count, flags);
+	m_count += count;
+	return first;
+}
+
+bool SectorStore::AppendRaw(const BYTE* data, size_t bytes) {
+	bool withSub = bytes >= static_cast<size_t>(RAW_SECTOR_SIZE);
+	BYTE* audio = AppendSector(withSub);
+	if (!audio) return false;
+
+	memcpy(audio, data, std::min<size_t>(bytes, AUDIO_SECTOR_SIZE));
+	if (withSub) memcpy(Subchannel(m_count - 1), data + AUDIO_SECTOR_SIZE, SUBCHANNEL_SIZE);
+	return true;
+}
+
+bool SectorStore::AppendAudio(const BYTE* pcm, size_t sectorCount) {
+	BYTE* dst = AppendSectors(sectorCount);
+	if (!dst) return false;
+	memcpy(dst, pcm, sectorCount * AUDIO_SECTOR_SIZE);
+	return true;
+}
+
+bool SectorStore::AppendSilence(size_t sectorCount) {
+	// Freshly committed pages and truncated tails are already zero.
+	return AppendSectors(sectorCount) != nullptr || sectorCount == 0;
+}
+
+bool SectorStore::AppendFrom(const SectorStore& other, size_t first, size_t count) {
+	if (first > other.m_count || other.m_released) return false;
+	count = std::min(count, other.m_count - first);
+	if (count == 0) return true;
+
+	size_t dst = m_count;
+	bool withSub = other.m_sub.base != nullptr;
+	bool withC2 = other.m_c2.base != nullptr;
+	if (!Grow(dst + count, withSub, withC2)) return false;
+
+	memcpy(m_audio.base + dst * AUDIO_SECTOR_SIZE,
+		other.m_audio.base + first * AUDIO_SECTOR_SIZE, count * AUDIO_SECTOR_SIZE);
+	if (withSub) {
+		memcpy(m_sub.base + dst * SUBCHANNEL_SIZE,
+			other.m_sub.base + first * SUBCHANNEL_SIZE, count * SUBCHANNEL_SIZE);
+	}
+	if (withC2) {
+		memcpy(m_c2.base + dst * C2_ERROR_SIZE,
+			other.m_c2.base + first * C2_ERROR_SIZE, count * C2_ERROR_SIZE);
+	}
+
+	m_flags.insert(m_flags.end(), other.m_flags.begin() + first,
+		other.m_flags.begin() + first + count);
+	m_count += count;
+	return true;
+}
+
+// ============================================================================
+// Random access
+// ============================================================================
+
+void SectorStore::StoreRaw(size_t index, const BYTE* data, size_t bytes) {
+	if (index >= m_count) return;
+	memcpy(Audio(index), data, std::min<size_t>(bytes, AUDIO_SECTOR_SIZE));
+	if (bytes >= static_cast<size_t>(RAW_SECTOR_SIZE) && HasSubchannel(index)) {
+		memcpy(Subchannel(index), data + AUDIO_SECTOR_SIZE, SUBCHANNEL_SIZE);
+	}
+}
+
+void SectorStore::LoadRaw(size_t index, BYTE* out, size_t bytes) const {
+	if (index >= m_count) return;
+	memcpy(out, Audio(index), std::min<size_t>(bytes, AUDIO_SECTOR_SIZE));
+	if (bytes >= static_cast<size_t>(RAW_SECTOR_SIZE)) {
+		const BYTE* sub = Subchannel(index);
+		if (sub) memcpy(out + AUDIO_SECTOR_SIZE, sub, SUBCHANNEL_SIZE);
+		else memset(out + AUDIO_SECTOR_SIZE, 0, SUBCHANNEL_SIZE);
+	}
+}
+
+BYTE* SectorStore::EnableC2(size_t index) {
+	if (index >= m_count) return nullptr;
+	if (!(m_flags[index] & FLAG_C2)) {
+		if (!m_c2.Commit(m_count)) return nullptr;
+		m_flags[index] |= FLAG_C2;
+	}
+	return m_c2.base + index * C2_ERROR_SIZE;
+}
+
+void SectorStore::Truncate(size_t count) {
+	if (count >= m_count) return;
+
+	// Keep the invariant that committed bytes past size() are zero, so the
+	// next append hands out silent sectors without a memset of its own.
+	size_t dropped = m_count - count;
+	memset(m_audio.base + count * AUDIO_SECTOR_SIZE, 0, dropped * AUDIO_SECTOR_SIZE);
+	if (m_sub.base) memset(m_sub.base + count * SUBCHANNEL_SIZE, 0, dropped * SUBCHANNEL_SIZE);
+	if (m_c2.base) memset(m_c2.base + count * C2_ERROR_SIZE, 0, dropped * C2_ERROR_SIZE);
+
+	m_flags.resize(count);
+	m_count = count;
+}
+
+void SectorStore::ReleaseBelow(size_t upTo, const std::vector<size_t>& keep) {
+	upTo = std::min(upTo, m_count);
+	m_audio.ReleaseBelow(upTo, keep);
+	m_sub.ReleaseBelow(upTo, keep);
+	m_c2.ReleaseBelow(upTo, keep);
+	if (m_audio.releasedBytes > 0 || m_sub.releasedBytes > 0 || m_c2.releasedBytes > 0) {
+		m_released = true;
+	}
+}
+
+SectorSpan SectorStore::AudioSpan(size_t first, size_t count) const {
+	if (first > m_count) first = m_count;
+	count = std::min(count, m_count - first);
+	return { m_audio.base ? m_audio.base + first * AUDIO_SECTOR_SIZE : nullptr,
+		count, AUDIO_SECTOR_SIZE };
+}
+
+MutableSectorSpan SectorStore::MutableAudioSpan(size_t first, size_t count) {
+	if (first > m_count) first = m_count;
+	count = std::min(count, m_count - first);
+	return { m_audio.base ? m_audio.base + first * AUDIO_SECTOR_SIZE : nullptr,
+		count, AUDIO_SECTOR_SIZE };
+}
@@ -0,0 +1,167 @@
+﻿// ============================================================================
+// SectorStore.h - Contiguous, page-aligned storage for ripped sectors
+//
+// Replaces the old vector-of-vectors sector cache.  Each kind of data lives
+// in its own plane of fixed-stride records:
+//
+//   audio plane       2352 bytes per sector (always present)
+//   subchannel plane    96 bytes per sector (only once a sector carries it)
+//   C2 plane           296 bytes per sector (only once a sector carries it)
+//
+// Every plane is one VirtualAlloc reservation whose pages are committed as
+// the store grows, so appending never moves existing sectors as long as the
+// caller reserved enough address space up front (the read loops know the
+// sector count before they start).  Because the audio plane is a single
+// packed run, a track's PCM is one contiguous byte range that can be handed
+// straight to CRC, WAV and offset-shift code without gathering.
+//
+// A streaming rip (RipStream.h) gives sectors back once they are on disk:
+// ReleaseBelow decommits their pages but keeps the reservation, so indices
+// and pointers of the sectors still held stay valid.
+// ============================================================================
+#pragma once
+
+#include "Constants.h"
+#include <windows.h>
+#include <cstddef>
+#include <vector>
+
+// ── Read-only view over consecutive sectors of one plane ────────────────────
+// stride is the byte distance between sectors (2352 for audio, 96 for
+// subchannel, 296 for C2).  Spans are invalidated by anything that can grow
+// the store past its reservation or release it (Append*, Reserve, clear).
+struct SectorSpan {
+	const BYTE* data = nullptr;     // First byte of the first sector
+	size_t count = 0;               // Number of sectors in the view
+	size_t stride = AUDIO_SECTOR_SIZE;
+
+	bool empty() const { return count == 0; }
+	size_t Bytes() const { return count * stride; }
+	const BYTE* Sector(size_t i) const { return data + i * stride; }
+	SectorSpan Sub(size_t first, size_t n) const {
+		if (first > count) first = count;
+		if (n > count - first) n = count - first;
+		return { data + first * stride, n, stride };
+	}
+};
+
+// Writable counterpart — used by in-place operations such as offset shifting.
+struct MutableSectorSpan {
+	BYTE* data = nullptr;
+	size_t count = 0;
+	size_t stride = AUDIO_SECTOR_SIZE;
+
+	bool empty() const { return count == 0; }
+	size_t Bytes() const { return count * stride; }
+	BYTE* Sector(size_t i) const { return data + i * stride; }
+	operator SectorSpan() const { return { data, count, stride }; }
+};
+
+class SectorStore {
+public:
+	SectorStore();
+	~SectorStore();
+	SectorStore(const SectorStore& other);
+	SectorStore& operator=(const SectorStore& other);
+	SectorStore(SectorStore&& other) noexcept;
+	SectorStore& operator=(SectorStore&& other) noexcept;
+
+	size_t size() const { return m_count; }
+	bool empty() const { return m_count == 0; }
+
+	// Release every plane.  The next append starts from a fresh reservation.
+	void clear();
+	// Decommit pages past the last stored sector (keeps the reservation).
+	void shrink_to_fit();
+
+	// Reserve address space for `sectorCount` sectors.  Optional planes are
+	// reserved too when requested so they never need to move either.
+	// Returns false if the address space could not be reserved.
+	bool Reserve(size_t sectorCount, bool withSubchannel = false, bool withC2 = false);
+
+	// Append one zero-filled sector and return a pointer to its audio bytes
+	// (nullptr when out of memory).  The subchannel / C2 records for the new
+	// sector are available through Subchannel() / C2() when requested.
+	BYTE* AppendSector(bool withSubchannel = false, bool withC2 = false);
+
+	// Append `count` zero-filled sectors and return the first audio byte —
+	// the block is contiguous in every plane, so a multi-sector READ CD can
+	// land directly in the store (subchannel at Subchannel(first), C2 at
+	// C2(first)).
+	BYTE* AppendSectors(size_t count, bool withSubchannel = false, bool withC2 = false);
+
+	// Append a sector in the legacy interleaved layout: 2352 bytes of audio,
+	// optionally followed by 96 bytes of subchannel (bytes == 2448).
+	bool AppendRaw(const BYTE* data, size_t bytes);
+	// Append packed 2352-byte audio sectors.
+	bool AppendAudio(const BYTE* pcm, size_t sectorCount);
+	bool AppendSilence(size_t sectorCount);
+	// Append sectors [first, first+count) of another store, every plane.
+	bool AppendFrom(const SectorStore& other, size_t first, size_t count);
+
+	// Overwrite sector `index` from the legacy interleaved layout.
+	void StoreRaw(size_t index, const BYTE* data, size_t bytes);
+	// Copy sector `index` into the legacy interleaved layout (audio then,
+	// when bytes >= 2448 and present, subchannel).
+	void LoadRaw(size_t index, BYTE* out, size_t bytes) const;
+
+	// Drop sectors from the end so size() == count.
+	void Truncate(size_t count);
+
+	// Decommit every page below sector `upTo` that holds no sector listed
+	// in `keep` (sorted ascending).  Pages held back for a kept sector are
+	// rechecked on every call and go once it is no longer listed.  Released
+	// sectors must not be accessed again; size() and indices are unchanged.
+	void ReleaseBelow(size_t upTo, const std::vector<size_t>& keep);
+	// True once any page has been released — whole-store views (AudioSpan(),
+	// copies, AppendFrom) are then no longer available.
+	bool HasReleased() const { return m_released; }
+
+	BYTE* Audio(size_t index) { return m_audio.base + index * AUDIO_SECTOR_SIZE; }
+	const BYTE* Audio(size_t index) const { return m_audio.base + index * AUDIO_SECTOR_SIZE; }
+
+	bool HasSubchannel(size_t index) const { return index < m_count && (m_flags[index] & FLAG_SUBCHANNEL); }
+	BYTE* Subchannel(size_t index) { return HasSubchannel(index) ? m_sub.base + index * SUBCHANNEL_SIZE : nullptr; }
+	const BYTE* Subchannel(size_t index) const { return HasSubchannel(index) ? m_sub.base + index * SUBCHANNEL_SIZE : nullptr; }
+
+	bool HasC2(size_t index) const { return index < m_count && (m_flags[index] & FLAG_C2); }
+	BYTE* C2(size_t index) { return HasC2(index) ? m_c2.base + index * C2_ERROR_SIZE : nullptr; }
+	const BYTE* C2(size_t index) const { return HasC2(index) ? m_c2.base + index * C2_ERROR_SIZE : nullptr; }
+	// Attach a C2 record to an existing sector (commits the C2 plane on demand).
+	BYTE* EnableC2(size_t index);
+
+	// Views over the audio plane.  Both clamp to the stored range.
+	SectorSpan AudioSpan(size_t first, size_t count) const;
+	SectorSpan AudioSpan() const { return AudioSpan(0, m_count); }
+	MutableSectorSpan MutableAudioSpan(size_t first, size_t count);
+	MutableSectorSpan MutableAudioSpan() { return MutableAudioSpan(0, m_count); }
+
+private:
+	static constexpr BYTE FLAG_SUBCHANNEL = 0x01;
+	static constexpr BYTE FLAG_C2 = 0x02;
+
+	// One fixed-stride VirtualAlloc region.
+	struct Plane {
+		BYTE* base = nullptr;
+		size_t stride = 0;
+		size_t reservedBytes = 0;
+		size_t committedBytes = 0;
+		size_t releasedBytes = 0;       // [0, releasedBytes) handed to ReleaseBelow
+		std::vector<size_t> heldPages;  // offsets of pages kept back below it
+
+		bool Reserve(size_t sectors);
+		bool Commit(size_t sectors);
+		void Decommit(size_t sectors);
+		void ReleaseBelow(size_t upTo, const std::vector<size_t>& keep);
+		void Release();
+	};
+
+	bool Grow(size_t newCount, bool withSubchannel, bool withC2);
+
+	Plane m_audio;
+	Plane m_sub;
+	Plane m_c2;
+	std::vector<BYTE> m_flags;      // FLAG_* per sector
+	size_t m_count = 0;
+	bool m_released = false;
+};
@@ -29,6 +29,7 @@ struct SecureRipConfig {
 	bool c2Guided = true;
 	bool cacheDefeat = true;
 	int maxSpeed = 0;
+	bool sampleVote = true;      // Rebuild unmatched sectors by C2-weighted per-sample vote
 };
 
 // ── Per-sector log entry from a secure rip ──────────────────────────────────
@@ -42,7 +43,17 @@ struct SecureRipLogEntry {
 	int c2Errors = 0;            // C2 error flags encountered across all passes
 	double readTimeMs = 0.0;     // Wall-clock time spent reading this sector
 	bool verified = false;       // true if the sector met the match threshold
-	uint32_t hash = 0;           // CRC / hash of the accepted data
+	uint64_t hash = 0;           // 64-bit prefix of the accepted data's SectorHash
+	int contestedSamples = 0;    // 16-bit samples on which the reads disagreed
+	float minSampleConfidence = 1.0f; // Lowest per-sample vote share (1.0 = unanimous)
+};
+
+// ── Per-sample vote outcome ─────────────────────────────────────────────────
+// Recorded for every contested sample of a sector rebuilt by sample vote.
+struct SampleConfidence {
+	DWORD lba = 0;               // Sector address
+	int sample = 0;              // 16-bit sample index within the sector (0–1175)
+	float confidence = 0.0f;     // Winning value's share of the C2-weighted vote
 };
 
 // ── Per-phase aggregate statistics ──────────────────────────────────────────
@@ -66,9 +77,11 @@ struct SecureRipLog {
 	int requiredMatches = 0;
 	bool useC2 = false;
 	bool cacheDefeat = false;
+	bool sampleVote = false;
 
 	std::vector<SecureRipLogEntry> entries;        // One entry per sector
 	std::vector<SecureRipPhaseStats> phaseStats;   // One entry per phase
+	std::vector<SampleConfidence> sampleVotes;     // Contested samples of voted sectors
 
 	int totalSectors = 0;
 	int totalVerified = 0;
@@ -86,7 +99,11 @@ struct SecureSectorResult {
 	int c2ErrorPasses = 0;           // Passes that had C2 errors
 	bool isSecure = false;           // true = verified, false = gave up
 	bool usedCacheDefeat = false;    // Whether cache defeat was needed
-	uint32_t finalHash = 0;          // Hash of the accepted data
+	uint64_t finalHash = 0;          // SectorHash prefix of the accepted data
+	bool reconstructed = false;      // Data assembled by per-sample vote
+	int contestedSamples = 0;        // Samples on which the reads disagreed
+	float minSampleConfidence = 1.0f;// Lowest per-sample vote share
+	std::vector<SampleConfidence> sampleConfidence;  // Contested samples only
 };
 
 // ── Disc-wide secure rip summary ────────────────────────────────────────────
@@ -0,0 +1,211 @@
+﻿#include "SecureSectorTable.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+// ============================================================================
+// SecureSectorTable
+// ============================================================================
+
+void SecureSectorTable::Reset(DWORD firstLBA, DWORD lastLBA) {
+	m_firstLBA = firstLBA;
+	size_t slots = (lastLBA >= firstLBA) ? static_cast<size_t>(lastLBA - firstLBA) + 1 : 0;
+
+	m_storeIndex.assign(slots, 0);
+	m_hash.assign(slots, SectorHash{});
+	m_matchCount.assign(slots, 0);
+	m_c2Failures.assign(slots, 0);
+	m_flags.assign(slots, 0);
+	m_track.assign(slots, 0);
+	m_partialSlot.assign(slots, 0);
+	m_partialCounts.clear();
+}
+
+void SecureSectorTable::Set(DWORD lba, size_t storeIndex, const SectorHash& hash, int matchCount,
+	BYTE flags, int track) {
+	size_t s = Slot(lba);
+	m_storeIndex[s] = static_cast<uint32_t>(storeIndex);
+	m_hash[s] = hash;
+	m_matchCount[s] = static_cast<uint16_t>(matchCount);
+	m_c2Failures[s] = 0;
+	m_flags[s] = static_cast<BYTE>(flags | FLAG_PRESENT);
+	m_track[s] = static_cast<BYTE>(track);
+}
+
+void SecureSectorTable::BeginPartial(DWORD lba, const BYTE* c2Pointers) {
+	size_t offset = m_partialCounts.size();
+	m_partialCounts.resize(offset + AUDIO_SECTOR_SIZE);
+	m_partialSlot[Slot(lba)] = static_cast<uint32_t>(offset / AUDIO_SECTOR_SIZE) + 1;
+
+	BYTE* counts = m_partialCounts.data() + offset;
+	for (int i = 0; i < AUDIO_SECTOR_SIZE; i++) {
+		counts[i] = C2Flagged(c2Pointers, i) ? 0 : BYTE_TRUSTED;
+	}
+}
+
+SecureSectorTable::PartialProgress SecureSectorTable::MergePartial(DWORD lba, BYTE* storedAudio,
+	const BYTE* reread, const BYTE* c2Pointers, int requiredMatches) {
+	PartialProgress progress;
+	uint32_t record = m_partialSlot[Slot(lba)];
+	if (record == 0) return progress;
+
+	BYTE* counts = m_partialCounts.data() + static_cast<size_t>(record - 1) * AUDIO_SECTOR_SIZE;
+	int minMatches = INT_MAX;
+
+	for (int i = 0; i < AUDIO_SECTOR_SIZE; i++) {
+		BYTE& count = counts[i];
+		if (count == BYTE_TRUSTED) continue;
+
+		if (!c2Pointers || !C2Flagged(c2Pointers, i)) {
+			if (count > 0 && storedAudio[i] == reread[i]) {
+				if (count < BYTE_TRUSTED - 1) count++;
+			}
+			else {
+				// First clean observation, or a clean one that contradicts
+				// the last: the newest clean value starts over.
+				if (storedAudio[i] != reread[i]) progress.mergedBytes++;
+				storedAudio[i] = reread[i];
+				count = 1;
+			}
+		}
+
+		if (count < requiredMatches) progress.pendingBytes++;
+		minMatches = std::min(minMatches, static_cast<int>(count));
+	}
+
+	progress.minMatches = (minMatches == INT_MAX) ? requiredMatches : minMatches;
+	progress.complete = (progress.pendingBytes == 0);
+	return progress;
+}
+
+// ============================================================================
+// SectorCandidatePool
+// ============================================================================
+
+void SectorCandidatePool::Reset() {
+	m_size = 0;
+	m_scratch = MAX_CANDIDATES;
+	for (int i = 0; i < MAX_CANDIDATES; i++) m_candidates[i] = { SectorHash{}, 0, i };
+}
+
+namespace {
+	// True when the C2 pointers flag either byte of 16-bit sample s.
+	bool SampleFlagged(const BYTE* c2Pointers, int s) {
+		return SecureSectorTable::C2Flagged(c2Pointers, 2 * s) ||
+			SecureSectorTable::C2Flagged(c2Pointers, 2 * s + 1);
+	}
+}
+
+int SectorCandidatePool::Commit(const SectorHash& hash, const BYTE* c2Pointers, bool countsAsMatch) {
+	auto addVotes = [&](int candidate) {
+		BYTE* votes = m_votes[candidate];
+		for (int s = 0; s < SAMPLES; s++) {
+			if (c2Pointers && SampleFlagged(c2Pointers, s)) {
+				if ((votes[s] >> 4) < 15) votes[s] += 0x10;
+			}
+			else if ((votes[s] & 0x0F) < 15) {
+				votes[s]++;
+			}
+		}
+	};
+
+	for (int i = 0; i < m_size; i++) {
+		if (m_candidates[i].hash == hash) {
+			addVotes(i);
+			if (countsAsMatch) m_candidates[i].count++;
+			return m_candidates[i].count;
+		}
+	}
+
+	int target = m_size;
+	if (m_size < MAX_CANDIDATES) {
+		m_size++;
+	}
+	else {
+		// Evict the least-confirmed candidate (the newest one on ties —
+		// older readings have had more chances to be matched).
+		target = 0;
+		for (int i = 1; i < m_size; i++) {
+			if (m_candidates[i].count <= m_candidates[target].count) target = i;
+		}
+	}
+
+	// The scratch buffer becomes the candidate's; its old buffer is the
+	// next scratch.
+	Candidate& c = m_candidates[target];
+	std::swap(c.slot, m_scratch);
+	c.hash = hash;
+	c.count = countsAsMatch ? 1 : 0;
+	memset(m_votes[target], 0, SAMPLES);
+	addVotes(target);
+	return c.count;
+}
+
+const SectorCandidatePool::Candidate* SectorCandidatePool::Best() const {
+	const Candidate* best = nullptr;
+	for (int i = 0; i < m_size; i++) {
+		if (!best || m_candidates[i].count > best->count) best = &m_candidates[i];
+	}
+	return best;
+}
+
+SectorCandidatePool::VoteResult SectorCandidatePool::Vote(BYTE* audio, int requiredClean,
+	float* confidence) const {
+	VoteResult result;
+	result.secure = (m_size > 0);
+
+	for (int s = 0; s < SAMPLES; s++) {
+		// Distinct values of this sample across candidates, with their tally.
+		uint16_t value[MAX_CANDIDATES];
+		int weight[MAX_CANDIDATES];
+		int clean[MAX_CANDIDATES];
+		int distinct = 0;
+		int total = 0;
+
+		for (int i = 0; i < m_size; i++) {
+			BYTE votes = m_votes[i][s];
+			int cleanReads = votes & 0x0F;
+			int w = cleanReads * CLEAN_WEIGHT + (votes >> 4) * FLAGGED_WEIGHT;
+			if (w == 0) continue;
+
+			uint16_t v;
+			memcpy(&v, m_buffers[m_candidates[i].slot] + 2 * s, sizeof(v));
+			int k = 0;
+			while (k < distinct && value[k] != v) k++;
+			if (k == distinct) {
+				value[k] = v;
+				weight[k] = 0;
+				clean[k] = 0;
+				distinct++;
+			}
+			weight[k] += w;
+			clean[k] += cleanReads;
+			total += w;
+		}
+
+		if (distinct == 0) {
+			result.secure = false;
+			if (confidence) confidence[s] = 0.0f;
+			continue;
+		}
+
+		int win = 0;
+		for (int k = 1; k < distinct; k++) {
+			if (weight[k] > weight[win]) win = k;
+		}
+		int rivalClean = 0;
+		for (int k = 0; k < distinct; k++) {
+			if (k != win) rivalClean = std::max(rivalClean, clean[k]);
+		}
+
+		memcpy(audio + 2 * s, &value[win], sizeof(value[win]));
+
+		float share = static_cast<float>(weight[win]) / static_cast<float>(total);
+		if (confidence) confidence[s] = share;
+		if (distinct > 1) result.contested++;
+		result.minConfidence = std::min(result.minConfidence, share);
+		if (clean[win] < requiredClean || clean[win] <= rivalClean) result.secure = false;
+	}
+
+	return result;
+}
@@ -0,0 +1,200 @@
+﻿// ============================================================================
+// SecureSectorTable.h - Dense per-sector state for the secure rip engine
+//
+// The secure rip used to keep its bookkeeping in node-based containers: a
+// std::map<DWORD, SectorState> for every sector on the disc, an
+// unordered_map of C2 failure counts, and a map of hash -> heap-allocated
+// sector copy for every rescued sector.  On a full disc that is hundreds of
+// thousands of tree nodes and allocations on the hottest path.
+//
+// SecureSectorTable replaces the first two with one structure-of-arrays
+// table indexed by (lba - firstLBA): each field is a flat vector, so a sweep
+// over the re-read list touches a few bytes per sector and memory is a fixed
+// 32 bytes per LBA, plus 2352 bytes per sector under partial verification.
+// SectorCandidatePool replaces the third with a fixed set of inline sector
+// buffers that is reset, never reallocated, per sector.
+// ============================================================================
+#pragma once
+
+#include "Constants.h"
+#include "SectorHash.h"
+#include "SecureRipTypes.h"
+#include <windows.h>
+#include <cstdint>
+#include <vector>
+
+class SecureSectorTable {
+public:
+	static constexpr BYTE FLAG_PRESENT = 0x01;      // Sector belongs to the rip
+	static constexpr BYTE FLAG_AUDIO = 0x02;        // Audio (vs. data) track
+	static constexpr BYTE FLAG_SUBCHANNEL = 0x04;   // Stored with 96 bytes of subchannel
+	static constexpr BYTE FLAG_HAD_C2 = 0x08;       // Last accepted read carried C2 errors
+	static constexpr BYTE FLAG_VALID_HASH = 0x10;   // Hash() describes the stored data
+
+	// Size the table for LBAs [firstLBA, lastLBA].  Every slot starts empty.
+	void Reset(DWORD firstLBA, DWORD lastLBA);
+
+	bool Contains(DWORD lba) const {
+		return lba >= m_firstLBA && lba - m_firstLBA < m_flags.size() &&
+			(m_flags[lba - m_firstLBA] & FLAG_PRESENT);
+	}
+
+	// Record a sector's first-pass outcome.
+	void Set(DWORD lba, size_t storeIndex, const SectorHash& hash, int matchCount,
+		BYTE flags, int track);
+
+	// ── Field accessors (lba must be inside the table) ──────────────────
+	size_t StoreIndex(DWORD lba) const { return m_storeIndex[Slot(lba)]; }
+	SectorHash& Hash(DWORD lba) { return m_hash[Slot(lba)]; }
+	uint16_t& MatchCount(DWORD lba) { return m_matchCount[Slot(lba)]; }
+	uint16_t& C2Failures(DWORD lba) { return m_c2Failures[Slot(lba)]; }
+	int Track(DWORD lba) const { return m_track[Slot(lba)]; }
+
+	bool Has(DWORD lba, BYTE flag) const { return (m_flags[Slot(lba)] & flag) != 0; }
+	void SetFlag(DWORD lba, BYTE flag, bool on) {
+		if (on) m_flags[Slot(lba)] |= flag;
+		else m_flags[Slot(lba)] &= static_cast<BYTE>(~flag);
+	}
+
+	bool IsAudio(DWORD lba) const { return Has(lba, FLAG_AUDIO); }
+	int SectorSize(DWORD lba) const {
+		return Has(lba, FLAG_SUBCHANNEL) ? RAW_SECTOR_SIZE : AUDIO_SECTOR_SIZE;
+	}
+
+	// ── C2-guided partial verification ──────────────────────────────────
+	// A sector whose first read came back with C2 pointers is verified byte
+	// by byte instead of by whole-sector re-reads: bytes the pointers left
+	// clean are trusted (the same C2-guided rule phase 1 applies to whole
+	// sectors), and each flagged byte needs requiredMatches agreeing clean
+	// observations from later reads.  Per-byte counts live in one shared
+	// pool, 2352 bytes per tracked sector.
+	struct PartialProgress {
+		bool complete = false;      // Every flagged byte is confirmed
+		int pendingBytes = 0;       // Flagged bytes still short of requiredMatches
+		int mergedBytes = 0;        // Bytes this read changed in the stored audio
+		int minMatches = 0;         // Fewest clean observations of any flagged byte
+	};
+
+	// Start tracking `lba` from its first read's 294-byte C2 pointer bitmap.
+	void BeginPartial(DWORD lba, const BYTE* c2Pointers);
+	bool HasPartial(DWORD lba) const { return m_partialSlot[Slot(lba)] != 0; }
+
+	// Fold a re-read into `storedAudio` (the sector's 2352 stored bytes).
+	// Only flagged bytes are compared; the re-read's own C2 pointers decide
+	// which of its bytes count as clean observations.
+	PartialProgress MergePartial(DWORD lba, BYTE* storedAudio, const BYTE* reread,
+		const BYTE* c2Pointers, int requiredMatches);
+
+	// True when the C2 pointers flag audio byte `index`.  Bit 7 of pointer
+	// byte 0 covers audio byte 0.  A pointer byte of 0xFF is drive filler,
+	// not eight errors — the rule ParseC2Block applies when counting bytes.
+	static bool C2Flagged(const BYTE* c2Pointers, int index) {
+		BYTE bits = c2Pointers[index >> 3];
+		return bits != 0xFF && (bits & (0x80 >> (index & 7))) != 0;
+	}
+
+private:
+	// Count value for bytes the first read's C2 pointers left clean.
+	static constexpr BYTE BYTE_TRUSTED = 0xFF;
+
+	size_t Slot(DWORD lba) const { return lba - m_firstLBA; }
+
+	DWORD m_firstLBA = 0;
+	std::vector<uint32_t> m_storeIndex;     // Index into DiscInfo::rawSectors
+	std::vector<SectorHash> m_hash;
+	std::vector<uint16_t> m_matchCount;
+	std::vector<uint16_t> m_c2Failures;     // Consecutive unusable re-reads
+	std::vector<BYTE> m_flags;              // FLAG_*
+	std::vector<BYTE> m_track;
+	std::vector<uint32_t> m_partialSlot;    // 1-based record in m_partialCounts, 0 = none
+	std::vector<BYTE> m_partialCounts;      // 2352 clean-observation counts per record
+};
+
+// ── Candidate reads for one sector ──────────────────────────────────────────
+// Each distinct read result (by hash) gets one inline buffer plus a match
+// count.  Reads land in Scratch(); Commit() either bumps an existing
+// candidate or adopts the scratch buffer as a new one by swapping buffer
+// slots, so no sector data is copied or allocated per pass.  When every
+// slot is taken, the least-confirmed candidate is evicted.
+//
+// Alongside the whole-sector match counts the pool keeps a per-sample vote:
+// for each 16-bit sample, how many reads of each candidate the drive's C2
+// pointers left clean and how many they flagged.  Vote() rebuilds the
+// sector one sample at a time from that tally, so a sector where every
+// pass has a few different bad samples can still be assembled from the
+// samples the passes agree on.
+class SectorCandidatePool {
+public:
+	static constexpr int MAX_CANDIDATES = 8;
+	static constexpr int SAMPLES = AUDIO_SECTOR_SIZE / 2;  // 16-bit samples per sector
+
+	// A read counts this much toward a sample's vote when its C2 pointers
+	// leave the sample clean, FLAGGED_WEIGHT when they mark it.
+	static constexpr int CLEAN_WEIGHT = 4;
+	static constexpr int FLAGGED_WEIGHT = 1;
+
+	struct VoteResult {
+		bool secure = false;        // Every sample backed by enough clean reads
+		int contested = 0;          // Samples on which the candidates disagree
+		float minConfidence = 1.0f; // Lowest winning share of a sample's vote
+	};
+
+	struct Candidate {
+		SectorHash hash;
+		int count = 0;
+		int slot = 0;
+	};
+
+	SectorCandidatePool() { Reset(); }
+
+	void Reset();
+
+	// Buffer for the next read (RAW_SECTOR_SIZE bytes).
+	BYTE* Scratch() { return m_buffers[m_scratch]; }
+
+	// File the read in Scratch() under `hash`; returns its match count.
+	// c2Pointers (the 294-byte C2 pointer bitmap, or nullptr for "all
+	// clean") sets the read's per-sample vote weight.  With countsAsMatch
+	// false the read only joins the sample vote, not the match count.
+	int Commit(const SectorHash& hash, const BYTE* c2Pointers = nullptr, bool countsAsMatch = true);
+
+	// Write the per-sample winner into the first 2352 bytes of `audio`.
+	// A sample is secure when its winning value has at least requiredClean
+	// clean reads and more clean reads than any rival value.  confidence,
+	// when given, receives SAMPLES winning vote shares (1.0 = unanimous).
+	VoteResult Vote(BYTE* audio, int requiredClean, float* confidence = nullptr) const;
+
+	// Highest-count candidate (earliest on ties), nullptr when empty.
+	const Candidate* Best() const;
+	const BYTE* Data(const Candidate& c) const { return m_buffers[c.slot]; }
+
+	int Size() const { return m_size; }
+
+private:
+	Candidate m_candidates[MAX_CANDIDATES];
+	int m_size = 0;
+	int m_scratch = MAX_CANDIDATES;
+	BYTE m_buffers[MAX_CANDIDATES + 1][RAW_SECTOR_SIZE];
+	// Per candidate and sample: clean reads in the low nibble, C2-flagged
+	// reads in the high nibble (each saturating at 15).
+	BYTE m_votes[MAX_CANDIDATES][SAMPLES];
+};
+
+// ── Rescue state for one sector ─────────────────────────────────────────────
+// ReadSectorSecure's pass loop keeps everything it needs here, so phase 3
+// can rescue the sectors of a run pass by pass — one cache defeat per pass
+// per run — instead of finishing each sector before starting the next.
+struct SectorRescue {
+	DWORD lba = 0;
+	int sectorSize = AUDIO_SECTOR_SIZE;
+	bool isAudio = true;
+	bool finished = false;          // Accepted, or no point reading further
+	bool ok = false;                // data holds the chosen result
+	int consecutiveReadFailures = 0;
+	int consecutiveUnusableReads = 0;
+	SecureSectorResult result;
+	SectorCandidatePool candidates;
+	BYTE c2Pointers[C2_ERROR_SIZE] = {};
+	float confidence[SectorCandidatePool::SAMPLES] = {};
+	BYTE data[RAW_SECTOR_SIZE] = {};
+};
@@ -0,0 +1,193 @@
+﻿// ============================================================================
+// AccurateRipCacheTests.cpp - dBAR parsing and the memory-mapped cache
+// ============================================================================
+#include "UnitTest.h"
+#include "../AccurateRip.h"
+#include "../AccurateRipCache.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+	void PutLE32(std::vector<BYTE>& v, uint32_t x) {
+		for (int i = 0; i < 4; i++) v.push_back(static_cast<BYTE>(x >> (8 * i)));
+	}
+
+	// One dBAR chunk: header, then confidence + CRC (+ frame-450 CRC) per
+	// track.  Track t of pressing p gets CRC base + t and 450-CRC ~(base + t).
+	void AppendChunk(std::vector<BYTE>& v, const AccurateRipDiscKey& key,
+		uint32_t base, bool nineByte) {
+		v.push_back(static_cast<BYTE>(key.trackCount));
+		PutLE32(v, key.discId1);
+		PutLE32(v, key.discId2);
+		PutLE32(v, key.cddbId);
+		for (int t = 0; t < key.trackCount; t++) {
+			v.push_back(static_cast<BYTE>(10 + t));
+			PutLE32(v, base + t);
+			if (nineByte) PutLE32(v, ~(base + t));
+		}
+	}
+
+	AccurateRipDiscKey Key(uint32_t n, int tracks) {
+		return { 0x00100000u + n, 0x00A00000u + n, 0x0A000000u + n, tracks };
+	}
+
+	// A cache file in the temp directory, removed again on scope exit.
+	struct TempCache {
+		std::filesystem::path path;
+		explicit TempCache(const char* name) : path(std::filesystem::temp_directory_path() / name) {
+			Remove();
+			AccurateRipCache::Instance().Open(path);
+		}
+		~TempCache() {
+			AccurateRipCache::Instance().Open(std::filesystem::temp_directory_path() / "audiocopy_unused.cache");
+			Remove();
+		}
+		void Remove() {
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+		}
+	};
+}
+
+TEST_CASE(ParseFiveAndNineByteResponses) {
+	AccurateRipDiscKey key = Key(1, 3);
+	for (bool nineByte : { false, true }) {
+		std::vector<BYTE> dbar;
+		AppendChunk(dbar, key, 0x1000, nineByte);
+		AppendChunk(dbar, key, 0x2000, nineByte);
+
+		std::vector<AccurateRipPressing> pressings;
+		REQUIRE(AccurateRip::ParseResponse(dbar.data(), dbar.size(), key.trackCount, pressings));
+		REQUIRE(pressings.size() == 2);
+		for (int p = 0; p < 2; p++) {
+			CHECK_EQ(pressings[p].discId1, key.discId1);
+			CHECK_EQ(pressings[p].discId2, key.discId2);
+			CHECK_EQ(pressings[p].cddbId, key.cddbId);
+			REQUIRE(pressings[p].tracks.size() == 3);
+			for (int t = 0; t < 3; t++) {
+				uint32_t crc = (p == 0 ? 0x1000u : 0x2000u) + t;
+				CHECK_EQ(pressings[p].tracks[t].confidence, 10 + t);
+				CHECK_EQ(pressings[p].tracks[t].crcV1, crc);
+				CHECK_EQ(pressings[p].tracks[t].crc450, nineByte ? ~crc : 0u);
+			}
+		}
+	}
+
+	std::vector<AccurateRipPressing> pressings;
+	std::vector<BYTE> tooShort(10, 0);
+	CHECK(!AccurateRip::ParseResponse(tooShort.data(), tooShort.size(), 3, pressings));
+}
+
+TEST_CASE(CacheStoresAndFindsSingleEntries) {
+	TempCache temp("audiocopy_test_single.cache");
+	auto& cache = AccurateRipCache::Instance();
+	CHECK_EQ(cache.Count(), 0u);
+
+	std::vector<BYTE> a, b, found;
+	AppendChunk(a, Key(1, 2), 0x100, false);
+	AppendChunk(b, Key(2, 5), 0x200, true);
+	REQUIRE(cache.Store(Key(1, 2), a.data(), a.size()));
+	REQUIRE(cache.Store(Key(2, 5), b.data(), b.size()));
+	CHECK_EQ(cache.Count(), 2u);
+
+	REQUIRE(cache.Find(Key(1, 2), found));
+	CHECK(found == a);
+	REQUIRE(cache.Find(Key(2, 5), found));
+	CHECK(found == b);
+	CHECK(!cache.Find(Key(1, 3), found));   // Same IDs, different track count
+
+	// Replacing an entry keeps the count and the other entry.
+	std::vector<BYTE> a2;
+	AppendChunk(a2, Key(1, 2), 0x300, true);
+	REQUIRE(cache.Store(Key(1, 2), a2.data(), a2.size()));
+	CHECK_EQ(cache.Count(), 2u);
+	REQUIRE(cache.Find(Key(1, 2), found));
+	CHECK(found == a2);
+	REQUIRE(cache.Find(Key(2, 5), found));
+	CHECK(found == b);
+}
+
+TEST_CASE(CacheBatchWritesOnceAndLaterEntryWins) {
+	TempCache temp("audiocopy_test_batch.cache");
+	auto& cache = AccurateRipCache::Instance();
+
+	// Enough entries to grow the table past its minimum size.
+	std::vector<AccurateRipCacheEntry> entries;
+	for (uint32_t n = 0; n < 100; n++) {
+		AccurateRipCacheEntry e;
+		e.key = Key(n, 1 + n % 20);
+		AppendChunk(e.dbar, e.key, n << 8, n % 2 == 0);
+		entries.push_back(std::move(e));
+	}
+	AccurateRipCacheEntry dup;
+	dup.key = entries[7].key;
+	AppendChunk(dup.dbar, dup.key, 0xBEEF00, true);
+	entries.push_back(dup);
+
+	REQUIRE(cache.StoreBatch(entries));
+	CHECK_EQ(cache.Count(), 100u);
+
+	std::vector<AccurateRipDiscKey> keys;
+	for (uint32_t n = 0; n < 100; n++) keys.push_back(entries[n].key);
+	keys.push_back(Key(1000, 4));           // Not stored
+	std::vector<std::vector<BYTE>> dbars;
+	CHECK_EQ(cache.FindBatch(keys, dbars), 100u);
+	REQUIRE(dbars.size() == keys.size());
+	for (uint32_t n = 0; n < 100; n++)
+		CHECK(dbars[n] == (n == 7 ? dup.dbar : entries[n].dbar));
+	CHECK(dbars[100].empty());
+
+	// A batch with an unusable entry writes nothing.
+	AccurateRipCacheEntry bad;
+	bad.key = Key(2000, 3);
+	CHECK(!cache.StoreBatch({ bad }));
+	CHECK_EQ(cache.Count(), 100u);
+}
+
+TEST_CASE(CacheKeepsOfflineFlagAcrossWrites) {
+	TempCache temp("audiocopy_test_offline.cache");
+	auto& cache = AccurateRipCache::Instance();
+	CHECK(!cache.IsOffline());
+	REQUIRE(cache.SetOffline(true));
+	CHECK(cache.IsOffline());
+
+	std::vector<BYTE> a;
+	AppendChunk(a, Key(3, 4), 0x400, false);
+	REQUIRE(cache.Store(Key(3, 4), a.data(), a.size()));
+	CHECK(cache.IsOffline());
+
+	// Reopening maps the same file from disk.
+	REQUIRE(cache.Open(temp.path));
+	CHECK(cache.IsOffline());
+	CHECK_EQ(cache.Count(), 1u);
+}
+
+TEST_CASE(CacheImportsFolderOfDbarFiles) {
+	TempCache temp("audiocopy_test_import.cache");
+	auto folder = std::filesystem::temp_directory_path() / "audiocopy_test_dbar";
+	std::error_code ec;
+	std::filesystem::remove_all(folder, ec);
+	std::filesystem::create_directories(folder / "a" / "b");
+
+	auto write = [](const std::filesystem::path& p, const std::vector<BYTE>& data) {
+		std::ofstream out(p, std::ios::binary);
+		out.write(reinterpret_cast<const char*>(data.data()), data.size());
+	};
+	std::vector<BYTE> one, two;
+	AppendChunk(one, Key(10, 6), 0x600, true);
+	AppendChunk(two, Key(11, 2), 0x700, false);
+	write(folder / "dBAR-006-one.bin", one);
+	write(folder / "a" / "b" / "dBAR-002-two.BIN", two);
+	write(folder / "a" / "junk.bin", std::vector<BYTE>(5, 0));
+	write(folder / "a" / "notes.txt", one);
+
+	AccurateRipImportStats stats;
+	REQUIRE(AccurateRipCache::Instance().ImportFolder(folder, stats));
+	CHECK_EQ(stats.imported, 2);
+	CHECK_EQ(stats.rejected, 1);
+
+	std::vector<BYTE> found;
+	REQUIRE(AccurateRipCache::Instance().Find(Key(11, 2), found));
+	CHECK(found == two);
+	std::filesystem::remove_all(folder, ec);
+}
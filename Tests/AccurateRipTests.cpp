@@ -0,0 +1,215 @@
+﻿// ============================================================================
+// AccurateRipTests.cpp - AccurateRip CRC checks against a direct evaluation
+// ============================================================================
+#include "UnitTest.h"
+#include "../AccurateRip.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+	// Packed stereo samples (L | R << 16), deterministic per seed.
+	std::vector<uint32_t> RandomSamples(size_t count, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::vector<uint32_t> v(count);
+		for (auto& s : v) s = rng();
+		return v;
+	}
+
+	// V1 by definition: sum of multiplier * sample over the AccurateRip window,
+	// with the track starting `offset` samples after trackStart.
+	uint32_t DirectCRC(const std::vector<uint32_t>& s, size_t trackStart, size_t trackLength,
+		bool firstTrack, bool lastTrack, int offset) {
+		const size_t SKIP = 5 * 588;
+		uint32_t crc = 0;
+		for (size_t k = 1; k <= trackLength; k++) {
+			if (firstTrack && k < SKIP) continue;
+			if (lastTrack && k > trackLength - SKIP) continue;
+			ptrdiff_t i = static_cast<ptrdiff_t>(trackStart) + offset + static_cast<ptrdiff_t>(k) - 1;
+			uint32_t v = (i >= 0 && static_cast<size_t>(i) < s.size()) ? s[i] : 0;
+			crc += v * static_cast<uint32_t>(k);
+		}
+		return crc;
+	}
+
+	// V2 by definition over a whole span: low plus high half of each product.
+	uint32_t DirectCRCv2(const uint32_t* s, size_t trackLength, bool firstTrack, bool lastTrack) {
+		const size_t SKIP = 5 * 588;
+		uint32_t crc = 0;
+		for (size_t k = 1; k <= trackLength; k++) {
+			if (firstTrack && k < SKIP) continue;
+			if (lastTrack && k > trackLength - SKIP) continue;
+			uint64_t prod = static_cast<uint64_t>(s[k - 1]) * k;
+			crc += static_cast<uint32_t>(prod) + static_cast<uint32_t>(prod >> 32);
+		}
+		return crc;
+	}
+
+	// Three audio tracks of `sectors` sectors each, starting at LBA 0.
+	DiscInfo ThreeTrackDisc(DWORD sectors, int offset) {
+		DiscInfo disc;
+		for (int t = 0; t < 3; t++) {
+			TrackInfo track;
+			track.trackNumber = t + 1;
+			track.startLBA = t * sectors;
+			track.endLBA = (t + 1) * sectors - 1;
+			disc.tracks.push_back(track);
+		}
+		disc.leadOutLBA = 3 * sectors;
+		disc.driveOffset = offset;
+		return disc;
+	}
+
+	SectorSpan SpanOf(const std::vector<uint32_t>& s, size_t firstSample, size_t sectors) {
+		return { reinterpret_cast<const BYTE*>(s.data() + firstSample), sectors, AUDIO_SECTOR_SIZE };
+	}
+}
+
+TEST_CASE(SlidingCrcMatchesDirectSum) {
+	const size_t margin = 3000, length = 588 * 12;
+	auto s = RandomSamples(length + 2 * margin, 1);
+	const int minOffset = -40, maxOffset = 40;
+
+	for (int flags = 0; flags < 4; flags++) {
+		bool first = (flags & 1) != 0, last = (flags & 2) != 0;
+		std::vector<uint32_t> crcs;
+		AccurateRip::CalculateCRCForOffsets(s.data(), s.size(), margin, length,
+			first, last, minOffset, maxOffset, crcs);
+		REQUIRE(crcs.size() == static_cast<size_t>(maxOffset - minOffset + 1));
+		for (int o = minOffset; o <= maxOffset; o++)
+			CHECK_EQ(crcs[o - minOffset], DirectCRC(s, margin, length, first, last, o));
+	}
+}
+
+TEST_CASE(SlidingCrcTreatsOutsideAsSilence) {
+	// Offsets far past the buffer edges must read zeros, not wrap or fault.
+	const size_t length = 588 * 11;
+	auto s = RandomSamples(length, 2);
+	std::vector<uint32_t> crcs;
+	AccurateRip::CalculateCRCForOffsets(s.data(), s.size(), 0, length,
+		false, false, -700, 700, crcs);
+	REQUIRE(crcs.size() == 1401);
+	for (int o : { -700, -1, 0, 1, 699, 700 })
+		CHECK_EQ(crcs[o + 700], DirectCRC(s, 0, length, false, false, o));
+}
+
+TEST_CASE(SlidingCrcAgreesWithSectorCrc) {
+	// Offset 0 must reproduce the sector-based CRC used for verification,
+	// including the first/last track skips.
+	const size_t margin = 588, sectors = 14;
+	auto s = RandomSamples(sectors * 588 + 2 * margin, 3);
+	SectorSpan track = SpanOf(s, margin, sectors);
+
+	for (int flags = 0; flags < 4; flags++) {
+		bool first = (flags & 1) != 0, last = (flags & 2) != 0;
+		int trackNum = first ? 1 : 2, totalTracks = last ? trackNum : 3;
+		std::vector<uint32_t> crcs;
+		AccurateRip::CalculateCRCForOffsets(s.data(), s.size(), margin, sectors * 588,
+			first, last, 0, 0, crcs);
+		REQUIRE(crcs.size() == 1);
+		CHECK_EQ(crcs[0], AccurateRip::CalculateCRC(track, trackNum, totalTracks, 0));
+	}
+}
+
+TEST_CASE(ShiftedTrackFoundAtItsOffset) {
+	// A drive reading k samples early delivers the track k samples late in the
+	// buffer; the CRC at offset +k must equal the CRC of the original track.
+	const size_t margin = 1200, sectors = 10, length = sectors * 588;
+	auto original = RandomSamples(length, 4);
+	std::vector<uint32_t> reference;
+	std::vector<uint32_t> zeros(length + 2 * margin, 0);
+	std::copy(original.begin(), original.end(), zeros.begin() + margin);
+	AccurateRip::CalculateCRCForOffsets(zeros.data(), zeros.size(), margin, length,
+		false, false, 0, 0, reference);
+
+	for (int k : { -667, -6, 0, 48, 667 }) {
+		std::vector<uint32_t> shifted(length + 2 * margin, 0);
+		std::copy(original.begin(), original.end(), shifted.begin() + margin + k);
+		std::vector<uint32_t> crcs;
+		AccurateRip::CalculateCRCForOffsets(shifted.data(), shifted.size(), margin, length,
+			false, false, -1000, 1000, crcs);
+		REQUIRE(crcs.size() == 2001);
+		CHECK_EQ(crcs[k + 1000], reference[0]);
+		int hits = 0;
+		for (uint32_t c : crcs) hits += (c == reference[0]);
+		CHECK_EQ(hits, 1);
+	}
+}
+
+TEST_CASE(CrcOfKnownConstantTrack) {
+	// Every sample 0xFFFFFFFF in a middle track of N samples:
+	//   V1 = sum -k       = -N(N+1)/2  (mod 2^32)
+	//   V2 = sum (-k + k - 1) = -N     (mod 2^32)
+	const size_t sectors = 8, n = sectors * 588;
+	std::vector<uint32_t> s(n, 0xFFFFFFFFu);
+	uint32_t v2 = 0;
+	uint32_t v1 = AccurateRip::CalculateCRC(SpanOf(s, 0, sectors), 2, 3, &v2);
+	CHECK_EQ(v1, static_cast<uint32_t>(0u - static_cast<uint32_t>(n * (n + 1) / 2)));
+	CHECK_EQ(v2, static_cast<uint32_t>(0u - static_cast<uint32_t>(n)));
+
+	// Ascending samples 1, 2, 3 ... give V1 = sum k^2 = N(N+1)(2N+1)/6.
+	for (size_t k = 0; k < n; k++) s[k] = static_cast<uint32_t>(k + 1);
+	v1 = AccurateRip::CalculateCRC(SpanOf(s, 0, sectors), 2, 3, &v2);
+	CHECK_EQ(v1, static_cast<uint32_t>(static_cast<uint64_t>(n) * (n + 1) * (2 * n + 1) / 6));
+	CHECK_EQ(v2, v1);   // No product reaches 2^32, so the high halves are zero
+}
+
+TEST_CASE(CrcV2MatchesDirectSum) {
+	const size_t sectors = 12;
+	auto s = RandomSamples(sectors * 588, 5);
+	for (int flags = 0; flags < 4; flags++) {
+		bool first = (flags & 1) != 0, last = (flags & 2) != 0;
+		uint32_t v2 = 0;
+		AccurateRip::CalculateCRC(SpanOf(s, 0, sectors), first ? 1 : 2, last ? (first ? 1 : 2) : 3, &v2);
+		CHECK_EQ(v2, DirectCRCv2(s.data(), sectors * 588, first, last));
+	}
+}
+
+TEST_CASE(StreamMatchesWholeTrackCrc) {
+	// Sectors arrive in any order, some are re-read and replaced, and the
+	// drive offset shifts every sample across sector and track boundaries.
+	const DWORD sectors = 12;
+	for (int offset : { 0, 6, -667, 1200 }) {
+		DiscInfo disc = ThreeTrackDisc(sectors, offset);
+		const size_t total = 3 * sectors;
+
+		// Raw sectors cover the corrected disc plus the offset on either side.
+		// Those before LBA 0 only feed the first track's skipped edge, so the
+		// stream is given LBA 0 onwards.
+		const size_t pad = 3;
+		auto raw = RandomSamples((total + 2 * pad) * 588, 6 + offset);
+		auto rawSector = [&](ptrdiff_t lba) { return reinterpret_cast<const BYTE*>(raw.data() + (lba + pad) * 588); };
+
+		AccurateRipStream stream;
+		stream.Begin(disc);
+		std::vector<ptrdiff_t> order;
+		for (ptrdiff_t lba = 0; lba < static_cast<ptrdiff_t>(total + pad); lba++) order.push_back(lba);
+		std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+		auto junk = RandomSamples(588, 8);
+		const BYTE* bad = reinterpret_cast<const BYTE*>(junk.data());
+		for (ptrdiff_t lba : order) {
+			// A failed first read, retracted when the re-read replaces it.
+			if (lba % 5 == 0) {
+				stream.AddSector(static_cast<DWORD>(lba), bad);
+				stream.RemoveSector(static_cast<DWORD>(lba), bad);
+			}
+			stream.AddSector(static_cast<DWORD>(lba), rawSector(lba));
+		}
+
+		// Corrected sample P is raw sample P + offset.
+		std::vector<uint32_t> corrected(total * 588);
+		for (size_t p = 0; p < corrected.size(); p++)
+			corrected[p] = raw[p + pad * 588 + offset];
+
+		const auto& results = stream.Results();
+		REQUIRE(results.size() == 3);
+		for (int t = 0; t < 3; t++) {
+			uint32_t v2 = 0;
+			uint32_t v1 = AccurateRip::CalculateCRC(SpanOf(corrected, t * sectors * 588, sectors), t + 1, 3, &v2);
+			CHECK(results[t].IsComplete());
+			CHECK_EQ(results[t].readOffset, offset);
+			CHECK_EQ(results[t].crcV1, v1);
+			CHECK_EQ(results[t].crcV2, v2);
+		}
+	}
+}
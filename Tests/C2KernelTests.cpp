@@ -0,0 +1,61 @@
+﻿// ============================================================================
+// C2KernelTests.cpp - C2 pointer counting against bit-by-bit references
+// ============================================================================
+#include "UnitTest.h"
+#include "../C2Kernel.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	int ReferenceBits(const unsigned char* data, size_t size) {
+		int count = 0;
+		for (size_t i = 0; i < size; i++) {
+			for (int b = 0; b < 8; b++) count += (data[i] >> b) & 1;
+		}
+		return count;
+	}
+
+	int ReferenceBytes(const unsigned char* data, size_t size) {
+		int count = 0;
+		for (size_t i = 0; i < size; i++) count += (data[i] != 0x00 && data[i] != 0xFF);
+		return count;
+	}
+}
+
+TEST_CASE(C2CountsMatchReferenceForEveryLength) {
+	std::mt19937 rng(23);
+	std::vector<unsigned char> block(296 + 1);
+
+	// Offsets and lengths around the 8- and 16-byte vector steps, up to a
+	// full 294-byte pointer block and the 296-byte error block.
+	for (size_t offset : { 0u, 1u }) {
+		for (size_t size = 0; size <= 296; size++) {
+			for (auto& b : block) b = static_cast<unsigned char>(rng());
+			const unsigned char* data = block.data() + offset;
+			CHECK_EQ(C2Kernel::CountBits(data, size), ReferenceBits(data, size));
+			CHECK_EQ(C2Kernel::CountBytes(data, size), ReferenceBytes(data, size));
+		}
+	}
+}
+
+TEST_CASE(C2CountsHandleFillerAndSparseBlocks) {
+	std::vector<unsigned char> block(294, 0x00);
+	CHECK_EQ(C2Kernel::CountBits(block.data(), block.size()), 0);
+	CHECK_EQ(C2Kernel::CountBytes(block.data(), block.size()), 0);
+
+	// 0xFF filler: every bit set, but no PlexTools-style error bytes.
+	std::fill(block.begin(), block.end(), 0xFF);
+	CHECK_EQ(C2Kernel::CountBits(block.data(), block.size()), 294 * 8);
+	CHECK_EQ(C2Kernel::CountBytes(block.data(), block.size()), 0);
+
+	std::fill(block.begin(), block.end(), 0x00);
+	block[0] = 0x80;
+	block[150] = 0x7F;
+	block[293] = 0x01;
+	CHECK_EQ(C2Kernel::CountBits(block.data(), block.size()), 1 + 7 + 1);
+	CHECK_EQ(C2Kernel::CountBytes(block.data(), block.size()), 3);
+
+	std::string name = C2Kernel::Name();
+	CHECK(!name.empty());
+}
@@ -0,0 +1,56 @@
+﻿// ============================================================================
+// Crc32Tests.cpp - CRC-32 against known values and a bitwise reference
+// ============================================================================
+#include "UnitTest.h"
+#include "../Crc32.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+	uint32_t BitwiseCrc32(const unsigned char* data, size_t length) {
+		uint32_t crc = 0xFFFFFFFFu;
+		for (size_t i = 0; i < length; i++) {
+			crc ^= data[i];
+			for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+		}
+		return ~crc;
+	}
+}
+
+TEST_CASE(Crc32KnownValues) {
+	CHECK_EQ(Crc32::Compute("", 0), 0x00000000u);
+	CHECK_EQ(Crc32::Compute("a", 1), 0xE8B7BE43u);
+	CHECK_EQ(Crc32::Compute("123456789", 9), 0xCBF43926u);
+	const char* fox = "The quick brown fox jumps over the lazy dog";
+	CHECK_EQ(Crc32::Compute(fox, strlen(fox)), 0x414FA339u);
+}
+
+TEST_CASE(Crc32MatchesBitwiseAtEveryLengthAndAlignment) {
+	// Long enough to reach the 64-byte folding path several times over,
+	// with every small tail and start alignment.
+	std::mt19937 rng(21);
+	std::vector<unsigned char> data(4096 + 64);
+	for (auto& b : data) b = static_cast<unsigned char>(rng());
+
+	for (size_t align = 0; align < 16; align++) {
+		for (size_t length : { 0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 255, 256, 1000, 2352, 4096 })
+			CHECK_EQ(Crc32::Compute(data.data() + align, length), BitwiseCrc32(data.data() + align, length));
+	}
+	for (size_t length = 0; length <= 300; length++)
+		CHECK_EQ(Crc32::Compute(data.data() + 3, length), BitwiseCrc32(data.data() + 3, length));
+	CHECK(Crc32::Name() != nullptr);
+}
+
+TEST_CASE(Crc32ChainsAcrossChunks) {
+	std::mt19937 rng(22);
+	std::vector<unsigned char> data(2352 * 10);
+	for (auto& b : data) b = static_cast<unsigned char>(rng());
+
+	uint32_t whole = Crc32::Compute(data.data(), data.size());
+	for (size_t split : { 1, 7, 64, 1000, 2352, 20000 }) {
+		uint32_t crc = Crc32::Update(0, data.data(), split);
+		crc = Crc32::Update(crc, data.data() + split, data.size() - split);
+		CHECK_EQ(crc, whole);
+	}
+}
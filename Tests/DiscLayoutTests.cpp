@@ -0,0 +1,100 @@
+﻿// ============================================================================
+// DiscLayoutTests.cpp - Scan / rip spans, linear positions and range queries
+// ============================================================================
+#include "UnitTest.h"
+#include "../DiscLayout.h"
+
+namespace {
+	TrackInfo Track(int number, DWORD pregap, DWORD start, DWORD end, bool audio = true, int session = 1) {
+		TrackInfo t;
+		t.trackNumber = number;
+		t.pregapLBA = pregap;
+		t.startLBA = start;
+		t.endLBA = end;
+		t.isAudio = audio;
+		t.session = session;
+		return t;
+	}
+
+	// Three audio tracks with a gap before the third, then a data track in
+	// a second session.
+	DiscInfo TestDisc() {
+		DiscInfo disc;
+		disc.tracks.push_back(Track(1, 0, 150, 999));
+		disc.tracks.push_back(Track(2, 1000, 1150, 1999));
+		disc.tracks.push_back(Track(3, 3000, 3150, 3999));
+		disc.tracks.push_back(Track(4, 10000, 10150, 19999, false, 2));
+		return disc;
+	}
+}
+
+TEST_CASE(ScanLayoutCoversAudioFromPregaps) {
+	DiscLayout layout = DiscLayout::ForScan(TestDisc());
+	REQUIRE(layout.Spans().size() == 3);
+	CHECK_EQ(layout.FirstLBA(), 0u);
+	CHECK_EQ(layout.LastLBA(), 3999u);
+	CHECK_EQ(layout.TotalSectors(), 3000u);
+	CHECK_EQ(layout.TotalSeconds(), 40u);
+
+	CHECK_EQ(layout.TrackAt(0), 1);
+	CHECK_EQ(layout.TrackAt(1000), 2);
+	CHECK_EQ(layout.TrackAt(2500), 0);
+	CHECK_EQ(layout.TrackAt(10500), 0);
+	CHECK_EQ(layout.IndexAt(1000), 0);
+	CHECK_EQ(layout.IndexAt(1150), 1);
+	CHECK_EQ(layout.IndexAt(2500), -1);
+}
+
+TEST_CASE(LinearAndLBAAtAreInverse) {
+	DiscLayout layout = DiscLayout::ForScan(TestDisc());
+	CHECK_EQ(layout.Linear(0), 0u);
+	CHECK_EQ(layout.Linear(1999), 1999u);
+	CHECK_EQ(layout.Linear(2500), DiscLayout::NOT_COVERED);
+	CHECK_EQ(layout.Linear(3000), 2000u);     // The gap takes no positions
+	CHECK_EQ(layout.Linear(3999), 2999u);
+
+	for (DWORD linear = 0; linear < layout.TotalSectors(); linear++) {
+		CHECK_EQ(layout.Linear(layout.LBAAt(linear)), linear);
+	}
+	CHECK_EQ(layout.LBAAt(5000), 3999u);      // Past the end clamps
+
+	CHECK_EQ(layout.SecondOf(3000), 2000u / 75);
+	CHECK_EQ(layout.SecondStartLBA(27), 3025u);
+	CHECK_EQ(layout.SecondOf(2500), DiscLayout::NOT_COVERED);
+}
+
+TEST_CASE(SpansInFindsIntersectingSpans) {
+	DiscLayout layout = DiscLayout::ForScan(TestDisc());
+	using Range = std::pair<size_t, size_t>;
+	CHECK(layout.SpansIn(0, 0) == Range(0, 1));
+	CHECK(layout.SpansIn(999, 1000) == Range(0, 2));
+	CHECK(layout.SpansIn(900, 3000) == Range(0, 3));
+	CHECK(layout.SpansIn(1500, 3500) == Range(1, 3));
+	auto gap = layout.SpansIn(2500, 2600);
+	CHECK_EQ(gap.first, gap.second);
+	auto after = layout.SpansIn(4000, 5000);
+	CHECK_EQ(after.first, 3u);
+	CHECK_EQ(after.second, 3u);
+}
+
+TEST_CASE(RipLayoutFollowsSessionAndPregapMode) {
+	DiscInfo disc = TestDisc();
+	DiscLayout all = DiscLayout::ForRip(disc);
+	REQUIRE(all.Spans().size() == 4);
+	CHECK_EQ(all.Spans()[0].firstLBA, 0u);
+	CHECK(!all.Spans()[3].isAudio);
+	CHECK_EQ(all.TotalSectors(), 3000u + 10000u);
+
+	disc.pregapMode = PregapMode::Skip;
+	DiscLayout skip = DiscLayout::ForRip(disc);
+	CHECK_EQ(skip.Spans()[0].firstLBA, 150u);
+	CHECK_EQ(skip.Spans()[1].firstLBA, 1150u);
+	CHECK_EQ(skip.TrackAt(1000), 0);
+
+	disc.selectedSession = 2;
+	DiscLayout second = DiscLayout::ForRip(disc);
+	REQUIRE(second.Spans().size() == 1);
+	CHECK_EQ(second.Spans()[0].trackNumber, 4);
+	CHECK_EQ(second.FirstLBA(), 10150u);
+	CHECK_EQ(second.Linear(10150), 0u);
+}
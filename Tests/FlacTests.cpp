@@ -0,0 +1,118 @@
+﻿// ============================================================================
+// FlacTests.cpp - FlacEncoder / FlacDecoder round trips on synthetic audio
+// ============================================================================
+#include "UnitTest.h"
+#include "../FlacDecoder.h"
+#include "../FlacEncoder.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace {
+	std::wstring TempFlacPath(const wchar_t* name) {
+		return (std::filesystem::temp_directory_path() / name).wstring();
+	}
+
+	void PutSample(std::vector<uint8_t>& pcm, size_t frame, int channel, int value) {
+		int16_t v = static_cast<int16_t>(std::max(-32768, std::min(32767, value)));
+		memcpy(pcm.data() + frame * 4 + channel * 2, &v, sizeof(v));
+	}
+
+	// Music-like stereo: two tones, correlated channels, a little noise.
+	std::vector<uint8_t> Tones(size_t frames, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::normal_distribution<double> noise(0.0, 8.0);
+		std::vector<uint8_t> pcm(frames * 4);
+		for (size_t i = 0; i < frames; i++) {
+			double t = static_cast<double>(i) / 44100.0;
+			double mid = 9000.0 * std::sin(2 * 3.14159265358979 * 440.0 * t) +
+				4000.0 * std::sin(2 * 3.14159265358979 * 1234.5 * t);
+			double side = 1500.0 * std::sin(2 * 3.14159265358979 * 97.0 * t);
+			PutSample(pcm, i, 0, static_cast<int>(mid + side + noise(rng)));
+			PutSample(pcm, i, 1, static_cast<int>(mid - side + noise(rng)));
+		}
+		return pcm;
+	}
+
+	bool RoundTrip(const std::vector<uint8_t>& pcm, const wchar_t* name, uintmax_t* fileSize = nullptr) {
+		const std::wstring path = TempFlacPath(name);
+		FlacTags tags;
+		tags.Add("TITLE", "Round trip");
+		if (!FlacEncoder::EncodeFile(path, pcm.data(), pcm.size(), tags)) return false;
+		if (fileSize) *fileSize = std::filesystem::file_size(path);
+
+		FlacDecoder decoder;
+		std::string error;
+		bool ok = decoder.Open(path, error) && decoder.PcmBytes() == pcm.size();
+		std::vector<uint8_t> decoded(pcm.size());
+		ok = ok && decoder.DecodeTo(decoded.data(), error) && decoded == pcm;
+		std::filesystem::remove(path);
+		return ok;
+	}
+}
+
+TEST_CASE(FlacRoundTripsTonesBitExactly) {
+	uintmax_t size = 0;
+	auto pcm = Tones(44100 * 2 + 1234, 1);
+	CHECK(RoundTrip(pcm, L"roundtrip_tones.flac", &size));
+	CHECK(size < pcm.size() / 2);
+}
+
+TEST_CASE(FlacRoundTripsBlockEdges) {
+	// Whole blocks, one sample either side, and streams shorter than the
+	// LPC order.
+	for (size_t frames : { 1u, 5u, 13u, 4095u, 4096u, 4097u, 8192u }) {
+		CHECK(RoundTrip(Tones(frames, static_cast<uint32_t>(frames)), L"roundtrip_edge.flac"));
+	}
+}
+
+TEST_CASE(FlacRoundTripsSilenceNoiseAndFullScale) {
+	CHECK(RoundTrip(std::vector<uint8_t>(4 * 10000, 0), L"roundtrip_silence.flac"));
+
+	std::mt19937 rng(7);
+	std::vector<uint8_t> noise(4 * 10000);
+	for (auto& b : noise) b = static_cast<uint8_t>(rng());
+	CHECK(RoundTrip(noise, L"roundtrip_noise.flac"));
+
+	// Alternating full-scale extremes: the widest side channel there is.
+	std::vector<uint8_t> extremes(4 * 5000);
+	for (size_t i = 0; i < 5000; i++) {
+		PutSample(extremes, i, 0, (i & 1) ? 32767 : -32768);
+		PutSample(extremes, i, 1, (i & 1) ? -32768 : 32767);
+	}
+	CHECK(RoundTrip(extremes, L"roundtrip_extremes.flac"));
+}
+
+TEST_CASE(FlacDecoderRejectsCorruption) {
+	auto pcm = Tones(20000, 3);
+	const std::wstring path = TempFlacPath(L"roundtrip_corrupt.flac");
+	REQUIRE(FlacEncoder::EncodeFile(path, pcm.data(), pcm.size(), FlacTags{}));
+
+	std::vector<char> bytes(std::filesystem::file_size(path));
+	{
+		std::ifstream in(std::filesystem::path(path), std::ios::binary);
+		in.read(bytes.data(), bytes.size());
+	}
+	auto decodeWith = [&](const std::vector<char>& file) {
+		{
+			std::ofstream out(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+			out.write(file.data(), file.size());
+		}
+		FlacDecoder decoder;
+		std::string error;
+		std::vector<uint8_t> decoded(pcm.size());
+		return decoder.Open(path, error) && decoder.DecodeTo(decoded.data(), error);
+	};
+
+	CHECK(decodeWith(bytes));
+	auto flipped = bytes;
+	flipped[flipped.size() - 5000] ^= 0x10;
+	CHECK(!decodeWith(flipped));
+	auto truncated = bytes;
+	truncated.resize(truncated.size() - 100);
+	CHECK(!decodeWith(truncated));
+	std::filesystem::remove(path);
+}
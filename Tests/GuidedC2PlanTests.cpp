@@ -0,0 +1,102 @@
+﻿// ============================================================================
+// GuidedC2PlanTests.cpp - Seconds the disc rot C2 phase reads from a C1 map
+// ============================================================================
+#include "UnitTest.h"
+#include "../GuidedC2Plan.h"
+#include <numeric>
+
+namespace {
+	constexpr DWORD SECONDS = 100;
+
+	// One audio track of SECONDS seconds from LBA 0.
+	DiscLayout TestLayout() {
+		DiscInfo disc;
+		TrackInfo t;
+		t.trackNumber = 1;
+		t.pregapLBA = 0;
+		t.startLBA = 150;
+		t.endLBA = SECONDS * 75 - 1;
+		t.isAudio = true;
+		t.session = 1;
+		disc.tracks.push_back(t);
+		return DiscLayout::ForScan(disc);
+	}
+
+	// A C1 map with one sample per second ending at that second's last LBA.
+	QCheckResult CleanMap(int c1) {
+		QCheckResult result;
+		for (DWORD sec = 0; sec < SECONDS; sec++) {
+			QCheckSample s;
+			s.lba = (sec + 1) * 75 - 1;
+			s.c1 = c1;
+			result.samples.push_back(s);
+		}
+		return result;
+	}
+
+	// Every second is either read or stood in for by a baseline.
+	int TotalWeight(const std::vector<int>& plan) {
+		return std::accumulate(plan.begin(), plan.end(), 0);
+	}
+}
+
+TEST_CASE(NoMapMeansFullRead) {
+	CHECK(PlanGuidedC2(QCheckResult{}, TestLayout()).empty());
+}
+
+TEST_CASE(CleanMapReadsOneBaselinePerGroup) {
+	std::vector<int> plan = PlanGuidedC2(CleanMap(5), TestLayout());
+	REQUIRE(plan.size() == SECONDS);
+	for (DWORD sec = 0; sec < SECONDS; sec++)
+		CHECK_EQ(plan[sec], sec % ROT_BASELINE_STRIDE == 0 ? 10 : 0);
+	CHECK_EQ(TotalWeight(plan), static_cast<int>(SECONDS));
+}
+
+TEST_CASE(HotAndFlaggedSecondsAreReadWithNeighbours) {
+	QCheckResult map = CleanMap(5);
+	map.samples[45].c1 = 500;
+	map.samples[72].cu = 1;
+	std::vector<int> plan = PlanGuidedC2(map, TestLayout());
+	REQUIRE(plan.size() == SECONDS);
+	for (DWORD sec : { 44, 45, 46, 71, 72, 73 })
+		CHECK_EQ(plan[sec], 1);
+	CHECK_EQ(plan[43], 0);
+	CHECK_EQ(plan[47], 0);
+	CHECK_EQ(plan[40], 7);
+	CHECK_EQ(plan[70], 7);
+	CHECK_EQ(TotalWeight(plan), static_cast<int>(SECONDS));
+}
+
+TEST_CASE(HotThresholdFollowsTheMedian) {
+	// 4 x median = 400, so 300 C1/sec is ordinary on this disc.
+	QCheckResult map = CleanMap(100);
+	map.samples[45].c1 = 300;
+	std::vector<int> plan = PlanGuidedC2(map, TestLayout());
+	REQUIRE(plan.size() == SECONDS);
+	CHECK_EQ(plan[45], 0);
+	CHECK_EQ(plan[40], 10);
+}
+
+TEST_CASE(UnplacedSecondsAreRead) {
+	// No startup samples for seconds 0-2, and a gap too wide to place
+	// (seconds 20-30 arrive as one 11-second slice).
+	QCheckResult map = CleanMap(5);
+	map.samples.erase(map.samples.begin() + 20, map.samples.begin() + 30);
+	map.samples.erase(map.samples.begin(), map.samples.begin() + 3);
+	std::vector<int> plan = PlanGuidedC2(map, TestLayout());
+	REQUIRE(plan.size() == SECONDS);
+	for (DWORD sec = 0; sec < 3; sec++)
+		CHECK_EQ(plan[sec], 1);
+	for (DWORD sec = 20; sec <= 30; sec++)
+		CHECK_EQ(plan[sec], 1);
+	CHECK_EQ(plan[3], 7);
+	CHECK_EQ(plan[31], 9);
+	CHECK_EQ(TotalWeight(plan), static_cast<int>(SECONDS));
+}
+
+TEST_CASE(BusyPlanFallsBackToFullRead) {
+	QCheckResult map = CleanMap(5);
+	for (DWORD sec = 0; sec < SECONDS; sec += 3)
+		map.samples[sec].c1 = 500;
+	CHECK(PlanGuidedC2(map, TestLayout()).empty());
+}
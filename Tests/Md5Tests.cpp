@@ -0,0 +1,62 @@
+﻿// ============================================================================
+// Md5Tests.cpp - MD5 against the RFC 1321 test suite
+// ============================================================================
+#include "UnitTest.h"
+#include "../Md5.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace {
+	std::string Hex(const uint8_t digest[16]) {
+		char text[33];
+		for (int i = 0; i < 16; i++) snprintf(text + 2 * i, 3, "%02x", digest[i]);
+		return text;
+	}
+
+	std::string Digest(const std::string& message) {
+		Md5 md5;
+		md5.Update(message.data(), message.size());
+		uint8_t digest[16];
+		md5.Final(digest);
+		return Hex(digest);
+	}
+}
+
+TEST_CASE(Md5MatchesRfc1321Suite) {
+	CHECK_EQ(Digest(""), "d41d8cd98f00b204e9800998ecf8427e");
+	CHECK_EQ(Digest("a"), "0cc175b9c0f1b6a831c399e269772661");
+	CHECK_EQ(Digest("abc"), "900150983cd24fb0d6963f7d28e17f72");
+	CHECK_EQ(Digest("message digest"), "f96b697d7cb7938d525a2f31aaf161d0");
+	CHECK_EQ(Digest("abcdefghijklmnopqrstuvwxyz"), "c3fcd3d76192e4007dfb496cca67e13b");
+	CHECK_EQ(Digest("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"),
+		"d174ab98d277d9f5a5611c2c9f419d9f");
+	CHECK_EQ(Digest("12345678901234567890123456789012345678901234567890123456789012345678901234567890"),
+		"57edf4a22be3c955ac49da2e2107b67a");
+}
+
+TEST_CASE(Md5SplitUpdatesMatchOneShot) {
+	std::string message;
+	for (int i = 0; i < 1000; i++) message += static_cast<char>(i * 31 + 7);
+	const std::string whole = Digest(message);
+
+	// Split points either side of the 64-byte block and 56-byte padding edges.
+	for (size_t split : { 1u, 55u, 56u, 63u, 64u, 65u, 128u, 999u }) {
+		Md5 md5;
+		md5.Update(message.data(), split);
+		md5.Update(message.data() + split, message.size() - split);
+		uint8_t digest[16];
+		md5.Final(digest);
+		CHECK_EQ(Hex(digest), whole);
+	}
+
+	// Final leaves the object ready for Reset and reuse.
+	Md5 md5;
+	md5.Update("abc", 3);
+	uint8_t digest[16];
+	md5.Final(digest);
+	md5.Reset();
+	md5.Update("abc", 3);
+	md5.Final(digest);
+	CHECK_EQ(Hex(digest), "900150983cd24fb0d6963f7d28e17f72");
+}
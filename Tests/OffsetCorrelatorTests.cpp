@@ -0,0 +1,89 @@
+﻿// ============================================================================
+// OffsetCorrelatorTests.cpp - FFT offset detection on synthetic PCM
+// ============================================================================
+#include "UnitTest.h"
+#include "../OffsetCorrelator.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+	// Music-like stereo: a few drifting tones plus noise, packed L | R << 16.
+	std::vector<uint32_t> SyntheticAudio(size_t samples, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::normal_distribution<double> noise(0.0, 600.0);
+		std::vector<uint32_t> v(samples);
+		for (size_t i = 0; i < samples; i++) {
+			double t = static_cast<double>(i) / 44100.0;
+			double l = 6000 * sin(2 * 3.14159265 * 220 * t) + 3000 * sin(2 * 3.14159265 * 331.7 * t * (1 + 0.01 * t)) + noise(rng);
+			double r = 5000 * sin(2 * 3.14159265 * 147 * t + 1) + 2500 * sin(2 * 3.14159265 * 523.3 * t) + noise(rng);
+			auto pcm = [](double x) { return static_cast<uint16_t>(static_cast<int16_t>(std::max(-32768.0, std::min(32767.0, x)))); };
+			v[i] = pcm(l) | (static_cast<uint32_t>(pcm(r)) << 16);
+		}
+		return v;
+	}
+
+	SectorSpan Span(const std::vector<uint32_t>& v, size_t firstSample, size_t sectors) {
+		return { reinterpret_cast<const BYTE*>(v.data() + firstSample), sectors, AUDIO_SECTOR_SIZE };
+	}
+}
+
+TEST_CASE(CorrelatorFindsSyntheticShifts) {
+	const int radius = OffsetCorrelator::ONE_SECOND_SAMPLES;
+	const size_t lead = (radius + 587) / 588;         // Padding sectors on each side
+	const size_t windowSectors = 32;
+	auto disc = SyntheticAudio((2 * lead + windowSectors) * 588 + 2 * radius + 4 * 588, 41);
+	const size_t base = lead * 588 + radius + 588;    // Original window start in `disc`
+	SectorSpan orig = Span(disc, base, windowSectors);
+
+	for (int offset : { 0, 1, -1, 6, -48, 667, -1200, 10000, -30000, radius, -radius }) {
+		// copy[lead * 588 + i + offset] == orig[i]
+		std::vector<uint32_t> copy((2 * lead + windowSectors) * 588, 0);
+		for (size_t j = 0; j < copy.size(); j++) {
+			ptrdiff_t src = static_cast<ptrdiff_t>(base) - static_cast<ptrdiff_t>(lead * 588) + static_cast<ptrdiff_t>(j) - offset;
+			if (src >= 0 && static_cast<size_t>(src) < disc.size()) copy[j] = disc[src];
+		}
+		OffsetEstimate e = OffsetCorrelator::Estimate(orig, Span(copy, 0, 2 * lead + windowSectors), lead, radius);
+		CHECK(e.found);
+		CHECK_EQ(e.offset, offset);
+		CHECK(e.peakRatio > 1.0);
+		CHECK(e.meanSquaredError == 0.0);
+	}
+}
+
+TEST_CASE(CorrelatorRejectsUnrelatedAudio) {
+	auto a = SyntheticAudio(40 * 588, 42);
+	std::mt19937 rng(43);
+	std::vector<uint32_t> b(40 * 588);
+	for (auto& s : b) s = rng();
+	OffsetEstimate e = OffsetCorrelator::Estimate(Span(a, 4 * 588, 32), Span(b, 0, 40), 4, 2000);
+	CHECK(!e.found);
+}
+
+TEST_CASE(CombineTakesMajorityAndFlagsDisagreement) {
+	auto est = [](bool found, int offset, double ratio) {
+		OffsetEstimate e;
+		e.found = found;
+		e.offset = offset;
+		e.peakRatio = ratio;
+		return e;
+	};
+
+	SampleOffsetResult r = OffsetCorrelator::Combine({ est(true, 667, 5.0), est(true, 667, 3.0),
+		est(false, 0, 0.0), est(true, 12, 9.0), est(true, 667, 4.0) });
+	CHECK(r.found);
+	CHECK_EQ(r.offset, 667);
+	CHECK_EQ(r.windowsAgreeing, 3);
+	CHECK_EQ(r.windowsUsable, 4);
+	CHECK_EQ(r.windowsTotal, 5);
+	CHECK(!r.consistent);
+	CHECK(r.peakRatio == 3.0);
+
+	r = OffsetCorrelator::Combine({ est(true, -6, 2.0), est(true, -6, 2.5) });
+	CHECK(r.found);
+	CHECK_EQ(r.offset, -6);
+	CHECK(r.consistent);
+
+	r = OffsetCorrelator::Combine({ est(false, 0, 0.0) });
+	CHECK(!r.found);
+}
@@ -0,0 +1,111 @@
+﻿// ============================================================================
+// ReReadSchedulerTests.cpp - Run grouping, elevator order and cache defeats
+// ============================================================================
+#include "UnitTest.h"
+#include "../ReReadScheduler.h"
+
+namespace {
+	std::vector<DWORD> Firsts(const std::vector<ReReadRun*>& order) {
+		std::vector<DWORD> firsts;
+		for (const auto* run : order) firsts.push_back(run->first);
+		return firsts;
+	}
+}
+
+TEST_CASE(NearbyLbasShareARun) {
+	ReReadScheduler scheduler(750);
+	scheduler.Rebuild({ 120, 100, 116, 100, 137, 500 });
+	CHECK_EQ(scheduler.RunCount(), 3u);
+
+	auto order = scheduler.NextSweep(0);
+	REQUIRE(order.size() == 3);
+	CHECK_EQ(order[0]->first, 100u);
+	CHECK_EQ(order[0]->last, 120u);
+	CHECK(order[0]->lbas == std::vector<DWORD>({ 100, 116, 120 }));
+	CHECK_EQ(order[1]->first, 137u);    // 17 past 120: one beyond the gap
+	CHECK_EQ(order[2]->first, 500u);
+}
+
+TEST_CASE(MaxRunLengthSplitsRuns) {
+	ReReadScheduler scheduler(750, 4);
+	std::vector<DWORD> lbas;
+	for (DWORD lba = 0; lba < 10; lba++) lbas.push_back(lba);
+	scheduler.Rebuild(lbas);
+	CHECK_EQ(scheduler.RunCount(), 3u);
+	CHECK(Firsts(scheduler.NextSweep(0)) == std::vector<DWORD>({ 0, 4, 8 }));
+}
+
+TEST_CASE(SweepsFollowElevatorOrder) {
+	ReReadScheduler scheduler(750);
+	scheduler.Rebuild({ 100, 200, 300, 400 });
+
+	// Up from the head first, then back down past it.
+	CHECK(Firsts(scheduler.NextSweep(250)) == std::vector<DWORD>({ 300, 400, 200, 100 }));
+	// That sweep ended heading down, so the next continues down first.
+	CHECK(Firsts(scheduler.NextSweep(250)) == std::vector<DWORD>({ 200, 100, 300, 400 }));
+	// Nothing below the head: turn round and keep ascending.
+	CHECK(Firsts(scheduler.NextSweep(50)) == std::vector<DWORD>({ 100, 200, 300, 400 }));
+	CHECK(Firsts(scheduler.NextSweep(50)) == std::vector<DWORD>({ 100, 200, 300, 400 }));
+}
+
+TEST_CASE(DefeatOnlyWhileRunMayBeCached) {
+	ReReadScheduler scheduler(750);
+	scheduler.Rebuild({ 1000 });
+	ReReadRun& run = *scheduler.NextSweep(0)[0];
+	CHECK(!scheduler.NeedsCacheDefeat(run));    // Never read
+
+	scheduler.BeginRun(run);
+	scheduler.NoteRead(1);
+	CHECK(scheduler.NeedsCacheDefeat(run));
+
+	scheduler.NoteCacheDefeat();
+	CHECK(!scheduler.NeedsCacheDefeat(run));
+
+	scheduler.BeginRun(run);
+	scheduler.NoteRead(1);
+	scheduler.NoteRead(749);
+	CHECK(!scheduler.NeedsCacheDefeat(run));    // A cache's worth read since
+}
+
+TEST_CASE(FarVisitEvictsRun) {
+	ReReadScheduler scheduler(750);
+	scheduler.Rebuild({ 1000, 1400, 5000 });
+	auto order = scheduler.NextSweep(0);
+	REQUIRE(order.size() == 3);
+
+	scheduler.BeginRun(*order[0]);
+	scheduler.NoteRead(1);
+	scheduler.BeginRun(*order[1]);          // 400 sectors away: still cached
+	scheduler.NoteRead(1);
+	CHECK(scheduler.NeedsCacheDefeat(*order[0]));
+
+	scheduler.BeginRun(*order[2]);          // 4000 sectors away
+	scheduler.NoteRead(1);
+	CHECK(!scheduler.NeedsCacheDefeat(*order[0]));
+	CHECK(scheduler.NeedsCacheDefeat(*order[2]));
+}
+
+TEST_CASE(LinearPassStampsRunsAndHistoryCarriesOver) {
+	ReReadScheduler scheduler(750);
+	scheduler.NoteLinearPass(0, 9999);
+	scheduler.Rebuild({ 100, 9990 });
+	auto order = scheduler.NextSweep(9999);
+	REQUIRE(order.size() == 2);
+	CHECK_EQ(order[0]->first, 9990u);
+	CHECK(scheduler.NeedsCacheDefeat(*order[0]));   // Read just before the pass ended
+	CHECK(!scheduler.NeedsCacheDefeat(*order[1]));  // 9900 sectors ago
+
+	ReReadScheduler::NoteSweep(*order[0], false);
+	ReReadScheduler::NoteSweep(*order[0], false);
+	CHECK(ReReadScheduler::ShouldSlowDown(*order[0]));
+
+	// Merging the run with a new neighbour keeps its failures and stamp.
+	scheduler.Rebuild({ 9985, 9990 });
+	auto rebuilt = scheduler.NextSweep(9999);
+	REQUIRE(rebuilt.size() == 1);
+	CHECK(ReReadScheduler::ShouldSlowDown(*rebuilt[0]));
+	CHECK(scheduler.NeedsCacheDefeat(*rebuilt[0]));
+
+	ReReadScheduler::NoteSweep(*rebuilt[0], true);
+	CHECK(!ReReadScheduler::ShouldSlowDown(*rebuilt[0]));
+}
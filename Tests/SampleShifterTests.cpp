@@ -0,0 +1,85 @@
+﻿// ============================================================================
+// SampleShifterTests.cpp - Streaming and in-place sample-offset shifting
+// ============================================================================
+#include "UnitTest.h"
+#include "../SampleShifter.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+	std::vector<BYTE> RandomSectors(size_t sectors, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::vector<BYTE> v(sectors * AUDIO_SECTOR_SIZE);
+		for (auto& b : v) b = static_cast<BYTE>(rng());
+		return v;
+	}
+
+	// Output sample i is input sample i + offset; outside the input is silence.
+	std::vector<BYTE> DirectShift(const std::vector<BYTE>& in, int offset) {
+		std::vector<BYTE> out(in.size(), 0);
+		ptrdiff_t samples = static_cast<ptrdiff_t>(in.size() / 4);
+		for (ptrdiff_t i = 0; i < samples; i++) {
+			ptrdiff_t src = i + offset;
+			if (src >= 0 && src < samples) std::copy_n(in.begin() + src * 4, 4, out.begin() + i * 4);
+		}
+		return out;
+	}
+}
+
+TEST_CASE(ShiftInPlaceMatchesDefinition) {
+	auto in = RandomSectors(6, 31);
+	for (int offset : { 1, -1, 6, -6, 587, 588, -589, 667, -1200, 3000 }) {
+		auto shifted = in;
+		SampleShifter::ShiftInPlace({ shifted.data(), 6, AUDIO_SECTOR_SIZE }, offset);
+		CHECK(shifted == DirectShift(in, offset));
+	}
+
+	// An offset spanning the whole buffer leaves it untouched.
+	auto shifted = in;
+	SampleShifter::ShiftInPlace({ shifted.data(), 6, AUDIO_SECTOR_SIZE }, 6 * 588);
+	CHECK(shifted == in);
+}
+
+TEST_CASE(StreamMatchesShiftInPlaceForAnyChunking) {
+	const size_t sectors = 40;
+	auto in = RandomSectors(sectors, 32);
+	std::mt19937 rng(33);
+
+	for (int offset : { 0, 1, -1, 30, -30, 588, -588, 667, -667, 1234, -2939 }) {
+		auto expected = in;
+		SampleShifter::ShiftInPlace({ expected.data(), sectors, AUDIO_SECTOR_SIZE }, offset);
+
+		for (int trial = 0; trial < 4; trial++) {
+			SampleShifter shifter(offset);
+			std::vector<BYTE> out(in.size());
+			size_t fed = 0, emitted = 0;
+			while (fed < sectors) {
+				size_t n = std::min<size_t>(1 + rng() % 7, sectors - fed);
+				emitted += shifter.Push(in.data() + fed * AUDIO_SECTOR_SIZE, n,
+					out.data() + emitted * AUDIO_SECTOR_SIZE);
+				fed += n;
+				CHECK_EQ(shifter.Pending(), fed - emitted);
+			}
+			emitted += shifter.Finish(out.data() + emitted * AUDIO_SECTOR_SIZE);
+			CHECK_EQ(emitted, sectors);
+			CHECK(out == expected);
+			CHECK_EQ(shifter.Pending(), 0u);
+		}
+	}
+}
+
+TEST_CASE(StreamLagIsBoundedByOffset) {
+	// A positive offset holds back ceil(offset * 4 / 2352) sectors at most;
+	// a negative one emits every sector as it arrives.
+	auto in = RandomSectors(10, 34);
+	std::vector<BYTE> out(in.size());
+	for (int offset : { 1, 588, 589, 1200 }) {
+		SampleShifter shifter(offset);
+		size_t lag = (static_cast<size_t>(offset) * 4 + AUDIO_SECTOR_SIZE - 1) / AUDIO_SECTOR_SIZE;
+		for (size_t i = 0; i < in.size() / AUDIO_SECTOR_SIZE; i++)
+			shifter.Push(in.data() + i * AUDIO_SECTOR_SIZE, 1, out.data());
+		CHECK(shifter.Pending() <= lag);
+	}
+	SampleShifter late(-700);
+	CHECK_EQ(late.Push(in.data(), 10, out.data()), 10u);
+}
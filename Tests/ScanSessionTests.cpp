@@ -0,0 +1,107 @@
+﻿// ============================================================================
+// ScanSessionTests.cpp - Slice filtering and late-slice splitting
+// ============================================================================
+#include "UnitTest.h"
+#include "../ScanSession.h"
+#include <memory>
+
+namespace {
+	struct Reply {
+		DWORD lba;
+		int c1, c2, cu;
+		bool done;
+	};
+
+	// A blocking scan that replays `replies`, one per poll.
+	ScanSession::Config Scripted(std::vector<Reply> replies, bool levels = false) {
+		auto script = std::make_shared<std::vector<Reply>>(std::move(replies));
+		auto next = std::make_shared<size_t>(0);
+		ScanSession::Config config;
+		config.poll = [script, next](int& c1, int& c2, int& cu, DWORD& lba, bool& done) {
+			if (*next >= script->size()) return false;
+			const Reply& r = (*script)[(*next)++];
+			c1 = r.c1;
+			c2 = r.c2;
+			cu = r.cu;
+			lba = r.lba;
+			done = r.done;
+			return true;
+		};
+		config.pacing = ScanSession::Pacing::Blocking;
+		config.firstLBA = 0;
+		config.lastLBA = 100000;
+		config.levels = levels;
+		return config;
+	}
+
+	std::vector<ScanSlice> RunToEnd(ScanSession& session) {
+		std::vector<ScanSlice> slices, batch;
+		session.Start();
+		while (session.Wait(batch, 100)) {
+			slices.insert(slices.end(), batch.begin(), batch.end());
+			batch.clear();
+		}
+		return slices;
+	}
+}
+
+TEST_CASE(SessionDropsStartupEmptyAndRepeatedSlices) {
+	ScanSession session(Scripted({
+		{ 75, 50, 0, 0, false }, { 150, 50, 0, 0, false }, { 225, 50, 0, 0, false },
+		{ 0, 0, 0, 0, false },                                  // seeking
+		{ 300, 1, 0, 0, false }, { 300, 1, 0, 0, false },       // repeated
+		{ 375, 2, 0, 0, false }, { 450, 3, 1, 0, true } }));
+	auto slices = RunToEnd(session);
+	CHECK(session.GetState() == ScanSession::State::Done);
+	REQUIRE(slices.size() == 3);
+	CHECK_EQ(slices[0].lba, 300u);
+	CHECK_EQ(slices[2].lba, 450u);
+	CHECK_EQ(slices[2].c2, 1);
+	CHECK_EQ(session.LateSlices(), 0);
+}
+
+TEST_CASE(LateSliceIsSplitPerSecond) {
+	ScanSession session(Scripted({
+		{ 75, 0, 0, 0, false }, { 150, 0, 0, 0, false }, { 225, 0, 0, 0, false },
+		{ 300, 4, 0, 0, false },
+		{ 600, 10, 5, 3, false },                               // four seconds in one poll
+		{ 675, 1, 0, 0, true } }));
+	auto slices = RunToEnd(session);
+	CHECK_EQ(session.LateSlices(), 1);
+	REQUIRE(slices.size() == 6);
+
+	int c1 = 0, c2 = 0, cu = 0;
+	for (int k = 0; k < 4; k++) {
+		const ScanSlice& part = slices[1 + k];
+		CHECK_EQ(part.lba, 300u + 75u * (k + 1));
+		CHECK(part.timeMs >= slices[0].timeMs && part.timeMs <= slices[5].timeMs);
+		c1 += part.c1;
+		c2 += part.c2;
+		cu += part.cu;
+	}
+	CHECK_EQ(slices[1].c1, 3);
+	CHECK_EQ(slices[4].c1, 2);
+	CHECK(c1 == 10 && c2 == 5 && cu == 3);
+	CHECK(slices[4].timeMs > slices[1].timeMs);
+}
+
+TEST_CASE(LateLevelSliceRepeatsValues) {
+	ScanSession session(Scripted({
+		{ 75, 0, 0, 0, false }, { 150, 0, 0, 0, false }, { 225, 0, 0, 0, false },
+		{ 300, 8, -2, 0, false }, { 450, 9, -3, 0, true } }, true));
+	auto slices = RunToEnd(session);
+	CHECK_EQ(session.LateSlices(), 1);
+	REQUIRE(slices.size() == 3);
+	CHECK(slices[1].lba == 375 && slices[1].c1 == 9 && slices[1].c2 == -3);
+	CHECK(slices[2].lba == 450 && slices[2].c1 == 9 && slices[2].c2 == -3);
+}
+
+TEST_CASE(DoneSliceDuringStartupIsKept) {
+	ScanSession session(Scripted({ { 75, 0, 0, 0, false }, { 900, 7, 0, 0, true } }));
+	auto slices = RunToEnd(session);
+	CHECK(session.GetState() == ScanSession::State::Done);
+	REQUIRE(slices.size() == 1);
+	CHECK_EQ(slices[0].lba, 900u);
+	CHECK_EQ(slices[0].c1, 7);
+	CHECK_EQ(session.LateSlices(), 0);
+}
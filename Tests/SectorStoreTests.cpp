@@ -0,0 +1,57 @@
+﻿// ============================================================================
+// SectorStoreTests.cpp - Contiguous sector store and streaming release
+// ============================================================================
+#include "UnitTest.h"
+#include "../SectorStore.h"
+#include <cstring>
+
+namespace {
+	void FillSector(BYTE* audio, size_t index) {
+		memset(audio, static_cast<int>(index & 0xFF), AUDIO_SECTOR_SIZE);
+	}
+
+	bool SectorIntact(const SectorStore& store, size_t index) {
+		const BYTE* audio = store.Audio(index);
+		for (size_t i = 0; i < AUDIO_SECTOR_SIZE; i++) {
+			if (audio[i] != static_cast<BYTE>(index & 0xFF)) return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE(AppendKeepsSectorsContiguous) {
+	SectorStore store;
+	REQUIRE(store.Reserve(64, false, true));
+	for (size_t i = 0; i < 40; i++) FillSector(store.AppendSector(), i);
+	CHECK_EQ(store.size(), 40u);
+	CHECK(store.Audio(1) == store.Audio(0) + AUDIO_SECTOR_SIZE);
+	CHECK(!store.HasC2(5));
+	REQUIRE(store.EnableC2(5) != nullptr);
+	CHECK(store.HasC2(5));
+
+	store.Truncate(30);
+	CHECK_EQ(store.size(), 30u);
+	for (size_t i = 0; i < 30; i++) CHECK(SectorIntact(store, i));
+}
+
+TEST_CASE(ReleaseBelowKeepsListedAndLaterSectors) {
+	SectorStore store;
+	REQUIRE(store.Reserve(200));
+	for (size_t i = 0; i < 100; i++) FillSector(store.AppendSector(), i);
+	const BYTE* before = store.Audio(70);
+
+	store.ReleaseBelow(60, { 10, 11 });
+	CHECK(store.HasReleased());
+	CHECK_EQ(store.size(), 100u);
+	CHECK(store.Audio(70) == before);
+	CHECK(SectorIntact(store, 10));
+	CHECK(SectorIntact(store, 11));
+	for (size_t i = 60; i < 100; i++) CHECK(SectorIntact(store, i));
+
+	// Appending after a release still works, and a later call drops the
+	// pages it held back once sector 10 is no longer listed.
+	for (size_t i = 100; i < 150; i++) FillSector(store.AppendSector(), i);
+	store.ReleaseBelow(120, { 11 });
+	CHECK(SectorIntact(store, 11));
+	for (size_t i = 120; i < 150; i++) CHECK(SectorIntact(store, i));
+}
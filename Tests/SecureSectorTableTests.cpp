@@ -0,0 +1,291 @@
+﻿// ============================================================================
+// SecureSectorTableTests.cpp - Secure rip sector table and candidate pool
+// ============================================================================
+#include "UnitTest.h"
+#include "../SecureSectorTable.h"
+#include <cstring>
+
+namespace {
+	SectorHash H(uint64_t v) { return { v, ~v }; }
+}
+
+TEST_CASE(TableCoversExactlyItsRange) {
+	SecureSectorTable table;
+	table.Reset(1000, 1009);
+	CHECK(!table.Contains(999));
+	CHECK(!table.Contains(1000));           // Sized but not yet present
+	CHECK(!table.Contains(1010));
+
+	table.Set(1000, 0, H(0xAAAA), 1, SecureSectorTable::FLAG_AUDIO, 1);
+	table.Set(1009, 9, H(0xBBBB), 2, SecureSectorTable::FLAG_SUBCHANNEL, 3);
+	CHECK(table.Contains(1000));
+	CHECK(table.Contains(1009));
+	CHECK(!table.Contains(1005));
+	CHECK(!table.Contains(1010));
+	CHECK(!table.Contains(0));              // Below firstLBA must not wrap in
+}
+
+TEST_CASE(TableStoresFieldsPerLba) {
+	SecureSectorTable table;
+	table.Reset(150, 400);
+	table.Set(200, 50, H(0x12345678u), 3, SecureSectorTable::FLAG_AUDIO, 2);
+	table.Set(201, 51, H(0x9ABCDEF0u), 1, SecureSectorTable::FLAG_SUBCHANNEL | SecureSectorTable::FLAG_VALID_HASH, 7);
+
+	CHECK_EQ(table.StoreIndex(200), 50u);
+	CHECK(table.Hash(200) == H(0x12345678u));
+	CHECK_EQ(table.MatchCount(200), 3);
+	CHECK_EQ(table.Track(200), 2);
+	CHECK(table.IsAudio(200));
+	CHECK_EQ(table.SectorSize(200), AUDIO_SECTOR_SIZE);
+
+	CHECK(!table.IsAudio(201));
+	CHECK_EQ(table.SectorSize(201), RAW_SECTOR_SIZE);
+	CHECK(table.Has(201, SecureSectorTable::FLAG_VALID_HASH));
+	CHECK_EQ(table.Track(201), 7);
+
+	// Accessors return references into the table.
+	table.C2Failures(200)++;
+	table.C2Failures(200)++;
+	table.MatchCount(201) = 9;
+	table.Hash(201) = H(1);
+	CHECK_EQ(table.C2Failures(200), 2);
+	CHECK_EQ(table.C2Failures(201), 0);
+	CHECK_EQ(table.MatchCount(201), 9);
+	CHECK(table.Hash(201) == H(1));
+
+	table.SetFlag(200, SecureSectorTable::FLAG_HAD_C2, true);
+	CHECK(table.Has(200, SecureSectorTable::FLAG_HAD_C2));
+	table.SetFlag(200, SecureSectorTable::FLAG_HAD_C2, false);
+	CHECK(!table.Has(200, SecureSectorTable::FLAG_HAD_C2));
+	CHECK(table.IsAudio(200));
+
+	// Set() starts a sector over, clearing its C2 failure count.
+	table.Set(200, 60, H(0), 1, SecureSectorTable::FLAG_AUDIO, 2);
+	CHECK_EQ(table.C2Failures(200), 0);
+	CHECK_EQ(table.StoreIndex(200), 60u);
+
+	table.Reset(150, 400);
+	CHECK(!table.Contains(200));
+}
+
+TEST_CASE(PoolCountsMatchesAndKeepsData) {
+	SectorCandidatePool pool;
+	CHECK(pool.Best() == nullptr);
+
+	auto read = [&](BYTE fill, uint64_t hash) {
+		memset(pool.Scratch(), fill, RAW_SECTOR_SIZE);
+		return pool.Commit(H(hash));
+	};
+	CHECK_EQ(read(0x11, 1), 1);
+	CHECK_EQ(read(0x22, 2), 1);
+	CHECK_EQ(read(0x11, 1), 2);
+	CHECK_EQ(read(0x22, 2), 2);
+	CHECK_EQ(read(0x11, 1), 3);
+	CHECK_EQ(pool.Size(), 2);
+
+	const auto* best = pool.Best();
+	REQUIRE(best != nullptr);
+	CHECK(best->hash == H(1));
+	CHECK_EQ(best->count, 3);
+	// The adopted buffer still holds the first read of that candidate.
+	const BYTE* data = pool.Data(*best);
+	CHECK(data[0] == 0x11 && data[RAW_SECTOR_SIZE - 1] == 0x11);
+
+	pool.Reset();
+	CHECK_EQ(pool.Size(), 0);
+	CHECK(pool.Best() == nullptr);
+}
+
+TEST_CASE(PoolBestPrefersEarliestOnTies) {
+	SectorCandidatePool pool;
+	for (uint32_t h = 10; h < 13; h++) {
+		memset(pool.Scratch(), static_cast<int>(h), RAW_SECTOR_SIZE);
+		pool.Commit(H(h));
+	}
+	REQUIRE(pool.Best() != nullptr);
+	CHECK(pool.Best()->hash == H(10));
+	CHECK(pool.Data(*pool.Best())[0] == 10);
+}
+
+TEST_CASE(PoolEvictsLeastConfirmedWhenFull) {
+	SectorCandidatePool pool;
+	auto read = [&](uint64_t hash) {
+		memset(pool.Scratch(), static_cast<int>(hash), RAW_SECTOR_SIZE);
+		return pool.Commit(H(hash));
+	};
+	// Fill every slot; all but the last are confirmed twice.
+	for (uint32_t h = 0; h < SectorCandidatePool::MAX_CANDIDATES; h++) {
+		read(h);
+		if (h + 1 < SectorCandidatePool::MAX_CANDIDATES) read(h);
+	}
+	CHECK_EQ(pool.Size(), SectorCandidatePool::MAX_CANDIDATES);
+
+	// A new reading replaces the only single-count candidate (the last one).
+	CHECK_EQ(read(100), 1);
+	CHECK_EQ(pool.Size(), SectorCandidatePool::MAX_CANDIDATES);
+	CHECK_EQ(read(SectorCandidatePool::MAX_CANDIDATES - 1), 1);  // Was evicted
+
+	// Every surviving candidate still owns its own data.
+	for (uint32_t h = 0; h + 1 < SectorCandidatePool::MAX_CANDIDATES; h++) {
+		memset(pool.Scratch(), 0xEE, RAW_SECTOR_SIZE);
+		CHECK_EQ(pool.Commit(H(h)), 3);
+	}
+	REQUIRE(pool.Best() != nullptr);
+	CHECK(pool.Best()->hash == H(0));
+	CHECK(pool.Data(*pool.Best())[0] == 0);
+}
+
+// ── Per-sample vote ─────────────────────────────────────────────────────────
+
+namespace {
+	constexpr int C2_BYTES = AUDIO_SECTOR_SIZE / 8;
+
+	uint16_t GoodSample(int s) { return static_cast<uint16_t>(s * 2654435761u >> 7); }
+
+	void FillGood(BYTE* audio) {
+		for (int s = 0; s < SectorCandidatePool::SAMPLES; s++) {
+			uint16_t v = GoodSample(s);
+			memcpy(audio + 2 * s, &v, sizeof(v));
+		}
+	}
+
+	void Corrupt(BYTE* audio, int s) { audio[2 * s] ^= 0x5A; }
+
+	void FlagSample(BYTE* c2, int s) { c2[(2 * s) >> 3] |= static_cast<BYTE>(0xC0 >> ((2 * s) & 7)); }
+}
+
+TEST_CASE(VoteRebuildsSectorFromFlaggedReads) {
+	// Three reads, each with six different C2-flagged bad samples and one
+	// bad sample the drive did not flag; no two reads agree as a whole.
+	SectorCandidatePool pool;
+	for (int pass = 0; pass < 3; pass++) {
+		BYTE* audio = pool.Scratch();
+		FillGood(audio);
+		BYTE c2[C2_BYTES] = {};
+		for (int k = 0; k < 6; k++) {
+			int s = 10 + pass * 100 + k * 7;
+			Corrupt(audio, s);
+			FlagSample(c2, s);
+		}
+		Corrupt(audio, 500 + pass);
+		CHECK_EQ(pool.Commit(H(pass + 1), c2, false), 0);
+	}
+	CHECK_EQ(pool.Size(), 3);
+
+	BYTE rebuilt[AUDIO_SECTOR_SIZE];
+	float confidence[SectorCandidatePool::SAMPLES];
+	auto vote = pool.Vote(rebuilt, 2, confidence);
+	CHECK(vote.secure);
+	CHECK_EQ(vote.contested, 21);
+	CHECK(vote.minConfidence < 1.0f);
+
+	BYTE expected[AUDIO_SECTOR_SIZE];
+	FillGood(expected);
+	CHECK(memcmp(rebuilt, expected, AUDIO_SECTOR_SIZE) == 0);
+	CHECK(confidence[0] == 1.0f);
+	CHECK(confidence[10] > 0.5f && confidence[10] < 1.0f);
+}
+
+TEST_CASE(VoteIsNotSecureWithoutEnoughCleanReads) {
+	SectorCandidatePool pool;
+	BYTE c2[C2_BYTES] = {};
+	FlagSample(c2, 3);
+
+	FillGood(pool.Scratch());
+	pool.Commit(H(1), c2, false);
+	FillGood(pool.Scratch());
+	Corrupt(pool.Scratch(), 3);
+	pool.Commit(H(2));
+
+	// Sample 3: one flagged read of the right value against one clean read
+	// of a wrong one.  The clean read outweighs the flagged one, but a single
+	// clean read is short of the two required.
+	BYTE rebuilt[AUDIO_SECTOR_SIZE];
+	auto vote = pool.Vote(rebuilt, 2);
+	CHECK(!vote.secure);
+	CHECK_EQ(vote.contested, 1);
+	uint16_t v;
+	memcpy(&v, rebuilt + 6, sizeof(v));
+	CHECK(v != GoodSample(3));
+	CHECK(pool.Vote(rebuilt, 1).secure);
+}
+
+TEST_CASE(VoteTreatsFillerPointerBytesAsClean) {
+	SectorCandidatePool pool;
+	BYTE c2[C2_BYTES];
+	memset(c2, 0xFF, sizeof(c2));
+	for (int pass = 0; pass < 2; pass++) {
+		FillGood(pool.Scratch());
+		pool.Commit(H(1), c2, false);
+	}
+	BYTE rebuilt[AUDIO_SECTOR_SIZE];
+	auto vote = pool.Vote(rebuilt, 2);
+	CHECK(vote.secure);
+	CHECK_EQ(vote.contested, 0);
+}
+
+// ── Partial verification ────────────────────────────────────────────────────
+
+namespace {
+	void FlagByte(BYTE* c2, int i) { c2[i >> 3] |= static_cast<BYTE>(0x80 >> (i & 7)); }
+}
+
+TEST_CASE(PartialVerifiesFlaggedBytesAcrossReads) {
+	// The first read has ten flagged bytes; each re-read has ten different
+	// flagged bytes of its own, which must not hold the sector back.
+	SecureSectorTable table;
+	table.Reset(100, 100);
+
+	BYTE good[AUDIO_SECTOR_SIZE];
+	FillGood(good);
+	BYTE stored[AUDIO_SECTOR_SIZE];
+	memcpy(stored, good, sizeof(stored));
+	BYTE c2[C2_BYTES] = {};
+	for (int k = 0; k < 10; k++) {
+		FlagByte(c2, 40 + k * 13);
+		stored[40 + k * 13] ^= 0xFF;
+	}
+	table.BeginPartial(100, c2);
+	CHECK(table.HasPartial(100));
+
+	SecureSectorTable::PartialProgress progress;
+	for (int pass = 0; pass < 2; pass++) {
+		BYTE reread[AUDIO_SECTOR_SIZE];
+		memcpy(reread, good, sizeof(reread));
+		BYTE rereadC2[C2_BYTES] = {};
+		for (int k = 0; k < 10; k++) {
+			int i = 1000 + pass * 500 + k * 11;
+			FlagByte(rereadC2, i);
+			reread[i] ^= 0xFF;
+		}
+		progress = table.MergePartial(100, stored, reread, rereadC2, 2);
+		if (pass == 0) {
+			CHECK(!progress.complete);
+			CHECK_EQ(progress.mergedBytes, 10);
+			CHECK_EQ(progress.pendingBytes, 10);
+			CHECK_EQ(progress.minMatches, 1);
+		}
+	}
+	CHECK(progress.complete);
+	CHECK_EQ(progress.mergedBytes, 0);
+	CHECK(memcmp(stored, good, sizeof(stored)) == 0);
+}
+
+TEST_CASE(PartialRestartsOnContradictingCleanRead) {
+	SecureSectorTable table;
+	table.Reset(0, 0);
+	BYTE c2[C2_BYTES] = {};
+	FlagByte(c2, 7);
+	table.BeginPartial(0, c2);
+
+	BYTE stored[AUDIO_SECTOR_SIZE] = {};
+	BYTE reread[AUDIO_SECTOR_SIZE] = {};
+	reread[7] = 0x11;
+	CHECK_EQ(table.MergePartial(0, stored, reread, nullptr, 2).minMatches, 1);
+	reread[7] = 0x22;
+	auto progress = table.MergePartial(0, stored, reread, nullptr, 2);
+	CHECK_EQ(progress.minMatches, 1);
+	CHECK_EQ(progress.mergedBytes, 1);
+	CHECK(stored[7] == 0x22);
+	CHECK(table.MergePartial(0, stored, reread, nullptr, 2).complete);
+}
@@ -0,0 +1,38 @@
+﻿// ============================================================================
+// TestMain.cpp - Runs the registered unit tests
+//
+// Stand-alone console target (no drive, no network): every case exercises
+// pure logic on synthetic data.  Usage: UnitTests [name-filter]
+// ============================================================================
+#include "UnitTest.h"
+#include <cstring>
+
+namespace {
+	int g_failures = 0;
+}
+
+std::vector<UnitTest::Case>& UnitTest::Registry() {
+	static std::vector<Case> cases;
+	return cases;
+}
+
+void UnitTest::Fail(const char* file, int line, const char* expr) {
+	g_failures++;
+	std::printf("    %s(%d): CHECK(%s) failed\n", file, line, expr);
+}
+
+int main(int argc, char* argv[]) {
+	const char* filter = (argc > 1) ? argv[1] : nullptr;
+	int run = 0, failed = 0;
+	for (const auto& test : UnitTest::Registry()) {
+		if (filter && !std::strstr(test.name, filter)) continue;
+		int before = g_failures;
+		test.fn();
+		run++;
+		bool ok = (g_failures == before);
+		if (!ok) failed++;
+		std::printf("  [%s] %s\n", ok ? " OK " : "FAIL", test.name);
+	}
+	std::printf("\n%d test(s), %d failed\n", run, failed);
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+﻿// ============================================================================
+// UnitTest.h - Minimal self-registering test harness for the Tests target
+//
+// Each TEST_CASE registers itself at static-initialisation time; TestMain
+// runs them in registration order (or only those whose name contains the
+// first command-line argument) and exits non-zero if any check failed.
+// CHECK records a failure and carries on; REQUIRE also leaves the case.
+// ============================================================================
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+namespace UnitTest {
+	struct Case {
+		const char* name;
+		void (*fn)();
+	};
+
+	std::vector<Case>& Registry();
+	void Fail(const char* file, int line, const char* expr);
+
+	struct Registrar {
+		Registrar(const char* name, void (*fn)()) { Registry().push_back({ name, fn }); }
+	};
+}
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static UnitTest::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(expr) \
+	do { if (!(expr)) UnitTest::Fail(__FILE__, __LINE__, #expr); } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+#define REQUIRE(expr) \
+	do { if (!(expr)) { UnitTest::Fail(__FILE__, __LINE__, #expr); return; } } while (0)
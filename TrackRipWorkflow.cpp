@@ -4,22 +4,34 @@
 // Workflow: track selection → format (WAV/FLAC) → speed → burst/safe mode →
 // verification prompt → read disc → save files → optional physical compare.
 //
-// FLAC output requires flac.exe on the system PATH.  If not found the track
-// is saved as WAV and the user is notified.
+// FLAC is encoded in-process (FlacEncoder.h), several tracks at once, from
+// the sector store — no intermediate WAV.  Tags come from CD-Text and the
+// track ISRCs.
+//
+// Without verification the output can be streamed (RipStream.h): a WAV is
+// complete as soon as the read passes its end, and a FLAC track is handed
+// to the encoder then, so encoding overlaps the rest of the read.
+// Verification compares two in-memory rips, so it buffers and encodes
+// every track in parallel after the read.
 // ============================================================================
 #define NOMINMAX
 #include "TrackRipWorkflow.h"
 #include "ConsoleColors.h"
+#include "DiscLayout.h"
 #include "FileUtils.h"
+#include "FlacEncoder.h"
 #include "InterruptHandler.h"
 #include "MenuHelpers.h"
 #include "PioneerVendor.h"
 #include "Progress.h"
+#include "RipStream.h"
 #include <algorithm>
 #include <conio.h>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -62,19 +74,12 @@ static bool TrackHadReadErrors(const DiscInfo& disc, const TrackInfo& track)
 }
 
 // Writes a standard 44-byte RIFF/WAVE file (16-bit stereo 44100 Hz PCM).
- // Sectors are batched into a write buffer to reduce I/O call overhead.
-static bool WriteWavFile(const std::wstring& path,
-	const std::vector<std::vector<BYTE>>& sectors,
-	size_t startSector, size_t sectorCount)
+// The audio span is contiguous in the sector store, so the payload goes out
+// in a few large writes straight from the store — no staging copy.
+static bool WriteWavFile(const std::wstring& path, const SectorSpan& audio)
 {
-	if (sectorCount == 0) return false;
-	if (startSector >= sectors.size()) return false;
-	if (sectorCount > (sectors.size() - startSector)) return false;
-
-	for (size_t i = 0; i < sectorCount; i++) {
-		if (sectors[startSector + i].size() < AUDIO_SECTOR_SIZE)
-			return false;
-	}
+	size_t sectorCount = audio.count;
+	if (sectorCount == 0 || !audio.data) return false;
 
 	unsigned long long dataSize64 =
 		static_cast<unsigned long long>(sectorCount) * AUDIO_SECTOR_SIZE;
@@ -84,111 +89,78 @@ static bool WriteWavFile(const std::wstring& path,
 	std::ofstream out(path, std::ios::binary);
 	if (!out) return false;
 
-	uint32_t dataSize = static_cast<uint32_t>(dataSize64);
-	uint32_t fileSize = dataSize + 36;
-	uint16_t audioFmt = 1, ch = 2, bps = 16;
-	uint32_t rate = 44100;
-	uint16_t blockAlign = ch * (bps / 8);
-	uint32_t byteRate = rate * blockAlign;
-	uint32_t fmtSize = 16;
-
-	out.write("RIFF", 4);
-	out.write(reinterpret_cast<const char*>(&fileSize), 4);
-	out.write("WAVE", 4);
-	out.write("fmt ", 4);
-	out.write(reinterpret_cast<const char*>(&fmtSize), 4);
-	out.write(reinterpret_cast<const char*>(&audioFmt), 2);
-	out.write(reinterpret_cast<const char*>(&ch), 2);
-	out.write(reinterpret_cast<const char*>(&rate), 4);
-	out.write(reinterpret_cast<const char*>(&byteRate), 4);
-	out.write(reinterpret_cast<const char*>(&blockAlign), 2);
-	out.write(reinterpret_cast<const char*>(&bps), 2);
-	out.write("data", 4);
-	out.write(reinterpret_cast<const char*>(&dataSize), 4);
-
-	// Batch writes: ~150 KB per I/O call instead of one per sector
-	constexpr size_t WRITE_BATCH = 64;
-	std::vector<BYTE> buf(WRITE_BATCH * AUDIO_SECTOR_SIZE);
-	size_t buffered = 0;
-
-	for (size_t i = 0; i < sectorCount; i++) {
-		size_t idx = startSector + i;
-		memcpy(buf.data() + buffered * AUDIO_SECTOR_SIZE,
-			sectors[idx].data(), AUDIO_SECTOR_SIZE);
-		buffered++;
-		if (buffered == WRITE_BATCH) {
-			out.write(reinterpret_cast<const char*>(buf.data()),
-				buffered * AUDIO_SECTOR_SIZE);
-			buffered = 0;
-		}
-	}
-	if (buffered > 0) {
-		out.write(reinterpret_cast<const char*>(buf.data()),
-			buffered * AUDIO_SECTOR_SIZE);
+	WriteWavHeader(out, static_cast<uint32_t>(dataSize64));
+
+	// Write in ~4 MB slices so a single huge request doesn't stall the
+	// stream buffer on very long tracks.
+	constexpr size_t WRITE_SLICE = 1782 * AUDIO_SECTOR_SIZE;
+	const char* src = reinterpret_cast<const char*>(audio.data);
+	size_t remaining = audio.Bytes();
+	while (remaining > 0 && out) {
+		size_t n = std::min(remaining, WRITE_SLICE);
+		out.write(src, static_cast<std::streamsize>(n));
+		src += n;
+		remaining -= n;
 	}
 
 	return out.good();
 }
 
-// Attempts WAV → FLAC conversion via flac.exe (best compression, silent).
-// Returns true if the FLAC file was created successfully.
-static bool ConvertWavToFlac(const std::wstring& wavPath, const std::wstring& flacPath) {
-	std::wstring cmdLine = L"flac --best --silent --force -o \"" + flacPath + L"\" \"" + wavPath + L"\"";
+// Output name without extension: "02. Artist - Title" or "Track 02".
+static std::wstring TrackBaseName(const DiscInfo& disc, const TrackInfo& t)
+{
+	std::wostringstream prefix;
+	prefix << std::setfill(L'0') << std::setw(2) << t.trackNumber << L". ";
 
-	STARTUPINFOW si = { sizeof(si) };
-	si.dwFlags = STARTF_USESHOWWINDOW;
-	si.wShowWindow = SW_HIDE;
-	PROCESS_INFORMATION pi = {};
+	bool hasCDText = (t.trackNumber > 0 &&
+		static_cast<size_t>(t.trackNumber) <= disc.cdText.trackTitles.size() &&
+		!disc.cdText.trackTitles[t.trackNumber - 1].empty());
 
-	if (!CreateProcessW(nullptr, &cmdLine[0], nullptr, nullptr, FALSE,
-		CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)) {
-		return false;
-	}
-
-	WaitForSingleObject(pi.hProcess, INFINITE);
+	if (hasCDText) {
+		std::string title = disc.cdText.trackTitles[t.trackNumber - 1];
+		std::string artist;
+		if (t.trackNumber > 0 &&
+			static_cast<size_t>(t.trackNumber) <= disc.cdText.trackArtists.size() &&
+			!disc.cdText.trackArtists[t.trackNumber - 1].empty()) {
+			artist = disc.cdText.trackArtists[t.trackNumber - 1];
+		}
+		std::string narrow = artist.empty() ? title : (artist + " - " + title);
 
-	DWORD exitCode = 1;
-	GetExitCodeProcess(pi.hProcess, &exitCode);
-	CloseHandle(pi.hProcess);
-	CloseHandle(pi.hThread);
+		std::wstring wide;
+		if (Utf8ToWide(narrow, wide)) {
+			std::wstring sanitized = SanitizeFilename(wide);
+			if (!sanitized.empty()) {
+				return prefix.str() + sanitized;
+			}
+		}
+	}
 
-	return exitCode == 0;
+	return L"Track " + prefix.str().substr(0, 2);
 }
 
-// Writes a track file in the requested format.
-// For FLAC: writes a temp WAV, converts via flac.exe, deletes the WAV on success.
-// If FLAC encoding is unavailable or fails, keeps the WAV and returns the actual path used.
-static bool WriteTrackFile(TrackOutputFormat format,
-	const std::wstring& basePath,        // path without extension
-	const std::vector<std::vector<BYTE>>& sectors,
-	size_t startSector, size_t sectorCount,
-	std::wstring& actualPath,            // [out] final file path
-	bool& flacFallback)                  // [out] true if fell back to WAV
+// Vorbis comments for a FLAC track: CD-Text titles and performers, track
+// numbering and the ISRC from the Q subchannel.
+static FlacTags TrackTags(const DiscInfo& disc, const TrackInfo& t)
 {
-	flacFallback = false;
-
-	if (format == TrackOutputFormat::WAV) {
-		actualPath = basePath + L".wav";
-		return WriteWavFile(actualPath, sectors, startSector, sectorCount);
-	}
-
-	// FLAC: write temp WAV → convert → delete WAV
-	std::wstring wavPath = basePath + L".wav";
-	std::wstring flacPath = basePath + L".flac";
-
-	if (!WriteWavFile(wavPath, sectors, startSector, sectorCount))
-		return false;
-
-	if (ConvertWavToFlac(wavPath, flacPath)) {
-		DeleteFileW(wavPath.c_str());
-		actualPath = flacPath;
-		return true;
-	}
-
-	// flac.exe not found or failed — keep the WAV
-	flacFallback = true;
-	actualPath = wavPath;
-	return true;
+	auto perTrack = [&](const std::vector<std::string>& values) {
+		return (t.trackNumber > 0 && static_cast<size_t>(t.trackNumber) <= values.size())
+			? values[t.trackNumber - 1] : std::string();
+	};
+	int audioTracks = 0;
+	for (const auto& track : disc.tracks) {
+		if (track.isAudio) audioTracks++;
+	}
+
+	std::string artist = perTrack(disc.cdText.trackArtists);
+	FlacTags tags;
+	tags.Add("TITLE", perTrack(disc.cdText.trackTitles));
+	tags.Add("ARTIST", artist.empty() ? disc.cdText.albumArtist : artist);
+	tags.Add("ALBUM", disc.cdText.albumTitle);
+	tags.Add("ALBUMARTIST", disc.cdText.albumArtist);
+	tags.Add("TRACKNUMBER", std::to_string(t.trackNumber));
+	tags.Add("TRACKTOTAL", std::to_string(audioTracks));
+	tags.Add("ISRC", t.isrc);
+	return tags;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════
@@ -270,7 +242,7 @@ static int SelectOutputFormat() {
 	std::cout << "\n=== Output Format ===\n";
 	std::cout << "0. Back to menu\n";
 	std::cout << "1. WAV (uncompressed, maximum compatibility)\n";
-	std::cout << "2. FLAC (lossless compressed — requires flac.exe on PATH)\n";
+	std::cout << "2. FLAC (lossless compressed)\n";
 	std::cout << "Choice: ";
 	int c = GetMenuChoice(0, 2, 1);
 	std::cin.clear(); std::cin.ignore(10000, '\n');
@@ -344,6 +316,14 @@ bool RunTrackRipWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstri
 	bool verifyRip = (verifyMode == 2 || verifyMode == 3);
 	bool autoRetry = (verifyMode == 3);
 
+	// ── 5b. Rip output (streaming needs no second in-memory rip) ────────
+	bool streaming = false;
+	if (!verifyRip) {
+		int ripOutput = copier.SelectRipOutput();
+		if (ripOutput == -1) return false;
+		streaming = (ripOutput == 1);
+	}
+
 	// ── 6. Drive capabilities ───────────────────────────────────────────
 	SecureRipConfig secureConfig{};
 	if (!isBurst) {
@@ -501,7 +481,40 @@ bool RunTrackRipWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstri
 	}
 	ripDisc.selectedSession = 0;   // not needed — we already picked the tracks
 
-	// ── 10. Read only the selected tracks ───────────────────────────────
+	// ── 10. Build per-track sector map ──────────────────────────────────
+	// ripDisc.tracks may include gap-fill tracks; slices covers all of them.
+	struct TrackSlice { size_t start; size_t count; };
+	std::vector<TrackSlice> slices(ripDisc.tracks.size(), { 0, 0 });
+	for (const auto& span : DiscLayout::ForRip(ripDisc).Spans()) {
+		slices[span.trackIndex] = { span.linearStart, span.Count() };
+	}
+
+	const bool flac = (format == TrackOutputFormat::FLAC);
+	const wchar_t* extension = flac ? L".flac" : L".wav";
+
+	// Streaming: one file per selected track, written (or encoded) during
+	// the read.
+	RipStreamWriter stream;
+	if (streaming) {
+		std::vector<RipStreamWriter::TrackFile> files;
+		for (size_t si = 0; si < selectedTracks.size(); si++) {
+			int ri = ripIndices[si];
+			RipStreamWriter::TrackFile file;
+			file.path = outputDir + TrackBaseName(disc, ripDisc.tracks[ri]) + extension;
+			file.firstSector = slices[ri].start;
+			file.sectorCount = slices[ri].count;
+			file.flac = flac;
+			if (flac) file.tags = TrackTags(disc, ripDisc.tracks[ri]);
+			files.push_back(std::move(file));
+		}
+		if (!stream.OpenTrackFiles(ripDisc, files)) {
+			Console::Error("Cannot create track files.\n");
+			return false;
+		}
+		copier.SetRipStream(&stream);
+	}
+
+	// ── 11. Read only the selected tracks ───────────────────────────────
 	Console::Info("\nReading disc...\n");
 	ProgressIndicator prog;
 	prog.SetLabel("  Ripping");
@@ -518,8 +531,11 @@ bool RunTrackRipWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstri
 			MakeProgressCallback(&prog));
 	}
 
+	copier.SetRipStream(nullptr);
+
 	if (!readOk) {
 		prog.Finish(false);
+		if (streaming) stream.Abort();
 		Console::Error("Disc read failed.\n");
 		return false;
 	}
@@ -540,81 +556,60 @@ bool RunTrackRipWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstri
 		Console::Warning(msg.c_str());
 	}
 
-	// Apply offset correction before splitting tracks
-	if (ripDisc.driveOffset != 0) {
-		copier.ApplyOffsetCorrection(ripDisc);
+	// Apply offset correction before splitting tracks — a streamed rip was
+	// corrected on its way to disk.
+	bool streamOk = true;
+	if (streaming) {
+		streamOk = stream.Finish(ripDisc.rawSectors);
+		ripDisc.rawSectors.clear();
 	}
-
-	// ── 11. Build per-track sector map ──────────────────────────────────
-	// ripDisc.tracks may include gap-fill tracks; slices covers all of them.
-	struct TrackSlice { size_t start; size_t count; };
-	std::vector<TrackSlice> slices(ripDisc.tracks.size());
-	size_t cumIdx = 0;
-	for (size_t i = 0; i < ripDisc.tracks.size(); i++) {
-		DWORD readStart = (ripDisc.pregapMode == PregapMode::Skip)
-			? ripDisc.tracks[i].startLBA : ripDisc.tracks[i].pregapLBA;
-		DWORD cnt = ripDisc.tracks[i].endLBA - readStart + 1;
-		slices[i] = { cumIdx, cnt };
-		cumIdx += cnt;
+	else if (ripDisc.driveOffset != 0) {
+		copier.ApplyOffsetCorrection(ripDisc);
 	}
 
 	// ── 12. Save each selected track ────────────────────────────────────
+	// Streamed tracks are already on disk.  Buffered FLAC tracks go to the
+	// encoder together and are collected in order.
 	Console::Info("\nSaving tracks...\n");
-	int savedCount = 0;
-	bool anyFlacFallback = false;
+	std::vector<bool> saved(selectedTracks.size(), false);
+	{
+		std::unique_ptr<FlacEncodeQueue> encoder;
+		std::vector<std::future<bool>> encodes(selectedTracks.size());
+		if (flac && !streaming) encoder = std::make_unique<FlacEncodeQueue>();
 
-	for (size_t si = 0; si < selectedTracks.size(); si++) {
-		int ri = ripIndices[si];
-		const auto& t = ripDisc.tracks[ri];
-		const TrackSlice& sl = slices[ri];
-
-		// Build filename: "02. Artist - Title" or "Track 02"
-		std::wostringstream prefix;
-		prefix << std::setfill(L'0') << std::setw(2) << t.trackNumber << L". ";
+		for (size_t si = 0; si < selectedTracks.size(); si++) {
+			int ri = ripIndices[si];
+			const TrackSlice& sl = slices[ri];
+			std::wstring path = outputDir + TrackBaseName(disc, ripDisc.tracks[ri]) + extension;
 
-		std::wstring baseName;
-		bool hasCDText = (t.trackNumber > 0 &&
-			static_cast<size_t>(t.trackNumber) <= disc.cdText.trackTitles.size() &&
-			!disc.cdText.trackTitles[t.trackNumber - 1].empty());
-
-		if (hasCDText) {
-			std::string title = disc.cdText.trackTitles[t.trackNumber - 1];
-			std::string artist;
-			if (t.trackNumber > 0 &&
-				static_cast<size_t>(t.trackNumber) <= disc.cdText.trackArtists.size() &&
-				!disc.cdText.trackArtists[t.trackNumber - 1].empty()) {
-				artist = disc.cdText.trackArtists[t.trackNumber - 1];
+			if (streaming) {
+				saved[si] = streamOk;
+				continue;
 			}
-			std::string narrow = artist.empty() ? title : (artist + " - " + title);
-
-			std::wstring wide;
-			if (Utf8ToWide(narrow, wide)) {
-				std::wstring sanitized = SanitizeFilename(wide);
-				if (!sanitized.empty()) {
-					baseName = prefix.str() + sanitized;
-				}
+			SectorSpan trackAudio = ripDisc.rawSectors.AudioSpan(sl.start, sl.count);
+			if (trackAudio.count != sl.count) continue;
+			if (!flac) {
+				saved[si] = WriteWavFile(path, trackAudio);
+				continue;
 			}
+			FlacEncodeQueue::Job job;
+			job.path = path;
+			job.pcm = trackAudio.data;
+			job.bytes = trackAudio.Bytes();
+			job.tags = TrackTags(disc, ripDisc.tracks[ri]);
+			encodes[si] = encoder->Submit(std::move(job));
 		}
-
-		if (baseName.empty()) {
-			baseName = L"Track " + prefix.str().substr(0, 2);
+		for (size_t si = 0; si < selectedTracks.size(); si++) {
+			if (encodes[si].valid()) saved[si] = encodes[si].get();
 		}
+	}
 
-		std::wstring basePath = outputDir + baseName;
-		std::wstring actualPath;
-		bool flacFallback = false;
-
-		bool ok = WriteTrackFile(format, basePath, ripDisc.rawSectors,
-			sl.start, sl.count, actualPath, flacFallback);
-
-		if (flacFallback) anyFlacFallback = true;
-
-		if (ok) {
+	int savedCount = 0;
+	for (size_t si = 0; si < selectedTracks.size(); si++) {
+		std::wstring baseName = TrackBaseName(disc, ripDisc.tracks[ripIndices[si]]);
+		if (saved[si]) {
 			Console::Success("  Saved: ");
-			std::wcout << baseName;
-			if (flacFallback)
-				std::cout << " (WAV — FLAC encoding unavailable)";
-			std::cout << "\n";
+			std::wcout << baseName << extension << L"\n";
 			savedCount++;
 		}
 		else {
@@ -623,12 +618,6 @@ bool RunTrackRipWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstri
 		}
 	}
 
-	if (anyFlacFallback) {
-		Console::Warning("\nFLAC encoding unavailable or failed — affected tracks were saved as WAV.\n");
-		Console::Info("Install FLAC command-line tools (https://xiph.org/flac/) and ensure\n");
-		Console::Info("flac.exe is on your system PATH. If it is already installed, verify it launches correctly.\n");
-	}
-
 	std::string summary = "\n" + std::to_string(savedCount) + "/" +
 		std::to_string(selectedTracks.size()) + " track(s) saved to: ";
 	
@@ -753,19 +742,11 @@ bool RunTrackRipWorkflow(AudioCDCopier& copier, DiscInfo& disc, const std::wstri
 					continue;
 				}
 
-				bool trackMatch = true;
-				for (size_t i = 0; i < sl.count; i++) {
-					size_t idx = sl.start + i;
-					if (idx >= ripDisc.rawSectors.size() || idx >= verifyDisc.rawSectors.size()) {
-						trackMatch = false;
-						break;
-					}
-					if (memcmp(ripDisc.rawSectors[idx].data(),
-						verifyDisc.rawSectors[idx].data(), AUDIO_SECTOR_SIZE) != 0) {
-						trackMatch = false;
-						break;
-					}
-				}
+				// Both audio planes are contiguous — one compare per track.
+				SectorSpan ripAudio = ripDisc.rawSectors.AudioSpan(sl.start, sl.count);
+				SectorSpan verifyAudio = verifyDisc.rawSectors.AudioSpan(sl.start, sl.count);
+				bool trackMatch = ripAudio.count == sl.count && verifyAudio.count == sl.count &&
+					(sl.count == 0 || memcmp(ripAudio.data, verifyAudio.data, ripAudio.Bytes()) == 0);
 
 				if (trackMatch) {
 					verifiedAtAttempt[si] = attempt;
@@ -8,6 +8,8 @@ namespace WriteDiscInternal {
 	// Drive readiness and cache
 	bool WaitForDriveReady(ScsiDrive& drive, int timeoutSeconds);
 	bool SynchronizeCache(ScsiDrive& drive);
+	// READ BUFFER CAPACITY: drive write buffer size and its unused part, in bytes.
+	bool ReadBufferCapacity(ScsiDrive& drive, DWORD& bufferBytes, DWORD& blankBytes);
 
 	// Subchannel helpers
 	void DeinterleaveSubchannel(const BYTE* raw, BYTE* packed);
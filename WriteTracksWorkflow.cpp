@@ -1,15 +1,17 @@
-// ============================================================================
+﻿// ============================================================================
 // WriteTracksWorkflow.cpp - Write ripped track files to disc using the
 // pregap layout of the disc currently in the drive.
 //
 // Workflow:
 //   1. Confirm the inserted disc has audio tracks and show its pregap layout.
 //   2. Pick a folder containing one WAV (or FLAC) per audio track, sorted by
-//      filename. FLAC inputs are decoded to a temp WAV via flac.exe.
+//      filename. FLAC inputs are decoded in-process (FlacDecoder.h) straight
+//      into the image in step 4 — no temp WAVs — with their MD5 checked.
 //   3. Validate format (16-bit / 44100 Hz / stereo) and warn on length mismatch
 //      vs the source TOC.
 //   4. Build a temporary .bin (track audio + silence pregaps) and .cue with
-//      matching INDEX 00 / 01 entries.
+//      matching INDEX 00 / 01 entries.  Track payloads are read / decoded
+//      on worker threads, several tracks at once.
 //   5. Eject the source disc, wait for a blank, reopen the drive.
 //   6. Reuse the existing WriteDisc() pipeline (blanking, OPC, CUE sheet,
 //      CD-Text, IMAPI fallback).
@@ -24,9 +26,12 @@
 #include "ConsoleColors.h"
 #include "Constants.h"
 #include "FileUtils.h"
+#include "FlacDecoder.h"
 #include "InterruptHandler.h"
 #include "MenuHelpers.h"
+#include "SampleShifter.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <climits>
 #include <conio.h>
@@ -37,6 +42,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <windows.h>
 
@@ -44,10 +50,9 @@ namespace {
 
 struct TrackSource {
     std::wstring originalPath;     // .wav or .flac as supplied by the user
-    std::wstring wavPath;          // path actually opened for PCM (== originalPath unless decoded)
-    std::wstring tempWavPath;      // non-empty if we created a temp WAV from FLAC
-    DWORD dataOffset = 0;          // byte offset of "data" payload inside wavPath
-    DWORD dataBytes = 0;           // size of the "data" payload
+    bool isFlac = false;           // decoded with FlacDecoder rather than read
+    DWORD dataOffset = 0;          // WAV: byte offset of the "data" payload
+    DWORD dataBytes = 0;           // PCM bytes: WAV "data" size / decoded FLAC size
     DWORD sectorCount = 0;         // ceil(dataBytes / 2352)
     DWORD pregapSectors = 0;       // silence sectors emitted before this track's audio
     DWORD binStartLBA = 0;         // BIN LBA of INDEX 01 (audio start)
@@ -55,13 +60,13 @@ struct TrackSource {
     // Source-disc pregap audio captured at write time, offset-corrected.  Used
     // to preserve non-silent pregaps (live albums, continuous mixes) that the
     // PregapMode::Skip rip discards.  Empty → fall back to silence.
-    std::vector<std::vector<BYTE>> pregapAudio;
+    SectorStore pregapAudio;
     // Offset-corrected sectors immediately BEFORE this track's pregap, read
     // contiguously across the boundary so they carry the true audio for the
     // last few LBAs of the previous track's INDEX 01 region.  Used to repair
     // the previous track's gap-corrupted last WAV sector(s).  Captured even
     // when the pregap audio itself can't be read (drive refusing INDEX 00).
-    std::vector<std::vector<BYTE>> headOverlap;
+    SectorStore headOverlap;
 };
 
 bool Utf8ToWide(const std::string& input, std::wstring& output) {
@@ -146,26 +151,13 @@ bool ProbeWavFile(const std::wstring& path, TrackSource& ts, std::string& err) {
     return false;
 }
 
-// Decode a FLAC file to a temp WAV using flac.exe. Returns false if flac.exe
-// is missing or the decode fails.
-bool DecodeFlacToWav(const std::wstring& flacPath, const std::wstring& outWavPath) {
-    std::wstring cmd = L"flac --decode --silent --force -o \"" + outWavPath + L"\" \"" + flacPath + L"\"";
-
-    STARTUPINFOW si = { sizeof(si) };
-    si.dwFlags = STARTF_USESHOWWINDOW;
-    si.wShowWindow = SW_HIDE;
-    PROCESS_INFORMATION pi = {};
-
-    if (!CreateProcessW(nullptr, &cmd[0], nullptr, nullptr, FALSE,
-        CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)) {
-        return false;
-    }
-    WaitForSingleObject(pi.hProcess, INFINITE);
-    DWORD exitCode = 1;
-    GetExitCodeProcess(pi.hProcess, &exitCode);
-    CloseHandle(pi.hProcess);
-    CloseHandle(pi.hThread);
-    return exitCode == 0;
+// Read the FLAC STREAMINFO: format checks as for WAV, and the PCM size.
+bool ProbeFlacFile(const std::wstring& path, TrackSource& ts, std::string& err) {
+    FlacDecoder decoder;
+    if (!decoder.Open(path, err)) return false;
+    if (decoder.PcmBytes() > 0xFFFFFFFFull) { err = "track too long"; return false; }
+    ts.dataBytes = static_cast<DWORD>(decoder.PcmBytes());
+    return true;
 }
 
 // Collect .wav / .flac files from a folder, sorted alphabetically (case-insensitive).
@@ -189,40 +181,51 @@ std::vector<std::wstring> ScanAudioFiles(const std::wstring& folder) {
     return files;
 }
 
-// Append a track's PCM payload as 2352-byte sectors, padding the last sector
-// with zeros if the WAV doesn't end on a sector boundary. Bails out if the
-// WAV file delivers fewer bytes than the "data" chunk header promised — a
-// truncated rip would otherwise produce silent-tail tracks with no error.
-bool AppendWavToSectors(std::vector<std::vector<BYTE>>& sectors, const TrackSource& ts) {
-    std::ifstream in(ts.wavPath, std::ios::binary);
-    if (!in) return false;
+// Fill a track's place in the image (ceil(dataBytes / 2352) zeroed sectors)
+// with its PCM: the WAV payload in one read, or the FLAC decoded in place.
+// Fails if the WAV delivers fewer bytes than its "data" chunk promised or
+// the FLAC does not decode cleanly — a truncated track would otherwise
+// shift every following track and corrupt AccurateRip CRCs.
+bool ReadTrackAudio(const TrackSource& ts, BYTE* dst, std::string& err) {
+    if (ts.isFlac) {
+        FlacDecoder decoder;
+        if (!decoder.Open(ts.originalPath, err)) return false;
+        if (decoder.PcmBytes() != ts.dataBytes) { err = "file changed since it was probed"; return false; }
+        return decoder.DecodeTo(dst, err);
+    }
+
+    std::ifstream in(ts.originalPath, std::ios::binary);
+    if (!in) { err = "cannot open file"; return false; }
     in.seekg(ts.dataOffset);
-
-    DWORD remaining = ts.dataBytes;
-    for (DWORD s = 0; s < ts.sectorCount; s++) {
-        std::vector<BYTE> sec(AUDIO_SECTOR_SIZE, 0);
-        DWORD toRead = (remaining < AUDIO_SECTOR_SIZE) ? remaining : AUDIO_SECTOR_SIZE;
-        if (toRead > 0) {
-            in.read(reinterpret_cast<char*>(sec.data()), toRead);
-            DWORD got = static_cast<DWORD>(in.gcount());
-            if (got != toRead) {
-                // Short read: the WAV is shorter than its declared data size,
-                // or a stream error occurred. Either way the caller would get
-                // silent-tail audio, which would shift every following track
-                // and corrupt AccurateRip CRCs. Fail loudly instead.
-                return false;
-            }
-            remaining -= got;
-        }
-        sectors.push_back(std::move(sec));
+    if (ts.dataBytes > 0) {
+        in.read(reinterpret_cast<char*>(dst), ts.dataBytes);
+        if (static_cast<DWORD>(in.gcount()) != ts.dataBytes) { err = "file is shorter than its header says"; return false; }
     }
     return true;
 }
 
-void AppendSilenceSectors(std::vector<std::vector<BYTE>>& sectors, DWORD count) {
-    for (DWORD i = 0; i < count; i++) {
-        sectors.emplace_back(AUDIO_SECTOR_SIZE, 0);
-    }
+// ReadTrackAudio for every track on a few worker threads — FLAC decoding is
+// CPU-bound and the tracks are independent.  errors[i] is empty on success.
+void ReadAllTrackAudio(const std::vector<TrackSource>& sources, const std::vector<BYTE*>& dst,
+    std::vector<std::string>& errors) {
+    errors.assign(sources.size(), std::string());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next++; i < sources.size(); i = next++) {
+            std::string err;
+            if (!ReadTrackAudio(sources[i], dst[i], err)) errors[i] = err.empty() ? "read failed" : err;
+        }
+    };
+
+    size_t threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), sources.size()));
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+}
+
+void AppendSilenceSectors(SectorStore& sectors, DWORD count) {
+    sectors.AppendSilence(count);
 }
 
 DWORD ComputeMarginSectors(int driveReadOffset) {
@@ -254,19 +257,19 @@ DWORD ComputeMarginSectors(int driveReadOffset) {
 // Returns false only when even the boundary sectors are unreadable.
 bool ReadBoundaryOverlap(AudioCDCopier& copier, DWORD pregapStart,
     int driveReadOffset, DWORD marginSectors,
-    std::vector<std::vector<BYTE>>& outHeadOverlap) {
+    SectorStore& outHeadOverlap) {
     outHeadOverlap.clear();
     if (pregapStart < marginSectors) return false;
 
     DWORD readStart = pregapStart - marginSectors;
     DWORD readCount = marginSectors + 1;  // +1 sector for the offset shift target
 
-    std::vector<std::vector<BYTE>> readBuf(readCount,
-        std::vector<BYTE>(AUDIO_SECTOR_SIZE, 0));
+    SectorStore readBuf;
+    if (!readBuf.AppendSilence(readCount)) return false;
 
     auto& drive = copier.GetDriveRef();
     for (DWORD j = 0; j < readCount; j++) {
-        if (!drive.ReadSectorAudioOnly(readStart + j, readBuf[j].data())) {
+        if (!drive.ReadSectorAudioOnly(readStart + j, readBuf.Audio(j))) {
             if (j < marginSectors) {
                 // A boundary-overlap sector itself is unreadable — give up;
                 // burning silence here would corrupt the previous track's
@@ -287,11 +290,7 @@ bool ReadBoundaryOverlap(AudioCDCopier& copier, DWORD pregapStart,
         copier.ApplySampleOffset(readBuf, driveReadOffset);
     }
 
-    outHeadOverlap.reserve(marginSectors);
-    for (DWORD j = 0; j < marginSectors; j++) {
-        outHeadOverlap.push_back(std::move(readBuf[j]));
-    }
-    return true;
+    return outHeadOverlap.AppendFrom(readBuf, 0, marginSectors);
 }
 
 // Read the pregap region [pregapStart, pregapEnd] (inclusive LBAs) from the
@@ -305,8 +304,8 @@ bool ReadBoundaryOverlap(AudioCDCopier& copier, DWORD pregapStart,
 // the head-overlap data needed for the boundary repair.
 bool ReadPregapAudio(AudioCDCopier& copier, DWORD pregapStart, DWORD pregapEnd,
     int driveReadOffset, DWORD marginSectors,
-    std::vector<std::vector<BYTE>>& outSectors,
-    std::vector<std::vector<BYTE>>& outHeadOverlap) {
+    SectorStore& outSectors,
+    SectorStore& outHeadOverlap) {
     outHeadOverlap.clear();
     if (pregapEnd < pregapStart) { outSectors.clear(); return true; }
 
@@ -314,11 +313,11 @@ bool ReadPregapAudio(AudioCDCopier& copier, DWORD pregapStart, DWORD pregapEnd,
     DWORD readEnd = pregapEnd + marginSectors;
     DWORD readCount = readEnd - readStart + 1;
 
-    std::vector<std::vector<BYTE>> readBuf(readCount,
-        std::vector<BYTE>(AUDIO_SECTOR_SIZE, 0));
+    SectorStore readBuf;
+    if (!readBuf.AppendSilence(readCount)) return false;
     auto& drive = copier.GetDriveRef();
     for (DWORD j = 0; j < readCount; j++) {
-        if (!drive.ReadSectorAudioOnly(readStart + j, readBuf[j].data())) {
+        if (!drive.ReadSectorAudioOnly(readStart + j, readBuf.Audio(j))) {
             return false;
         }
     }
@@ -330,46 +329,53 @@ bool ReadPregapAudio(AudioCDCopier& copier, DWORD pregapStart, DWORD pregapEnd,
     DWORD pregapCount = pregapEnd - pregapStart + 1;
     DWORD startIdx = pregapStart - readStart;
 
-    outHeadOverlap.reserve(startIdx);
-    for (DWORD j = 0; j < startIdx; j++) {
-        outHeadOverlap.push_back(std::move(readBuf[j]));
-    }
-
     outSectors.clear();
-    outSectors.reserve(pregapCount);
-    for (DWORD j = 0; j < pregapCount; j++) {
-        outSectors.push_back(std::move(readBuf[startIdx + j]));
-    }
-
-    return true;
+    return outHeadOverlap.AppendFrom(readBuf, 0, startIdx) &&
+        outSectors.AppendFrom(readBuf, startIdx, pregapCount);
 }
 
-bool WriteSectorsToBin(const std::wstring& binPath, const std::vector<std::vector<BYTE>>& sectors) {
+// shiftSamples applies write-offset compensation on the way out, through a
+// carry buffer, instead of shifting the whole image in memory first.
+bool WriteSectorsToBin(const std::wstring& binPath, const SectorStore& sectors,
+    int shiftSamples) {
     std::ofstream bin(binPath, std::ios::binary | std::ios::trunc);
     if (!bin) return false;
-    constexpr size_t WRITE_BATCH = 64;  // sectors per write call
-    std::vector<BYTE> buf(WRITE_BATCH * AUDIO_SECTOR_SIZE);
-    size_t buffered = 0;
-    for (const auto& s : sectors) {
-        size_t copyLen = std::min<size_t>(s.size(), AUDIO_SECTOR_SIZE);
-        memcpy(buf.data() + buffered * AUDIO_SECTOR_SIZE, s.data(), copyLen);
-        if (copyLen < AUDIO_SECTOR_SIZE) {
-            memset(buf.data() + buffered * AUDIO_SECTOR_SIZE + copyLen, 0,
-                AUDIO_SECTOR_SIZE - copyLen);
-        }
-        buffered++;
-        if (buffered == WRITE_BATCH) {
-            bin.write(reinterpret_cast<const char*>(buf.data()),
-                buffered * AUDIO_SECTOR_SIZE);
+    // The audio plane is already the BIN payload byte-for-byte; write it in
+    // large slices straight from the store.
+    constexpr size_t WRITE_SLICE_SECTORS = 1782;  // ~4 MB per write call
+    SectorSpan audio = sectors.AudioSpan();
+
+    // Same no-op rule as ApplySampleOffset for offsets past the image size.
+    if (static_cast<uint64_t>(std::abs(static_cast<int64_t>(shiftSamples)) * 4) >= audio.Bytes()) {
+        shiftSamples = 0;
+    }
+
+    if (shiftSamples == 0) {
+        const char* src = reinterpret_cast<const char*>(audio.data);
+        size_t remaining = audio.Bytes();
+        while (remaining > 0) {
+            size_t n = std::min(remaining, WRITE_SLICE_SECTORS * AUDIO_SECTOR_SIZE);
+            bin.write(src, static_cast<std::streamsize>(n));
             if (!bin) return false;
-            buffered = 0;
+            src += n;
+            remaining -= n;
         }
+        return true;
     }
-    if (buffered > 0) {
-        bin.write(reinterpret_cast<const char*>(buf.data()), buffered * AUDIO_SECTOR_SIZE);
+
+    SampleShifter shifter(shiftSamples);
+    std::vector<BYTE> slice(WRITE_SLICE_SECTORS * AUDIO_SECTOR_SIZE);
+    for (size_t first = 0; first < audio.count; first += WRITE_SLICE_SECTORS) {
+        size_t n = std::min(WRITE_SLICE_SECTORS, audio.count - first);
+        size_t out = shifter.Push(audio.Sector(first), n, slice.data());
+        bin.write(reinterpret_cast<const char*>(slice.data()),
+            static_cast<std::streamsize>(out * AUDIO_SECTOR_SIZE));
         if (!bin) return false;
     }
-    return true;
+    size_t out = shifter.Finish(slice.data());
+    bin.write(reinterpret_cast<const char*>(slice.data()),
+        static_cast<std::streamsize>(out * AUDIO_SECTOR_SIZE));
+    return static_cast<bool>(bin);
 }
 
 // Sentinel returned by SelectWriteOffset to mean "user chose Back".
@@ -501,14 +507,6 @@ bool WaitForDiscReady(AudioCDCopier& copier, int timeoutSec) {
     return false;
 }
 
-void CleanupSources(std::vector<TrackSource>& sources) {
-    for (auto& ts : sources) {
-        if (!ts.tempWavPath.empty()) {
-            DeleteFileW(ts.tempWavPath.c_str());
-        }
-    }
-}
-
 }  // namespace
 
 void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
@@ -617,30 +615,13 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
         TrackSource& ts = sources[i];
         ts.originalPath = files[i];
 
-        if (EndsWithLower(files[i], L".flac")) {
-            std::wstring tempWav = workDir + L"\\_writetracks_in_" +
-                std::to_wstring(i) + L".wav";
-            Console::Info("Decoding ");
-            size_t slash = files[i].find_last_of(L"\\/");
-            std::wcout << (slash == std::wstring::npos ? files[i] : files[i].substr(slash + 1));
-            std::cout << "...\n";
-            if (!DecodeFlacToWav(files[i], tempWav)) {
-                Console::Error("FLAC decode failed (is flac.exe on PATH?). Aborting.\n");
-                CleanupSources(sources);
-                return;
-            }
-            ts.wavPath = tempWav;
-            ts.tempWavPath = tempWav;
-        }
-        else {
-            ts.wavPath = files[i];
-        }
+        ts.isFlac = EndsWithLower(files[i], L".flac");
 
         std::string err;
-        if (!ProbeWavFile(ts.wavPath, ts, err)) {
+        bool probed = ts.isFlac ? ProbeFlacFile(files[i], ts, err) : ProbeWavFile(files[i], ts, err);
+        if (!probed) {
             Console::Error("Track ");
             std::cout << (i + 1) << ": " << err << "\n";
-            CleanupSources(sources);
             return;
         }
 
@@ -662,7 +643,7 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
         std::cout << "Continue? (y/n): ";
         char c = static_cast<char>(_getch());
         std::cout << c << "\n";
-        if (tolower(c) != 'y') { CleanupSources(sources); return; }
+        if (tolower(c) != 'y') return;
     }
 
     // ── 6. Drive read offset + read pregap audio from source disc ──────
@@ -740,7 +721,6 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
     // ── 7. Write-offset compensation ───────────────────────────────────
     int writeOffsetCompensation = SelectWriteOffset(driveReadOffset);
     if (writeOffsetCompensation == WRITE_OFFSET_BACK) {
-        CleanupSources(sources);
         return;
     }
 
@@ -774,16 +754,18 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
     std::wstring cuePath = workDir + L"\\_writetracks_temp.cue";
 
     {
-        std::vector<std::vector<BYTE>> binSectors;
-        binSectors.reserve(totalBinSectors);
+        SectorStore binSectors;
+        if (!binSectors.Reserve(totalBinSectors)) {
+            Console::Error("Not enough memory for temp image.\n");
+            return;
+        }
 
+        std::vector<BYTE*> trackAudio(sources.size(), nullptr);
         for (size_t i = 0; i < sources.size(); i++) {
             if (sources[i].pregapSectors > 0) {
                 if (sources[i].pregapAudio.size() == sources[i].pregapSectors) {
                     // Use the audio captured fresh from the source disc.
-                    for (auto& sec : sources[i].pregapAudio) {
-                        binSectors.push_back(std::move(sec));
-                    }
+                    binSectors.AppendFrom(sources[i].pregapAudio, 0, sources[i].pregapSectors);
                     sources[i].pregapAudio.clear();
                 }
                 else {
@@ -791,14 +773,29 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
                     AppendSilenceSectors(binSectors, sources[i].pregapSectors);
                 }
             }
-            if (!AppendWavToSectors(binSectors, sources[i])) {
-                Console::Error("Failed reading WAV for track ");
-                std::cout << disc.tracks[audioTrackIdx[i]].trackNumber << "\n";
-                CleanupSources(sources);
+            // Zeroed, so a partial last sector is already padded.
+            trackAudio[i] = binSectors.AppendSectors(sources[i].sectorCount);
+            if (!trackAudio[i] && sources[i].sectorCount > 0) {
+                Console::Error("Not enough memory for temp image.\n");
                 return;
             }
         }
 
+        size_t flacCount = std::count_if(sources.begin(), sources.end(),
+            [](const TrackSource& ts) { return ts.isFlac; });
+        if (flacCount > 0) {
+            Console::Info("Decoding ");
+            std::cout << flacCount << " FLAC file(s)...\n";
+        }
+        std::vector<std::string> readErrors;
+        ReadAllTrackAudio(sources, trackAudio, readErrors);
+        for (size_t i = 0; i < sources.size(); i++) {
+            if (readErrors[i].empty()) continue;
+            Console::Error("Failed reading track ");
+            std::cout << disc.tracks[audioTrackIdx[i]].trackNumber << ": " << readErrors[i] << "\n";
+            return;
+        }
+
         // Fix boundary sectors corrupted by offset correction across gaps.
         // The WAV rip used PregapMode::Skip, so the rawSectors stream had
         // gaps at each pregap.  ApplyOffsetCorrection treated it as contiguous,
@@ -825,7 +822,8 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
             DWORD startPos = pos - count;
             for (DWORD j = 0; j < count; j++) {
                 if (startPos + j < binSectors.size()) {
-                    binSectors[startPos + j] = std::move(sources[i].headOverlap[j]);
+                    memcpy(binSectors.Audio(startPos + j),
+                        sources[i].headOverlap.Audio(j), AUDIO_SECTOR_SIZE);
                 }
             }
             sources[i].headOverlap.clear();
@@ -841,13 +839,11 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
             Console::Info("Applying write-offset compensation: ");
             std::cout << writeOffsetCompensation << " samples ("
                 << (writeOffsetCompensation * 4) << " bytes)...\n";
-            copier.ApplySampleOffset(binSectors, writeOffsetCompensation);
         }
 
-        if (!WriteSectorsToBin(binPath, binSectors)) {
+        if (!WriteSectorsToBin(binPath, binSectors, writeOffsetCompensation)) {
             Console::Error("Failed writing temp BIN file.\n");
             DeleteFileW(binPath.c_str());
-            CleanupSources(sources);
             return;
         }
     }  // binSectors freed here
@@ -856,16 +852,11 @@ void RunWriteTracksWorkflow(AudioCDCopier& copier, DiscInfo& disc,
         Console::Error("Failed writing temp CUE file.\n");
         DeleteFileW(binPath.c_str());
         DeleteFileW(cuePath.c_str());
-        CleanupSources(sources);
         return;
     }
 
     Console::Success("Temp image ready.\n");
 
-    // The decoded WAV temp files for FLAC inputs are no longer needed once
-    // the BIN has been built.
-    CleanupSources(sources);
-
     auto removeTemps = [&]() {
         DeleteFileW(binPath.c_str());
         DeleteFileW(cuePath.c_str());
@@ -240,10 +240,9 @@ int main() {
 		copier.ReadISRC(disc);
 
 		// • AccurateRip: query the online database using disc IDs derived
-		//   from the TOC geometry.  Returns per-track CRCs from multiple
-		//   verified pressings so the ripped audio can be validated later.
-		std::vector<std::vector<uint32_t>> pressingCRCs;
-		AccurateRip::Lookup(disc, pressingCRCs);
+		//   from the TOC geometry.  Stores per-track V1/V2 CRCs from every
+		//   pressing in disc.accurateRipPressings so the rip can be verified.
+		AccurateRip::Lookup(disc);
 
 		// Display a formatted summary of the disc: track count, total
 		// duration, CD-TEXT metadata, and AccurateRip match status.
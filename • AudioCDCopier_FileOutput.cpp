@@ -14,22 +14,6 @@
 // ============================================================================
 
 bool AudioCDCopier::SaveToFile(const DiscInfo& disc, const std::wstring& base) {
-	// Calculate and display original disc IDs for verification
-	uint32_t originalDiscID1 = AccurateRip::CalculateDiscID1(disc);
-	uint32_t originalDiscID2 = AccurateRip::CalculateDiscID2(disc);
-	uint32_t originalCDDB = AccurateRip::CalculateCDDBID(disc);
-
-	std::cout << "\n=== IMPORTANT: Original Disc AccurateRip IDs ===\n";
-	std::cout << "These IDs are from the ORIGINAL disc TOC.\n";
-	std::cout << "Burned copies will have DIFFERENT IDs but identical audio.\n";
-	std::cout << "  Disc ID 1: " << std::hex << std::setfill('0')
-		<< std::setw(8) << originalDiscID1 << std::dec << "\n";
-	std::cout << "  Disc ID 2: " << std::hex << std::setfill('0')
-		<< std::setw(8) << originalDiscID2 << std::dec << "\n";
-	std::cout << "  CDDB ID:   " << std::hex << std::setfill('0')
-		<< std::setw(8) << originalCDDB << std::dec << "\n";
-	std::cout << "These IDs are saved in the .cue file for reference.\n\n";
-
 	std::ofstream img(std::filesystem::path(base + L".bin"), std::ios::binary);
 	if (!img) return false;
 
@@ -61,10 +45,12 @@ bool AudioCDCopier::SaveToFile(const DiscInfo& disc, const std::wstring& base) {
 			std::ofstream pregapFile(std::filesystem::path(pregapPath), std::ios::binary);
 			if (pregapFile) {
 				DWORD pregapCount = t.startLBA - t.pregapLBA;
-				for (DWORD j = 0; j < pregapCount && sectorIdx < disc.rawSectors.size(); j++) {
-					const auto& s = disc.rawSectors[sectorIdx++];
-					pregapFile.write(reinterpret_cast<const char*>(s.data()), AUDIO_SECTOR_SIZE);
+				SectorSpan pregap = disc.rawSectors.AudioSpan(sectorIdx, pregapCount);
+				if (!pregap.empty()) {
+					pregapFile.write(reinterpret_cast<const char*>(pregap.data),
+						static_cast<std::streamsize>(pregap.Bytes()));
 				}
+				sectorIdx += pregap.count;
 				pregapFiles.push_back(pregapPath);
 			}
 			start = t.startLBA;
@@ -72,16 +58,44 @@ bool AudioCDCopier::SaveToFile(const DiscInfo& disc, const std::wstring& base) {
 			count = t.endLBA - t.startLBA + 1;
 		}
 
-		for (DWORD j = 0; j < count&& sectorIdx < disc.rawSectors.size(); j++) {
-			const auto& s = disc.rawSectors[sectorIdx++];
-			img.write(reinterpret_cast<const char*>(s.data()), AUDIO_SECTOR_SIZE);
+		// The track's audio is one contiguous run in the store — write it
+		// in a single call; subchannel records come from their own plane.
+		SectorSpan audio = disc.rawSectors.AudioSpan(sectorIdx, count);
+		if (!audio.empty()) {
+			img.write(reinterpret_cast<const char*>(audio.data),
+				static_cast<std::streamsize>(audio.Bytes()));
+		}
 
-			if (disc.includeSubchannel && t.isAudio && s.size() > AUDIO_SECTOR_SIZE) {
-				sub.write(reinterpret_cast<const char*>(s.data() + AUDIO_SECTOR_SIZE), SUBCHANNEL_SIZE);
+		if (disc.includeSubchannel && t.isAudio) {
+			for (size_t j = 0; j < audio.count; j++) {
+				const BYTE* q = disc.rawSectors.Subchannel(sectorIdx + j);
+				if (q) sub.write(reinterpret_cast<const char*>(q), SUBCHANNEL_SIZE);
 			}
 		}
+		sectorIdx += audio.count;
 	}
 
+	return SaveCueSheet(disc, base, pregapFiles);
+}
+
+bool AudioCDCopier::SaveCueSheet(const DiscInfo& disc, const std::wstring& base,
+	const std::vector<std::wstring>& pregapFiles) {
+	// Calculate and display original disc IDs for verification
+	uint32_t originalDiscID1 = AccurateRip::CalculateDiscID1(disc);
+	uint32_t originalDiscID2 = AccurateRip::CalculateDiscID2(disc);
+	uint32_t originalCDDB = AccurateRip::CalculateCDDBID(disc);
+
+	std::cout << "\n=== IMPORTANT: Original Disc AccurateRip IDs ===\n";
+	std::cout << "These IDs are from the ORIGINAL disc TOC.\n";
+	std::cout << "Burned copies will have DIFFERENT IDs but identical audio.\n";
+	std::cout << "  Disc ID 1: " << std::hex << std::setfill('0')
+		<< std::setw(8) << originalDiscID1 << std::dec << "\n";
+	std::cout << "  Disc ID 2: " << std::hex << std::setfill('0')
+		<< std::setw(8) << originalDiscID2 << std::dec << "\n";
+	std::cout << "  CDDB ID:   " << std::hex << std::setfill('0')
+		<< std::setw(8) << originalCDDB << std::dec << "\n";
+	std::cout << "These IDs are saved in the .cue file for reference.\n\n";
+
 	int fnLen = WideCharToMultiByte(CP_ACP, 0, base.c_str(), -1, nullptr, 0, nullptr, nullptr);
 	std::string fn(fnLen > 0 ? fnLen - 1 : 0, '\0');
 	WideCharToMultiByte(CP_ACP, 0, base.c_str(), -1, fn.data(), fnLen, nullptr, nullptr);
@@ -397,7 +411,8 @@ bool AudioCDCopier::SaveSecureRipLog(const SecureRipResult& result, const std::w
 	out << "# Passes: " << log.minPasses << "-" << log.maxPasses
 		<< ", Required matches: " << log.requiredMatches << "\n";
 	out << "# C2 detection: " << (log.useC2 ? "YES" : "NO")
-		<< ", Cache defeat: " << (log.cacheDefeat ? "YES" : "NO") << "\n";
+		<< ", Cache defeat: " << (log.cacheDefeat ? "YES" : "NO")
+		<< ", Sample vote: " << (log.sampleVote ? "YES" : "NO") << "\n";
 	out << "#\n";
 
 	// Overall summary
@@ -429,7 +444,7 @@ bool AudioCDCopier::SaveSecureRipLog(const SecureRipResult& result, const std::w
 	out << "#\n";
 
 	// Sector-level CSV
-	out << "LBA,Track,Phase,Passes,Matches,C2Errors,ReadTimeMs,Verified,Hash\n";
+	out << "LBA,Track,Phase,Passes,Matches,C2Errors,ReadTimeMs,Verified,Hash,Contested,MinConfidence\n";
 
 	for (const auto& e : log.entries) {
 		out << e.lba << ","
@@ -440,8 +455,21 @@ bool AudioCDCopier::SaveSecureRipLog(const SecureRipResult& result, const std::w
 			<< e.c2Errors << ","
 			<< std::fixed << std::setprecision(2) << e.readTimeMs << ","
 			<< (e.verified ? "YES" : "NO") << ","
-			<< std::hex << std::setfill('0') << std::setw(8) << e.hash
-			<< std::dec << "\n";
+			<< std::hex << std::setfill('0') << std::setw(16) << e.hash
+			<< std::dec << std::setfill(' ') << ","
+			<< e.contestedSamples << ","
+			<< std::setprecision(3) << e.minSampleConfidence << "\n";
+	}
+
+	// Per-sample confidence for sectors rebuilt by sample vote
+	if (!log.sampleVotes.empty()) {
+		out << "#\n";
+		out << "# === Sample Vote ===\n";
+		out << "LBA,Sample,Confidence\n";
+		for (const auto& v : log.sampleVotes) {
+			out << v.lba << "," << v.sample << ","
+				<< std::fixed << std::setprecision(3) << v.confidence << "\n";
+		}
 	}
 
 	out.flush();
@@ -274,12 +274,11 @@ bool AudioCDCopier::CalculateAudioFingerprint(const DiscInfo& disc, AudioFingerp
 		for (DWORD i = 0; i < trackSectors && sectorIdx < disc.rawSectors.size(); i++, sectorIdx++) {
 			if (i % sampleInterval != 0) continue;  // Skip non-sampled sectors
 
-			const auto& sector = disc.rawSectors[sectorIdx];
-			if (sector.size() < AUDIO_SECTOR_SIZE) continue;
+			const BYTE* sector = disc.rawSectors.Audio(sectorIdx);
 
 			// Read 4-byte words at 16-byte intervals through the 2352-byte sector.
 			for (int j = 0; j < AUDIO_SECTOR_SIZE; j += 16) {
-				uint32_t sample = *reinterpret_cast<const uint32_t*>(sector.data() + j);
+				uint32_t sample = *reinterpret_cast<const uint32_t*>(sector + j);
 
 				// Fold the sample into the running FNV-1a hash.
 				audioHash ^= sample;
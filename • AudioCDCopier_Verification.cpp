@@ -73,10 +73,7 @@ bool AudioCDCopier::VerifyWrittenFile(const std::wstring& filename, const DiscIn
 			break;
 		}
 
-		const auto& origSector = disc.rawSectors[i];
-		size_t compareSize = std::min(origSector.size(), static_cast<size_t>(AUDIO_SECTOR_SIZE));
-
-		if (memcmp(fileSector.data(), origSector.data(), compareSize) != 0) {
+		if (memcmp(fileSector.data(), disc.rawSectors.Audio(i), AUDIO_SECTOR_SIZE) != 0) {
 			mismatchedSectors.push_back(sectorNum);
 		}
 